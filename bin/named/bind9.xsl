@@ -590,7 +590,7 @@
           <xsl:if test="counters[@type=&quot;cachestats&quot;]/counter[.&gt;0]">
             <h3>Cache Statistics for View <xsl:value-of select="@name"/></h3>
             <table class="counters">
-              <xsl:for-each select="counters[@type=&quot;cachestats&quot;]/counter[.&gt;0]">
+              <xsl:for-each select="counters[@type=&quot;cachestats&quot;]/counter[.&gt;0 and @name!=&quot;CacheRRsets&quot; and @name!=&quot;AvgTreeMemPerRRset&quot;]">
                 <xsl:sort select="." data-type="number" order="descending"/>
                 <xsl:variable name="css-class5">
                   <xsl:choose>
@@ -610,6 +610,25 @@
             </table>
           </xsl:if>
         </xsl:for-each>
+        <xsl:for-each select="views/view">
+          <xsl:if test="counters[@type=&quot;cachestats&quot;]/counter[@name=&quot;CacheRRsets&quot;][.&gt;0]">
+            <h3>Cache Memory per RRset for View <xsl:value-of select="@name"/></h3>
+            <table class="counters">
+              <tr class="odd">
+                <th>RRsets</th>
+                <td>
+                  <xsl:value-of select="counters[@type=&quot;cachestats&quot;]/counter[@name=&quot;CacheRRsets&quot;]"/>
+                </td>
+              </tr>
+              <tr class="even">
+                <th>Average Tree Memory per RRset</th>
+                <td>
+                  <xsl:value-of select="counters[@type=&quot;cachestats&quot;]/counter[@name=&quot;AvgTreeMemPerRRset&quot;]"/>
+                </td>
+              </tr>
+            </table>
+          </xsl:if>
+        </xsl:for-each>
         <xsl:for-each select="views/view">
           <xsl:if test="cache/rrset">
             <h3>Cache DB RRsets for View <xsl:value-of select="@name"/></h3>
@@ -95,6 +95,8 @@ options {\n\
 #endif
 			    "\
 	prefetch 2 9;\n\
+	prefetch-refresh-count 0;\n\
+	prefetch-refresh-rate 100;\n\
 #	querylog <boolean>;\n\
 	recursing-file \"named.recursing\";\n\
 	recursive-clients 1000;\n\
@@ -104,6 +106,7 @@ options {\n\
 	rrset-order { order random; };\n\
 	secroots-file \"named.secroots\";\n\
 	send-cookie true;\n\
+	serial-query-batch 0;\n\
 	serial-query-rate 20;\n\
 	server-id none;\n\
 	session-keyalg hmac-sha256;\n\
@@ -118,6 +121,7 @@ options {\n\
 	tcp-initial-timeout 300;\n\
 	tcp-keepalive-timeout 300;\n\
 	tcp-listen-queue 10;\n\
+	tcp-pipelining-limit 23;\n\
 	tcp-receive-buffer 0;\n\
 	tcp-send-buffer 0;\n\
 #	tkey-domain <none>\n\
@@ -129,6 +133,7 @@ options {\n\
 	trust-anchor-telemetry yes;\n\
 	udp-receive-buffer 0;\n\
 	udp-send-buffer 0;\n\
+	update-batch-size 0;\n\
 	update-quota 100;\n\
 \n\
 	/* view */\n\
@@ -179,6 +184,7 @@ options {\n\
 	notify-source *;\n\
 	notify-source-v6 *;\n\
 	nsec3-test-zone no;\n\
+	nxdomain-cut yes;\n\
 	parental-source *;\n\
 	parental-source-v6 *;\n\
 	provide-ixfr true;\n\
@@ -70,6 +70,7 @@ struct named_server {
 	isc_timer_t *heartbeat_timer;
 	isc_timer_t *pps_timer;
 	isc_timer_t *tat_timer;
+	isc_timer_t *ticketkey_timer;
 
 	uint32_t interface_interval;
 
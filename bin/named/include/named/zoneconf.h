@@ -43,6 +43,22 @@ named_zone_configure(const cfg_obj_t *config, const cfg_obj_t *vconfig,
  * \li	'zone' to be initialized.
  */
 
+isc_result_t
+named_zone_configure_acls(const cfg_obj_t *config, const cfg_obj_t *vconfig,
+			  const cfg_obj_t *zconfig, cfg_aclconfctx_t *ac,
+			  dns_zone_t *zone, dns_zone_t *raw);
+/*%<
+ * Configure the zone ACLs according to the named.conf data.  ACLs
+ * that the zone inherits from the view or the global options are
+ * taken from, or cached in, the view the zone is attached to, so
+ * this must be called again whenever the zone moves to a new view,
+ * even if the zone statement itself is unchanged.
+ *
+ * Require:
+ * \li	'ac' to point to an initialized cfg_aclconfctx_t.
+ * \li	'zone' to be initialized and attached to its view.
+ */
+
 bool
 named_zone_reusable(dns_zone_t *zone, const cfg_obj_t *zconfig,
 		    const cfg_obj_t *vconfig, const cfg_obj_t *config,
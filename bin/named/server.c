@@ -60,6 +60,7 @@
 #include <isc/string.h>
 #include <isc/time.h>
 #include <isc/timer.h>
+#include <isc/tls.h>
 #include <isc/util.h>
 
 #include <dns/adb.h>
@@ -328,18 +329,28 @@ typedef struct {
 	isc_refcount_t refs;
 } ns_zoneload_t;
 
+typedef struct catz_chgzone catz_chgzone_t;
+
 typedef struct {
 	named_server_t *server;
+
+	/* Member zone changes waiting for catz_chgzones_cb() */
+	isc_mutex_t lock;
+	ISC_LIST(catz_chgzone_t) changes;
 } catz_cb_data_t;
 
-typedef struct catz_chgzone {
+struct catz_chgzone {
 	isc_mem_t *mctx;
 	dns_catz_entry_t *entry;
 	dns_catz_zone_t *origin;
 	dns_view_t *view;
 	catz_cb_data_t *cbd;
 	bool mod;
-} catz_chgzone_t;
+	bool del;
+	dns_zone_t *zone; /* added zone, to be loaded */
+	cfg_obj_t *zoneconf;
+	ISC_LINK(catz_chgzone_t) link;
+};
 
 typedef struct catz_reconfig_data {
 	dns_catz_zone_t *catz;
@@ -474,7 +485,11 @@ configure_zone(const cfg_obj_t *config, const cfg_obj_t *zconfig,
 	       const cfg_obj_t *vconfig, dns_view_t *view,
 	       dns_viewlist_t *viewlist, dns_kasplist_t *kasplist,
 	       dns_keystorelist_t *keystores, cfg_aclconfctx_t *aclconf,
-	       bool added, bool old_rpz_ok, bool is_catz_member, bool modify);
+	       bool added, bool old_rpz_ok, bool is_catz_member, bool modify,
+	       uint64_t cfgctx);
+
+static uint64_t
+cfghash_context(const cfg_obj_t *config, const cfg_obj_t *vconfig);
 
 static void
 configure_zone_setviewcommit(isc_result_t result, const cfg_obj_t *zconfig,
@@ -703,6 +718,75 @@ cleanup:
 	return (result);
 }
 
+/*
+ * Configure the query names, query types and per-source rate that
+ * cause requests to be dropped before they are parsed.
+ */
+static isc_result_t
+configure_early_drop(const cfg_obj_t *config, const cfg_obj_t **maps,
+		     ns_server_t *sctx) {
+	isc_result_t result;
+	const cfg_obj_t *obj = NULL;
+	const cfg_listelt_t *element = NULL;
+	dns_nametree_t *names = NULL;
+	dns_rdatatype_t *types = NULL;
+	size_t ntypes = 0;
+
+	(void)named_config_get(maps, "early-drop-names", &obj);
+	if (obj != NULL && cfg_list_first(obj) != NULL) {
+		result = configure_view_nametable(NULL, config,
+						  "early-drop-names", NULL,
+						  named_g_mctx, &names);
+		if (result != ISC_R_SUCCESS) {
+			return (result);
+		}
+	}
+	ns_server_setdropnames(sctx, names);
+	if (names != NULL) {
+		dns_nametree_detach(&names);
+	}
+
+	obj = NULL;
+	(void)named_config_get(maps, "early-drop-types", &obj);
+	if (obj != NULL) {
+		ntypes = cfg_list_length(obj, false);
+	}
+	if (ntypes != 0) {
+		size_t i = 0;
+
+		types = isc_mem_cget(named_g_mctx, ntypes, sizeof(types[0]));
+		for (element = cfg_list_first(obj); element != NULL;
+		     element = cfg_list_next(element))
+		{
+			const cfg_obj_t *typeobj = cfg_listelt_value(element);
+			isc_textregion_t r;
+
+			r.base = UNCONST(cfg_obj_asstring(typeobj));
+			r.length = strlen(r.base);
+			result = dns_rdatatype_fromtext(&types[i++], &r);
+			if (result != ISC_R_SUCCESS) {
+				cfg_obj_log(typeobj, ISC_LOG_ERROR,
+					    "early-drop-types: invalid type "
+					    "'%s'",
+					    r.base);
+				isc_mem_cput(named_g_mctx, types, ntypes,
+					     sizeof(types[0]));
+				return (result);
+			}
+		}
+	}
+	ns_server_setdroptypes(sctx, types, ntypes);
+	if (types != NULL) {
+		isc_mem_cput(named_g_mctx, types, ntypes, sizeof(types[0]));
+	}
+
+	obj = NULL;
+	(void)named_config_get(maps, "early-drop-rate", &obj);
+	ns_server_setdroprate(sctx, obj != NULL ? cfg_obj_asuint32(obj) : 0);
+
+	return (ISC_R_SUCCESS);
+}
+
 static isc_result_t
 ta_fromconfig(const cfg_obj_t *key, bool *initialp, const char **namestrp,
 	      unsigned char *digest, dns_rdata_ds_t *ds) {
@@ -2371,9 +2455,13 @@ configure_rpz(dns_view_t *view, dns_view_t *pview, const cfg_obj_t *rpz_obj,
 	return (ISC_R_SUCCESS);
 }
 
+/*
+ * Configure a zone added or modified by a catalog zone.  This runs with
+ * the loops paused; a new zone is left in cz->zone to be loaded after
+ * they are resumed.
+ */
 static void
-catz_addmodzone_cb(void *arg) {
-	catz_chgzone_t *cz = (catz_chgzone_t *)arg;
+catz_addmodzone(catz_chgzone_t *cz) {
 	isc_result_t result;
 	dns_forwarders_t *dnsforwarders = NULL;
 	dns_name_t *name = NULL;
@@ -2381,14 +2469,8 @@ catz_addmodzone_cb(void *arg) {
 	isc_buffer_t *confbuf = NULL;
 	char nameb[DNS_NAME_FORMATSIZE];
 	const cfg_obj_t *zlist = NULL;
-	cfg_obj_t *zoneconf = NULL;
 	cfg_obj_t *zoneobj = NULL;
 	ns_cfgctx_t *cfg = NULL;
-	dns_zone_t *zone = NULL;
-
-	if (isc_loop_shuttingdown(isc_loop_get(named_g_loopmgr, isc_tid()))) {
-		goto cleanup;
-	}
 
 	/*
 	 * A non-empty 'catalog-zones' statement implies that 'allow-new-zones'
@@ -2418,7 +2500,7 @@ catz_addmodzone_cb(void *arg) {
 		goto cleanup;
 	}
 
-	result = dns_view_findzone(cz->view, name, DNS_ZTFIND_EXACT, &zone);
+	result = dns_view_findzone(cz->view, name, DNS_ZTFIND_EXACT, &cz->zone);
 
 	if (cz->mod) {
 		dns_catz_zone_t *parentcatz;
@@ -2432,7 +2514,7 @@ catz_addmodzone_cb(void *arg) {
 			goto cleanup;
 		}
 
-		if (!dns_zone_getadded(zone)) {
+		if (!dns_zone_getadded(cz->zone)) {
 			isc_log_write(NAMED_LOGCATEGORY_GENERAL,
 				      NAMED_LOGMODULE_SERVER, ISC_LOG_WARNING,
 				      "catz: catz_addmodzone_cb: "
@@ -2442,7 +2524,7 @@ catz_addmodzone_cb(void *arg) {
 			goto cleanup;
 		}
 
-		parentcatz = dns_zone_get_parentcatz(zone);
+		parentcatz = dns_zone_get_parentcatz(cz->zone);
 
 		if (parentcatz == NULL) {
 			isc_log_write(NAMED_LOGCATEGORY_GENERAL,
@@ -2463,11 +2545,11 @@ catz_addmodzone_cb(void *arg) {
 			goto cleanup;
 		}
 
-		dns_zone_detach(&zone);
+		dns_zone_detach(&cz->zone);
 	} else {
 		/* Zone shouldn't already exist when adding */
 		if (result == ISC_R_SUCCESS) {
-			if (dns_zone_get_parentcatz(zone) == NULL) {
+			if (dns_zone_get_parentcatz(cz->zone) == NULL) {
 				isc_log_write(NAMED_LOGCATEGORY_GENERAL,
 					      NAMED_LOGMODULE_SERVER,
 					      ISC_LOG_WARNING,
@@ -2494,14 +2576,15 @@ catz_addmodzone_cb(void *arg) {
 			RUNTIME_CHECK(result == ISC_R_NOTFOUND);
 		}
 	}
-	RUNTIME_CHECK(zone == NULL);
+	RUNTIME_CHECK(cz->zone == NULL);
 	/* Create a config for new zone */
 	confbuf = NULL;
 	result = dns_catz_generate_zonecfg(cz->origin, cz->entry, &confbuf);
 	if (result == ISC_R_SUCCESS) {
 		cfg_parser_reset(cfg->add_parser);
 		result = cfg_parse_buffer(cfg->add_parser, confbuf, "catz", 0,
-					  &cfg_type_addzoneconf, 0, &zoneconf);
+					  &cfg_type_addzoneconf, 0,
+					  &cz->zoneconf);
 		isc_buffer_free(&confbuf);
 	}
 	/*
@@ -2516,7 +2599,7 @@ catz_addmodzone_cb(void *arg) {
 			      isc_result_totext(result), nameb);
 		goto cleanup;
 	}
-	CHECK(cfg_map_get(zoneconf, "zone", &zlist));
+	CHECK(cfg_map_get(cz->zoneconf, "zone", &zlist));
 	if (!cfg_obj_islist(zlist)) {
 		CHECK(ISC_R_FAILURE);
 	}
@@ -2524,17 +2607,12 @@ catz_addmodzone_cb(void *arg) {
 	/* For now we only support adding one zone at a time */
 	zoneobj = cfg_listelt_value(cfg_list_first(zlist));
 
-	/* Mark view unfrozen so that zone can be added */
-	isc_loopmgr_pause(named_g_loopmgr);
-	dns_view_thaw(cz->view);
+	/* The view has been unfrozen by the caller */
 	result = configure_zone(cfg->config, zoneobj, cfg->vconfig, cz->view,
 				&cz->cbd->server->viewlist,
 				&cz->cbd->server->kasplist,
 				&cz->cbd->server->keystorelist, cfg->actx, true,
-				false, true, cz->mod);
-	dns_view_freeze(cz->view);
-	isc_loopmgr_resume(named_g_loopmgr);
-
+				false, true, cz->mod, 0);
 	if (result != ISC_R_SUCCESS) {
 		isc_log_write(NAMED_LOGCATEGORY_GENERAL, NAMED_LOGMODULE_SERVER,
 			      ISC_LOG_WARNING,
@@ -2543,8 +2621,26 @@ catz_addmodzone_cb(void *arg) {
 		goto cleanup;
 	}
 
-	/* Is it there yet? */
-	CHECK(dns_view_findzone(cz->view, name, DNS_ZTFIND_EXACT, &zone));
+	/* Is it there yet?  It is loaded once the loops are resumed. */
+	CHECK(dns_view_findzone(cz->view, name, DNS_ZTFIND_EXACT, &cz->zone));
+	if (dnsforwarders != NULL) {
+		dns_forwarders_detach(&dnsforwarders);
+	}
+	return;
+
+cleanup:
+	if (cz->zone != NULL) {
+		dns_zone_detach(&cz->zone);
+	}
+	if (dnsforwarders != NULL) {
+		dns_forwarders_detach(&dnsforwarders);
+	}
+}
+
+static void
+catz_addmodzone_load(catz_chgzone_t *cz) {
+	isc_result_t result;
+	dns_zone_t *zone = cz->zone;
 
 	/*
 	 * Load the zone from the master file.	If this fails, we'll
@@ -2567,44 +2663,26 @@ catz_addmodzone_cb(void *arg) {
 
 		/* Remove the zone from the zone table */
 		dns_view_delzone(cz->view, zone);
-		goto cleanup;
+		return;
 	}
 
 	/* Flag the zone as having been added at runtime */
 	dns_zone_setadded(zone, true);
 	dns_zone_set_parentcatz(zone, cz->origin);
-
-cleanup:
-	if (zone != NULL) {
-		dns_zone_detach(&zone);
-	}
-	if (zoneconf != NULL) {
-		cfg_obj_destroy(cfg->add_parser, &zoneconf);
-	}
-	if (dnsforwarders != NULL) {
-		dns_forwarders_detach(&dnsforwarders);
-	}
-	dns_catz_entry_detach(cz->origin, &cz->entry);
-	dns_catz_zone_detach(&cz->origin);
-	dns_view_weakdetach(&cz->view);
-	isc_mem_putanddetach(&cz->mctx, cz, sizeof(*cz));
 }
 
+/*
+ * Delete a zone removed from a catalog zone.  This runs with the loops
+ * paused.
+ */
 static void
-catz_delzone_cb(void *arg) {
-	catz_chgzone_t *cz = (catz_chgzone_t *)arg;
+catz_delzone_run(catz_chgzone_t *cz) {
 	isc_result_t result;
 	dns_zone_t *zone = NULL;
 	dns_db_t *dbp = NULL;
 	char cname[DNS_NAME_FORMATSIZE];
 	const char *file = NULL;
 
-	if (isc_loop_shuttingdown(isc_loop_get(named_g_loopmgr, isc_tid()))) {
-		goto cleanup;
-	}
-
-	isc_loopmgr_pause(named_g_loopmgr);
-
 	dns_name_format(dns_catz_entry_getname(cz->entry), cname,
 			DNS_NAME_FORMATSIZE);
 	result = dns_view_findzone(cz->view, dns_catz_entry_getname(cz->entry),
@@ -2615,7 +2693,7 @@ catz_delzone_cb(void *arg) {
 			      "catz: catz_delzone_cb: "
 			      "zone '%s' not found",
 			      cname);
-		goto resume;
+		goto cleanup;
 	}
 
 	if (!dns_zone_getadded(zone)) {
@@ -2624,7 +2702,7 @@ catz_delzone_cb(void *arg) {
 			      "catz: catz_delzone_cb: "
 			      "zone '%s' is not a dynamically added zone",
 			      cname);
-		goto resume;
+		goto cleanup;
 	}
 
 	if (dns_zone_get_parentcatz(zone) != cz->origin) {
@@ -2633,7 +2711,7 @@ catz_delzone_cb(void *arg) {
 			      "catz: catz_delzone_cb: zone "
 			      "'%s' exists in multiple catalog zones",
 			      cname);
-		goto resume;
+		goto cleanup;
 	}
 
 	/* Stop answering for this zone */
@@ -2643,7 +2721,7 @@ catz_delzone_cb(void *arg) {
 	}
 
 	if (dns_view_delzone(cz->view, zone) != ISC_R_SUCCESS) {
-		goto resume;
+		goto cleanup;
 	}
 	file = dns_zone_getfile(zone);
 	if (file != NULL) {
@@ -2659,31 +2737,97 @@ catz_delzone_cb(void *arg) {
 		      "catz: catz_delzone_cb: "
 		      "zone '%s' deleted",
 		      cname);
-resume:
-	isc_loopmgr_resume(named_g_loopmgr);
 cleanup:
 	if (zone != NULL) {
 		dns_zone_detach(&zone);
 	}
+}
+
+static void
+catz_chgzone_free(catz_chgzone_t *cz) {
+	if (cz->zone != NULL) {
+		dns_zone_detach(&cz->zone);
+	}
+	if (cz->zoneconf != NULL) {
+		ns_cfgctx_t *cfg = (ns_cfgctx_t *)cz->view->new_zone_config;
+		cfg_obj_destroy(cfg->add_parser, &cz->zoneconf);
+	}
 	dns_catz_entry_detach(cz->origin, &cz->entry);
 	dns_catz_zone_detach(&cz->origin);
 	dns_view_weakdetach(&cz->view);
 	isc_mem_putanddetach(&cz->mctx, cz, sizeof(*cz));
 }
 
+/*
+ * Apply all the queued member zone changes with the loops paused once,
+ * committing the changes of each view to its zone table at once, then
+ * load the new zones.
+ */
+static void
+catz_chgzones_cb(void *arg) {
+	catz_cb_data_t *cbd = arg;
+	ISC_LIST(catz_chgzone_t) changes;
+	catz_chgzone_t *cz = NULL;
+	dns_view_t *view = NULL;
+
+	ISC_LIST_INIT(changes);
+	LOCK(&cbd->lock);
+	ISC_LIST_MOVE(changes, cbd->changes);
+	UNLOCK(&cbd->lock);
+
+	if (isc_loop_shuttingdown(isc_loop_get(named_g_loopmgr, isc_tid()))) {
+		goto cleanup;
+	}
+
+	isc_loopmgr_pause(named_g_loopmgr);
+	for (cz = ISC_LIST_HEAD(changes); cz != NULL;
+	     cz = ISC_LIST_NEXT(cz, link))
+	{
+		if (cz->view != view) {
+			if (view != NULL) {
+				dns_view_endzonebatch(view);
+				dns_view_freeze(view);
+			}
+			view = cz->view;
+
+			/* Mark view unfrozen so that zones can be added */
+			dns_view_thaw(view);
+			dns_view_beginzonebatch(view);
+		}
+
+		if (cz->del) {
+			catz_delzone_run(cz);
+		} else {
+			catz_addmodzone(cz);
+		}
+	}
+	if (view != NULL) {
+		dns_view_endzonebatch(view);
+		dns_view_freeze(view);
+	}
+	isc_loopmgr_resume(named_g_loopmgr);
+
+cleanup:
+	while ((cz = ISC_LIST_HEAD(changes)) != NULL) {
+		ISC_LIST_UNLINK(changes, cz, link);
+		if (cz->zone != NULL) {
+			catz_addmodzone_load(cz);
+		}
+		catz_chgzone_free(cz);
+	}
+}
+
 static isc_result_t
 catz_run(dns_catz_entry_t *entry, dns_catz_zone_t *origin, dns_view_t *view,
 	 void *udata, catz_type_t type) {
+	catz_cb_data_t *cbd = (catz_cb_data_t *)udata;
 	catz_chgzone_t *cz = NULL;
-	isc_job_cb action = NULL;
+	bool first;
 
 	switch (type) {
 	case CATZ_ADDZONE:
 	case CATZ_MODZONE:
-		action = catz_addmodzone_cb;
-		break;
 	case CATZ_DELZONE:
-		action = catz_delzone_cb;
 		break;
 	default:
 		REQUIRE(0);
@@ -2692,8 +2836,10 @@ catz_run(dns_catz_entry_t *entry, dns_catz_zone_t *origin, dns_view_t *view,
 
 	cz = isc_mem_get(view->mctx, sizeof(*cz));
 	*cz = (catz_chgzone_t){
-		.cbd = (catz_cb_data_t *)udata,
+		.cbd = cbd,
 		.mod = (type == CATZ_MODZONE),
+		.del = (type == CATZ_DELZONE),
+		.link = ISC_LINK_INITIALIZER,
 	};
 	isc_mem_attach(view->mctx, &cz->mctx);
 
@@ -2701,7 +2847,18 @@ catz_run(dns_catz_entry_t *entry, dns_catz_zone_t *origin, dns_view_t *view,
 	dns_catz_zone_attach(origin, &cz->origin);
 	dns_view_weakattach(view, &cz->view);
 
-	isc_async_run(named_g_mainloop, action, cz);
+	/*
+	 * A catalog update queues all its changes before the main loop
+	 * gets to them, so they are applied together.
+	 */
+	LOCK(&cbd->lock);
+	first = ISC_LIST_EMPTY(cbd->changes);
+	ISC_LIST_APPEND(cbd->changes, cz, link);
+	UNLOCK(&cbd->lock);
+
+	if (first) {
+		isc_async_run(named_g_mainloop, catz_chgzones_cb, cbd);
+	}
 
 	return (ISC_R_SUCCESS);
 }
@@ -2807,7 +2964,7 @@ catz_reconfigure(dns_catz_entry_t *entry, void *arg1, void *arg2) {
 				&data->cbd->server->viewlist,
 				&data->cbd->server->kasplist,
 				&data->cbd->server->keystorelist, cfg->actx,
-				true, false, true, true);
+				true, false, true, true, 0);
 	if (result != ISC_R_SUCCESS) {
 		isc_log_write(NAMED_LOGCATEGORY_GENERAL, NAMED_LOGMODULE_SERVER,
 			      ISC_LOG_ERROR,
@@ -2994,7 +3151,7 @@ cleanup:
 		} else {                                                    \
 			rrl->rate.r = def;                                  \
 		}                                                           \
-		rrl->rate.scaled = rrl->rate.r;                             \
+		atomic_init(&rrl->rate.scaled, rrl->rate.r);                \
 	} while (0)
 
 static isc_result_t
@@ -3828,6 +3985,7 @@ configure_view(dns_view_t *view, dns_viewlist_t *viewlist, cfg_obj_t *config,
 	const cfg_obj_t *obj, *obj2;
 	const cfg_listelt_t *element = NULL;
 	const cfg_listelt_t *zone_element_latest = NULL;
+	uint64_t cfgctx;
 	in_port_t port;
 	dns_cache_t *cache = NULL;
 	isc_result_t result;
@@ -3945,17 +4103,30 @@ configure_view(dns_view_t *view, dns_viewlist_t *viewlist, cfg_obj_t *config,
 	}
 
 	/*
-	 * Load zone configuration
+	 * Load zone configuration.  The zones are mounted in a single
+	 * zone table transaction; with hundreds of thousands of zones,
+	 * committing each of them separately dominates the start-up
+	 * and reconfiguration time.  Reused zones whose configuration
+	 * has not changed are not reconfigured.
 	 */
+	cfgctx = cfghash_context(config, vconfig);
+	result = ISC_R_SUCCESS;
+	dns_view_beginzonebatch(view);
 	for (element = cfg_list_first(zonelist); element != NULL;
 	     element = cfg_list_next(element))
 	{
 		const cfg_obj_t *zconfig = cfg_listelt_value(element);
-		CHECK(configure_zone(config, zconfig, vconfig, view, viewlist,
-				     kasplist, keystores, actx, false,
-				     old_rpz_ok, false, false));
+		result = configure_zone(config, zconfig, vconfig, view,
+					viewlist, kasplist, keystores, actx,
+					false, old_rpz_ok, false, false,
+					cfgctx);
+		if (result != ISC_R_SUCCESS) {
+			break;
+		}
 		zone_element_latest = element;
 	}
+	dns_view_endzonebatch(view);
+	CHECK(result);
 
 	/*
 	 * Check that a primary or secondary zone was found for each
@@ -4324,6 +4495,11 @@ configure_view(dns_view_t *view, dns_viewlist_t *viewlist, cfg_obj_t *config,
 	INSIST(result == ISC_R_SUCCESS);
 	view->synthfromdnssec = cfg_obj_asboolean(obj);
 
+	obj = NULL;
+	result = named_config_get(maps, "nxdomain-cut", &obj);
+	INSIST(result == ISC_R_SUCCESS);
+	view->nxdomaincut = cfg_obj_asboolean(obj);
+
 	obj = NULL;
 	result = named_config_get(maps, "stale-cache-enable", &obj);
 	INSIST(result == ISC_R_SUCCESS);
@@ -5360,6 +5536,15 @@ configure_view(dns_view_t *view, dns_viewlist_t *viewlist, cfg_obj_t *config,
 		view->prefetch_eligible = view->prefetch_trigger + 6;
 	}
 
+	obj = NULL;
+	result = named_config_get(maps, "prefetch-refresh-count", &obj);
+	INSIST(result == ISC_R_SUCCESS);
+	obj2 = NULL;
+	result = named_config_get(maps, "prefetch-refresh-rate", &obj2);
+	INSIST(result == ISC_R_SUCCESS);
+	dns_resolver_setrefresh(view->resolver, cfg_obj_asuint32(obj),
+				cfg_obj_asuint32(obj2));
+
 	/*
 	 * For now, there is only one kind of trusted keys, the
 	 * "security roots".
@@ -6272,15 +6457,90 @@ create_view(const cfg_obj_t *vconfig, dns_viewlist_t *viewlist,
 	return (ISC_R_SUCCESS);
 }
 
+static void
+cfghash_text(void *closure, const char *text, int textlen) {
+	isc_hash64_hash(closure, text, textlen, true);
+}
+
+/*
+ * Hash every statement in 'map' except the zones and views.
+ */
+static void
+cfghash_map(isc_hash64_t *state, const cfg_obj_t *map) {
+	const void *clauses = NULL;
+	unsigned int idx = 0;
+	const char *name = NULL;
+
+	for (name = cfg_map_firstclause(map->type, &clauses, &idx);
+	     name != NULL;
+	     name = cfg_map_nextclause(map->type, &clauses, &idx))
+	{
+		const cfg_obj_t *obj = NULL;
+
+		if (strcasecmp(name, "zone") == 0 ||
+		    strcasecmp(name, "view") == 0 ||
+		    cfg_map_get(map, name, &obj) != ISC_R_SUCCESS)
+		{
+			continue;
+		}
+		isc_hash64_hash(state, name, strlen(name), true);
+		cfg_printx(obj, CFG_PRINTER_ONELINE, cfghash_text, state);
+	}
+}
+
+/*
+ * Compute a digest of everything in the configuration that the zones
+ * of a view inherit from: the global statements and the view's own
+ * options.  A zone whose own statement and this context are both
+ * unchanged does not need to be reconfigured.
+ */
+static uint64_t
+cfghash_context(const cfg_obj_t *config, const cfg_obj_t *vconfig) {
+	isc_hash64_t state;
+	uint64_t hash;
+
+	isc_hash64_init(&state);
+	cfghash_map(&state, config);
+	if (vconfig != NULL) {
+		cfg_printx(cfg_tuple_get(vconfig, "name"), 0, cfghash_text,
+			   &state);
+		cfg_printx(cfg_tuple_get(vconfig, "class"), 0, cfghash_text,
+			   &state);
+		cfghash_map(&state, cfg_tuple_get(vconfig, "options"));
+	}
+	hash = isc_hash64_finalize(&state);
+
+	/* zero means "unknown" */
+	return (hash != 0 ? hash : 1);
+}
+
+static uint64_t
+cfghash_zone(uint64_t cfgctx, const cfg_obj_t *zconfig) {
+	isc_hash64_t state;
+	uint64_t hash;
+
+	isc_hash64_init(&state);
+	isc_hash64_hash(&state, &cfgctx, sizeof(cfgctx), true);
+	cfg_printx(zconfig, CFG_PRINTER_ONELINE, cfghash_text, &state);
+	hash = isc_hash64_finalize(&state);
+
+	return (hash != 0 ? hash : 1);
+}
+
 /*
  * Configure or reconfigure a zone.
+ *
+ * If 'cfgctx' is not zero, it is the cfghash_context() of 'config' and
+ * 'vconfig', and a reused zone whose configuration has not changed
+ * since the last time is left as it is.
  */
 static isc_result_t
 configure_zone(const cfg_obj_t *config, const cfg_obj_t *zconfig,
 	       const cfg_obj_t *vconfig, dns_view_t *view,
 	       dns_viewlist_t *viewlist, dns_kasplist_t *kasplist,
 	       dns_keystorelist_t *keystores, cfg_aclconfctx_t *aclconf,
-	       bool added, bool old_rpz_ok, bool is_catz_member, bool modify) {
+	       bool added, bool old_rpz_ok, bool is_catz_member, bool modify,
+	       uint64_t cfgctx) {
 	dns_view_t *pview = NULL; /* Production view */
 	dns_zone_t *zone = NULL;  /* New or reused zone */
 	dns_zone_t *raw = NULL;	  /* New or reused raw zone */
@@ -6305,6 +6565,8 @@ configure_zone(const cfg_obj_t *config, const cfg_obj_t *zconfig,
 	bool zone_maybe_inline = false;
 	bool inline_signing = false;
 	bool fullsign = false;
+	bool reused = false;
+	uint64_t cfghash = 0;
 
 	options = NULL;
 	(void)cfg_map_get(config, "options", &options);
@@ -6564,6 +6826,7 @@ configure_zone(const cfg_obj_t *config, const cfg_obj_t *zconfig,
 		 * new view.
 		 */
 		dns_zone_setview(zone, view);
+		reused = true;
 	} else {
 		/*
 		 * We cannot reuse an existing zone, we have
@@ -6645,10 +6908,32 @@ configure_zone(const cfg_obj_t *config, const cfg_obj_t *zconfig,
 	}
 
 	/*
-	 * Configure the zone.
+	 * Configure the zone, unless it is a plain zone that is being
+	 * reused and neither its own statement nor anything it inherits
+	 * has changed.  Signed, response policy and catalog zones are
+	 * always reconfigured.
 	 */
-	CHECK(named_zone_configure(config, vconfig, zconfig, aclconf, kasplist,
-				   keystores, zone, raw));
+	if (cfgctx != 0) {
+		cfghash = cfghash_zone(cfgctx, zconfig);
+	}
+	if (reused && cfghash != 0 && dns_zone_getcfghash(zone) == cfghash &&
+	    raw == NULL && rpz_num == DNS_RPZ_INVALID_NUM && !zone_is_catz &&
+	    dns_zone_getkasp(zone) == NULL)
+	{
+		dns_zone_log(zone, ISC_LOG_DEBUG(1),
+			     "configuration unchanged, not reconfiguring");
+		/*
+		 * Inherited ACLs belong to the new view and must be
+		 * derived again, whatever the hash says.
+		 */
+		CHECK(named_zone_configure_acls(config, vconfig, zconfig,
+						aclconf, zone, NULL));
+	} else {
+		dns_zone_setcfghash(zone, 0);
+		CHECK(named_zone_configure(config, vconfig, zconfig, aclconf,
+					   kasplist, keystores, zone, raw));
+		dns_zone_setcfghash(zone, cfghash);
+	}
 
 	/*
 	 * Add the zone to its view in the new view list.
@@ -7148,6 +7433,13 @@ pps_timer_tick(void *arg) {
 	oldrequests = requests;
 }
 
+static void
+ticketkey_timer_tick(void *arg) {
+	UNUSED(arg);
+
+	isc_tls_rotateticketkeys();
+}
+
 /*
  * Replace the current value of '*field', a dynamically allocated
  * string or NULL, with a dynamically allocated copy of the
@@ -7605,7 +7897,7 @@ configure_newzones(dns_view_t *view, cfg_obj_t *config, cfg_obj_t *vconfig,
 				     &named_g_server->viewlist,
 				     &named_g_server->kasplist,
 				     &named_g_server->keystorelist, actx, true,
-				     false, false, false));
+				     false, false, false, 0));
 	}
 
 	result = ISC_R_SUCCESS;
@@ -7790,7 +8082,7 @@ configure_newzone(const cfg_obj_t *zconfig, cfg_obj_t *config,
 	return (configure_zone(
 		config, zconfig, vconfig, view, &named_g_server->viewlist,
 		&named_g_server->kasplist, &named_g_server->keystorelist, actx,
-		true, false, false, false));
+		true, false, false, false, 0));
 }
 
 /*%
@@ -7960,6 +8252,7 @@ load_configuration(const char *filename, named_server_t *server,
 	uint32_t send_tcp_buffer_size;
 	uint32_t recv_udp_buffer_size;
 	uint32_t send_udp_buffer_size;
+	uint32_t tcp_pipelining_limit;
 	named_cache_t *nsc;
 	named_cachelist_t cachelist, tmpcachelist;
 	ns_altsecret_t *altsecret;
@@ -8231,6 +8524,16 @@ load_configuration(const char *filename, named_server_t *server,
 					     server->sctx->blackholeacl);
 	}
 
+	/*
+	 * Set "early-drop-names", "early-drop-types" and
+	 * "early-drop-rate". Only legal at options level; there
+	 * are no defaults.
+	 */
+	result = configure_early_drop(config, maps, server->sctx);
+	if (result != ISC_R_SUCCESS) {
+		goto cleanup_bindkeys_parser;
+	}
+
 	obj = NULL;
 	result = named_config_get(maps, "match-mapped-addresses", &obj);
 	INSIST(result == ISC_R_SUCCESS);
@@ -8346,6 +8649,24 @@ load_configuration(const char *filename, named_server_t *server,
 
 #undef CAP_IF_NOT_ZERO
 
+	obj = NULL;
+	result = named_config_get(maps, "tcp-pipelining-limit", &obj);
+	INSIST(result == ISC_R_SUCCESS);
+	tcp_pipelining_limit = cfg_obj_asuint32(obj);
+	if (tcp_pipelining_limit > ISC_NM_MAX_PIPELINED) {
+		cfg_obj_log(obj, ISC_LOG_WARNING,
+			    "tcp-pipelining-limit value is out of range: "
+			    "lowering to %u",
+			    ISC_NM_MAX_PIPELINED);
+		tcp_pipelining_limit = ISC_NM_MAX_PIPELINED;
+	} else if (tcp_pipelining_limit < 1) {
+		cfg_obj_log(obj, ISC_LOG_WARNING,
+			    "tcp-pipelining-limit value is out of range: "
+			    "raising to 1");
+		tcp_pipelining_limit = 1;
+	}
+	isc_nm_setmaxpipelined(named_g_netmgr, tcp_pipelining_limit);
+
 	/*
 	 * Configure sets of UDP query source ports.
 	 */
@@ -8430,6 +8751,12 @@ load_configuration(const char *filename, named_server_t *server,
 	server->sctx->transfer_tcp_message_size =
 		(uint16_t)transfer_message_size;
 
+	/* Set how many dynamic updates may be applied together */
+	obj = NULL;
+	result = named_config_get(maps, "update-batch-size", &obj);
+	INSIST(result == ISC_R_SUCCESS);
+	server->sctx->updbatchsize = cfg_obj_asuint32(obj);
+
 	/*
 	 * Configure the zone manager.
 	 */
@@ -8459,6 +8786,12 @@ load_configuration(const char *filename, named_server_t *server,
 	INSIST(result == ISC_R_SUCCESS);
 	dns_zonemgr_setserialqueryrate(server->zonemgr, cfg_obj_asuint32(obj));
 
+	obj = NULL;
+	result = named_config_get(maps, "serial-query-batch", &obj);
+	INSIST(result == ISC_R_SUCCESS);
+	dns_zonemgr_setserialquerybatch(server->zonemgr,
+					cfg_obj_asuint32(obj));
+
 	/*
 	 * Determine which port to use for listening for incoming connections.
 	 */
@@ -8651,6 +8984,16 @@ load_configuration(const char *filename, named_server_t *server,
 	isc_interval_set(&interval, 1200, 0);
 	isc_timer_start(server->pps_timer, isc_timertype_ticker, &interval);
 
+	/*
+	 * Rotate the TLS session ticket keys on a fixed schedule, which
+	 * reconfiguration must not keep pushing back.
+	 */
+	if (first_time) {
+		isc_interval_set(&interval, ISC_TLS_TICKETKEY_INTERVAL, 0);
+		isc_timer_start(server->ticketkey_timer, isc_timertype_ticker,
+				&interval);
+	}
+
 	isc_interval_set(&interval, named_g_tat_interval, 0);
 	isc_timer_start(server->tat_timer, isc_timertype_ticker, &interval);
 
@@ -9615,6 +9958,9 @@ run_server(void *arg) {
 	isc_timer_create(named_g_mainloop, pps_timer_tick, server,
 			 &server->pps_timer);
 
+	isc_timer_create(named_g_mainloop, ticketkey_timer_tick, server,
+			 &server->ticketkey_timer);
+
 	CHECKFATAL(cfg_parser_create(named_g_mctx, &named_g_parser),
 		   "creating default configuration parser");
 
@@ -9723,6 +10069,7 @@ shutdown_server(void *arg) {
 	isc_timer_destroy(&server->interface_timer);
 	isc_timer_destroy(&server->pps_timer);
 	isc_timer_destroy(&server->tat_timer);
+	isc_timer_destroy(&server->ticketkey_timer);
 
 	ns_interfacemgr_detach(&server->interfacemgr);
 
@@ -9990,6 +10337,9 @@ named_server_create(isc_mem_t *mctx, named_server_t **serverp) {
 	ISC_LIST_INIT(server->keystorelist);
 	ISC_LIST_INIT(server->viewlist);
 
+	isc_mutex_init(&ns_catz_cbdata.lock);
+	ISC_LIST_INIT(ns_catz_cbdata.changes);
+
 	CHECKFATAL(dns_rootns_create(mctx, dns_rdataclass_in, NULL,
 				     &server->in_roothints),
 		   "setting up root hints");
@@ -10088,6 +10438,8 @@ named_server_destroy(named_server_t **serverp) {
 		dns_zonemgr_detach(&server->zonemgr);
 	}
 
+	isc_mutex_destroy(&ns_catz_cbdata.lock);
+
 	INSIST(ISC_LIST_EMPTY(server->kasplist));
 	INSIST(ISC_LIST_EMPTY(server->keystorelist));
 	INSIST(ISC_LIST_EMPTY(server->viewlist));
@@ -13366,7 +13718,7 @@ do_addzone(named_server_t *server, ns_cfgctx_t *cfg, dns_view_t *view,
 	result = configure_zone(cfg->config, zoneobj, cfg->vconfig, view,
 				&server->viewlist, &server->kasplist,
 				&server->keystorelist, cfg->actx, true, false,
-				false, false);
+				false, false, 0);
 	dns_view_freeze(view);
 
 	isc_loopmgr_resume(named_g_loopmgr);
@@ -13551,7 +13903,7 @@ do_modzone(named_server_t *server, ns_cfgctx_t *cfg, dns_view_t *view,
 	result = configure_zone(cfg->config, zoneobj, cfg->vconfig, view,
 				&server->viewlist, &server->kasplist,
 				&server->keystorelist, cfg->actx, true, false,
-				false, true);
+				false, true, 0);
 	dns_view_freeze(view);
 
 	isc_loopmgr_resume(named_g_loopmgr);
@@ -474,6 +474,10 @@ init_desc(void) {
 	SET_RESSTATDESC(priming, "priming queries", "Priming");
 	SET_RESSTATDESC(forwardonlyfail, "all forwarders failed",
 			"ForwardOnlyFail");
+	SET_RESSTATDESC(refresh, "background cache refresh queries",
+			"BackgroundRefresh");
+	SET_RESSTATDESC(refreshfail, "background cache refresh failures",
+			"BackgroundRefreshFail");
 
 	INSIST(i == dns_resstatscounter_max);
 
@@ -619,6 +623,15 @@ init_desc(void) {
 			 "TCP4Clients");
 	SET_SOCKSTATDESC(tcp6clients, "TCP/IPv6 clients currently connected",
 			 "TCP6Clients");
+	SET_SOCKSTATDESC(tlshandshake, "TLS handshakes completed",
+			 "TLSHandshakes");
+	SET_SOCKSTATDESC(tlsresumed, "TLS sessions resumed", "TLSResumed");
+	SET_SOCKSTATDESC(tcppipelined,
+			 "TCP queries received while others were in progress",
+			 "TCPPipelined");
+	SET_SOCKSTATDESC(tcppipelinefull,
+			 "TCP connections paused at the pipelining limit",
+			 "TCPPipelineFull");
 	INSIST(i == isc_sockstatscounter_max);
 
 	/* Initialize DNSSEC statistics */
@@ -860,6 +860,89 @@ process_notifytype(dns_notifytype_t ntype, dns_zonetype_t ztype,
 	return (dns_notifytype_explicit);
 }
 
+isc_result_t
+named_zone_configure_acls(const cfg_obj_t *config, const cfg_obj_t *vconfig,
+			  const cfg_obj_t *zconfig, cfg_aclconfctx_t *ac,
+			  dns_zone_t *zone, dns_zone_t *raw) {
+	isc_result_t result;
+	const char *zname = cfg_obj_asstring(cfg_tuple_get(zconfig, "name"));
+	const cfg_obj_t *zoptions = cfg_tuple_get(zconfig, "options");
+	dns_zonetype_t ztype = zonetype_fromconfig(zoptions);
+	dns_zone_t *mayberaw = (raw != NULL) ? raw : zone;
+
+	/*
+	 * Notify messages are processed by the raw zone if it exists.
+	 */
+	if (ztype == dns_zone_secondary || ztype == dns_zone_mirror) {
+		CHECK(configure_zone_acl(zconfig, vconfig, config, allow_notify,
+					 ac, mayberaw, dns_zone_setnotifyacl,
+					 dns_zone_clearnotifyacl));
+	}
+
+	/*
+	 * XXXAG This probably does not make sense for stubs.
+	 */
+	CHECK(configure_zone_acl(zconfig, vconfig, config, allow_query, ac,
+				 zone, dns_zone_setqueryacl,
+				 dns_zone_clearqueryacl));
+
+	CHECK(configure_zone_acl(zconfig, vconfig, config, allow_query_on, ac,
+				 zone, dns_zone_setqueryonacl,
+				 dns_zone_clearqueryonacl));
+
+	if (ztype != dns_zone_stub && ztype != dns_zone_staticstub &&
+	    ztype != dns_zone_redirect)
+	{
+		CHECK(configure_zone_acl(
+			zconfig, vconfig, config, allow_transfer, ac, zone,
+			dns_zone_setxfracl, dns_zone_clearxfracl));
+	}
+
+	/*
+	 * Disable outgoing zone transfers for mirror zones unless they
+	 * are explicitly enabled by zone configuration.  This is done
+	 * here rather than in named_zone_configure() so that an unchanged
+	 * mirror zone keeps it when its inherited ACLs are set again.
+	 */
+	if (ztype == dns_zone_mirror) {
+		const cfg_obj_t *obj = NULL;
+		(void)cfg_map_get(zoptions, "allow-transfer", &obj);
+		if (obj == NULL) {
+			dns_acl_t *none = NULL;
+			CHECK(dns_acl_none(dns_zone_getmctx(zone), &none));
+			dns_zone_setxfracl(zone, none);
+			dns_acl_detach(&none);
+		}
+	}
+
+	if (ztype == dns_zone_primary) {
+		dns_acl_t *updateacl;
+
+		CHECK(configure_zone_acl(zconfig, vconfig, config, allow_update,
+					 ac, mayberaw, dns_zone_setupdateacl,
+					 dns_zone_clearupdateacl));
+
+		updateacl = dns_zone_getupdateacl(mayberaw);
+		if (updateacl != NULL && dns_acl_isinsecure(updateacl)) {
+			isc_log_write(DNS_LOGCATEGORY_SECURITY,
+				      NAMED_LOGMODULE_SERVER, ISC_LOG_WARNING,
+				      "zone '%s' allows unsigned updates "
+				      "from remote hosts, which is insecure",
+				      zname);
+		}
+	}
+
+	if (ztype == dns_zone_secondary || ztype == dns_zone_mirror) {
+		CHECK(configure_zone_acl(zconfig, vconfig, config,
+					 allow_update_forwarding, ac, mayberaw,
+					 dns_zone_setforwardacl,
+					 dns_zone_clearforwardacl));
+	}
+
+cleanup:
+	return (result);
+}
+
 isc_result_t
 named_zone_configure(const cfg_obj_t *config, const cfg_obj_t *vconfig,
 		     const cfg_obj_t *zconfig, cfg_aclconfctx_t *ac,
@@ -1111,25 +1194,8 @@ named_zone_configure(const cfg_obj_t *config, const cfg_obj_t *vconfig,
 		CHECK(dns_zone_setjournal(mayberaw, cfg_obj_asstring(obj)));
 	}
 
-	/*
-	 * Notify messages are processed by the raw zone if it exists.
-	 */
-	if (ztype == dns_zone_secondary || ztype == dns_zone_mirror) {
-		CHECK(configure_zone_acl(zconfig, vconfig, config, allow_notify,
-					 ac, mayberaw, dns_zone_setnotifyacl,
-					 dns_zone_clearnotifyacl));
-	}
-
-	/*
-	 * XXXAG This probably does not make sense for stubs.
-	 */
-	CHECK(configure_zone_acl(zconfig, vconfig, config, allow_query, ac,
-				 zone, dns_zone_setqueryacl,
-				 dns_zone_clearqueryacl));
-
-	CHECK(configure_zone_acl(zconfig, vconfig, config, allow_query_on, ac,
-				 zone, dns_zone_setqueryonacl,
-				 dns_zone_clearqueryonacl));
+	CHECK(named_zone_configure_acls(config, vconfig, zconfig, ac, zone,
+					raw));
 
 	obj = NULL;
 	result = named_config_get(maps, "zone-statistics", &obj);
@@ -1291,10 +1357,6 @@ named_zone_configure(const cfg_obj_t *config, const cfg_obj_t *vconfig,
 
 		dns_zone_setisself(zone, isself, NULL);
 
-		CHECK(configure_zone_acl(
-			zconfig, vconfig, config, allow_transfer, ac, zone,
-			dns_zone_setxfracl, dns_zone_clearxfracl));
-
 		obj = NULL;
 		result = named_config_get(maps, "max-transfer-time-out", &obj);
 		INSIST(result == ISC_R_SUCCESS && obj != NULL);
@@ -1510,21 +1572,6 @@ named_zone_configure(const cfg_obj_t *config, const cfg_obj_t *vconfig,
 	 * primary servers only.
 	 */
 	if (ztype == dns_zone_primary) {
-		dns_acl_t *updateacl;
-
-		CHECK(configure_zone_acl(zconfig, vconfig, config, allow_update,
-					 ac, mayberaw, dns_zone_setupdateacl,
-					 dns_zone_clearupdateacl));
-
-		updateacl = dns_zone_getupdateacl(mayberaw);
-		if (updateacl != NULL && dns_acl_isinsecure(updateacl)) {
-			isc_log_write(DNS_LOGCATEGORY_SECURITY,
-				      NAMED_LOGMODULE_SERVER, ISC_LOG_WARNING,
-				      "zone '%s' allows unsigned updates "
-				      "from remote hosts, which is insecure",
-				      zname);
-		}
-
 		CHECK(configure_zone_ssutable(zoptions, mayberaw, zname));
 	}
 
@@ -1598,13 +1645,6 @@ named_zone_configure(const cfg_obj_t *config, const cfg_obj_t *vconfig,
 		}
 	}
 
-	if (ztype == dns_zone_secondary || ztype == dns_zone_mirror) {
-		CHECK(configure_zone_acl(zconfig, vconfig, config,
-					 allow_update_forwarding, ac, mayberaw,
-					 dns_zone_setforwardacl,
-					 dns_zone_clearforwardacl));
-	}
-
 	/*%
 	 * Configure parental agents, applies to primary and secondary zones.
 	 */
@@ -1757,19 +1797,6 @@ named_zone_configure(const cfg_obj_t *config, const cfg_obj_t *vconfig,
 	 */
 	switch (ztype) {
 	case dns_zone_mirror:
-		/*
-		 * Disable outgoing zone transfers for mirror zones unless they
-		 * are explicitly enabled by zone configuration.
-		 */
-		obj = NULL;
-		(void)cfg_map_get(zoptions, "allow-transfer", &obj);
-		if (obj == NULL) {
-			dns_acl_t *none;
-			CHECK(dns_acl_none(mctx, &none));
-			dns_zone_setxfracl(zone, none);
-			dns_acl_detach(&none);
-		}
-		FALLTHROUGH;
 	case dns_zone_secondary:
 	case dns_zone_stub:
 	case dns_zone_redirect:
@@ -429,6 +429,36 @@ grep '^a.normal.example' dig.out.ns2.$n >/dev/null && ret=1
 if [ $ret != 0 ]; then echo_i "failed"; fi
 status=$((status + ret))
 
+# Test 35 - views, view-level allow-query changed on reconfig, query allowed
+n=$((n + 1))
+copy_setports ns2/named22.conf.in ns2/named.conf
+rndc_reconfig ns2 10.53.0.2
+
+echo_i "test $n: views, allow-query changed on reconfig - query allowed"
+ret=0
+$DIG $DIGOPTS @10.53.0.2 -b 10.53.0.2 a.normal.example a >dig.out.ns2.$n || ret=1
+grep 'status: NOERROR' dig.out.ns2.$n >/dev/null || ret=1
+grep '^a.normal.example' dig.out.ns2.$n >/dev/null || ret=1
+if [ $ret != 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
+# Test 36 - views, reconfig that skips the unchanged zone keeps its
+# inherited allow-query, query refused
+n=$((n + 1))
+copy_setports ns2/named23.conf.in ns2/named.conf
+rndc_reconfig ns2 10.53.0.2
+nextpart ns2/named.run >/dev/null
+rndc_reconfig ns2 10.53.0.2
+
+echo_i "test $n: views, unchanged reconfig keeps allow-query - query refused"
+ret=0
+nextpart ns2/named.run | grep 'normal.example/IN/internal.*configuration unchanged' >/dev/null || ret=1
+$DIG $DIGOPTS @10.53.0.2 -b 10.53.0.2 a.normal.example a >dig.out.ns2.$n || ret=1
+grep 'status: REFUSED' dig.out.ns2.$n >/dev/null || ret=1
+grep '^a.normal.example' dig.out.ns2.$n >/dev/null && ret=1
+if [ $ret != 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
 # Tests for allow-query in the zone statements
 
 n=40
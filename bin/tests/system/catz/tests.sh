@@ -314,6 +314,79 @@ status=$((status + ret))
 
 nextpart ns2/named.run >/dev/null
 
+##########################################################################
+echo_i "Testing catalog zone updates processed from the journal"
+n=$((n + 1))
+echo_i "adding domains journal1.example. and journal2.example. to catalog1 zone ($n)"
+ret=0
+$NSUPDATE -d <<END >>nsupdate.out.test$n 2>&1 || ret=1
+    server 10.53.0.1 ${PORT}
+    update add journal1.zones.catalog1.example. 3600 IN PTR journal1.example.
+    update add journal2.zones.catalog1.example. 3600 IN PTR journal2.example.
+    send
+END
+if [ $ret -ne 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
+n=$((n + 1))
+echo_i "waiting for secondary to sync up ($n)"
+ret=0
+wait_for_message ns2/named.run "catz: adding zone 'journal1.example' from catalog 'catalog1.example'" \
+  && wait_for_message ns2/named.run "catz: adding zone 'journal2.example' from catalog 'catalog1.example'" || ret=1
+if [ $ret -ne 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
+nextpart ns2/named.run >/dev/null
+
+n=$((n + 1))
+echo_i "deleting, modifying and adding a member zone in one update ($n)"
+ret=0
+$NSUPDATE -d <<END >>nsupdate.out.test$n 2>&1 || ret=1
+    server 10.53.0.1 ${PORT}
+    update delete journal1.zones.catalog1.example. 3600 IN PTR journal1.example.
+    update add primaries.journal2.zones.catalog1.example. 3600 IN A 10.53.0.3
+    update add journal3.zones.catalog1.example. 3600 IN PTR journal3.example.
+    send
+END
+if [ $ret -ne 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
+n=$((n + 1))
+echo_i "checking that only the changed member zones were processed ($n)"
+ret=0
+wait_for_message ns2/named.run "catz: deleting zone 'journal1.example' from catalog 'catalog1.example'" \
+  && wait_for_message ns2/named.run "catz: modifying zone 'journal2.example' from catalog 'catalog1.example'" \
+  && wait_for_message ns2/named.run "catz: adding zone 'journal3.example' from catalog 'catalog1.example'" || ret=1
+nextpart ns2/named.run >named.run.test$n
+grep -F "catz: catalog1.example: serial" named.run.test$n | grep -F "from journal: 3 changed entries" >/dev/null || ret=1
+lines=$(grep -c "catz: \(adding\|modifying\|deleting\) zone" named.run.test$n || true)
+[ "$lines" -eq 3 ] || ret=1
+if [ $ret -ne 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
+n=$((n + 1))
+echo_i "removing domains journal2.example. and journal3.example. from catalog1 zone ($n)"
+ret=0
+$NSUPDATE -d <<END >>nsupdate.out.test$n 2>&1 || ret=1
+    server 10.53.0.1 ${PORT}
+    update delete journal2.zones.catalog1.example.
+    update delete primaries.journal2.zones.catalog1.example.
+    update delete journal3.zones.catalog1.example.
+    send
+END
+if [ $ret -ne 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
+n=$((n + 1))
+echo_i "waiting for secondary to sync up ($n)"
+ret=0
+wait_for_message ns2/named.run "catz: catz_delzone_cb: zone 'journal2.example' deleted" \
+  && wait_for_message ns2/named.run "catz: catz_delzone_cb: zone 'journal3.example' deleted" || ret=1
+if [ $ret -ne 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
+nextpart ns2/named.run >/dev/null
+
 ##########################################################################
 echo_i "Testing various simple operations on domains, including using multiple catalog zones and garbage in zone"
 n=$((n + 1))
@@ -0,0 +1,86 @@
+# Copyright (C) Internet Systems Consortium, Inc. ("ISC")
+#
+# SPDX-License-Identifier: MPL-2.0
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0.  If a copy of the MPL was not distributed with this
+# file, you can obtain one at https://mozilla.org/MPL/2.0/.
+#
+# See the COPYRIGHT file distributed with this work for additional
+# information regarding copyright ownership.
+
+import socket
+
+import pytest
+
+import isctest
+
+pytest.importorskip("dns", minversion="2.0.0")
+import dns.exception
+import dns.message
+import dns.query
+
+
+@pytest.mark.parametrize(
+    "qname,qtype",
+    [
+        ("drop.example.", "A"),
+        ("www.drop.example.", "A"),
+        ("www.example.", "ANY"),
+    ],
+)
+def test_earlydrop_question(named_port, servers, qname, qtype):
+    ns1 = servers["ns1"]
+
+    # Queries that do not match are answered as usual.
+    msg = dns.message.make_query("www.example.", "A")
+    res = isctest.query.udp(msg, "10.53.0.1")
+    isctest.check.noerror(res)
+
+    # Queries that match early-drop-names or early-drop-types get no
+    # response, over UDP or TCP, and named drops them before it gets
+    # as far as logging the query.
+    msg = dns.message.make_query(qname, qtype)
+    with ns1.watch_log_from_here() as watcher:
+        with pytest.raises(dns.exception.Timeout):
+            dns.query.udp(msg, "10.53.0.1", timeout=2, port=named_port)
+        watcher.wait_for_line("dropped request: query name or type")
+    with ns1.watch_log_from_here() as watcher:
+        with pytest.raises((EOFError, ConnectionError, dns.exception.Timeout)):
+            dns.query.tcp(msg, "10.53.0.1", timeout=2, port=named_port)
+        watcher.wait_for_line("dropped request: query name or type")
+
+    ns1.log.expect("query: www.example IN A")
+    ns1.log.prohibit(f"query: {qname.rstrip('.')} IN {qtype}")
+
+
+def test_earlydrop_rate(named_port, servers):
+    ns2 = servers["ns2"]
+    burst = 20
+
+    # Send a burst of UDP queries at once, well over early-drop-rate.
+    # At most two seconds' worth of them are answered.
+    with ns2.watch_log_from_here() as watcher:
+        with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+            sock.settimeout(2)
+            for i in range(burst):
+                msg = dns.message.make_query(f"q{i}.www.example.", "A")
+                sock.sendto(msg.to_wire(), ("10.53.0.2", named_port))
+            answered = 0
+            try:
+                while answered < burst:
+                    sock.recvfrom(65535)
+                    answered += 1
+            except socket.timeout:
+                pass
+        watcher.wait_for_line("dropped request: source rate exceeded")
+    assert 0 < answered <= 10
+
+    # TCP queries from the same source are not counted.
+    msg = dns.message.make_query("www.example.", "A")
+    res = isctest.query.tcp(msg, "10.53.0.2")
+    isctest.check.noerror(res)
+
+    # Once the second is over, UDP queries are answered again.
+    res = isctest.query.udp(msg, "10.53.0.2")
+    isctest.check.noerror(res)
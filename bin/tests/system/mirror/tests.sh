@@ -456,6 +456,18 @@ grep "; Transfer failed" dig.out.ns3.test$n >/dev/null || ret=1
 if [ $ret != 0 ]; then echo_i "failed"; fi
 status=$((status + ret))
 
+n=$((n + 1))
+echo_i "checking that outgoing transfers of mirror zones stay disabled after \"rndc reconfig\" ($n)"
+ret=0
+nextpart ns3/named.run >/dev/null
+rndc_reconfig ns3 10.53.0.3
+# The zone is kept as it is, and only its inherited ACLs are set again.
+wait_for_log 10 "zone ./IN: configuration unchanged, not reconfiguring" ns3/named.run || ret=1
+$DIG $DIGOPTS @10.53.0.3 . AXFR >dig.out.ns3.test$n 2>&1 || ret=1
+grep "; Transfer failed" dig.out.ns3.test$n >/dev/null || ret=1
+if [ $ret != 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+
 n=$((n + 1))
 echo_i "checking that notifies are disabled by default for mirror zones ($n)"
 ret=0
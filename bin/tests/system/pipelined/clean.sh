@@ -16,3 +16,4 @@ rm -f ./*/named.memstats
 rm -f ./*/named.run*
 rm -f raw* output* ./*.out.*
 rm -f ns*/managed-keys.bind*
+rm -f ns4/named.stats
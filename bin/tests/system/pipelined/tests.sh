@@ -67,6 +67,33 @@ status=$((status + ret))
 n=$((n + 1))
 ret=0
 
+echo_i "check pipelined TCP queries with tcp-pipelining-limit 1 ($n)"
+copy_setports ns4/named2.conf.in ns4/named.conf
+rndc_reconfig ns4 10.53.0.4
+nextpart ns4/named.run >/dev/null
+rndccmd 10.53.0.4 flush
+wait_for_log 10 "flushing caches in all views succeeded" ns4/named.run
+mdig_with_opts +noall +answer +vc -f input -b 10.53.0.4 @10.53.0.4 >raw.mdig.$n
+awk '{ print $1 " " $5 }' <raw.mdig.$n >output.mdig.$n
+sort <output.mdig.$n >output-sorted.mdig.$n
+diff ref output-sorted.mdig.$n || {
+  ret=1
+  echo_i "diff sorted failed"
+}
+# Only one query is processed at a time, so the answers are in query order.
+awk '{ print $1 }' <output.mdig.$n | sed 's/\.$//' | diff input - || {
+  ret=1
+  echo_i "diff in order failed"
+}
+rm -f ns4/named.stats
+rndccmd 10.53.0.4 stats
+retry_quiet 5 test -f ns4/named.stats || ret=1
+grep "TCP connections paused at the pipelining limit" ns4/named.stats >/dev/null || ret=1
+if [ $ret != 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+n=$((n + 1))
+ret=0
+
 echo_i "check mdig -4 -6 ($n)"
 mdig_with_opts -4 -6 -f input @10.53.0.4 >output.mdig.$n 2>&1 && ret=1
 grep "only one of -4 and -6 allowed" output.mdig.$n >/dev/null || ret=1
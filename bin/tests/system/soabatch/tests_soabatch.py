@@ -0,0 +1,100 @@
+# Copyright (C) Internet Systems Consortium, Inc. ("ISC")
+#
+# SPDX-License-Identifier: MPL-2.0
+#
+# This Source Code Form is subject to the terms of the Mozilla Public
+# License, v. 2.0.  If a copy of the MPL was not distributed with this
+# file, you can obtain one at https://mozilla.org/MPL/2.0/.
+#
+# See the COPYRIGHT file distributed with this work for additional
+# information regarding copyright ownership.
+
+from concurrent.futures import ThreadPoolExecutor
+import glob
+import re
+
+import isctest
+
+
+def refresh_batch(ns1, ns2, zones):
+    """
+    Refresh 'zones' on ns2 at the same time, and return the source ports
+    of the SOA queries that ns1 received for them over TCP
+    """
+    pattern = re.compile(
+        r"client @\S+ 10\.53\.0\.2#([0-9]+) \((zone[0-9]+\.example)\): "
+        r"query: zone[0-9]+\.example IN SOA [-+]E\(0\)S?T"
+    )
+    ports = {}
+    leftover = ""
+
+    with open(ns1.log.path, encoding="utf-8") as log:
+        log.seek(0, 2)
+        with ThreadPoolExecutor() as executor:
+            for zone in zones:
+                executor.submit(ns2.rndc, f"refresh {zone}")
+
+        def all_queried():
+            nonlocal leftover
+            for line in log.readlines():
+                if not line.endswith("\n"):
+                    leftover += line
+                    continue
+                match = pattern.search(leftover + line)
+                leftover = ""
+                if match and match.group(2) in zones:
+                    ports[match.group(2)] = match.group(1)
+            return len(ports) == len(zones)
+
+        isctest.run.retry_with_timeout(all_queried, timeout=10)
+
+    return set(ports.values())
+
+
+def test_soabatch(named_port, servers):
+    ns1 = servers["ns1"]
+    ns2 = servers["ns2"]
+
+    # All zones are transferred, including those whose first primary is
+    # not running.
+    def all_transferred():
+        return len(glob.glob("ns2/zone*.example.bk")) == 20
+
+    isctest.run.retry_with_timeout(all_transferred, timeout=60)
+
+    # Several SOA queries queued for the same primary are pipelined over
+    # TCP.
+    pattern = re.compile(r"query: zone[0-9]+\.example IN SOA [-+]E\(0\)S?T")
+    with ns1.watch_log_from_start() as watcher:
+        watcher.wait_for_line(pattern)
+
+    # The batched queries to the primary that is not running fail, and
+    # the zones fall back to the next primary.
+    pattern = re.compile(
+        r"zone zone000000\.example/IN: refresh: "
+        r"(failure trying|retry limit for) primary 10\.53\.0\.3#"
+    )
+    with ns2.watch_log_from_start() as watcher:
+        watcher.wait_for_line(pattern)
+    for z in range(5):
+        with ns2.watch_log_from_start() as watcher:
+            watcher.wait_for_line(
+                f"transfer of 'zone{z:06d}.example/IN' from "
+                f"10.53.0.1#{named_port}: Transfer completed"
+            )
+
+    # A batch that holds a single query sends it over UDP.
+    pattern = re.compile(
+        r"query: zone000010\.example IN SOA [-+]E\(0\)[^T ]* \(10\.53\.0\.1\)"
+    )
+    with ns1.watch_log_from_here() as watcher:
+        ns2.rndc("refresh zone000010.example")
+        watcher.wait_for_line(pattern)
+
+    # A later batch to the same primary reuses the TCP connection that
+    # the previous batch left open.
+    first = [f"zone{z:06d}.example" for z in range(10, 15)]
+    second = [f"zone{z:06d}.example" for z in range(15, 20)]
+    ports = refresh_batch(ns1, ns2, first)
+    assert len(ports) == 1
+    assert refresh_batch(ns1, ns2, second) == ports
@@ -134,6 +134,14 @@ if [ $ret != 0 ]; then echo_i "failed"; fi
 status=$((status + ret))
 n=$((n + 1))
 
+ret=0
+echo_i "verifying cache RRset memory output in named.stats ($n)"
+grep "[1-9][0-9]* cache RRsets" $last_stats >/dev/null || ret=1
+grep "[1-9][0-9]* average cache tree memory per RRset" $last_stats >/dev/null || ret=1
+if [ $ret != 0 ]; then echo_i "failed"; fi
+status=$((status + ret))
+n=$((n + 1))
+
 ret=0
 echo_i "verifying bucket size output ($n)"
 grep "bucket size" $last_stats >/dev/null || ret=1
@@ -202,6 +210,9 @@ if $FEATURETEST --have-libxml2 && "${CURL}" --http1.1 http://10.53.0.3:${EXTRAPO
   grep "<h3>Resolver Statistics for View " xsltproc.out.${n} >/dev/null || ret=1
   grep "<h3>ADB Statistics for View " xsltproc.out.${n} >/dev/null || ret=1
   grep "<h3>Cache Statistics for View " xsltproc.out.${n} >/dev/null || ret=1
+  grep "<h3>Cache Memory per RRset for View " xsltproc.out.${n} >/dev/null || ret=1
+  grep '<counter name="CacheRRsets">[1-9][0-9]*</counter>' curl.out.${n}.xml >/dev/null || ret=1
+  grep '<counter name="AvgTreeMemPerRRset">[1-9][0-9]*</counter>' curl.out.${n}.xml >/dev/null || ret=1
   # grep "<h3>Cache DB RRsets for View " xsltproc.out.${n} >/dev/null || ret=1
   grep "<h2>Traffic Size Statistics</h2>" xsltproc.out.${n} >/dev/null || ret=1
   grep "<h4>UDP Requests Received</h4>" xsltproc.out.${n} >/dev/null || ret=1
@@ -607,10 +607,41 @@ getcounters(isc_stats_t *stats, isc_statsformat_t type, int ncounters,
 	isc_stats_dump(stats, getcounter, &dumparg, ISC_STATSDUMP_VERBOSE);
 }
 
+static void
+countrrsets(dns_rdatastatstype_t type, uint64_t val, void *arg) {
+	uint64_t *rrsets = arg;
+
+	UNUSED(type);
+
+	*rrsets += val;
+}
+
+/*
+ * Count the RRsets (positive, negative, stale and ancient) held in the
+ * cache, and divide all of the cache's tree memory by that count.  The
+ * average includes the nodes, owner names and any memory context
+ * overhead along with the slab headers and rdataslabs, so it is not
+ * the size of any one RRset, but a rough measure of what each RRset
+ * costs the cache.
+ */
+static void
+getrrsetusage(dns_cache_t *cache, uint64_t *rrsetsp, uint64_t *avgp) {
+	dns_stats_t *stats = dns_db_getrrsetstats(cache->db);
+	uint64_t rrsets = 0;
+
+	if (stats != NULL) {
+		dns_rdatasetstats_dump(stats, countrrsets, &rrsets, 0);
+	}
+
+	*rrsetsp = rrsets;
+	*avgp = (rrsets == 0) ? 0 : isc_mem_inuse(cache->tmctx) / rrsets;
+}
+
 void
 dns_cache_dumpstats(dns_cache_t *cache, FILE *fp) {
 	int indices[dns_cachestatscounter_max];
 	uint64_t values[dns_cachestatscounter_max];
+	uint64_t rrsets, avgmem;
 
 	REQUIRE(VALID_CACHE(cache));
 
@@ -636,6 +667,9 @@ dns_cache_dumpstats(dns_cache_t *cache, FILE *fp) {
 	fprintf(fp, "%20" PRIu64 " %s\n",
 		values[dns_cachestatscounter_coveringnsec],
 		"covering nsec returned");
+	fprintf(fp, "%20" PRIu64 " %s\n",
+		values[dns_cachestatscounter_refreshhits],
+		"cache hits on refreshed records");
 	fprintf(fp, "%20u %s\n", dns_db_nodecount(cache->db, dns_dbtree_main),
 		"cache database nodes");
 	fprintf(fp, "%20u %s\n", dns_db_nodecount(cache->db, dns_dbtree_nsec),
@@ -648,6 +682,11 @@ dns_cache_dumpstats(dns_cache_t *cache, FILE *fp) {
 
 	fprintf(fp, "%20" PRIu64 " %s\n", (uint64_t)isc_mem_inuse(cache->hmctx),
 		"cache heap memory in use");
+
+	getrrsetusage(cache, &rrsets, &avgmem);
+	fprintf(fp, "%20" PRIu64 " %s\n", rrsets, "cache RRsets");
+	fprintf(fp, "%20" PRIu64 " %s\n", avgmem,
+		"average cache tree memory per RRset");
 }
 
 #ifdef HAVE_LIBXML2
@@ -675,6 +714,7 @@ int
 dns_cache_renderxml(dns_cache_t *cache, void *writer0) {
 	int indices[dns_cachestatscounter_max];
 	uint64_t values[dns_cachestatscounter_max];
+	uint64_t rrsets, avgmem;
 	int xmlrc;
 	xmlTextWriterPtr writer = (xmlTextWriterPtr)writer0;
 
@@ -696,6 +736,8 @@ dns_cache_renderxml(dns_cache_t *cache, void *writer0) {
 			writer));
 	TRY0(renderstat("CoveringNSEC",
 			values[dns_cachestatscounter_coveringnsec], writer));
+	TRY0(renderstat("RefreshHits",
+			values[dns_cachestatscounter_refreshhits], writer));
 
 	TRY0(renderstat("CacheNodes",
 			dns_db_nodecount(cache->db, dns_dbtree_main), writer));
@@ -706,6 +748,10 @@ dns_cache_renderxml(dns_cache_t *cache, void *writer0) {
 	TRY0(renderstat("TreeMemInUse", isc_mem_inuse(cache->tmctx), writer));
 
 	TRY0(renderstat("HeapMemInUse", isc_mem_inuse(cache->hmctx), writer));
+
+	getrrsetusage(cache, &rrsets, &avgmem);
+	TRY0(renderstat("CacheRRsets", rrsets, writer));
+	TRY0(renderstat("AvgTreeMemPerRRset", avgmem, writer));
 error:
 	return (xmlrc);
 }
@@ -725,6 +771,7 @@ dns_cache_renderjson(dns_cache_t *cache, void *cstats0) {
 	isc_result_t result = ISC_R_SUCCESS;
 	int indices[dns_cachestatscounter_max];
 	uint64_t values[dns_cachestatscounter_max];
+	uint64_t rrsets, avgmem;
 	json_object *obj;
 	json_object *cstats = (json_object *)cstats0;
 
@@ -761,6 +808,10 @@ dns_cache_renderjson(dns_cache_t *cache, void *cstats0) {
 	CHECKMEM(obj);
 	json_object_object_add(cstats, "CoveringNSEC", obj);
 
+	obj = json_object_new_int64(values[dns_cachestatscounter_refreshhits]);
+	CHECKMEM(obj);
+	json_object_object_add(cstats, "RefreshHits", obj);
+
 	obj = json_object_new_int64(
 		dns_db_nodecount(cache->db, dns_dbtree_main));
 	CHECKMEM(obj);
@@ -783,6 +834,16 @@ dns_cache_renderjson(dns_cache_t *cache, void *cstats0) {
 	CHECKMEM(obj);
 	json_object_object_add(cstats, "HeapMemInUse", obj);
 
+	getrrsetusage(cache, &rrsets, &avgmem);
+
+	obj = json_object_new_int64(rrsets);
+	CHECKMEM(obj);
+	json_object_object_add(cstats, "CacheRRsets", obj);
+
+	obj = json_object_new_int64(avgmem);
+	CHECKMEM(obj);
+	json_object_object_add(cstats, "AvgTreeMemPerRRset", obj);
+
 	result = ISC_R_SUCCESS;
 error:
 	return (result);
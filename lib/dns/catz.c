@@ -30,6 +30,7 @@
 
 #include <dns/catz.h>
 #include <dns/dbiterator.h>
+#include <dns/journal.h>
 #include <dns/rdatasetiter.h>
 #include <dns/view.h>
 #include <dns/zone.h>
@@ -101,6 +102,13 @@ struct dns_catz_zone {
 	bool active;
 	bool broken;
 
+	/*
+	 * The entries reflect the database at this serial, so the next
+	 * update can be taken from the journal (protected by catzs->lock).
+	 */
+	bool insync;
+	uint32_t serial;
+
 	isc_refcount_t references;
 	isc_mutex_t lock;
 };
@@ -477,19 +485,29 @@ dns_catz_zone_resetdefoptions(dns_catz_zone_t *catz) {
 
 	dns_catz_options_free(&catz->defoptions, catz->catzs->mctx);
 	dns_catz_options_init(&catz->defoptions);
+
+	/* The new defaults have to be applied to all the entries. */
+	LOCK(&catz->catzs->lock);
+	catz->insync = false;
+	UNLOCK(&catz->catzs->lock);
 }
 
 /*%<
  * Merge 'newcatz' into 'catz', calling addzone/delzone/modzone
  * (from catz->catzs->zmm) for appropriate member zones.
  *
+ * If 'changed' is not NULL, 'newcatz' only holds the entries whose
+ * unique labels (the keys of 'changed') were touched by the update,
+ * and the other entries of 'catz' and its global options are kept.
+ *
  * Requires:
  * \li	'catz' is a valid dns_catz_zone_t.
  * \li	'newcatz' is a valid dns_catz_zone_t.
  *
  */
 static isc_result_t
-dns__catz_zones_merge(dns_catz_zone_t *catz, dns_catz_zone_t *newcatz) {
+dns__catz_zones_merge(dns_catz_zone_t *catz, dns_catz_zone_t *newcatz,
+		      isc_ht_t *changed) {
 	isc_result_t result;
 	isc_ht_iter_t *iter1 = NULL, *iter2 = NULL;
 	isc_ht_iter_t *iteradd = NULL, *itermod = NULL;
@@ -511,15 +529,51 @@ dns__catz_zones_merge(dns_catz_zone_t *catz, dns_catz_zone_t *newcatz) {
 	delzone = catz->catzs->zmm->delzone;
 
 	/* Copy zoneoptions from newcatz into catz. */
-
-	dns_catz_options_free(&catz->zoneoptions, catz->catzs->mctx);
-	dns_catz_options_copy(catz->catzs->mctx, &newcatz->zoneoptions,
-			      &catz->zoneoptions);
-	dns_catz_options_setdefault(catz->catzs->mctx, &catz->defoptions,
-				    &catz->zoneoptions);
+	if (changed == NULL) {
+		dns_catz_options_free(&catz->zoneoptions, catz->catzs->mctx);
+		dns_catz_options_copy(catz->catzs->mctx, &newcatz->zoneoptions,
+				      &catz->zoneoptions);
+		dns_catz_options_setdefault(catz->catzs->mctx,
+					    &catz->defoptions,
+					    &catz->zoneoptions);
+	}
 
 	dns_name_format(&catz->name, czname, DNS_NAME_FORMATSIZE);
 
+	/*
+	 * The coo records of the changed entries are replaced by those
+	 * in newcatz below.
+	 */
+	if (changed != NULL) {
+		isc_ht_iter_t *iter = NULL;
+
+		isc_ht_iter_create(changed, &iter);
+		for (result = isc_ht_iter_first(iter); result == ISC_R_SUCCESS;
+		     result = isc_ht_iter_next(iter))
+		{
+			dns_catz_entry_t *oentry = NULL;
+			dns_catz_coo_t *coo = NULL;
+			unsigned char *key = NULL;
+			size_t keysize;
+
+			isc_ht_iter_currentkey(iter, &key, &keysize);
+			if (isc_ht_find(catz->entries, key, (uint32_t)keysize,
+					(void **)&oentry) != ISC_R_SUCCESS ||
+			    isc_ht_find(catz->coos, oentry->name.ndata,
+					oentry->name.length,
+					(void **)&coo) != ISC_R_SUCCESS)
+			{
+				continue;
+			}
+			result = isc_ht_delete(catz->coos, oentry->name.ndata,
+					       oentry->name.length);
+			RUNTIME_CHECK(result == ISC_R_SUCCESS);
+			catz_coo_detach(catz, &coo);
+		}
+		INSIST(result == ISC_R_NOMORE);
+		isc_ht_iter_destroy(&iter);
+	}
+
 	isc_ht_init(&toadd, catz->catzs->mctx, 1, ISC_HT_CASE_SENSITIVE);
 	isc_ht_init(&tomod, catz->catzs->mctx, 1, ISC_HT_CASE_SENSITIVE);
 	isc_ht_iter_create(newcatz->entries, &iter1);
@@ -685,12 +739,34 @@ dns__catz_zones_merge(dns_catz_zone_t *catz, dns_catz_zone_t *newcatz) {
 
 	/*
 	 * Then - walk the old zone; only deleted entries should remain.
+	 * When only some entries were updated, only those can have been
+	 * deleted.
 	 */
+	if (changed != NULL) {
+		isc_ht_iter_destroy(&iter2);
+		isc_ht_iter_create(changed, &iter2);
+	}
 	for (result = isc_ht_iter_first(iter2); result == ISC_R_SUCCESS;
 	     result = isc_ht_iter_delcurrent_next(iter2))
 	{
 		dns_catz_entry_t *entry = NULL;
-		isc_ht_iter_current(iter2, (void **)&entry);
+
+		if (changed != NULL) {
+			unsigned char *key = NULL;
+			size_t keysize;
+
+			isc_ht_iter_currentkey(iter2, &key, &keysize);
+			if (isc_ht_find(catz->entries, key, (uint32_t)keysize,
+					(void **)&entry) != ISC_R_SUCCESS)
+			{
+				continue;
+			}
+			result = isc_ht_delete(catz->entries, key,
+					       (uint32_t)keysize);
+			RUNTIME_CHECK(result == ISC_R_SUCCESS);
+		} else {
+			isc_ht_iter_current(iter2, (void **)&entry);
+		}
 
 		dns_name_format(&entry->name, zname, DNS_NAME_FORMATSIZE);
 		result = delzone(entry, catz, catz->catzs->view,
@@ -703,9 +779,11 @@ dns__catz_zones_merge(dns_catz_zone_t *catz, dns_catz_zone_t *newcatz) {
 	}
 	RUNTIME_CHECK(result == ISC_R_NOMORE);
 	isc_ht_iter_destroy(&iter2);
-	/* At this moment catz->entries has to be be empty. */
-	INSIST(isc_ht_count(catz->entries) == 0);
-	isc_ht_destroy(&catz->entries);
+	if (changed == NULL) {
+		/* At this moment catz->entries has to be be empty. */
+		INSIST(isc_ht_count(catz->entries) == 0);
+		isc_ht_destroy(&catz->entries);
+	}
 
 	for (result = isc_ht_iter_first(iteradd); result == ISC_R_SUCCESS;
 	     result = isc_ht_iter_delcurrent_next(iteradd))
@@ -739,14 +817,64 @@ dns__catz_zones_merge(dns_catz_zone_t *catz, dns_catz_zone_t *newcatz) {
 			      zname, czname, isc_result_totext(result));
 	}
 
-	catz->entries = newcatz->entries;
-	newcatz->entries = NULL;
+	if (changed != NULL) {
+		isc_ht_iter_t *iter = NULL;
+
+		/*
+		 * Move the updated entries and their coo records over;
+		 * the old ones are all gone by now.
+		 */
+		isc_ht_iter_create(newcatz->entries, &iter);
+		for (result = isc_ht_iter_first(iter); result == ISC_R_SUCCESS;
+		     result = isc_ht_iter_delcurrent_next(iter))
+		{
+			dns_catz_entry_t *entry = NULL;
+			unsigned char *key = NULL;
+			size_t keysize;
+
+			isc_ht_iter_current(iter, (void **)&entry);
+			isc_ht_iter_currentkey(iter, &key, &keysize);
+			result = isc_ht_add(catz->entries, key,
+					    (uint32_t)keysize, entry);
+			RUNTIME_CHECK(result == ISC_R_SUCCESS);
+		}
+		INSIST(result == ISC_R_NOMORE);
+		isc_ht_iter_destroy(&iter);
+
+		isc_ht_iter_create(newcatz->coos, &iter);
+		for (result = isc_ht_iter_first(iter); result == ISC_R_SUCCESS;
+		     result = isc_ht_iter_delcurrent_next(iter))
+		{
+			dns_catz_coo_t *coo = NULL, *ocoo = NULL;
+			unsigned char *key = NULL;
+			size_t keysize;
+
+			isc_ht_iter_current(iter, (void **)&coo);
+			isc_ht_iter_currentkey(iter, &key, &keysize);
+			if (isc_ht_find(catz->coos, key, (uint32_t)keysize,
+					(void **)&ocoo) == ISC_R_SUCCESS)
+			{
+				result = isc_ht_delete(catz->coos, key,
+						       (uint32_t)keysize);
+				RUNTIME_CHECK(result == ISC_R_SUCCESS);
+				catz_coo_detach(catz, &ocoo);
+			}
+			result = isc_ht_add(catz->coos, key, (uint32_t)keysize,
+					    coo);
+			RUNTIME_CHECK(result == ISC_R_SUCCESS);
+		}
+		INSIST(result == ISC_R_NOMORE);
+		isc_ht_iter_destroy(&iter);
+	} else {
+		catz->entries = newcatz->entries;
+		newcatz->entries = NULL;
+	}
 
 	/*
 	 * We do not need to merge old coo (change of ownership) permission
 	 * records with the new ones, just replace them.
 	 */
-	if (catz->coos != NULL && newcatz->coos != NULL) {
+	if (changed == NULL && catz->coos != NULL && newcatz->coos != NULL) {
 		isc_ht_iter_t *iter = NULL;
 
 		isc_ht_iter_create(catz->coos, &iter);
@@ -836,7 +964,7 @@ dns_catz_zone_new(dns_catz_zones_t *catzs, const dns_name_t *name) {
 	dns_catz_zones_attach(catzs, &catz->catzs);
 	isc_mutex_init(&catz->lock);
 	isc_refcount_init(&catz->references, 1);
-	isc_ht_init(&catz->entries, catzs->mctx, 4, ISC_HT_CASE_SENSITIVE);
+	isc_ht_init(&catz->entries, catzs->mctx, 4, ISC_HT_CASE_INSENSITIVE);
 	isc_ht_init(&catz->coos, catzs->mctx, 4, ISC_HT_CASE_INSENSITIVE);
 	isc_time_settoepoch(&catz->lastupdated);
 	dns_catz_options_init(&catz->defoptions);
@@ -2158,6 +2286,8 @@ dns_catz_dbupdate_callback(dns_db_t *db, void *fn_arg) {
 
 	/* New zone came as AXFR */
 	if (catz->db != NULL && catz->db != db) {
+		catz->insync = false;
+
 		/* Old db cleanup. */
 		if (catz->dbversion != NULL) {
 			dns_db_closeversion(catz->db, &catz->dbversion, false);
@@ -2220,6 +2350,259 @@ catz_rdatatype_is_processable(const dns_rdatatype_t type) {
 		type != dns_rdatatype_cdnskey && type != dns_rdatatype_zonemd);
 }
 
+/*
+ * Process all the rdatasets of one node of a catalog zone database.
+ */
+static isc_result_t
+catz_update_node(dns_catz_zone_t *newcatz, dns_db_t *updb,
+		 dns_dbversion_t *version, dns_dbnode_t *node,
+		 const dns_name_t *name) {
+	isc_result_t result;
+	dns_rdatasetiter_t *rdsiter = NULL;
+	dns_rdataset_t rdataset;
+	char cname[DNS_NAME_FORMATSIZE];
+
+	result = dns_db_allrdatasets(updb, node, version, 0, 0, &rdsiter);
+	if (result != ISC_R_SUCCESS) {
+		isc_log_write(DNS_LOGCATEGORY_GENERAL, DNS_LOGMODULE_MASTER,
+			      ISC_LOG_ERROR,
+			      "catz: failed to fetch rrdatasets - %s",
+			      isc_result_totext(result));
+		return (result);
+	}
+
+	dns_rdataset_init(&rdataset);
+	result = dns_rdatasetiter_first(rdsiter);
+	while (result == ISC_R_SUCCESS) {
+		dns_rdatasetiter_current(rdsiter, &rdataset);
+
+		/*
+		 * Skip processing DNSSEC-related and ZONEMD types,
+		 * because we are not interested in them in the context
+		 * of a catalog zone, and processing them will fail
+		 * and produce an unnecessary warning message.
+		 */
+		if (!catz_rdatatype_is_processable(rdataset.type)) {
+			goto next;
+		}
+
+		/*
+		 * Although newcatz->coos is accessed in
+		 * catz_process_coo() in the call-chain below, we don't
+		 * need to hold the newcatz->lock, because the newcatz
+		 * is still local to this thread and function and
+		 * newcatz->coos can't be accessed from the outside
+		 * until dns__catz_zones_merge() has been called.
+		 */
+		result = dns__catz_update_process(newcatz, name, &rdataset);
+		if (result != ISC_R_SUCCESS) {
+			char typebuf[DNS_RDATATYPE_FORMATSIZE];
+			char classbuf[DNS_RDATACLASS_FORMATSIZE];
+
+			dns_name_format(name, cname, DNS_NAME_FORMATSIZE);
+			dns_rdataclass_format(rdataset.rdclass, classbuf,
+					      sizeof(classbuf));
+			dns_rdatatype_format(rdataset.type, typebuf,
+					     sizeof(typebuf));
+			isc_log_write(DNS_LOGCATEGORY_GENERAL,
+				      DNS_LOGMODULE_MASTER, ISC_LOG_WARNING,
+				      "catz: invalid record in catalog "
+				      "zone - %s %s %s (%s) - ignoring",
+				      cname, classbuf, typebuf,
+				      isc_result_totext(result));
+		}
+	next:
+		dns_rdataset_disassociate(&rdataset);
+		result = dns_rdatasetiter_next(rdsiter);
+	}
+
+	dns_rdatasetiter_destroy(&rdsiter);
+
+	return (ISC_R_SUCCESS);
+}
+
+/*
+ * Read the names changed between 'serial' and 'end_serial' from the
+ * journal, and process only the member zone entries they belong to into
+ * a new catz.  On success '*changedp' holds the unique labels of those
+ * entries, for dns__catz_zones_merge().
+ *
+ * Changes outside of the member zone entries, to the version or to the
+ * global options, need the whole zone; ISC_R_NOTFOUND is returned then.
+ */
+static isc_result_t
+catz_update_from_journal(dns_catz_zone_t *catz, dns_dbiterator_t *updbit,
+			 const char *journal, uint32_t serial,
+			 uint32_t end_serial, dns_catz_zone_t **newcatzp,
+			 isc_ht_t **changedp) {
+	isc_result_t result;
+	isc_mem_t *mctx = catz->catzs->mctx;
+	dns_journal_t *j = NULL;
+	dns_catz_zone_t *newcatz = NULL;
+	isc_ht_t *changed = NULL;
+	isc_ht_iter_t *iter = NULL;
+	dns_fixedname_t fzones, fentry, fname;
+	dns_name_t *zones = dns_fixedname_initname(&fzones);
+	dns_name_t *entryname = dns_fixedname_initname(&fentry);
+	dns_name_t *name = dns_fixedname_initname(&fname);
+	char cname[DNS_NAME_FORMATSIZE];
+
+	isc_ht_init(&changed, mctx, 1, ISC_HT_CASE_INSENSITIVE);
+
+	if (serial != end_serial) {
+		result = dns_journal_open(mctx, journal, DNS_JOURNAL_READ, &j);
+		if (result != ISC_R_SUCCESS) {
+			goto cleanup;
+		}
+		result = dns_journal_iter_init(j, serial, end_serial, NULL);
+		if (result != ISC_R_SUCCESS) {
+			goto cleanup;
+		}
+	}
+
+	for (result = (j != NULL) ? dns_journal_first_rr(j) : ISC_R_NOMORE;
+	     result == ISC_R_SUCCESS; result = dns_journal_next_rr(j))
+	{
+		dns_name_t *owner = NULL;
+		dns_rdata_t *rdata = NULL;
+		dns_label_t label;
+		unsigned int nlabels;
+		uint32_t ttl;
+
+		dns_journal_current_rr(j, &owner, &ttl, &rdata);
+		if (!catz_rdatatype_is_processable(rdata->type) ||
+		    dns_name_equal(owner, &catz->name))
+		{
+			continue;
+		}
+
+		/* Only <unique-N>.zones.<catalog> and below. */
+		if (!dns_name_issubdomain(owner, &catz->name)) {
+			result = ISC_R_NOTFOUND;
+			goto cleanup;
+		}
+		nlabels = owner->labels - catz->name.labels;
+		if (nlabels < 2) {
+			result = ISC_R_NOTFOUND;
+			goto cleanup;
+		}
+		dns_name_getlabel(owner, nlabels - 1, &label);
+		if (catz_get_option(&label) != CATZ_OPT_ZONES) {
+			result = ISC_R_NOTFOUND;
+			goto cleanup;
+		}
+
+		dns_name_getlabel(owner, nlabels - 2, &label);
+		(void)isc_ht_add(changed, label.base, label.length, catz);
+	}
+	if (result != ISC_R_NOMORE) {
+		goto cleanup;
+	}
+
+	result = dns_name_fromstring(zones, "zones", &catz->name, 0, NULL);
+	if (result != ISC_R_SUCCESS) {
+		goto cleanup;
+	}
+
+	newcatz = dns_catz_zone_new(catz->catzs, &catz->name);
+	newcatz->version = catz->version;
+
+	isc_ht_iter_create(changed, &iter);
+	for (result = isc_ht_iter_first(iter); result == ISC_R_SUCCESS;
+	     result = isc_ht_iter_next(iter))
+	{
+		dns_name_t label;
+		isc_region_t r;
+		unsigned char *key = NULL;
+		size_t keysize;
+
+		if (atomic_load(&catz->catzs->shuttingdown)) {
+			result = ISC_R_SHUTTINGDOWN;
+			goto cleanup;
+		}
+
+		isc_ht_iter_currentkey(iter, &key, &keysize);
+		r.base = key;
+		r.length = (unsigned int)keysize;
+		dns_name_init(&label, NULL);
+		dns_name_fromregion(&label, &r);
+		result = dns_name_concatenate(&label, zones, entryname, NULL);
+		if (result != ISC_R_SUCCESS) {
+			goto cleanup;
+		}
+
+		/*
+		 * Without a node for the member zone PTR record there is
+		 * no entry anymore.  Otherwise the entry is the node and
+		 * the suboptions below it, which follow it in the
+		 * database.
+		 */
+		result = dns_dbiterator_seek(updbit, entryname);
+		while (result == ISC_R_SUCCESS) {
+			dns_dbnode_t *node = NULL;
+
+			result = dns_dbiterator_current(updbit, &node, name);
+			if (result != ISC_R_SUCCESS) {
+				goto cleanup;
+			}
+			if (!dns_name_issubdomain(name, entryname)) {
+				dns_db_detachnode(catz->updb, &node);
+				break;
+			}
+
+			result = dns_dbiterator_pause(updbit);
+			RUNTIME_CHECK(result == ISC_R_SUCCESS);
+
+			result = catz_update_node(newcatz, catz->updb,
+						  catz->updbversion, node,
+						  name);
+			dns_db_detachnode(catz->updb, &node);
+			if (result != ISC_R_SUCCESS) {
+				goto cleanup;
+			}
+
+			result = dns_dbiterator_next(updbit);
+		}
+		if (result != ISC_R_SUCCESS && result != ISC_R_NOMORE &&
+		    result != ISC_R_NOTFOUND && result != DNS_R_PARTIALMATCH)
+		{
+			goto cleanup;
+		}
+	}
+	if (result != ISC_R_NOMORE) {
+		goto cleanup;
+	}
+	result = ISC_R_SUCCESS;
+
+	dns_name_format(&catz->name, cname, DNS_NAME_FORMATSIZE);
+	isc_log_write(DNS_LOGCATEGORY_GENERAL, DNS_LOGMODULE_MASTER,
+		      ISC_LOG_DEBUG(1),
+		      "catz: %s: serial %u to %u from journal: "
+		      "%zu changed entries",
+		      cname, serial, end_serial, isc_ht_count(changed));
+
+	*newcatzp = newcatz;
+	newcatz = NULL;
+	*changedp = changed;
+	changed = NULL;
+
+cleanup:
+	if (iter != NULL) {
+		isc_ht_iter_destroy(&iter);
+	}
+	if (newcatz != NULL) {
+		dns_catz_zone_detach(&newcatz);
+	}
+	if (changed != NULL) {
+		isc_ht_destroy(&changed);
+	}
+	if (j != NULL) {
+		dns_journal_destroy(&j);
+	}
+
+	return (result);
+}
+
 /*
  * Process an updated database for a catalog zone.
  * It creates a new catz, iterates over database to fill it with content, and
@@ -2238,13 +2621,16 @@ dns__catz_update_cb(void *data) {
 	dns_dbiterator_t *updbit = NULL;
 	dns_fixedname_t fixname;
 	dns_name_t *name = NULL;
-	dns_rdatasetiter_t *rdsiter = NULL;
-	dns_rdataset_t rdataset;
+	dns_zone_t *zone = NULL;
+	isc_ht_t *changed = NULL;
 	char bname[DNS_NAME_FORMATSIZE];
 	char cname[DNS_NAME_FORMATSIZE];
+	char *journal = NULL;
 	bool is_vers_processed = false;
 	bool is_active;
-	uint32_t vers;
+	bool insync;
+	uint32_t vers = 0;
+	uint32_t serial;
 	uint32_t catz_vers;
 
 	REQUIRE(DNS_CATZ_ZONE_VALID(catz));
@@ -2273,6 +2659,8 @@ dns__catz_update_cb(void *data) {
 	}
 	result = isc_ht_find(catzs->zones, r.base, r.length, (void **)&oldcatz);
 	is_active = (result == ISC_R_SUCCESS && oldcatz->active);
+	insync = (result == ISC_R_SUCCESS && oldcatz->insync);
+	serial = insync ? oldcatz->serial : 0;
 	UNLOCK(&catzs->lock);
 	if (result != ISC_R_SUCCESS) {
 		/* This can happen if we remove the zone in the meantime. */
@@ -2317,6 +2705,40 @@ dns__catz_update_cb(void *data) {
 
 	name = dns_fixedname_initname(&fixname);
 
+	/*
+	 * If the previous update was processed from this database, only
+	 * the member zones changed since then need to be looked at.
+	 */
+	if (insync && dns_view_findzone(catzs->view, &updb->origin,
+					DNS_ZTFIND_EXACT,
+					&zone) == ISC_R_SUCCESS)
+	{
+		if (dns_zone_getjournal(zone) != NULL) {
+			journal = isc_mem_strdup(catzs->mctx,
+						 dns_zone_getjournal(zone));
+		}
+		dns_zone_detach(&zone);
+	}
+	if (journal != NULL) {
+		result = catz_update_from_journal(oldcatz, updbit, journal,
+						  serial, vers, &newcatz,
+						  &changed);
+		isc_mem_free(catzs->mctx, journal);
+		if (result == ISC_R_SUCCESS || result == ISC_R_SHUTTINGDOWN) {
+			dns_dbiterator_destroy(&updbit);
+			if (result == ISC_R_SUCCESS) {
+				goto merge;
+			}
+			goto exit;
+		}
+
+		isc_log_write(DNS_LOGCATEGORY_GENERAL, DNS_LOGMODULE_MASTER,
+			      ISC_LOG_DEBUG(1),
+			      "catz: %s: journal does not cover serial %u "
+			      "(%s), walking the whole zone",
+			      bname, serial, isc_result_totext(result));
+	}
+
 	/*
 	 * Take the version record to process first, because the other
 	 * records might be processed differently depending on the version of
@@ -2377,70 +2799,13 @@ dns__catz_update_cb(void *data) {
 			continue;
 		}
 
-		result = dns_db_allrdatasets(updb, node, oldcatz->updbversion,
-					     0, 0, &rdsiter);
+		result = catz_update_node(newcatz, updb, oldcatz->updbversion,
+					  node, name);
+		dns_db_detachnode(updb, &node);
 		if (result != ISC_R_SUCCESS) {
-			isc_log_write(DNS_LOGCATEGORY_GENERAL,
-				      DNS_LOGMODULE_MASTER, ISC_LOG_ERROR,
-				      "catz: failed to fetch rrdatasets - %s",
-				      isc_result_totext(result));
-			dns_db_detachnode(updb, &node);
 			break;
 		}
 
-		dns_rdataset_init(&rdataset);
-		result = dns_rdatasetiter_first(rdsiter);
-		while (result == ISC_R_SUCCESS) {
-			dns_rdatasetiter_current(rdsiter, &rdataset);
-
-			/*
-			 * Skip processing DNSSEC-related and ZONEMD types,
-			 * because we are not interested in them in the context
-			 * of a catalog zone, and processing them will fail
-			 * and produce an unnecessary warning message.
-			 */
-			if (!catz_rdatatype_is_processable(rdataset.type)) {
-				goto next;
-			}
-
-			/*
-			 * Although newcatz->coos is accessed in
-			 * catz_process_coo() in the call-chain below, we don't
-			 * need to hold the newcatz->lock, because the newcatz
-			 * is still local to this thread and function and
-			 * newcatz->coos can't be accessed from the outside
-			 * until dns__catz_zones_merge() has been called.
-			 */
-			result = dns__catz_update_process(newcatz, name,
-							  &rdataset);
-			if (result != ISC_R_SUCCESS) {
-				char typebuf[DNS_RDATATYPE_FORMATSIZE];
-				char classbuf[DNS_RDATACLASS_FORMATSIZE];
-
-				dns_name_format(name, cname,
-						DNS_NAME_FORMATSIZE);
-				dns_rdataclass_format(rdataset.rdclass,
-						      classbuf,
-						      sizeof(classbuf));
-				dns_rdatatype_format(rdataset.type, typebuf,
-						     sizeof(typebuf));
-				isc_log_write(DNS_LOGCATEGORY_GENERAL,
-					      DNS_LOGMODULE_MASTER,
-					      ISC_LOG_WARNING,
-					      "catz: invalid record in catalog "
-					      "zone - %s %s %s (%s) - ignoring",
-					      cname, classbuf, typebuf,
-					      isc_result_totext(result));
-			}
-		next:
-			dns_rdataset_disassociate(&rdataset);
-			result = dns_rdatasetiter_next(rdsiter);
-		}
-
-		dns_rdatasetiter_destroy(&rdsiter);
-
-		dns_db_detachnode(updb, &node);
-
 		if (!is_vers_processed) {
 			is_vers_processed = true;
 			result = dns_dbiterator_first(updbit);
@@ -2455,6 +2820,7 @@ dns__catz_update_cb(void *data) {
 		      "catz: update_from_db: iteration finished: %s",
 		      isc_result_totext(result));
 
+merge:
 	/*
 	 * Check catalog zone version compatibilites.
 	 */
@@ -2492,7 +2858,7 @@ dns__catz_update_cb(void *data) {
 	/*
 	 * Finally merge new zone into old zone.
 	 */
-	result = dns__catz_zones_merge(oldcatz, newcatz);
+	result = dns__catz_zones_merge(oldcatz, newcatz, changed);
 	dns_catz_zone_detach(&newcatz);
 	if (result != ISC_R_SUCCESS) {
 		isc_log_write(DNS_LOGCATEGORY_GENERAL, DNS_LOGMODULE_MASTER,
@@ -2507,6 +2873,16 @@ dns__catz_update_cb(void *data) {
 		      "catz: update_from_db: new zone merged");
 
 exit:
+	if (changed != NULL) {
+		isc_ht_destroy(&changed);
+	}
+	if (oldcatz != NULL) {
+		LOCK(&catzs->lock);
+		oldcatz->insync = (result == ISC_R_SUCCESS &&
+				   oldcatz->db == updb);
+		oldcatz->serial = vers;
+		UNLOCK(&catzs->lock);
+	}
 	catz->updateresult = result;
 }
 
@@ -2587,7 +2963,7 @@ dns_catz_postreconfig(dns_catz_zones_t *catzs) {
 			 * all members.
 			 */
 			newcatz = dns_catz_zone_new(catzs, &catz->name);
-			dns__catz_zones_merge(catz, newcatz);
+			dns__catz_zones_merge(catz, newcatz, NULL);
 			dns_catz_zone_detach(&newcatz);
 
 			/* Make sure that we have an empty catalog zone. */
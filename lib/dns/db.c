@@ -1188,3 +1188,17 @@ dns_db_setmaxtypepername(dns_db_t *db, uint32_t value) {
 		(db->methods->setmaxtypepername)(db, value);
 	}
 }
+
+unsigned int
+dns_db_gethot(dns_db_t *db, isc_stdtime_t now, dns_ttl_t window,
+	      uint32_t minhits, dns_dbhotentry_t *entries, unsigned int count) {
+	REQUIRE(DNS_DB_VALID(db));
+	REQUIRE((db->attributes & DNS_DBATTR_CACHE) != 0);
+	REQUIRE(entries != NULL || count == 0);
+
+	if (db->methods->gethot != NULL) {
+		return ((db->methods->gethot)(db, now, window, minhits, entries,
+					      count));
+	}
+	return (0);
+}
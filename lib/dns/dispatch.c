@@ -117,6 +117,7 @@ struct dns_dispatch {
 	isc_nmhandle_t *handle; /*%< netmgr handle for TCP connection */
 	isc_sockaddr_t local;	/*%< local address */
 	isc_sockaddr_t peer;	/*%< peer address (TCP) */
+	dns_transport_t *transport; /*%< transport used to connect (TCP) */
 
 	dns_dispatchopt_t options;
 	dns_dispatchstate_t state;
@@ -168,6 +169,13 @@ ISC_REFCOUNT_DECL(dns_dispentry);
 #define QIDS_INIT_SIZE (1 << 4) /* Must be power of 2 */
 #define QIDS_MIN_SIZE  (1 << 4) /* Must be power of 2 */
 
+/*
+ * How long (in milliseconds) to keep a shared TCP connection open
+ * after its last response has been received, so that it can be reused
+ * by dns_dispatch_gettcp().
+ */
+#define DISPATCH_TCP_IDLE_TIMEOUT 5000
+
 /*
  * Statics.
  */
@@ -191,6 +199,10 @@ static void
 udp_dispatch_connect(dns_dispatch_t *disp, dns_dispentry_t *resp);
 static void
 tcp_startrecv(dns_dispatch_t *disp, dns_dispentry_t *resp);
+static bool
+tcp_dispatch_poolable(dns_dispatch_t *disp);
+static void
+tcp_dispatch_idle(dns_dispatch_t *disp);
 static void
 tcp_dispatch_getnext(dns_dispatch_t *disp, dns_dispentry_t *resp,
 		     int32_t timeout);
@@ -797,6 +809,18 @@ tcp_recv(isc_nmhandle_t *handle, isc_result_t result, isc_region_t *region,
 	 */
 	switch (result) {
 	case ISC_R_TIMEDOUT:
+		if (ISC_LIST_EMPTY(disp->active) && tcp_dispatch_poolable(disp))
+		{
+			/*
+			 * The connection has been idle for too long; stop
+			 * reusing it and let it close.
+			 */
+			dispatch_log(disp, ISC_LOG_DEBUG(90),
+				     "idle TCP connection timed out");
+			disp->state = DNS_DISPATCHSTATE_CANCELED;
+			break;
+		}
+
 		/*
 		 * Time out the oldest response in the active queue.
 		 */
@@ -823,9 +847,13 @@ tcp_recv(isc_nmhandle_t *handle, isc_result_t result, isc_region_t *region,
 		if (disp->timedout > 0) {
 			/* There was active query that timed-out before */
 			disp->timedout--;
-		} else {
+		} else if ((disp->options & DNS_DISPATCHOPT_UNSHARED) != 0) {
 			result = ISC_R_UNEXPECTED;
 		}
+		/*
+		 * Otherwise, this is most likely a late response to
+		 * a query that has been canceled; skip it.
+		 */
 	}
 
 	/*
@@ -892,6 +920,8 @@ tcp_recv(isc_nmhandle_t *handle, isc_result_t result, isc_region_t *region,
 		if (timeout > 0) {
 			isc_nmhandle_settimeout(handle, timeout);
 		}
+	} else if (result == ISC_R_NOTFOUND && tcp_dispatch_poolable(disp)) {
+		tcp_dispatch_idle(disp);
 	}
 
 	rcu_read_unlock();
@@ -1136,33 +1166,36 @@ struct dispatch_key {
 	const isc_sockaddr_t *peer;
 };
 
+/*
+ * Only the peer address is hashed, so that dns_dispatch_gettcp() can
+ * find the dispatches with any local address when 'localaddr' is NULL.
+ */
 static uint32_t
 dispatch_hash(struct dispatch_key *key) {
-	uint32_t hashval = isc_sockaddr_hash(key->peer, false);
-	if (key->local) {
-		hashval ^= isc_sockaddr_hash(key->local, true);
-	}
-
-	return (hashval);
+	return (isc_sockaddr_hash(key->peer, false));
 }
 
 static int
 dispatch_match(struct cds_lfht_node *node, const void *key0) {
 	dns_dispatch_t *disp = caa_container_of(node, dns_dispatch_t, ht_node);
 	const struct dispatch_key *key = key0;
-	isc_sockaddr_t local;
 	isc_sockaddr_t peer;
 
 	if (disp->handle != NULL) {
-		local = isc_nmhandle_localaddr(disp->handle);
 		peer = isc_nmhandle_peeraddr(disp->handle);
 	} else {
-		local = disp->local;
 		peer = disp->peer;
 	}
 
+	/*
+	 * The local address is compared with the one the dispatch was
+	 * created with, not with the address the socket got bound to:
+	 * callers ask for their configured source address, which usually
+	 * has port 0 and may be a wildcard address.
+	 */
 	return (isc_sockaddr_equal(&peer, key->peer) &&
-		(key->local == NULL || isc_sockaddr_equal(&local, key->local)));
+		(key->local == NULL ||
+		 isc_sockaddr_equal(&disp->local, key->local)));
 }
 
 isc_result_t
@@ -1222,7 +1255,8 @@ dns_dispatch_createtcp(dns_dispatchmgr_t *mgr, const isc_sockaddr_t *localaddr,
 
 isc_result_t
 dns_dispatch_gettcp(dns_dispatchmgr_t *mgr, const isc_sockaddr_t *destaddr,
-		    const isc_sockaddr_t *localaddr, dns_dispatch_t **dispp) {
+		    const isc_sockaddr_t *localaddr, dns_transport_t *transport,
+		    dns_dispatch_t **dispp) {
 	dns_dispatch_t *disp_connected = NULL;
 	dns_dispatch_t *disp_fallback = NULL;
 	isc_result_t result = ISC_R_NOTFOUND;
@@ -1246,16 +1280,20 @@ dns_dispatch_gettcp(dns_dispatchmgr_t *mgr, const isc_sockaddr_t *destaddr,
 		INSIST(disp->tid == isc_tid());
 		INSIST(disp->socktype == isc_socktype_tcp);
 
+		if (disp->transport != transport) {
+			/* Connected using a different transport, skip it */
+			continue;
+		}
+
 		switch (disp->state) {
 		case DNS_DISPATCHSTATE_NONE:
 			/* A dispatch in indeterminate state, skip it */
 			break;
 		case DNS_DISPATCHSTATE_CONNECTED:
-			if (ISC_LIST_EMPTY(disp->active)) {
-				/* Ignore dispatch with no responses */
-				break;
-			}
-			/* We found a connected dispatch */
+			/*
+			 * We found a connected dispatch; it might be idle,
+			 * waiting for new responses.
+			 */
 			dns_dispatch_attach(disp, &disp_connected);
 			break;
 		case DNS_DISPATCHSTATE_CONNECTING:
@@ -1397,6 +1435,9 @@ dispatch_destroy(dns_dispatch_t *disp) {
 			     &disp->handle);
 		isc_nmhandle_detach(&disp->handle);
 	}
+	if (disp->transport != NULL) {
+		dns_transport_detach(&disp->transport);
+	}
 	dns_dispatchmgr_detach(&disp->mgr);
 
 	call_rcu(&disp->rcu_head, dispatch_destroy_rcu);
@@ -1627,6 +1668,32 @@ unlock:
 /*
  * NOTE: Must be RCU read locked!
  */
+/*
+ * A shared TCP dispatch that is still connected stays open, reading, for
+ * DISPATCH_TCP_IDLE_TIMEOUT after its last response is gone.  The pending
+ * read holds a reference to the dispatch, so it is freed (and the
+ * connection closed) only when the idle read times out or fails.
+ */
+static bool
+tcp_dispatch_poolable(dns_dispatch_t *disp) {
+	return ((disp->options & DNS_DISPATCHOPT_UNSHARED) == 0 &&
+		disp->state == DNS_DISPATCHSTATE_CONNECTED);
+}
+
+static void
+tcp_dispatch_idle(dns_dispatch_t *disp) {
+	dispatch_log(disp, ISC_LOG_DEBUG(90),
+		     "keeping idle TCP connection %p open for %u ms",
+		     disp->handle, DISPATCH_TCP_IDLE_TIMEOUT);
+
+	isc_nmhandle_cleartimeout(disp->handle);
+	isc_nmhandle_settimeout(disp->handle, DISPATCH_TCP_IDLE_TIMEOUT);
+
+	if (!disp->reading) {
+		tcp_startrecv(disp, NULL);
+	}
+}
+
 static void
 tcp_dispentry_cancel(dns_dispentry_t *resp, isc_result_t result) {
 	REQUIRE(VALID_RESPONSE(resp));
@@ -1663,40 +1730,18 @@ tcp_dispentry_cancel(dns_dispentry_t *resp, isc_result_t result) {
 		if (ISC_LIST_EMPTY(disp->active)) {
 			INSIST(disp->handle != NULL);
 
-#if DISPATCH_TCP_KEEPALIVE
-			/*
-			 * This is an experimental code that keeps the TCP
-			 * connection open for 1 second before it is finally
-			 * closed.  By keeping the TCP connection open, it can
-			 * be reused by dns_request that uses
-			 * dns_dispatch_gettcp() to join existing TCP
-			 * connections.
-			 *
-			 * It is disabled for now, because it changes the
-			 * behaviour, but I am keeping the code here for future
-			 * reference when we improve the dns_dispatch to reuse
-			 * the TCP connections also in the resolver.
-			 *
-			 * The TCP connection reuse should be seamless and not
-			 * require any extra handling on the client side though.
-			 */
-			isc_nmhandle_cleartimeout(disp->handle);
-			isc_nmhandle_settimeout(disp->handle, 1000);
-
-			if (!disp->reading) {
-				dispentry_log(resp, ISC_LOG_DEBUG(90),
-					      "final 1 second timeout on %p",
-					      disp->handle);
-				tcp_startrecv(disp, NULL);
-			}
-#else
-			if (disp->reading) {
+			if (tcp_dispatch_poolable(disp)) {
+				/*
+				 * Keep the connection open for a while, so
+				 * it can be reused by dns_dispatch_gettcp().
+				 */
+				tcp_dispatch_idle(disp);
+			} else if (disp->reading) {
 				dispentry_log(resp, ISC_LOG_DEBUG(90),
 					      "canceling read on %p",
 					      disp->handle);
 				isc_nm_cancelread(disp->handle);
 			}
-#endif
 		}
 		break;
 
@@ -1973,6 +2018,10 @@ tcp_dispatch_connect(dns_dispatch_t *disp, dns_dispentry_t *resp) {
 	case DNS_DISPATCHSTATE_NONE:
 		/* First connection, continue with connecting */
 		disp->state = DNS_DISPATCHSTATE_CONNECTING;
+		if (resp->transport != NULL) {
+			INSIST(disp->transport == NULL);
+			dns_transport_attach(resp->transport, &disp->transport);
+		}
 		resp->state = DNS_DISPATCHSTATE_CONNECTING;
 		resp->start = isc_loop_now(resp->loop);
 		dns_dispentry_ref(resp); /* DISPENTRY005 */
@@ -2009,6 +2058,15 @@ tcp_dispatch_connect(dns_dispatch_t *disp, dns_dispentry_t *resp) {
 		resp->state = DNS_DISPATCHSTATE_CONNECTED;
 		resp->start = isc_loop_now(resp->loop);
 
+		if (ISC_LIST_EMPTY(disp->active)) {
+			/* Replace the idle timeout with ours */
+			isc_nmhandle_cleartimeout(disp->handle);
+			if (resp->timeout > 0) {
+				isc_nmhandle_settimeout(disp->handle,
+							resp->timeout);
+			}
+		}
+
 		/* Add the resp to the reading list */
 		ISC_LIST_APPEND(disp->active, resp, alink);
 		dispentry_log(resp, ISC_LOG_DEBUG(90),
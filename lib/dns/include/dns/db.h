@@ -78,6 +78,18 @@ extern unsigned int dns_pps;
 ***** Types
 *****/
 
+/*%
+ * A popular cache entry that is about to expire, as returned by
+ * dns_db_gethot().
+ */
+typedef struct dns_dbhotentry {
+	dns_fixedname_t fixed;
+	dns_name_t     *name;
+	dns_rdatatype_t type;
+	uint32_t	hits;
+	isc_stdtime_t	expire;
+} dns_dbhotentry_t;
+
 typedef struct dns_dbmethods {
 	void (*destroy)(dns_db_t *db);
 	isc_result_t (*beginload)(dns_db_t	       *db,
@@ -185,6 +197,9 @@ typedef struct dns_dbmethods {
 				     dns_name_t *name);
 	void (*setmaxrrperset)(dns_db_t *db, uint32_t value);
 	void (*setmaxtypepername)(dns_db_t *db, uint32_t value);
+	unsigned int (*gethot)(dns_db_t *db, isc_stdtime_t now,
+			       dns_ttl_t window, uint32_t minhits,
+			       dns_dbhotentry_t *entries, unsigned int count);
 } dns_dbmethods_t;
 
 typedef isc_result_t (*dns_dbcreatefunc_t)(isc_mem_t	    *mctx,
@@ -259,6 +274,7 @@ enum {
 	DNS_DBFIND_ADDITIONALOK = 1 << 6,
 	DNS_DBFIND_NOZONECUT = 1 << 7,
 	DNS_DBFIND_WANTPARTIAL = 1 << 8,
+	DNS_DBFIND_NXDOMAINCUT = 1 << 9,
 };
 
 /*
@@ -303,6 +319,8 @@ enum {
 #define DNS_DBADD_EXACT	   0x04
 #define DNS_DBADD_EXACTTTL 0x08
 #define DNS_DBADD_PREFETCH 0x10
+#define DNS_DBADD_REFRESH  0x20
+#define DNS_DBADD_QMIN	   0x40
 /*@}*/
 
 /*%
@@ -807,6 +825,12 @@ dns__db_findext(dns_db_t *db, const dns_name_t *name, dns_dbversion_t *version,
  *	that it is correct.  This only affects answers returned from the
  *	cache.
  *
+ * \li	If the #DNS_DBFIND_NXDOMAINCUT option is set, then a name below
+ *	a cached NXDOMAIN is reported as not existing as well (RFC 8020).
+ *	An unvalidated NXDOMAIN that was added with #DNS_DBADD_QMIN is
+ *	not used for this.  This only affects answers returned from the
+ *	cache.
+ *
  * \li	If the #DNS_DBFIND_FORCENSEC3 option is set, then we are looking
  *	in the NSEC3 tree and not the main tree.  Without this option being
  *	set NSEC3 records will not be found.
@@ -912,7 +936,13 @@ dns__db_findext(dns_db_t *db, const dns_name_t *name, dns_dbversion_t *version,
  *	\li	#DNS_R_NCACHENXDOMAIN		The desired name does not
  *						exist.  'node' is bound to the
  *						cache node with the desired
- *						name, and 'rdataset' contains
+ *						name, or, if
+ *						DNS_DBFIND_NXDOMAINCUT is
+ *						set, to an ancestor that is
+ *						securely known not to exist
+ *						(RFC 8020), 'foundname' is
+ *						set to the name of that node,
+ *						and 'rdataset' contains
  *						the negative caching proof.
  *
  *	\li	#DNS_R_NCACHENXRRSET		The desired type does not
@@ -1249,6 +1279,9 @@ dns__db_addrdataset(dns_db_t *db, dns_dbnode_t *node, dns_dbversion_t *version,
  *	the old and new rdata sets.  If #DNS_DBADD_EXACTTTL is set then both
  *	the old and new rdata sets must have the same ttl.
  *
+ * \li	#DNS_DBADD_QMIN marks a negative cache entry that was learned by
+ *	a relaxed QNAME minimization query.  See #DNS_DBFIND_NXDOMAINCUT.
+ *
  * \li	The 'now' field is ignored if 'db' is a zone database.  If 'db' is
  *	a cache database, then the added rdataset will expire no later than
  *	now + rdataset->ttl.
@@ -1822,4 +1855,29 @@ dns_db_setmaxtypepername(dns_db_t *db, uint32_t value);
  * stored at a given node, then any subsequent attempt to add an rdataset
  * with a new RR type will return ISC_R_TOOMANYRECORDS.
  */
+
+unsigned int
+dns_db_gethot(dns_db_t *db, isc_stdtime_t now, dns_ttl_t window,
+	      uint32_t minhits, dns_dbhotentry_t *entries, unsigned int count);
+/*%<
+ * Find up to 'count' of the most frequently used prefetch-eligible
+ * RRsets in the cache database 'db' that will expire within 'window'
+ * seconds of 'now' and have been looked up at least 'minhits' times.
+ * The owner name, type, hit count and expiry time of each are stored
+ * in 'entries', most popular first.
+ *
+ * The DNS_SLABHEADERATTR_PREFETCH attribute is cleared on every
+ * returned RRset, so that it is neither returned again nor prefetched
+ * by a client query until it has been refreshed.
+ *
+ * Requires:
+ *
+ * \li	'db' is a valid cache database.
+ * \li	'entries' points to an array of at least 'count' elements.
+ *
+ * Returns:
+ *
+ * \li	The number of entries filled in; 0 if the database does not
+ *	track popularity.
+ */
 ISC_LANG_ENDDECLS
@@ -255,9 +255,14 @@ dns_dispatch_resume(dns_dispentry_t *resp, uint16_t timeout);
 
 isc_result_t
 dns_dispatch_gettcp(dns_dispatchmgr_t *mgr, const isc_sockaddr_t *destaddr,
-		    const isc_sockaddr_t *localaddr, dns_dispatch_t **dispp);
+		    const isc_sockaddr_t *localaddr, dns_transport_t *transport,
+		    dns_dispatch_t **dispp);
 /*
- * Attempt to connect to a existing TCP connection.
+ * Attempt to connect to a existing TCP connection to 'destaddr' that was
+ * established using 'transport' (NULL for plain TCP) from 'localaddr'
+ * (or from any address if NULL).  A shared TCP connection is kept open
+ * for a few seconds after its last response has been received, so it
+ * can be reused for queries sent to the same server in quick succession.
  */
 
 typedef void (*dispatch_cb_t)(isc_result_t eresult, isc_region_t *region,
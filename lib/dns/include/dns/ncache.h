@@ -57,12 +57,14 @@ ISC_LANG_BEGINDECLS
 isc_result_t
 dns_ncache_add(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 	       dns_rdatatype_t covers, isc_stdtime_t now, dns_ttl_t minttl,
-	       dns_ttl_t maxttl, dns_rdataset_t *addedrdataset);
+	       dns_ttl_t maxttl, unsigned int options,
+	       dns_rdataset_t *addedrdataset);
 isc_result_t
 dns_ncache_addoptout(dns_message_t *message, dns_db_t *cache,
 		     dns_dbnode_t *node, dns_rdatatype_t covers,
 		     isc_stdtime_t now, dns_ttl_t minttl, dns_ttl_t maxttl,
-		     bool optout, dns_rdataset_t *addedrdataset);
+		     bool optout, unsigned int options,
+		     dns_rdataset_t *addedrdataset);
 /*%<
  * Convert the authority data from 'message' into a negative cache
  * rdataset, and store it in 'cache' at 'node' with a TTL limited to
@@ -78,6 +80,8 @@ dns_ncache_addoptout(dns_message_t *message, dns_db_t *cache,
  *
  * 'optout' indicates a DNS_RDATASETATTR_OPTOUT should be set.
  *
+ * 'options' is passed on to dns_db_addrdataset().
+ *
  * Note:
  *\li	If 'addedrdataset' is not NULL, then it will be attached to the added
  *	rdataset.  See dns_db_addrdataset() for more details.
@@ -87,7 +91,7 @@ dns_ncache_addoptout(dns_message_t *message, dns_db_t *cache,
  *	authority section.
  *
  *\li	The requirements of dns_db_addrdataset() apply to 'cache', 'node',
- *	'now', and 'addedrdataset'.
+ *	'now', 'options', and 'addedrdataset'.
  *
  * Returns:
  *\li	#ISC_R_SUCCESS
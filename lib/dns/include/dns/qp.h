@@ -100,6 +100,11 @@ typedef struct dns_qp dns_qp_t;
  */
 typedef struct dns_qpmulti dns_qpmulti_t;
 
+/*%
+ * A `dns_qpbuild_t` fills an empty `dns_qp_t` from keys in sorted order.
+ */
+typedef struct dns_qpbuild dns_qpbuild_t;
+
 /*%
  * Read-only parts of a qp-trie.
  *
@@ -280,6 +285,14 @@ typedef struct dns_qpchain {
  *
  * For logging and tracing, the `triename` method copies a human-
  * readable identifier into `buf` which has max length `size`.
+ *
+ * When `fingerprint` is true, the trie keeps a hash of each leaf's key
+ * in the leaf's integer value. Exact-match searches compare the hash
+ * before calling `makekey`, so they can reject most leaves that do not
+ * match without touching the value objects. This costs no memory, but
+ * the integer values belong to the trie: they must be zero when leaves
+ * are added, and the values passed to the methods and returned by
+ * lookups are the hashes.
  */
 typedef struct dns_qpmethods {
 	void (*attach)(void *uctx, void *pval, uint32_t ival);
@@ -287,6 +300,7 @@ typedef struct dns_qpmethods {
 	size_t (*makekey)(dns_qpkey_t key, void *uctx, void *pval,
 			  uint32_t ival);
 	void (*triename)(void *uctx, char *buf, size_t size);
+	bool fingerprint;
 } dns_qpmethods_t;
 
 /*%
@@ -526,6 +540,31 @@ dns_qp_getname(dns_qpreadable_t qpr, const dns_name_t *name, void **pval_r,
  * \li  ISC_R_SUCCESS if the leaf was found
  */
 
+void
+dns_qp_getnames(dns_qpreadable_t qpr, size_t count,
+		const dns_name_t *const names[], void *pvals[],
+		uint32_t ivals[], isc_result_t results[]);
+/*%<
+ * Find the leaves in a qp-trie that match each of an array of DNS names
+ *
+ * This gives the same results as calling `dns_qp_getname()` for each
+ * name, but the searches are interleaved so that the memory accesses
+ * of several searches overlap, which is faster when the trie is too
+ * big to fit in the CPU caches.
+ *
+ * The result for `names[i]` is stored in `results[i]`. When it is
+ * ISC_R_SUCCESS, the leaf values are assigned to whichever of
+ * `pvals[i]` and `ivals[i]` are in arrays that are not null;
+ * otherwise they are left unchanged.
+ *
+ * Requires:
+ * \li  `qpr` is a pointer to a readable qp-trie
+ * \li  `names` and `results` point to arrays of `count` elements,
+ *       and `pvals` and `ivals` are either NULL or point to arrays of
+ *       `count` elements
+ * \li  each of the `names` is a pointer to a valid `dns_name_t`
+ */
+
 isc_result_t
 dns_qp_lookup(dns_qpreadable_t qpr, const dns_name_t *name,
 	      dns_name_t *foundname, dns_qpiter_t *iter, dns_qpchain_t *chain,
@@ -579,12 +618,63 @@ dns_qp_insert(dns_qp_t *qp, void *pval, uint32_t ival);
  * \li  `qp` is a pointer to a valid qp-trie
  * \li  `pval != NULL`
  * \li  `alignof(pval) >= 4`
+ * \li  `ival == 0` if the trie's methods ask for fingerprints
  *
  * Returns:
  * \li  ISC_R_EXISTS if the trie already has a leaf with the same key
  * \li  ISC_R_SUCCESS if the leaf was added to the trie
  */
 
+void
+dns_qpbuild_create(dns_qp_t *qp, dns_qpbuild_t **qpbp);
+/*%<
+ * Start loading an empty qp-trie in bulk
+ *
+ * When leaves are added to a builder in key order, it lays out the
+ * trie in one pass, with every twig vector allocated once at its
+ * final size, so the trie does not need compacting afterwards. The
+ * trie must not be used in any other way until the builder is
+ * destroyed.
+ *
+ * Requires:
+ * \li  `qp` is a pointer to a valid qp-trie with no leaves
+ * \li  `qpbp != NULL && *qpbp == NULL`
+ */
+
+isc_result_t
+dns_qpbuild_add(dns_qpbuild_t *qpb, void *pval, uint32_t ival);
+/*%<
+ * Add a leaf to a qp-trie that is being loaded in bulk
+ *
+ * Leaves should be added in ascending key order. If a leaf is out of
+ * order, the builder completes the trie from the leaves it has so far
+ * and this leaf and all the following ones are added using
+ * dns_qp_insert(), so the result is correct but not as compact.
+ *
+ * Requires:
+ * \li  `qpb` is a pointer to a valid qp-trie builder
+ * \li  `pval != NULL`
+ * \li  `alignof(pval) >= 4`
+ * \li  `ival == 0` if the trie's methods ask for fingerprints
+ *
+ * Returns:
+ * \li  ISC_R_EXISTS if the trie already has a leaf with the same key
+ * \li  ISC_R_SUCCESS if the leaf was added to the trie
+ */
+
+void
+dns_qpbuild_destroy(dns_qpbuild_t **qpbp);
+/*%<
+ * Finish loading a qp-trie in bulk, and free the builder
+ *
+ * Requires:
+ * \li  `qpbp != NULL` and `*qpbp` is a pointer to a valid builder
+ *
+ * Ensures:
+ * \li  `*qpbp == NULL`
+ * \li  the trie contains all the leaves that were added
+ */
+
 isc_result_t
 dns_qp_deletekey(dns_qp_t *qp, const dns_qpkey_t key, size_t keylen,
 		 void **pval_r, uint32_t *ival_r);
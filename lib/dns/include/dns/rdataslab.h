@@ -83,16 +83,30 @@ struct dns_slabheader {
 	 */
 
 	isc_stdtime_t resign;
-	unsigned int  resign_lsb : 1;
+	isc_stdtime_t last_used;
+
+	atomic_uint_least32_t last_refresh_fail_ts;
+
+	atomic_uint_least32_t hits;
+	/*%<
+	 * Number of times this rdataset has been bound in a cache
+	 * lookup; used to find popular RRsets to refresh in the
+	 * background before they expire.
+	 */
 
-	atomic_uint_fast16_t count;
+	atomic_uint_least16_t count;
 	/*%<
 	 * Monotonically increased every time this rdataset is bound so that
 	 * it is used as the base of the starting point in DNS responses
 	 * when the "cyclic" rrset-order is required.
 	 */
 
-	atomic_uint_fast32_t last_refresh_fail_ts;
+	unsigned int resign_lsb : 1;
+	/*%<
+	 * The 32-bit and smaller members above are kept together ahead
+	 * of the pointers so that the header has no padding holes; there
+	 * is one of these for every RRset in every zone and cache.
+	 */
 
 	dns_slabheader_proof_t *noqname;
 	dns_slabheader_proof_t *closest;
@@ -122,7 +136,6 @@ struct dns_slabheader {
 	 * this rdataset, if any.
 	 */
 
-	isc_stdtime_t last_used;
 	ISC_LINK(struct dns_slabheader) link;
 
 	/*%
@@ -150,6 +163,8 @@ enum {
 	DNS_SLABHEADERATTR_CASEFULLYLOWER = 1 << 11,
 	DNS_SLABHEADERATTR_ANCIENT = 1 << 12,
 	DNS_SLABHEADERATTR_STALE_WINDOW = 1 << 13,
+	DNS_SLABHEADERATTR_REFRESHED = 1 << 14,
+	DNS_SLABHEADERATTR_QMIN = 1 << 15,
 };
 
 #define DNS_SLABHEADER_GETATTR(header, attribute) \
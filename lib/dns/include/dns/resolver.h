@@ -129,6 +129,12 @@ enum {
 						* on ip6.arpa. */
 	DNS_FETCHOPT_NOFORWARD = 1 << 15,      /*%< Do not use forwarders if
 						* possible. */
+	DNS_FETCHOPT_REFRESH = 1 << 16,	       /*%< Background refresh of a
+						* popular cache entry. */
+	DNS_FETCHOPT_QMINFETCH = 1 << 17,      /*%< Relaxed QNAME minimization
+						* fetch; an NXDOMAIN it gets
+						* may be for an empty
+						* non-terminal. */
 
 	/*% EDNS version bits: */
 	DNS_FETCHOPT_EDNSVERSIONSET = 1 << 23,
@@ -298,6 +304,12 @@ dns_resolver_createfetch(dns_resolver_t *res, const dns_name_t *name,
  *	must remain stable until after 'action' has been called or
  *	dns_resolver_cancelfetch() is called.
  *
+ *\li	Unless DNS_FETCHOPT_UNSHARED is set, the fetch joins any running
+ *	fetch for the same 'name' and 'type' whose options differ at most
+ *	in DNS_FETCHOPT_PREFETCH and DNS_FETCHOPT_REFRESH, except that a
+ *	fetch without DNS_FETCHOPT_PREFETCH never joins one with it, so
+ *	that it is always counted against the fetch quotas.
+ *
  * Requires:
  *
  *\li	'res' is a valid resolver that has been frozen.
@@ -627,6 +639,22 @@ dns_resolver_getquotaresponse(dns_resolver_t *resolver, dns_quotatype_t which);
  * \li	'resp' to be DNS_R_DROP or DNS_R_SERVFAIL.
  */
 
+void
+dns_resolver_setrefresh(dns_resolver_t *resolver, uint32_t count,
+			uint32_t rate);
+/*%
+ * Configure background refresh of popular cache entries.  Once a second,
+ * up to 'count' of the most frequently looked up prefetch-eligible RRsets
+ * that are about to expire from the view's cache are fetched again, so
+ * that they do not expire during quiet periods.  No more than 'rate'
+ * refresh fetches are allowed to be outstanding at any one time.  A
+ * 'count' of zero disables background refresh.
+ *
+ * Requires:
+ * \li	'resolver' to be valid and not frozen.
+ * \li	The caller to be running on a loop thread.
+ */
+
 void
 dns_resolver_dumpfetches(dns_resolver_t *resolver, isc_statsformat_t format,
 			 FILE *fp);
@@ -164,12 +164,17 @@ struct dns_rpz_zone {
 					 * on */
 	bool	     addsoa;		/* add soa to the additional section */
 	isc_timer_t *updatetimer;
+	char	    *journal;		/* zone's journal file */
+	bool	     insync;		/* 'nodes' match 'db' at 'serial' */
+	uint32_t     serial;		/* SOA serial of the summarized
+					 * version */
 };
 
 /*
  * Radix tree node for response policy IP addresses
  */
 typedef struct dns_rpz_cidr_node dns_rpz_cidr_node_t;
+typedef struct dns_rpz_cidr_snap dns_rpz_cidr_snap_t;
 
 /*
  * Bitfields indicating which policy zones have policies of
@@ -259,14 +264,26 @@ struct dns_rpz_zones {
 	 * consistency of the pointers.
 	 * A second lock for maintenance that guarantees no other thread
 	 * is adding or deleting nodes.
+	 *
+	 * The radix tree in 'cidr' is only read under the write lock;
+	 * IP address lookups use 'cidrsnap', a copy that is published
+	 * with RCU when an update of a policy zone succeeds.  The copy
+	 * shares the nodes that did not change with the previous one;
+	 * 'cidr_retired' holds the published nodes that were replaced
+	 * or deleted since then.
 	 */
 	isc_rwlock_t search_lock;
 	isc_mutex_t  maint_lock;
 
 	bool shuttingdown;
-
-	dns_rpz_cidr_node_t *cidr;
-	dns_qpmulti_t	    *table;
+	bool cidr_changed;
+
+	dns_rpz_cidr_node_t  *cidr;
+	dns_rpz_cidr_snap_t  *cidrsnap;
+	dns_rpz_cidr_node_t **cidr_retired;
+	size_t		      cidr_nretired;
+	size_t		      cidr_retiredsize;
+	dns_qpmulti_t	     *table;
 };
 
 /*
@@ -392,6 +409,16 @@ dns_rpz_dbupdate_unregister(dns_db_t *db, dns_rpz_zone_t *rpz);
 void
 dns_rpz_dbupdate_register(dns_db_t *db, dns_rpz_zone_t *rpz);
 
+void
+dns_rpz_setjournal(dns_rpz_zone_t *rpz, const char *journal);
+/*%<
+ * Tell the policy zone where the journal of its zone is kept.  When the
+ * zone database is updated in place, the changes between the previous
+ * and the new version are read from the journal and only the owner
+ * names that appear in it are re-examined.  Without a journal, or when
+ * it does not cover the change, the whole database is walked.
+ */
+
 void
 dns_rpz_zones_shutdown(dns_rpz_zones_t *rpzs);
 
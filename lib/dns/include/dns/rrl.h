@@ -20,7 +20,9 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include <isc/atomic.h>
 #include <isc/lang.h>
+#include <isc/mutex.h>
 
 #include <dns/fixedname.h>
 #include <dns/rdata.h>
@@ -187,17 +189,56 @@ struct dns_rrl_qname_buf {
 
 typedef struct dns_rrl_rate dns_rrl_rate_t;
 struct dns_rrl_rate {
-	int	    r;
-	int	    scaled;
-	const char *str;
+	int		    r;
+	atomic_int_fast32_t scaled;
+	const char	   *str;
 };
 
+/*
+ * One shard of the rate-limit database.  Responses are assigned to a
+ * table by their client address block, so all of the buckets of one
+ * client, including its all-per-second and TCP buckets, are in the same
+ * table and are protected by the same lock.
+ */
+typedef struct dns_rrl_table dns_rrl_table_t;
+struct dns_rrl_table {
+	isc_mutex_t lock;
+
+	int num_entries;
+
+	unsigned int probes;
+	unsigned int searches;
+
+	ISC_LIST(dns_rrl_block_t) blocks;
+	ISC_LIST(dns_rrl_entry_t) lru;
+
+	dns_rrl_hash_t *hash;
+	dns_rrl_hash_t *old_hash;
+	unsigned int	hash_gen;
+
+	unsigned int ts_gen;
+#define DNS_RRL_TS_BASES (1 << DNS_RRL_TS_GEN_BITS)
+	isc_stdtime_t ts_bases[DNS_RRL_TS_BASES];
+
+	isc_stdtime_t	 log_stops_time;
+	dns_rrl_entry_t *last_logged;
+	int		 num_logged;
+	int		 num_qnames;
+	ISC_LIST(dns_rrl_qname_buf_t) qname_free;
+#define DNS_RRL_QNAMES (1 << DNS_RRL_QNAMES_BITS)
+	dns_rrl_qname_buf_t *qnames[DNS_RRL_QNAMES];
+};
+
+#ifndef DNS_RRL_TABLES
+#define DNS_RRL_TABLES 16
+#endif /* ifndef DNS_RRL_TABLES */
+
 /*
  * Per-view query rate limit parameters and a pointer to database.
  */
 typedef struct dns_rrl dns_rrl_t;
 struct dns_rrl {
-	isc_mutex_t lock;
+	isc_mutex_t lock; /*%< protects the qps estimate */
 	isc_mem_t  *mctx;
 
 	bool	       log_only;
@@ -214,38 +255,22 @@ struct dns_rrl {
 
 	dns_acl_t *exempt;
 
-	int num_entries;
+	/*
+	 * Entries in all of the tables.  Checked against max_entries
+	 * without a common lock, so the limit is approximate.
+	 */
+	atomic_int_fast32_t num_entries;
 
 	int	      qps_responses;
 	isc_stdtime_t qps_time;
 	double	      qps;
 
-	unsigned int probes;
-	unsigned int searches;
-
-	ISC_LIST(dns_rrl_block_t) blocks;
-	ISC_LIST(dns_rrl_entry_t) lru;
-
-	dns_rrl_hash_t *hash;
-	dns_rrl_hash_t *old_hash;
-	unsigned int	hash_gen;
-
-	unsigned int ts_gen;
-#define DNS_RRL_TS_BASES (1 << DNS_RRL_TS_GEN_BITS)
-	isc_stdtime_t ts_bases[DNS_RRL_TS_BASES];
-
 	int	 ipv4_prefixlen;
 	uint32_t ipv4_mask;
 	int	 ipv6_prefixlen;
 	uint32_t ipv6_mask[4];
 
-	isc_stdtime_t	 log_stops_time;
-	dns_rrl_entry_t *last_logged;
-	int		 num_logged;
-	int		 num_qnames;
-	ISC_LIST(dns_rrl_qname_buf_t) qname_free;
-#define DNS_RRL_QNAMES (1 << DNS_RRL_QNAMES_BITS)
-	dns_rrl_qname_buf_t *qnames[DNS_RRL_QNAMES];
+	dns_rrl_table_t tables[DNS_RRL_TABLES];
 };
 
 typedef enum {
@@ -75,7 +75,9 @@ enum {
 	dns_resstatscounter_nextitem = 44,
 	dns_resstatscounter_priming = 45,
 	dns_resstatscounter_forwardonlyfail = 46,
-	dns_resstatscounter_max = 47,
+	dns_resstatscounter_refresh = 47,
+	dns_resstatscounter_refreshfail = 48,
+	dns_resstatscounter_max = 49,
 
 	/*
 	 * DNSSEC stats.
@@ -126,8 +128,9 @@ enum {
 	dns_cachestatscounter_deletelru = 5,
 	dns_cachestatscounter_deletettl = 6,
 	dns_cachestatscounter_coveringnsec = 7,
+	dns_cachestatscounter_refreshhits = 8,
 
-	dns_cachestatscounter_max = 8,
+	dns_cachestatscounter_max = 9,
 
 	/*%
 	 * Query statistics counters (obsolete).
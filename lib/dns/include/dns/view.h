@@ -123,6 +123,7 @@ struct dns_view {
 	bool		      acceptexpired;
 	bool		      requireservercookie;
 	bool		      synthfromdnssec;
+	bool		      nxdomaincut;
 	bool		      trust_anchor_telemetry;
 	bool		      root_key_sentinel;
 	dns_transfer_format_t transfer_format;
@@ -493,6 +494,20 @@ dns_view_addzone(dns_view_t *view, dns_zone_t *zone);
  *\li	'zone' is a valid zone.
  */
 
+void
+dns_view_beginzonebatch(dns_view_t *view);
+void
+dns_view_endzonebatch(dns_view_t *view);
+/*%<
+ * Collect the zones added to 'view' by the calling thread until
+ * dns_view_endzonebatch() is called, and commit them to the zone table
+ * all at once.  See dns_zt_beginbatch().
+ *
+ * Requires:
+ *
+ *\li	'view' is a valid view; unfrozen for dns_view_beginzonebatch().
+ */
+
 isc_result_t
 dns_view_delzone(dns_view_t *view, dns_zone_t *zone);
 /*%<
@@ -1890,6 +1890,18 @@ dns_zonemgr_setserialqueryrate(dns_zonemgr_t *zmgr, unsigned int value);
  *\li	'zmgr' to be a valid zone manager
  */
 
+void
+dns_zonemgr_setserialquerybatch(dns_zonemgr_t *zmgr, unsigned int value);
+/*%<
+ *	Set the maximum number of SOA queries to the same primary that
+ *	are sent together, over one TCP connection, while taking a single
+ *	slot of the rate set by dns_zonemgr_setserialqueryrate().  A value
+ *	of 0 or 1 sends each SOA query on its own.
+ *
+ * Requires:
+ *\li	'zmgr' to be a valid zone manager
+ */
+
 unsigned int
 dns_zonemgr_getnotifyrate(dns_zonemgr_t *zmgr);
 /*%<
@@ -1917,6 +1929,16 @@ dns_zonemgr_getserialqueryrate(dns_zonemgr_t *zmgr);
  *\li	'zmgr' to be a valid zone manager.
  */
 
+unsigned int
+dns_zonemgr_getserialquerybatch(dns_zonemgr_t *zmgr);
+/*%<
+ *	Return the maximum number of SOA queries sent together to the
+ *	same primary.
+ *
+ * Requires:
+ *\li	'zmgr' to be a valid zone manager.
+ */
+
 unsigned int
 dns_zonemgr_getcount(dns_zonemgr_t *zmgr, dns_zonestate_t state);
 /*%<
@@ -2327,6 +2349,26 @@ dns_zone_getadded(dns_zone_t *zone);
  * \li	'zone' to be valid.
  */
 
+void
+dns_zone_setcfghash(dns_zone_t *zone, uint64_t cfghash);
+/*%
+ * Record a digest of the configuration the zone has been configured
+ * from, so that a later reconfiguration can tell whether anything has
+ * changed.  Zero means the configuration is not known.
+ *
+ * Requires:
+ * \li	'zone' to be valid.
+ */
+
+uint64_t
+dns_zone_getcfghash(dns_zone_t *zone);
+/*%
+ * Returns the digest set with dns_zone_setcfghash(), or zero.
+ *
+ * Requires:
+ * \li	'zone' to be valid.
+ */
+
 void
 dns_zone_setautomatic(dns_zone_t *zone, bool automatic);
 /*%
@@ -68,6 +68,31 @@ dns_zt_mount(dns_zt_t *zt, dns_zone_t *zone);
  * \li	#ISC_R_EXISTS
  */
 
+void
+dns_zt_beginbatch(dns_zt_t *zt);
+void
+dns_zt_endbatch(dns_zt_t *zt);
+/*%<
+ * Open and commit a batch of changes to the zone table.
+ *
+ * Between dns_zt_beginbatch() and dns_zt_endbatch(), dns_zt_mount()
+ * and dns_zt_unmount() called from the same thread share a single
+ * write transaction instead of committing a new version of the table
+ * for every zone, which is what makes configuring a very large number
+ * of zones slow.  The changes are visible to dns_zt_find() called
+ * from the batching thread straight away, but other threads and
+ * dns_zt_apply() only see them after dns_zt_endbatch().
+ *
+ * The table's write lock is held for the duration of the batch, so
+ * it must be short-lived and must not wait for other threads.  If the
+ * calling thread is not a loop thread, the batch is not opened and
+ * every change is committed on its own.
+ *
+ * Requires:
+ * \li	'zt' to be valid
+ * \li	dns_zt_beginbatch(): no batch is open on this thread
+ */
+
 isc_result_t
 dns_zt_unmount(dns_zt_t *zt, dns_zone_t *zone);
 /*%<
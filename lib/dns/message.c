@@ -1740,6 +1740,67 @@ cleanup:
 	return (result);
 }
 
+/*
+ * Parse the additional section of a small query holding nothing but an
+ * EDNS OPT record.  The OPT record has the root name, which is not
+ * stored anywhere, and it is not subject to any duplicate checks, so
+ * the name and section bookkeeping of getsection() can be skipped.
+ *
+ * Return DNS_R_CONTINUE with 'source' unchanged if the record is not
+ * a plain OPT record; getsection() then deals with it.
+ */
+static isc_result_t
+getsmallopt(isc_buffer_t *source, dns_message_t *msg, dns_decompress_t dctx) {
+	isc_region_t r;
+	dns_rdataclass_t rdclass;
+	dns_rdatalist_t *rdatalist = NULL;
+	dns_rdataset_t *rdataset = NULL;
+	dns_rdata_t *rdata = NULL;
+	unsigned int rdatalen;
+	dns_ttl_t ttl;
+	isc_result_t result;
+
+	/* root name, type, class, ttl and rdata length */
+	isc_buffer_remainingregion(source, &r);
+	if (msg->opt != NULL || r.length < 1 + 2 + 2 + 4 + 2 ||
+	    r.base[0] != 0 || ISC_U8TO16_BE(r.base + 1) != dns_rdatatype_opt)
+	{
+		return (DNS_R_CONTINUE);
+	}
+	rdatalen = ISC_U8TO16_BE(r.base + 9);
+	if (r.length - 11 < rdatalen) {
+		return (ISC_R_UNEXPECTEDEND);
+	}
+
+	isc_buffer_forward(source, 3);
+	rdclass = isc_buffer_getuint16(source);
+	ttl = isc_buffer_getuint32(source);
+	isc_buffer_forward(source, 2);
+
+	rdata = newrdata(msg);
+	result = getrdata(source, msg, dctx, rdclass, dns_rdatatype_opt,
+			  rdatalen, rdata);
+	if (result != ISC_R_SUCCESS) {
+		return (result);
+	}
+	rdata->rdclass = rdclass;
+
+	rdatalist = newrdatalist(msg);
+	rdatalist->type = dns_rdatatype_opt;
+	rdatalist->covers = 0;
+	rdatalist->rdclass = rdclass;
+	rdatalist->ttl = ttl;
+	ISC_LIST_APPEND(rdatalist->rdata, rdata, link);
+
+	dns_message_gettemprdataset(msg, &rdataset);
+	dns_rdatalist_tordataset(rdatalist, rdataset);
+
+	msg->opt = rdataset;
+	msg->rcode |= (dns_rcode_t)((ttl & DNS_MESSAGE_EDNSRCODE_MASK) >> 20);
+
+	return (ISC_R_SUCCESS);
+}
+
 isc_result_t
 dns_message_parse(dns_message_t *msg, isc_buffer_t *source,
 		  unsigned int options) {
@@ -1808,6 +1869,30 @@ dns_message_parse(dns_message_t *msg, isc_buffer_t *source,
 	}
 	msg->question_ok = 1;
 
+	/*
+	 * Most queries carry nothing but an OPT record after the
+	 * question; take a shortcut for those.
+	 */
+	if (msg->counts[DNS_SECTION_ANSWER] == 0 &&
+	    msg->counts[DNS_SECTION_AUTHORITY] == 0 &&
+	    msg->counts[DNS_SECTION_ADDITIONAL] == 1 &&
+	    msg->opcode == dns_opcode_query &&
+	    (msg->flags & DNS_MESSAGEFLAG_QR) == 0 &&
+	    (options & (DNS_MESSAGEPARSE_PRESERVEORDER |
+			DNS_MESSAGEPARSE_BESTEFFORT)) == 0)
+	{
+		ret = getsmallopt(source, msg, dctx);
+		if (ret == ISC_R_UNEXPECTEDEND && ignore_tc) {
+			goto truncated;
+		}
+		if (ret == ISC_R_SUCCESS) {
+			goto done;
+		}
+		if (ret != DNS_R_CONTINUE) {
+			return (ret);
+		}
+	}
+
 	ret = getsection(source, msg, dctx, DNS_SECTION_ANSWER, options);
 	if (ret == ISC_R_UNEXPECTEDEND && ignore_tc) {
 		goto truncated;
@@ -1844,6 +1929,7 @@ dns_message_parse(dns_message_t *msg, isc_buffer_t *source,
 		return (ret);
 	}
 
+done:
 	isc_buffer_remainingregion(source, &r);
 	if (r.length != 0) {
 		isc_log_write(ISC_LOGCATEGORY_GENERAL, DNS_LOGMODULE_MESSAGE,
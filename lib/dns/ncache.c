@@ -53,7 +53,7 @@ atomic_getuint8(isc_buffer_t *b) {
 static isc_result_t
 addoptout(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 	  dns_rdatatype_t covers, isc_stdtime_t now, dns_ttl_t minttl,
-	  dns_ttl_t maxttl, bool optout, bool secure,
+	  dns_ttl_t maxttl, bool optout, bool secure, unsigned int options,
 	  dns_rdataset_t *addedrdataset);
 
 static isc_result_t
@@ -107,24 +107,26 @@ copy_rdataset(dns_rdataset_t *rdataset, isc_buffer_t *buffer) {
 isc_result_t
 dns_ncache_add(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 	       dns_rdatatype_t covers, isc_stdtime_t now, dns_ttl_t minttl,
-	       dns_ttl_t maxttl, dns_rdataset_t *addedrdataset) {
+	       dns_ttl_t maxttl, unsigned int options,
+	       dns_rdataset_t *addedrdataset) {
 	return (addoptout(message, cache, node, covers, now, minttl, maxttl,
-			  false, false, addedrdataset));
+			  false, false, options, addedrdataset));
 }
 
 isc_result_t
 dns_ncache_addoptout(dns_message_t *message, dns_db_t *cache,
 		     dns_dbnode_t *node, dns_rdatatype_t covers,
 		     isc_stdtime_t now, dns_ttl_t minttl, dns_ttl_t maxttl,
-		     bool optout, dns_rdataset_t *addedrdataset) {
+		     bool optout, unsigned int options,
+		     dns_rdataset_t *addedrdataset) {
 	return (addoptout(message, cache, node, covers, now, minttl, maxttl,
-			  optout, true, addedrdataset));
+			  optout, true, options, addedrdataset));
 }
 
 static isc_result_t
 addoptout(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 	  dns_rdatatype_t covers, isc_stdtime_t now, dns_ttl_t minttl,
-	  dns_ttl_t maxttl, bool optout, bool secure,
+	  dns_ttl_t maxttl, bool optout, bool secure, unsigned int options,
 	  dns_rdataset_t *addedrdataset) {
 	isc_result_t result;
 	isc_buffer_t buffer;
@@ -288,8 +290,8 @@ addoptout(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 		ncrdataset.attributes |= DNS_RDATASETATTR_OPTOUT;
 	}
 
-	return (dns_db_addrdataset(cache, node, NULL, now, &ncrdataset, 0,
-				   addedrdataset));
+	return (dns_db_addrdataset(cache, node, NULL, now, &ncrdataset,
+				   options, addedrdataset));
 }
 
 isc_result_t
@@ -359,6 +359,61 @@ qpkey_compare(const dns_qpkey_t key_a, const size_t keylen_a,
 	return (QPKEY_EQUAL);
 }
 
+/*
+ * A hash of a key, which is stored in a leaf's integer value when the
+ * trie's methods ask for fingerprints. An exact-match search can then
+ * reject most leaves that do not match without calling the `makekey`
+ * method, which usually has to fetch the leaf's value object from
+ * memory. Trailing SHIFT_NOBYTE elements are ignored to agree with
+ * qpkey_compare().
+ *
+ * This is FNV-1a, which is fast for short keys. It does not need to
+ * be hard to collide: a collision only means that the search falls
+ * back to comparing the keys.
+ */
+static uint32_t
+qpkey_fingerprint(const dns_qpkey_t key, size_t keylen) {
+	uint32_t hash = 2166136261U;
+
+	while (keylen > 0 && key[keylen - 1] == SHIFT_NOBYTE) {
+		keylen--;
+	}
+	for (size_t offset = 0; offset < keylen; offset++) {
+		hash = (hash ^ key[offset]) * 16777619U;
+	}
+	return (hash);
+}
+
+/*
+ * Can leaf `n` have the same key as `search_key`? This is a cheap
+ * check when the trie has fingerprints, and it is always true when it
+ * does not.
+ */
+static inline bool
+leaf_maybe_equal(dns_qpreadable_t qpr, dns_qpnode_t *n,
+		 const dns_qpkey_t search_key, size_t search_keylen) {
+	dns_qpreader_t *qp = dns_qpreader(qpr);
+	return (!qp->methods->fingerprint ||
+		leaf_ival(n) == qpkey_fingerprint(search_key, search_keylen));
+}
+
+/*
+ * Make a new leaf, and get its key.
+ */
+static dns_qpnode_t
+make_leaf_key(dns_qp_t *qp, void *pval, uint32_t ival, dns_qpkey_t key,
+	      size_t *keylenp) {
+	dns_qpnode_t leaf = make_leaf(pval, ival);
+	size_t keylen = leaf_qpkey(qp, &leaf, key);
+
+	if (qp->methods->fingerprint) {
+		REQUIRE(ival == 0);
+		leaf = make_leaf(pval, qpkey_fingerprint(key, keylen));
+	}
+	*keylenp = keylen;
+	return (leaf);
+}
+
 /***********************************************************************
  *
  *  allocator wrappers
@@ -1572,8 +1627,7 @@ dns_qp_insert(dns_qp_t *qp, void *pval, uint32_t ival) {
 
 	REQUIRE(QP_VALID(qp));
 
-	new_leaf = make_leaf(pval, ival);
-	new_keylen = leaf_qpkey(qp, &new_leaf, new_key);
+	new_leaf = make_leaf_key(qp, pval, ival, new_key, &new_keylen);
 
 	/* first leaf in an empty trie? */
 	if (qp->leaf_count == 0) {
@@ -1683,6 +1737,244 @@ growbranch:
 	return (ISC_R_SUCCESS);
 }
 
+/***********************************************************************
+ *
+ *  bulk loading
+ */
+
+/*
+ * When the keys arrive in order, the shape of the trie is fixed by the
+ * offsets at which each key differs from the previous one. The builder
+ * keeps the rightmost path of the trie under construction as a stack
+ * of open branches, each with the twigs that are complete so far.
+ * A branch is closed when a key differs from the previous one at a
+ * smaller offset, which means that no more keys can go under it; its
+ * twigs are then copied into a vector of exactly the right size. All
+ * the twigs are allocated in order from the bump chunk, and none is
+ * ever reallocated, so the trie has no garbage when the build is done.
+ */
+
+typedef struct qpbuild_twig {
+	dns_qpnode_t node;
+	dns_qpshift_t bit;
+} qpbuild_twig_t;
+
+typedef struct qpbuild_branch {
+	size_t offset;
+	size_t first; /* index of the branch's first twig in `twigs` */
+} qpbuild_branch_t;
+
+struct dns_qpbuild {
+	uint32_t magic;
+	dns_qp_t *qp;
+	/*% set once the keys have stopped arriving in order */
+	bool unsorted;
+	/*% the most recently added leaf, not yet in any branch */
+	dns_qpnode_t leaf;
+	dns_qpkey_t key;
+	size_t keylen;
+	/*% open branches on the rightmost path, root first */
+	qpbuild_branch_t *branches;
+	size_t branches_count, branches_size;
+	/*% complete twigs of the open branches */
+	qpbuild_twig_t *twigs;
+	size_t twigs_count, twigs_size;
+};
+
+void
+dns_qpbuild_create(dns_qp_t *qp, dns_qpbuild_t **qpbp) {
+	dns_qpbuild_t *qpb = NULL;
+
+	REQUIRE(QP_VALID(qp));
+	REQUIRE(qp->leaf_count == 0);
+	REQUIRE(qpbp != NULL && *qpbp == NULL);
+
+	qpb = isc_mem_get(qp->mctx, sizeof(*qpb));
+	*qpb = (dns_qpbuild_t){
+		.magic = QPBUILD_MAGIC,
+		.qp = qp,
+	};
+
+	*qpbp = qpb;
+}
+
+/*
+ * Add the pending twig to the open branch at the top of the stack.
+ */
+static void
+qpbuild_push_twig(dns_qpbuild_t *qpb, dns_qpnode_t node, dns_qpshift_t bit) {
+	if (qpb->twigs_count == qpb->twigs_size) {
+		size_t size = ISC_MAX(64, qpb->twigs_size * 2);
+		qpb->twigs = isc_mem_creget(qpb->qp->mctx, qpb->twigs,
+					    qpb->twigs_size, size,
+					    sizeof(qpb->twigs[0]));
+		qpb->twigs_size = size;
+	}
+	qpb->twigs[qpb->twigs_count++] = (qpbuild_twig_t){
+		.node = node,
+		.bit = bit,
+	};
+}
+
+static void
+qpbuild_push_branch(dns_qpbuild_t *qpb, size_t offset) {
+	if (qpb->branches_count == qpb->branches_size) {
+		size_t size = ISC_MAX(16, qpb->branches_size * 2);
+		qpb->branches = isc_mem_creget(qpb->qp->mctx, qpb->branches,
+					       qpb->branches_size, size,
+					       sizeof(qpb->branches[0]));
+		qpb->branches_size = size;
+	}
+	qpb->branches[qpb->branches_count++] = (qpbuild_branch_t){
+		.offset = offset,
+		.first = qpb->twigs_count,
+	};
+}
+
+/*
+ * Close the open branch at the top of the stack, whose last twig is
+ * `node`, and return the new branch node.
+ */
+static dns_qpnode_t
+qpbuild_pop_branch(dns_qpbuild_t *qpb, dns_qpnode_t node) {
+	dns_qp_t *qp = qpb->qp;
+	qpbuild_branch_t *branch = &qpb->branches[--qpb->branches_count];
+	uint64_t index = BRANCH_TAG |
+			 ((uint64_t)branch->offset << SHIFT_OFFSET);
+	dns_qpweight_t size;
+	dns_qpnode_t *twigs = NULL;
+	dns_qpref_t ref;
+
+	qpbuild_push_twig(qpb, node,
+			  qpkey_bit(qpb->key, qpb->keylen, branch->offset));
+	size = qpb->twigs_count - branch->first;
+	INSIST(size >= 2);
+
+	ref = alloc_twigs(qp, size);
+	twigs = ref_ptr(qp, ref);
+	for (dns_qpweight_t pos = 0; pos < size; pos++) {
+		qpbuild_twig_t *twig = &qpb->twigs[branch->first + pos];
+		twigs[pos] = twig->node;
+		index |= 1ULL << twig->bit;
+	}
+	qpb->twigs_count = branch->first;
+
+	return (make_node(index, ref));
+}
+
+/*
+ * Close every open branch and make the result the root of the trie.
+ */
+static void
+qpbuild_finish(dns_qpbuild_t *qpb) {
+	dns_qp_t *qp = qpb->qp;
+	dns_qpnode_t node = qpb->leaf;
+	dns_qpref_t ref;
+
+	if (qp->leaf_count == 0) {
+		return;
+	}
+
+	while (qpb->branches_count > 0) {
+		node = qpbuild_pop_branch(qpb, node);
+	}
+	INSIST(qpb->twigs_count == 0);
+
+	ref = alloc_twigs(qp, 1);
+	*ref_ptr(qp, ref) = node;
+	qp->root_ref = ref;
+}
+
+isc_result_t
+dns_qpbuild_add(dns_qpbuild_t *qpb, void *pval, uint32_t ival) {
+	dns_qp_t *qp = NULL;
+	dns_qpnode_t new_leaf;
+	dns_qpkey_t new_key;
+	size_t new_keylen, offset;
+
+	REQUIRE(QPBUILD_VALID(qpb));
+
+	qp = qpb->qp;
+	if (qpb->unsorted) {
+		return (dns_qp_insert(qp, pval, ival));
+	}
+
+	new_leaf = make_leaf_key(qp, pval, ival, new_key, &new_keylen);
+
+	if (qp->leaf_count == 0) {
+		goto add;
+	}
+
+	offset = qpkey_compare(new_key, new_keylen, qpb->key, qpb->keylen);
+	if (offset == QPKEY_EQUAL) {
+		return (ISC_R_EXISTS);
+	}
+	if (qpkey_bit(new_key, new_keylen, offset) <
+	    qpkey_bit(qpb->key, qpb->keylen, offset))
+	{
+		/*
+		 * Out of order: complete the trie from what we have so
+		 * far, and insert the rest of the keys one by one.
+		 */
+		qpbuild_finish(qpb);
+		qpb->unsorted = true;
+		return (dns_qp_insert(qp, pval, ival));
+	}
+
+	/*
+	 * Branches below the point where the keys differ are complete.
+	 */
+	while (qpb->branches_count > 0 &&
+	       qpb->branches[qpb->branches_count - 1].offset > offset)
+	{
+		qpb->leaf = qpbuild_pop_branch(qpb, qpb->leaf);
+	}
+
+	if (qpb->branches_count == 0 ||
+	    qpb->branches[qpb->branches_count - 1].offset < offset)
+	{
+		qpbuild_push_branch(qpb, offset);
+	}
+	qpbuild_push_twig(qpb, qpb->leaf,
+			  qpkey_bit(qpb->key, qpb->keylen, offset));
+
+add:
+	attach_leaf(qp, &new_leaf);
+	qp->leaf_count++;
+	qpb->leaf = new_leaf;
+	memmove(qpb->key, new_key, new_keylen);
+	qpb->keylen = new_keylen;
+
+	return (ISC_R_SUCCESS);
+}
+
+void
+dns_qpbuild_destroy(dns_qpbuild_t **qpbp) {
+	dns_qpbuild_t *qpb = NULL;
+	isc_mem_t *mctx = NULL;
+
+	REQUIRE(qpbp != NULL && QPBUILD_VALID(*qpbp));
+
+	qpb = *qpbp;
+	*qpbp = NULL;
+
+	if (!qpb->unsorted) {
+		qpbuild_finish(qpb);
+	}
+
+	mctx = qpb->qp->mctx;
+	if (qpb->twigs != NULL) {
+		isc_mem_cput(mctx, qpb->twigs, qpb->twigs_size,
+			     sizeof(qpb->twigs[0]));
+	}
+	if (qpb->branches != NULL) {
+		isc_mem_cput(mctx, qpb->branches, qpb->branches_size,
+			     sizeof(qpb->branches[0]));
+	}
+	qpb->magic = 0;
+	isc_mem_put(mctx, qpb, sizeof(*qpb));
+}
+
 isc_result_t
 dns_qp_deletekey(dns_qp_t *qp, const dns_qpkey_t search_key,
 		 size_t search_keylen, void **pval_r, uint32_t *ival_r) {
@@ -1707,6 +1999,10 @@ dns_qp_deletekey(dns_qp_t *qp, const dns_qpkey_t search_key,
 		n = branch_twig_ptr(qp, n, bit);
 	}
 
+	if (!leaf_maybe_equal(qp, n, search_key, search_keylen)) {
+		return (ISC_R_NOTFOUND);
+	}
+
 	dns_qpkey_t found_key;
 	size_t found_keylen = leaf_qpkey(qp, n, found_key);
 	if (qpkey_compare(search_key, search_keylen, found_key, found_keylen) !=
@@ -1996,6 +2292,10 @@ dns_qp_getkey(dns_qpreadable_t qpr, const dns_qpkey_t search_key,
 		n = branch_twig_ptr(qp, n, bit);
 	}
 
+	if (!leaf_maybe_equal(qp, n, search_key, search_keylen)) {
+		return (ISC_R_NOTFOUND);
+	}
+
 	found_keylen = leaf_qpkey(qp, n, found_key);
 	if (qpkey_compare(search_key, search_keylen, found_key, found_keylen) !=
 	    QPKEY_EQUAL)
@@ -2016,6 +2316,112 @@ dns_qp_getname(dns_qpreadable_t qpr, const dns_name_t *name, void **pval_r,
 	return (dns_qp_getkey(qpr, key, keylen, pval_r, ival_r));
 }
 
+/*
+ * Looking up a batch of names, one step of each search at a time, so
+ * that the twigs for the next step of one search are being fetched
+ * from memory while the other searches are stepping through the trie.
+ */
+#define GETNAMES_BATCH 8
+
+typedef struct getnames {
+	dns_qpkey_t key;
+	size_t keylen;
+	dns_qpnode_t *n;
+} getnames_t;
+
+static isc_result_t
+getnames_step(dns_qpreader_t *qp, getnames_t *search) {
+	dns_qpnode_t *n = search->n;
+	dns_qpkey_t found_key;
+	size_t found_keylen;
+	dns_qpshift_t bit;
+
+	if (is_branch(n)) {
+		bit = branch_keybit(n, search->key, search->keylen);
+		if (!branch_has_twig(n, bit)) {
+			return (ISC_R_NOTFOUND);
+		}
+		n = branch_twig_ptr(qp, n, bit);
+		if (is_branch(n)) {
+			prefetch_twigs(qp, n);
+		} else {
+			/* the leaf's key is made from its value */
+			__builtin_prefetch(leaf_pval(n));
+		}
+		search->n = n;
+		return (DNS_R_CONTINUE);
+	}
+
+	if (!leaf_maybe_equal(qp, n, search->key, search->keylen)) {
+		return (ISC_R_NOTFOUND);
+	}
+
+	found_keylen = leaf_qpkey(qp, n, found_key);
+	if (qpkey_compare(search->key, search->keylen, found_key,
+			  found_keylen) != QPKEY_EQUAL)
+	{
+		return (ISC_R_NOTFOUND);
+	}
+	return (ISC_R_SUCCESS);
+}
+
+void
+dns_qp_getnames(dns_qpreadable_t qpr, size_t count,
+		const dns_name_t *const names[], void *pvals[],
+		uint32_t ivals[], isc_result_t results[]) {
+	dns_qpreader_t *qp = dns_qpreader(qpr);
+	getnames_t search[GETNAMES_BATCH];
+	dns_qpnode_t *root = NULL;
+
+	REQUIRE(QP_VALID(qp));
+	REQUIRE(count == 0 || (names != NULL && results != NULL));
+
+	root = get_root(qp);
+	if (root != NULL && is_branch(root)) {
+		prefetch_twigs(qp, root);
+	}
+
+	for (size_t base = 0; base < count; base += GETNAMES_BATCH) {
+		size_t batch = ISC_MIN(count - base, GETNAMES_BATCH);
+		size_t pending = 0;
+
+		for (size_t i = 0; i < batch; i++) {
+			search[i].keylen = dns_qpkey_fromname(search[i].key,
+							      names[base + i]);
+			search[i].n = root;
+			if (root == NULL) {
+				results[base + i] = ISC_R_NOTFOUND;
+			} else {
+				pending++;
+			}
+		}
+
+		while (pending > 0) {
+			for (size_t i = 0; i < batch; i++) {
+				size_t r = base + i;
+				isc_result_t result;
+
+				if (search[i].n == NULL) {
+					continue;
+				}
+				result = getnames_step(qp, &search[i]);
+				if (result == DNS_R_CONTINUE) {
+					continue;
+				}
+				if (result == ISC_R_SUCCESS && pvals != NULL) {
+					pvals[r] = leaf_pval(search[i].n);
+				}
+				if (result == ISC_R_SUCCESS && ivals != NULL) {
+					ivals[r] = leaf_ival(search[i].n);
+				}
+				results[r] = result;
+				search[i].n = NULL;
+				pending--;
+			}
+		}
+	}
+}
+
 static inline void
 add_link(dns_qpchain_t *chain, dns_qpnode_t *node, size_t offset) {
 	/* prevent duplication */
@@ -356,6 +356,7 @@ ref_ptr(dns_qpreadable_t qpr, dns_qpref_t ref) {
 #define QPREADER_MAGIC ISC_MAGIC('q', 'p', 'r', 'x')
 #define QPBASE_MAGIC   ISC_MAGIC('q', 'p', 'b', 'p')
 #define QPRCU_MAGIC    ISC_MAGIC('q', 'p', 'c', 'b')
+#define QPBUILD_MAGIC  ISC_MAGIC('q', 'p', 'b', 'l')
 
 #define QP_VALID(qp)	  ISC_MAGIC_VALID(qp, QP_MAGIC)
 #define QPITER_VALID(qp)  ISC_MAGIC_VALID(qp, QPITER_MAGIC)
@@ -363,6 +364,7 @@ ref_ptr(dns_qpreadable_t qpr, dns_qpref_t ref) {
 #define QPMULTI_VALID(qp) ISC_MAGIC_VALID(qp, QPMULTI_MAGIC)
 #define QPBASE_VALID(qp)  ISC_MAGIC_VALID(qp, QPBASE_MAGIC)
 #define QPRCU_VALID(qp)	  ISC_MAGIC_VALID(qp, QPRCU_MAGIC)
+#define QPBUILD_VALID(qp) ISC_MAGIC_VALID(qp, QPBUILD_MAGIC)
 
 /*
  * Polymorphic initialization of the `dns_qpreader_t` prefix.
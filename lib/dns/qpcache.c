@@ -104,6 +104,12 @@
 #define STATCOUNT(header)                              \
 	((atomic_load_acquire(&(header)->attributes) & \
 	  DNS_SLABHEADERATTR_STATCOUNT) != 0)
+#define REFRESHED(header)                              \
+	((atomic_load_acquire(&(header)->attributes) & \
+	  DNS_SLABHEADERATTR_REFRESHED) != 0)
+#define QMIN(header)                                   \
+	((atomic_load_acquire(&(header)->attributes) & \
+	  DNS_SLABHEADERATTR_QMIN) != 0)
 
 #define STALE_TTL(header, qpdb) \
 	(NXDOMAIN(header) ? 0 : qpdb->common.serve_stale_ttl)
@@ -302,6 +308,7 @@ static dns_qpmethods_t qpmethods = {
 	qp_detach,
 	qp_makekey,
 	qp_triename,
+	.fingerprint = true,
 };
 
 static void
@@ -1070,6 +1077,21 @@ bindrdataset(qpcache_t *qpdb, qpcnode_t *node, dns_slabheader_t *header,
 
 	rdataset->count = atomic_fetch_add_relaxed(&header->count, 1);
 
+	/*
+	 * Count the hit for background refresh ranking, and if this
+	 * is the first use of an RRset that was fetched by a background
+	 * refresh, record that the refresh paid off.
+	 */
+	atomic_fetch_add_relaxed(&header->hits, 1);
+	if (REFRESHED(header) &&
+	    (DNS_SLABHEADER_CLRATTR(header, DNS_SLABHEADERATTR_REFRESHED) &
+	     DNS_SLABHEADERATTR_REFRESHED) != 0 &&
+	    qpdb->cachestats != NULL)
+	{
+		isc_stats_increment(qpdb->cachestats,
+				    dns_cachestatscounter_refreshhits);
+	}
+
 	rdataset->slab.db = (dns_db_t *)qpdb;
 	rdataset->slab.node = (dns_dbnode_t *)node;
 	rdataset->slab.raw = dns_slabheader_raw(header);
@@ -1136,6 +1158,9 @@ setup_delegation(qpc_search_t *search, dns_dbnode_t **nodep,
 	if (type == dns_rdatatype_dname) {
 		return (DNS_R_DNAME);
 	}
+	if (type == RDATATYPE_NCACHEANY) {
+		return (DNS_R_NCACHENXDOMAIN);
+	}
 	return (DNS_R_DELEGATION);
 }
 
@@ -1251,6 +1276,7 @@ check_zonecut(qpcnode_t *node, void *arg DNS__DB_FLARG) {
 	dns_slabheader_t *header = NULL;
 	dns_slabheader_t *header_prev = NULL, *header_next = NULL;
 	dns_slabheader_t *dname_header = NULL, *sigdname_header = NULL;
+	dns_slabheader_t *nxdomain_header = NULL;
 	isc_result_t result;
 	isc_rwlock_t *lock = NULL;
 	isc_rwlocktype_t nlocktype = isc_rwlocktype_none;
@@ -1261,7 +1287,8 @@ check_zonecut(qpcnode_t *node, void *arg DNS__DB_FLARG) {
 	NODE_RDLOCK(lock, &nlocktype);
 
 	/*
-	 * Look for a DNAME or RRSIG DNAME rdataset.
+	 * Look for a DNAME or RRSIG DNAME rdataset, or for a negative
+	 * cache entry saying that this name does not exist.
 	 */
 	for (header = node->data; header != NULL; header = header_next) {
 		header_next = header->next;
@@ -1279,6 +1306,16 @@ check_zonecut(qpcnode_t *node, void *arg DNS__DB_FLARG) {
 		{
 			sigdname_header = header;
 			header_prev = header;
+		} else if ((search->options & DNS_DBFIND_NXDOMAINCUT) != 0 &&
+			   header->type == RDATATYPE_NCACHEANY &&
+			   !DNS_TRUST_PENDING(header->trust) &&
+			   (header->trust == dns_trust_secure ||
+			    !QMIN(header)) &&
+			   NXDOMAIN(header) && EXISTS(header) &&
+			   !ANCIENT(header))
+		{
+			nxdomain_header = header;
+			header_prev = header;
 		} else {
 			header_prev = header;
 		}
@@ -1299,6 +1336,23 @@ check_zonecut(qpcnode_t *node, void *arg DNS__DB_FLARG) {
 		search->zonecut_sigheader = sigdname_header;
 		search->need_cleanup = true;
 		result = DNS_R_PARTIALMATCH;
+	} else if (nxdomain_header != NULL) {
+		/*
+		 * An ancestor of the name we're looking for is cached as
+		 * NXDOMAIN, so there is nothing underneath it either
+		 * (RFC 8020).  Stop here and answer with the ancestor's
+		 * negative cache entry.  Unvalidated NXDOMAINs learned by
+		 * relaxed QNAME minimization are not trusted for this:
+		 * some servers wrongly return NXDOMAIN for empty
+		 * non-terminals, which QNAME minimization works around.
+		 */
+		newref(search->qpdb, node, nlocktype,
+		       isc_rwlocktype_none DNS__DB_FLARG_PASS);
+		search->zonecut = node;
+		search->zonecut_header = nxdomain_header;
+		search->zonecut_sigheader = NULL;
+		search->need_cleanup = true;
+		result = DNS_R_PARTIALMATCH;
 	} else {
 		result = DNS_R_CONTINUE;
 	}
@@ -3299,6 +3353,14 @@ find_header:
 			     addedrdataset DNS__DB_FLARG_PASS);
 	}
 
+	/*
+	 * Marked after binding so that only later lookups are counted
+	 * as hits on the refreshed data.
+	 */
+	if ((options & DNS_DBADD_REFRESH) != 0) {
+		DNS_SLABHEADER_SETATTR(newheader, DNS_SLABHEADERATTR_REFRESHED);
+	}
+
 	return (ISC_R_SUCCESS);
 }
 
@@ -3446,6 +3508,9 @@ addrdataset(dns_db_t *db, dns_dbnode_t *node, dns_dbversion_t *version,
 	if ((rdataset->attributes & DNS_RDATASETATTR_OPTOUT) != 0) {
 		DNS_SLABHEADER_SETATTR(newheader, DNS_SLABHEADERATTR_OPTOUT);
 	}
+	if ((options & DNS_DBADD_QMIN) != 0) {
+		DNS_SLABHEADER_SETATTR(newheader, DNS_SLABHEADERATTR_QMIN);
+	}
 	if ((rdataset->attributes & DNS_RDATASETATTR_NOQNAME) != 0) {
 		result = addnoqname(qpdb->common.mctx, newheader,
 				    qpdb->maxrrperset, rdataset);
@@ -4371,6 +4436,194 @@ setmaxtypepername(dns_db_t *db, uint32_t value) {
 	qpdb->maxtypepername = value;
 }
 
+static bool
+hot_candidate(dns_slabheader_t *header, isc_stdtime_t now, uint32_t minhits) {
+	return (header->ttl > now && PREFETCH(header) && EXISTS(header) &&
+		!NEGATIVE(header) && !ANCIENT(header) && !STALE(header) &&
+		DNS_TYPEPAIR_COVERS(header->type) == 0 &&
+		atomic_load_relaxed(&header->hits) >= minhits);
+}
+
+typedef struct {
+	isc_stdtime_t now;
+	isc_stdtime_t limit;
+	uint32_t minhits;
+
+	/* First pass: the largest hit counts seen so far */
+	uint32_t *top;
+	unsigned int ntop;
+
+	/* Second pass: the entries being filled in */
+	uint32_t threshold;
+	unsigned int ties;
+	dns_dbhotentry_t *entries;
+	unsigned int nentries;
+
+	unsigned int count;
+} qpc_hot_t;
+
+/*
+ * Visit every candidate in the part of a TTL heap that expires no later
+ * than hot->limit.  The heap is a binary min-heap stored from index 1, so
+ * the children of an element that expires too late will also expire too
+ * late and need not be visited.
+ */
+static void
+gethot_walk(isc_heap_t *heap, unsigned int idx, qpc_hot_t *hot,
+	    void (*action)(dns_slabheader_t *header, qpc_hot_t *hot)) {
+	dns_slabheader_t *header = isc_heap_element(heap, idx);
+
+	if (header == NULL || header->ttl > hot->limit) {
+		return;
+	}
+
+	if (hot_candidate(header, hot->now, hot->minhits)) {
+		action(header, hot);
+	}
+
+	if (idx < UINT_MAX / 2) {
+		gethot_walk(heap, idx * 2, hot, action);
+		gethot_walk(heap, idx * 2 + 1, hot, action);
+	}
+}
+
+/*
+ * The first pass keeps the 'count' largest hit counts seen so far in a
+ * binary min-heap, so that the smallest of them, which is the one to
+ * be displaced next, is always at hot->top[0].
+ */
+static void
+gethot_rank(dns_slabheader_t *header, qpc_hot_t *hot) {
+	uint32_t hits = atomic_load_relaxed(&header->hits);
+	unsigned int i, child;
+
+	if (hot->ntop < hot->count) {
+		for (i = hot->ntop++; i > 0; i = (i - 1) / 2) {
+			if (hot->top[(i - 1) / 2] <= hits) {
+				break;
+			}
+			hot->top[i] = hot->top[(i - 1) / 2];
+		}
+		hot->top[i] = hits;
+		return;
+	}
+
+	if (hits <= hot->top[0]) {
+		return;
+	}
+
+	for (i = 0; (child = i * 2 + 1) < hot->ntop; i = child) {
+		if (child + 1 < hot->ntop &&
+		    hot->top[child + 1] < hot->top[child])
+		{
+			child++;
+		}
+		if (hits <= hot->top[child]) {
+			break;
+		}
+		hot->top[i] = hot->top[child];
+	}
+	hot->top[i] = hits;
+}
+
+static void
+gethot_collect(dns_slabheader_t *header, qpc_hot_t *hot) {
+	uint32_t hits = atomic_load_relaxed(&header->hits);
+	dns_dbhotentry_t *entry = NULL;
+
+	if (hot->nentries == hot->count || hits < hot->threshold) {
+		return;
+	}
+	if (hits == hot->threshold) {
+		if (hot->ties == 0) {
+			return;
+		}
+		hot->ties--;
+	}
+
+	entry = &hot->entries[hot->nentries++];
+	entry->name = dns_fixedname_initname(&entry->fixed);
+	dns_name_copy(&HEADERNODE(header)->name, entry->name);
+	entry->type = DNS_TYPEPAIR_TYPE(header->type);
+	entry->hits = hits;
+	entry->expire = header->ttl;
+
+	/*
+	 * Claim the RRset so that neither the next scan nor a client
+	 * query triggers another prefetch of it.
+	 */
+	DNS_SLABHEADER_CLRATTR(header, DNS_SLABHEADERATTR_PREFETCH);
+}
+
+static int
+hotentry_cmp(const void *a, const void *b) {
+	const dns_dbhotentry_t *ea = a, *eb = b;
+
+	if (ea->hits > eb->hits) {
+		return (-1);
+	} else if (ea->hits < eb->hits) {
+		return (1);
+	}
+	return (0);
+}
+
+static unsigned int
+gethot(dns_db_t *db, isc_stdtime_t now, dns_ttl_t window, uint32_t minhits,
+       dns_dbhotentry_t *entries, unsigned int count) {
+	qpcache_t *qpdb = (qpcache_t *)db;
+	isc_rwlocktype_t nlocktype = isc_rwlocktype_none;
+	qpc_hot_t hot = {
+		.now = now,
+		.limit = now + window,
+		.minhits = minhits,
+		.entries = entries,
+		.count = count,
+	};
+
+	REQUIRE(VALID_QPDB(qpdb));
+
+	if (count == 0) {
+		return (0);
+	}
+
+	/*
+	 * The first pass finds the hit count an RRset needs to make
+	 * the top 'count'; the second pass claims the RRsets that do.
+	 * Doing it this way round means that nothing is claimed only to
+	 * be pushed out by a more popular RRset in another bucket.
+	 */
+	hot.top = isc_mem_cget(qpdb->common.mctx, count, sizeof(hot.top[0]));
+	for (unsigned int i = 0; i < qpdb->node_lock_count; i++) {
+		NODE_RDLOCK(&qpdb->node_locks[i].lock, &nlocktype);
+		gethot_walk(qpdb->heaps[i], 1, &hot, gethot_rank);
+		NODE_UNLOCK(&qpdb->node_locks[i].lock, &nlocktype);
+	}
+
+	if (hot.ntop == 0) {
+		goto done;
+	}
+
+	hot.threshold = hot.top[0];
+	for (unsigned int i = 0; i < hot.ntop; i++) {
+		if (hot.top[i] == hot.threshold) {
+			hot.ties++;
+		}
+	}
+
+	for (unsigned int i = 0; i < qpdb->node_lock_count; i++) {
+		NODE_RDLOCK(&qpdb->node_locks[i].lock, &nlocktype);
+		gethot_walk(qpdb->heaps[i], 1, &hot, gethot_collect);
+		NODE_UNLOCK(&qpdb->node_locks[i].lock, &nlocktype);
+	}
+
+	qsort(entries, hot.nentries, sizeof(entries[0]), hotentry_cmp);
+
+done:
+	isc_mem_cput(qpdb->common.mctx, hot.top, count, sizeof(hot.top[0]));
+
+	return (hot.nentries);
+}
+
 static dns_dbmethods_t qpdb_cachemethods = {
 	.destroy = qpdb_destroy,
 	.findnode = findnode,
@@ -4397,6 +4650,7 @@ static dns_dbmethods_t qpdb_cachemethods = {
 	.deletedata = deletedata,
 	.setmaxrrperset = setmaxrrperset,
 	.setmaxtypepername = setmaxtypepername,
+	.gethot = gethot,
 };
 
 static void
@@ -263,6 +263,7 @@ static dns_qpmethods_t qpmethods = {
 	qp_detach,
 	qp_makekey,
 	qp_triename,
+	.fingerprint = true,
 };
 
 static void
@@ -5157,9 +5158,38 @@ addglue_to_message(dns_glue_t *ge, dns_message_t *msg) {
 	}
 }
 
+/*
+ * The NS target names of a delegation, collected by glue_names_cb()
+ */
+typedef struct {
+	isc_mem_t *mctx;
+	size_t size;
+	size_t count;
+	dns_fixedname_t *fixed;
+	const dns_name_t **names;
+} glue_names_t;
+
+static isc_result_t
+glue_names_cb(void *arg, const dns_name_t *name, dns_rdatatype_t qtype,
+	      dns_rdataset_t *unused DNS__DB_FLARG) {
+	glue_names_t *names = arg;
+
+	UNUSED(unused);
+
+	INSIST(qtype == dns_rdatatype_a);
+	INSIST(names->count < names->size);
+
+	dns_name_t *copy = dns_fixedname_initname(&names->fixed[names->count]);
+	dns_name_copy(name, copy);
+	names->names[names->count++] = copy;
+
+	return (ISC_R_SUCCESS);
+}
+
 static dns_glue_t *
 newglue(dns_db_t *db, qpz_version_t *version, qpznode_t *node,
 	dns_rdataset_t *rdataset) {
+	qpzonedb_t *qpdb = (qpzonedb_t *)db;
 	dns_fixedname_t nodename;
 	dns_glue_additionaldata_ctx_t ctx = {
 		.db = db,
@@ -5175,8 +5205,43 @@ newglue(dns_db_t *db, qpz_version_t *version, qpznode_t *node,
 	 */
 	dns_name_copy(&node->name, ctx.nodename);
 
+	/*
+	 * Glue can only come from a node that exists, so look up all the
+	 * NS target names in one batch first, and only do a full find()
+	 * for the ones that are in the tree. Nodes are never removed from
+	 * the tree, so the current tree covers every version.
+	 */
+	glue_names_t names = {
+		.mctx = db->mctx,
+		.size = dns_rdataset_count(rdataset),
+	};
+	names.fixed = isc_mem_cget(names.mctx, names.size,
+				   sizeof(names.fixed[0]));
+	names.names = isc_mem_cget(names.mctx, names.size,
+				   sizeof(names.names[0]));
 	(void)dns_rdataset_additionaldata(rdataset, dns_rootname,
-					  glue_nsdname_cb, &ctx);
+					  glue_names_cb, &names);
+
+	isc_result_t *results = isc_mem_cget(names.mctx, names.count,
+					     sizeof(results[0]));
+	dns_qpread_t qpr;
+	dns_qpmulti_query(qpdb->tree, &qpr);
+	dns_qp_getnames(&qpr, names.count, names.names, NULL, NULL, results);
+	dns_qpread_destroy(qpdb->tree, &qpr);
+
+	for (size_t i = 0; i < names.count; i++) {
+		if (results[i] == ISC_R_SUCCESS) {
+			(void)glue_nsdname_cb(&ctx, names.names[i],
+					      dns_rdatatype_a,
+					      NULL DNS__DB_FILELINE);
+		}
+	}
+
+	isc_mem_cput(names.mctx, results, names.count, sizeof(results[0]));
+	isc_mem_cput(names.mctx, names.names, names.size,
+		     sizeof(names.names[0]));
+	isc_mem_cput(names.mctx, names.fixed, names.size,
+		     sizeof(names.fixed[0]));
 
 	return (ctx.glue_list);
 }
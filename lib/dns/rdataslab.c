@@ -82,6 +82,13 @@
  *	the changes.  See the areas tagged with "RDATASLAB".
  */
 
+/*
+ * There is a slab header for every RRset in every zone and cache, so
+ * catch any change to it that brings back padding holes.
+ */
+STATIC_ASSERT(sizeof(void *) != 8 || sizeof(dns_slabheader_t) == 144,
+	      "dns_slabheader_t is expected to be 144 bytes on LP64");
+
 struct xrdata {
 	dns_rdata_t rdata;
 #if DNS_RDATASET_FIXED
@@ -1086,6 +1093,7 @@ dns_slabheader_reset(dns_slabheader_t *h, dns_db_t *db, dns_dbnode_t *node) {
 
 	atomic_init(&h->attributes, 0);
 	atomic_init(&h->last_refresh_fail_ts, 0);
+	atomic_init(&h->hits, 0);
 
 	STATIC_ASSERT((sizeof(h->attributes) == 2),
 		      "The .attributes field of dns_slabheader_t needs to be "
@@ -236,6 +236,14 @@ STATIC_ASSERT(NS_PROCESSING_LIMIT > NS_RR_LIMIT,
 #define RES_DOMAIN_HASH_BITS 12
 #endif /* ifndef RES_DOMAIN_HASH_BITS */
 
+/*
+ * How often (in seconds) to look for popular cache entries that need a
+ * background refresh, and how many times an entry must have been looked
+ * up to qualify.
+ */
+#define RES_REFRESH_INTERVAL 1
+#define RES_REFRESH_MINHITS  2
+
 /*%
  * Maximum EDNS0 input packet size.
  */
@@ -566,6 +574,9 @@ struct dns_resolver {
 	unsigned int spillatmax;
 	unsigned int spillatmin;
 	isc_timer_t *spillattimer;
+	isc_timer_t *refreshtimer;
+	uint32_t refreshcount;
+	uint32_t refreshrate;
 	bool zero_no_soa_ttl;
 	unsigned int query_timeout;
 	unsigned int maxdepth;
@@ -597,6 +608,7 @@ struct dns_resolver {
 
 	/* Atomic. */
 	atomic_uint_fast32_t nfctx;
+	atomic_uint_fast32_t nrefresh;
 
 	uint32_t nloops;
 
@@ -666,7 +678,8 @@ static isc_result_t
 ncache_adderesult(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 		  dns_rdatatype_t covers, isc_stdtime_t now, dns_ttl_t minttl,
 		  dns_ttl_t maxttl, bool optout, bool secure,
-		  dns_rdataset_t *ardataset, isc_result_t *eresultp);
+		  unsigned int options, dns_rdataset_t *ardataset,
+		  isc_result_t *eresultp);
 static void
 validated(void *arg);
 static void
@@ -955,6 +968,34 @@ dec_stats(dns_resolver_t *res, isc_statscounter_t counter) {
 	}
 }
 
+/*
+ * Cache database options for data fetched by a prefetch.
+ */
+static unsigned int
+prefetch_addoptions(fetchctx_t *fctx) {
+	unsigned int options = DNS_DBADD_PREFETCH;
+
+	if ((fctx->options & DNS_FETCHOPT_REFRESH) != 0) {
+		options |= DNS_DBADD_REFRESH;
+	}
+
+	return (options);
+}
+
+/*
+ * Cache database options for a negative answer.  An NXDOMAIN seen by a
+ * relaxed QNAME minimization fetch may be a broken server's answer for
+ * an empty non-terminal, so it must not hide the names below it.
+ */
+static unsigned int
+ncache_addoptions(fetchctx_t *fctx) {
+	if ((fctx->options & DNS_FETCHOPT_QMINFETCH) != 0) {
+		return (DNS_DBADD_QMIN);
+	}
+
+	return (0);
+}
+
 static void
 set_stats(dns_resolver_t *res, isc_statscounter_t counter, uint64_t val) {
 	if (res->stats != NULL) {
@@ -2043,9 +2084,19 @@ fctx_query(fetchctx_t *fctx, dns_adbaddrinfo_t *addrinfo,
 		}
 		isc_sockaddr_setport(&addr, 0);
 
-		result = dns_dispatch_createtcp(
-			res->view->dispatchmgr, &addr, &sockaddr,
-			DNS_DISPATCHOPT_UNSHARED, &query->dispatch);
+		/*
+		 * Reuse a connection to the same server if there is one,
+		 * so that bursts of queries sent over TCP or TLS do not
+		 * each pay for a new handshake.
+		 */
+		result = dns_dispatch_gettcp(res->view->dispatchmgr, &sockaddr,
+					     &addr, addrinfo->transport,
+					     &query->dispatch);
+		if (result != ISC_R_SUCCESS) {
+			result = dns_dispatch_createtcp(res->view->dispatchmgr,
+							&addr, &sockaddr, 0,
+							&query->dispatch);
+		}
 		if (result != ISC_R_SUCCESS) {
 			goto cleanup_query;
 		}
@@ -4094,9 +4145,13 @@ fctx_try(fetchctx_t *fctx, bool retrying, bool badcache) {
 		 * will also reduce the impact of mis-matched NS RRsets where
 		 * the child's NS RRset is garbage.  If a delegation is
 		 * discovered DNS_R_DELEGATION will be returned to resume_qmin.
+		 * QMINFETCH marks the NXDOMAINs it caches, which resume_qmin
+		 * ignores in this mode, so that they are not used as
+		 * NXDOMAIN cuts either.
 		 */
 		if ((options & DNS_FETCHOPT_QMIN_STRICT) == 0) {
-			options |= DNS_FETCHOPT_NOFOLLOW;
+			options |= DNS_FETCHOPT_NOFOLLOW |
+				   DNS_FETCHOPT_QMINFETCH;
 		}
 
 		fetchctx_ref(fctx);
@@ -5379,7 +5434,8 @@ validated(void *arg) {
 		result = ncache_adderesult(message, fctx->cache, node, covers,
 					   now, fctx->res->view->minncachettl,
 					   ttl, val->optout, val->secure,
-					   ardataset, &eresult);
+					   ncache_addoptions(fctx), ardataset,
+					   &eresult);
 		if (result != ISC_R_SUCCESS) {
 			goto noanswer_response;
 		}
@@ -5429,7 +5485,7 @@ validated(void *arg) {
 
 	options = 0;
 	if ((fctx->options & DNS_FETCHOPT_PREFETCH) != 0) {
-		options = DNS_DBADD_PREFETCH;
+		options = prefetch_addoptions(fctx);
 	}
 	result = dns_db_addrdataset(fctx->cache, node, NULL, now, val->rdataset,
 				    options, ardataset);
@@ -6048,7 +6104,7 @@ cache_name(fetchctx_t *fctx, dns_name_t *name, dns_message_t *message,
 				if ((fctx->options & DNS_FETCHOPT_PREFETCH) !=
 				    0)
 				{
-					options = DNS_DBADD_PREFETCH;
+					options = prefetch_addoptions(fctx);
 				}
 				if ((fctx->options & DNS_FETCHOPT_NOCACHED) !=
 				    0)
@@ -6188,7 +6244,7 @@ cache_name(fetchctx_t *fctx, dns_name_t *name, dns_message_t *message,
 				options = DNS_DBADD_FORCE;
 			} else if ((fctx->options & DNS_FETCHOPT_PREFETCH) != 0)
 			{
-				options = DNS_DBADD_PREFETCH;
+				options = prefetch_addoptions(fctx);
 			} else {
 				options = 0;
 			}
@@ -6335,7 +6391,8 @@ static isc_result_t
 ncache_adderesult(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 		  dns_rdatatype_t covers, isc_stdtime_t now, dns_ttl_t minttl,
 		  dns_ttl_t maxttl, bool optout, bool secure,
-		  dns_rdataset_t *ardataset, isc_result_t *eresultp) {
+		  unsigned int options, dns_rdataset_t *ardataset,
+		  isc_result_t *eresultp) {
 	isc_result_t result;
 	dns_rdataset_t rdataset;
 
@@ -6345,11 +6402,11 @@ ncache_adderesult(dns_message_t *message, dns_db_t *cache, dns_dbnode_t *node,
 	}
 	if (secure) {
 		result = dns_ncache_addoptout(message, cache, node, covers, now,
-					      minttl, maxttl, optout,
+					      minttl, maxttl, optout, options,
 					      ardataset);
 	} else {
 		result = dns_ncache_add(message, cache, node, covers, now,
-					minttl, maxttl, ardataset);
+					minttl, maxttl, options, ardataset);
 	}
 	if (result == DNS_R_UNCHANGED || result == ISC_R_SUCCESS) {
 		/*
@@ -6523,7 +6580,8 @@ ncache_message(fetchctx_t *fctx, dns_message_t *message,
 
 	result = ncache_adderesult(message, fctx->cache, node, covers, now,
 				   fctx->res->view->minncachettl, ttl, false,
-				   false, ardataset, &eresult);
+				   false, ncache_addoptions(fctx), ardataset,
+				   &eresult);
 	if (result != ISC_R_SUCCESS) {
 		goto unlock;
 	}
@@ -6993,12 +7051,24 @@ ISC_REFCOUNT_TRACE_IMPL(fetchctx, fctx_destroy);
 ISC_REFCOUNT_IMPL(fetchctx, fctx_destroy);
 #endif
 
+/*
+ * Fetch options that only affect how the answer is accounted for and
+ * cached (quota exemptions, prefetch eligibility), not which servers
+ * are asked or what they are asked.  Fetches that differ only in these
+ * options can share one fetch context, so that e.g. a background
+ * refresh and a prefetch for the same name and type, or either of them
+ * and a client query already in progress, do not iterate independently.
+ */
+#define FCTX_OPTIONS_NOMATCH (DNS_FETCHOPT_PREFETCH | DNS_FETCHOPT_REFRESH)
+
 static uint32_t
 fctx_hash(fetchctx_t *fctx) {
 	isc_hash32_t hash32;
+	unsigned int options = fctx->options & ~FCTX_OPTIONS_NOMATCH;
+
 	isc_hash32_init(&hash32);
 	isc_hash32_hash(&hash32, fctx->name->ndata, fctx->name->length, false);
-	isc_hash32_hash(&hash32, &fctx->options, sizeof(fctx->options), true);
+	isc_hash32_hash(&hash32, &options, sizeof(options), true);
 	isc_hash32_hash(&hash32, &fctx->type, sizeof(fctx->type), true);
 	return (isc_hash32_finalize(&hash32));
 }
@@ -7007,8 +7077,21 @@ static bool
 fctx_match(void *node, const void *key) {
 	const fetchctx_t *fctx0 = node;
 	const fetchctx_t *fctx1 = key;
+	unsigned int options = fctx0->options ^ fctx1->options;
+
+	/*
+	 * A prefetch is exempt from the fetches-per-zone and ADB
+	 * quotas, so a fetch that is not must not join one: it would
+	 * never be counted.  It gets a fetch context of its own instead,
+	 * which is checked against the quotas when it is created.
+	 */
+	if ((fctx0->options & DNS_FETCHOPT_PREFETCH) != 0 &&
+	    (fctx1->options & DNS_FETCHOPT_PREFETCH) == 0)
+	{
+		return (false);
+	}
 
-	return (fctx0->options == fctx1->options &&
+	return ((options & ~FCTX_OPTIONS_NOMATCH) == 0 &&
 		fctx0->type == fctx1->type &&
 		dns_name_equal(fctx0->name, fctx1->name));
 }
@@ -10169,6 +10252,148 @@ dns_resolver_prime(dns_resolver_t *res) {
 	}
 }
 
+/*
+ * Background refresh of popular cache entries.
+ */
+typedef struct refresh {
+	dns_resolver_t *res;
+	dns_fetch_t *fetch;
+	dns_rdataset_t rdataset;
+} refresh_t;
+
+static void
+refresh_done(void *arg) {
+	dns_fetchresponse_t *resp = (dns_fetchresponse_t *)arg;
+	refresh_t *refresh = resp->arg;
+	dns_resolver_t *res = refresh->res;
+
+	REQUIRE(VALID_RESOLVER(res));
+
+	switch (resp->result) {
+	case ISC_R_SUCCESS:
+	case DNS_R_CNAME:
+	case DNS_R_DNAME:
+	case DNS_R_NCACHENXDOMAIN:
+	case DNS_R_NCACHENXRRSET:
+		break;
+	default:
+		inc_stats(res, dns_resstatscounter_refreshfail);
+	}
+
+	if (resp->node != NULL) {
+		dns_db_detachnode(resp->db, &resp->node);
+	}
+	if (resp->db != NULL) {
+		dns_db_detach(&resp->db);
+	}
+	if (dns_rdataset_isassociated(resp->rdataset)) {
+		dns_rdataset_disassociate(resp->rdataset);
+	}
+	INSIST(resp->sigrdataset == NULL);
+
+	isc_mem_putanddetach(&resp->mctx, resp, sizeof(*resp));
+	dns_resolver_destroyfetch(&refresh->fetch);
+	isc_mem_put(res->mctx, refresh, sizeof(*refresh));
+
+	atomic_fetch_sub_release(&res->nrefresh, 1);
+	dns_resolver_detach(&res);
+}
+
+static void
+refresh_start(dns_resolver_t *res, const dns_name_t *name,
+	      dns_rdatatype_t type) {
+	isc_result_t result;
+	refresh_t *refresh = isc_mem_get(res->mctx, sizeof(*refresh));
+
+	*refresh = (refresh_t){ 0 };
+	dns_rdataset_init(&refresh->rdataset);
+	dns_resolver_attach(res, &refresh->res);
+	atomic_fetch_add_release(&res->nrefresh, 1);
+
+	result = dns_resolver_createfetch(
+		res, name, type, NULL, NULL, NULL, NULL, 0,
+		DNS_FETCHOPT_PREFETCH | DNS_FETCHOPT_REFRESH, 0, NULL,
+		isc_loop(), refresh_done, refresh, &refresh->rdataset, NULL,
+		&refresh->fetch);
+	if (result != ISC_R_SUCCESS) {
+		inc_stats(res, dns_resstatscounter_refreshfail);
+		atomic_fetch_sub_release(&res->nrefresh, 1);
+		isc_mem_put(res->mctx, refresh, sizeof(*refresh));
+		dns_resolver_detach(&res);
+		return;
+	}
+
+	inc_stats(res, dns_resstatscounter_refresh);
+}
+
+static void
+refresh_tick(void *arg) {
+	dns_resolver_t *res = (dns_resolver_t *)arg;
+	dns_dbhotentry_t *entries = NULL;
+	dns_db_t *db = NULL;
+	uint_fast32_t outstanding;
+	unsigned int count, n;
+	dns_ttl_t window;
+
+	REQUIRE(VALID_RESOLVER(res));
+
+	if (atomic_load_acquire(&res->exiting) || res->view->cache == NULL) {
+		return;
+	}
+
+	outstanding = atomic_load_acquire(&res->nrefresh);
+	if (outstanding >= res->refreshrate) {
+		return;
+	}
+	count = ISC_MIN(res->refreshcount, res->refreshrate - outstanding);
+
+	/*
+	 * Look far enough ahead that a refresh started now has time
+	 * to complete before the data expires and a client ends up
+	 * waiting for it.
+	 */
+	window = res->view->prefetch_trigger + 2 * RES_REFRESH_INTERVAL;
+
+	entries = isc_mem_cget(res->mctx, count, sizeof(entries[0]));
+
+	dns_cache_attachdb(res->view->cache, &db);
+	n = dns_db_gethot(db, isc_stdtime_now(), window, RES_REFRESH_MINHITS,
+			  entries, count);
+	dns_db_detach(&db);
+
+	for (unsigned int i = 0; i < n; i++) {
+		refresh_start(res, entries[i].name, entries[i].type);
+	}
+
+	isc_mem_cput(res->mctx, entries, count, sizeof(entries[0]));
+}
+
+void
+dns_resolver_setrefresh(dns_resolver_t *resolver, uint32_t count,
+			uint32_t rate) {
+	REQUIRE(VALID_RESOLVER(resolver));
+	REQUIRE(!resolver->frozen);
+
+	resolver->refreshcount = count;
+	resolver->refreshrate = rate;
+
+	LOCK(&resolver->lock);
+	if (count == 0 || rate == 0) {
+		if (resolver->refreshtimer != NULL) {
+			isc_timer_destroy(&resolver->refreshtimer);
+		}
+	} else if (resolver->refreshtimer == NULL) {
+		isc_interval_t interval;
+
+		isc_interval_set(&interval, RES_REFRESH_INTERVAL, 0);
+		isc_timer_create(isc_loop(), refresh_tick, resolver,
+				 &resolver->refreshtimer);
+		isc_timer_start(resolver->refreshtimer, isc_timertype_ticker,
+				&interval);
+	}
+	UNLOCK(&resolver->lock);
+}
+
 void
 dns_resolver_freeze(dns_resolver_t *res) {
 	/*
@@ -10215,6 +10440,9 @@ dns_resolver_shutdown(dns_resolver_t *res) {
 		if (res->spillattimer != NULL) {
 			isc_timer_async_destroy(&res->spillattimer);
 		}
+		if (res->refreshtimer != NULL) {
+			isc_timer_async_destroy(&res->refreshtimer);
+		}
 		UNLOCK(&res->lock);
 	}
 }
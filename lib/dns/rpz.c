@@ -30,12 +30,14 @@
 #include <isc/result.h>
 #include <isc/rwlock.h>
 #include <isc/string.h>
+#include <isc/urcu.h>
 #include <isc/util.h>
 #include <isc/work.h>
 
 #include <dns/db.h>
 #include <dns/dbiterator.h>
 #include <dns/fixedname.h>
+#include <dns/journal.h>
 #include <dns/qp.h>
 #include <dns/rdata.h>
 #include <dns/rdataset.h>
@@ -153,6 +155,24 @@ struct dns_rpz_cidr_node {
 	dns_rpz_prefix_t prefix;
 	dns_rpz_addr_zbits_t set;
 	dns_rpz_addr_zbits_t sum;
+	dns_rpz_cidr_node_t *pub; /* published copy of this node */
+	bool dirty;		  /* changed since 'pub' was made */
+};
+
+/*
+ * A read-only copy of the radix tree.  Each update copies only the
+ * nodes on the paths it changed; the untouched subtrees are shared
+ * with the previous copy.  The nodes that the next copy no longer
+ * uses are freed together with this one.
+ */
+struct dns_rpz_cidr_snap {
+	isc_mem_t *mctx;
+	struct rcu_head rcu_head;
+	dns_rpz_have_t have;
+	dns_rpz_cidr_node_t *root;
+	dns_rpz_cidr_node_t **retired;
+	size_t nretired;
+	size_t retiredsize;
 };
 
 /*
@@ -195,6 +215,12 @@ static isc_result_t
 rpz_add(dns_rpz_zone_t *rpz, const dns_name_t *src_name);
 static void
 rpz_del(dns_rpz_zone_t *rpz, const dns_name_t *src_name);
+static void
+cidr_dirty(dns_rpz_cidr_node_t *node);
+static void
+cidr_retire(dns_rpz_zones_t *rpzs, dns_rpz_cidr_node_t *pub);
+static void
+cidr_publish(dns_rpz_zones_t *rpzs);
 
 static nmdata_t *
 new_nmdata(isc_mem_t *mctx, const dns_name_t *name, const nmdata_t *data);
@@ -214,6 +240,7 @@ static dns_qpmethods_t qpmethods = {
 	qp_detach,
 	qp_makekey,
 	qp_triename,
+	.fingerprint = true,
 };
 
 const char *
@@ -447,6 +474,38 @@ set_sum_pair(dns_rpz_cidr_node_t *cnode) {
 	} while (cnode != NULL);
 }
 
+/*
+ * Note that a node, and so the path to it from the root, differs from
+ * the published copy of the radix tree.
+ */
+static void
+cidr_dirty(dns_rpz_cidr_node_t *node) {
+	while (node != NULL && !node->dirty) {
+		node->dirty = true;
+		node = node->parent;
+	}
+}
+
+/*
+ * Keep a published node that the next copy of the radix tree will not
+ * use until the current copy is freed.  Caller must hold maint_lock.
+ */
+static void
+cidr_retire(dns_rpz_zones_t *rpzs, dns_rpz_cidr_node_t *pub) {
+	if (pub == NULL) {
+		return;
+	}
+
+	if (rpzs->cidr_nretired == rpzs->cidr_retiredsize) {
+		size_t newsize = ISC_MAX(16, rpzs->cidr_retiredsize * 2);
+		rpzs->cidr_retired = isc_mem_creget(
+			rpzs->mctx, rpzs->cidr_retired, rpzs->cidr_retiredsize,
+			newsize, sizeof(rpzs->cidr_retired[0]));
+		rpzs->cidr_retiredsize = newsize;
+	}
+	rpzs->cidr_retired[rpzs->cidr_nretired++] = pub;
+}
+
 /* Caller must hold rpzs->maint_lock */
 static void
 fix_qname_skip_recurse(dns_rpz_zones_t *rpzs) {
@@ -1345,6 +1404,54 @@ search(dns_rpz_zones_t *rpzs, const dns_rpz_cidr_key_t *tgt_ip,
 	}
 }
 
+/*
+ * Find the longest match for an IP address in a published copy of the
+ * radix tree.  This is the lookup half of search().
+ */
+static const dns_rpz_cidr_node_t *
+lookup(const dns_rpz_cidr_snap_t *snap, const dns_rpz_cidr_key_t *tgt_ip,
+       const dns_rpz_addr_zbits_t *tgt_set) {
+	const dns_rpz_cidr_node_t *cur = snap->root, *found = NULL;
+	dns_rpz_addr_zbits_t set = *tgt_set;
+
+	while (cur != NULL) {
+		dns_rpz_prefix_t dbit;
+
+		if ((cur->sum.client_ip & set.client_ip) == 0 &&
+		    (cur->sum.ip & set.ip) == 0 &&
+		    (cur->sum.nsip & set.nsip) == 0)
+		{
+			break;
+		}
+
+		/*
+		 * The target is a whole address, so it can only match all
+		 * of a node or diverge from it.
+		 */
+		dbit = diff_keys(tgt_ip, 128, &cur->ip, cur->prefix);
+		if (dbit != cur->prefix) {
+			break;
+		}
+
+		if ((cur->set.client_ip & set.client_ip) != 0 ||
+		    (cur->set.ip & set.ip) != 0 ||
+		    (cur->set.nsip & set.nsip) != 0)
+		{
+			found = cur;
+			set.client_ip = trim_zbits(set.client_ip,
+						   cur->set.client_ip);
+			set.ip = trim_zbits(set.ip, cur->set.ip);
+			set.nsip = trim_zbits(set.nsip, cur->set.nsip);
+		}
+		if (dbit == 128) {
+			break;
+		}
+		cur = cur->child[DNS_RPZ_IP_BIT(tgt_ip, dbit)];
+	}
+
+	return (found);
+}
+
 /*
  * Add an IP address to the radix tree.
  */
@@ -1392,6 +1499,8 @@ add_cidr(dns_rpz_zone_t *rpz, dns_rpz_type_t rpz_type,
 	}
 
 	adj_trigger_cnt(rpz, rpz_type, &tgt_ip, tgt_prefix, true);
+	cidr_dirty(found);
+	rpz->rpzs->cidr_changed = true;
 done:
 	RWUNLOCK(&rpz->rpzs->search_lock, isc_rwlocktype_write);
 	return (result);
@@ -1590,6 +1699,9 @@ dns_rpz_dbupdate_callback(dns_db_t *db, void *fn_arg) {
 
 	/* New zone came as AXFR */
 	if (rpz->db != NULL && rpz->db != db) {
+		/* The journal does not describe a new database */
+		rpz->insync = false;
+
 		/* We need to clean up the old DB */
 		if (rpz->dbversion != NULL) {
 			dns_db_closeversion(rpz->db, &rpz->dbversion, false);
@@ -1645,6 +1757,21 @@ dns_rpz_dbupdate_register(dns_db_t *db, dns_rpz_zone_t *rpz) {
 
 	dns_db_updatenotify_register(db, dns_rpz_dbupdate_callback, rpz);
 }
+
+void
+dns_rpz_setjournal(dns_rpz_zone_t *rpz, const char *journal) {
+	REQUIRE(DNS_RPZ_ZONE_VALID(rpz));
+
+	LOCK(&rpz->rpzs->maint_lock);
+	if (rpz->journal != NULL) {
+		isc_mem_free(rpz->rpzs->mctx, rpz->journal);
+	}
+	if (journal != NULL) {
+		rpz->journal = isc_mem_strdup(rpz->rpzs->mctx, journal);
+	}
+	UNLOCK(&rpz->rpzs->maint_lock);
+}
+
 static void
 dns__rpz_timer_start(dns_rpz_zone_t *rpz) {
 	uint64_t tdiff;
@@ -1699,6 +1826,15 @@ update_rpz_done_cb(void *data) {
 	LOCK(&rpz->rpzs->maint_lock);
 	rpz->updaterunning = false;
 
+	/*
+	 * Remember which version the summary now reflects, so that the
+	 * next update of the same database can be read from the journal.
+	 */
+	rpz->insync = (rpz->updateresult == ISC_R_SUCCESS &&
+		       rpz->db == rpz->updb &&
+		       dns_db_getsoaserial(rpz->updb, rpz->updbversion,
+					   &rpz->serial) == ISC_R_SUCCESS);
+
 	dns_name_format(&rpz->origin, dname, DNS_NAME_FORMATSIZE);
 
 	if (rpz->updatepending && !rpz->rpzs->shuttingdown) {
@@ -1902,6 +2038,165 @@ cleanup_nodes(dns_rpz_zone_t *rpz) {
 	return (result);
 }
 
+/*
+ * Does 'name' own any rdataset in the version being updated to?
+ */
+static bool
+node_exists(dns_rpz_zone_t *rpz, const dns_name_t *name) {
+	isc_result_t result;
+	dns_dbnode_t *node = NULL;
+	dns_rdatasetiter_t *rdsiter = NULL;
+
+	result = dns_db_findnode(rpz->updb, name, false, &node);
+	if (result != ISC_R_SUCCESS) {
+		return (false);
+	}
+
+	result = dns_db_allrdatasets(rpz->updb, node, rpz->updbversion, 0, 0,
+				     &rdsiter);
+	if (result == ISC_R_SUCCESS) {
+		result = dns_rdatasetiter_first(rdsiter);
+		dns_rdatasetiter_destroy(&rdsiter);
+	}
+	dns_db_detachnode(rpz->updb, &node);
+
+	return (result == ISC_R_SUCCESS);
+}
+
+/*
+ * Bring the summary from the version with SOA serial 'serial' to the
+ * version being updated to, by re-examining only the owner names that
+ * the journal says were touched in between.  Any failure to read the
+ * journal is returned to the caller, which then walks the whole
+ * database instead.
+ */
+static isc_result_t
+update_from_journal(dns_rpz_zone_t *rpz, const char *journal,
+		    uint32_t serial) {
+	isc_result_t result;
+	dns_journal_t *j = NULL;
+	isc_ht_t *changed = NULL;
+	isc_ht_iter_t *iter = NULL;
+	uint32_t end_serial;
+	dns_fixedname_t fixname;
+	dns_name_t *name = dns_fixedname_initname(&fixname);
+	char domain[DNS_NAME_FORMATSIZE];
+	size_t added = 0, deleted = 0;
+
+	result = dns_db_getsoaserial(rpz->updb, rpz->updbversion, &end_serial);
+	if (result != ISC_R_SUCCESS) {
+		return (result);
+	}
+	if (end_serial == serial) {
+		return (ISC_R_SUCCESS);
+	}
+
+	result = dns_journal_open(rpz->rpzs->mctx, journal, DNS_JOURNAL_READ,
+				  &j);
+	if (result != ISC_R_SUCCESS) {
+		return (result);
+	}
+	result = dns_journal_iter_init(j, serial, end_serial, NULL);
+	if (result != ISC_R_SUCCESS) {
+		goto cleanup;
+	}
+
+	/*
+	 * Collect the distinct owner names first: a name is usually
+	 * deleted and re-added within the same transaction.
+	 */
+	isc_ht_init(&changed, rpz->rpzs->mctx, 1, ISC_HT_CASE_SENSITIVE);
+	for (result = dns_journal_first_rr(j); result == ISC_R_SUCCESS;
+	     result = dns_journal_next_rr(j))
+	{
+		dns_name_t *owner = NULL;
+		dns_rdata_t *rdata = NULL;
+		uint32_t ttl;
+
+		dns_journal_current_rr(j, &owner, &ttl, &rdata);
+		dns_name_downcase(owner, name, NULL);
+		(void)isc_ht_add(changed, name->ndata, name->length, rpz);
+	}
+	if (result != ISC_R_NOMORE) {
+		goto cleanup;
+	}
+
+	isc_ht_iter_create(changed, &iter);
+	for (result = isc_ht_iter_first(iter); result == ISC_R_SUCCESS;
+	     result = isc_ht_iter_next(iter))
+	{
+		isc_region_t region;
+		unsigned char *key = NULL;
+		size_t keysize;
+		bool exists, known;
+
+		result = dns__rpz_shuttingdown(rpz->rpzs);
+		if (result != ISC_R_SUCCESS) {
+			goto cleanup;
+		}
+
+		isc_ht_iter_currentkey(iter, &key, &keysize);
+		region.base = key;
+		region.length = (unsigned int)keysize;
+		dns_name_fromregion(name, &region);
+
+		exists = node_exists(rpz, name);
+		known = (isc_ht_find(rpz->nodes, key, keysize, NULL) ==
+			 ISC_R_SUCCESS);
+
+		if (exists && !known) {
+			RUNTIME_CHECK(isc_ht_add(rpz->nodes, key, keysize,
+						 rpz) == ISC_R_SUCCESS);
+			LOCK(&rpz->rpzs->maint_lock);
+			result = rpz_add(rpz, name);
+			UNLOCK(&rpz->rpzs->maint_lock);
+			if (result != ISC_R_SUCCESS) {
+				char namebuf[DNS_NAME_FORMATSIZE];
+				dns_name_format(&rpz->origin, domain,
+						sizeof(domain));
+				dns_name_format(name, namebuf,
+						sizeof(namebuf));
+				isc_log_write(DNS_LOGCATEGORY_GENERAL,
+					      DNS_LOGMODULE_MASTER,
+					      ISC_LOG_ERROR,
+					      "rpz: %s: adding node %s "
+					      "to RPZ error %s",
+					      domain, namebuf,
+					      isc_result_totext(result));
+			}
+			added++;
+		} else if (!exists && known) {
+			isc_ht_delete(rpz->nodes, key, keysize);
+			LOCK(&rpz->rpzs->maint_lock);
+			rpz_del(rpz, name);
+			UNLOCK(&rpz->rpzs->maint_lock);
+			deleted++;
+		}
+	}
+	INSIST(result != ISC_R_SUCCESS);
+	if (result == ISC_R_NOMORE) {
+		result = ISC_R_SUCCESS;
+	}
+
+	dns_name_format(&rpz->origin, domain, sizeof(domain));
+	isc_log_write(DNS_LOGCATEGORY_GENERAL, DNS_LOGMODULE_MASTER,
+		      ISC_LOG_DEBUG(1),
+		      "rpz: %s: serial %u to %u from journal: "
+		      "%zu added, %zu deleted",
+		      domain, serial, end_serial, added, deleted);
+
+cleanup:
+	if (iter != NULL) {
+		isc_ht_iter_destroy(&iter);
+	}
+	if (changed != NULL) {
+		isc_ht_destroy(&changed);
+	}
+	dns_journal_destroy(&j);
+
+	return (result);
+}
+
 static isc_result_t
 dns__rpz_shuttingdown(dns_rpz_zones_t *rpzs) {
 	bool shuttingdown = false;
@@ -1922,6 +2217,8 @@ update_rpz_cb(void *data) {
 	dns_rpz_zone_t *rpz = (dns_rpz_zone_t *)data;
 	isc_result_t result = ISC_R_SUCCESS;
 	isc_ht_t *newnodes = NULL;
+	char *journal = NULL;
+	uint32_t serial = 0;
 
 	REQUIRE(rpz->nodes != NULL);
 
@@ -1930,6 +2227,29 @@ update_rpz_cb(void *data) {
 		goto shuttingdown;
 	}
 
+	LOCK(&rpz->rpzs->maint_lock);
+	if (rpz->insync && rpz->journal != NULL) {
+		journal = isc_mem_strdup(rpz->rpzs->mctx, rpz->journal);
+		serial = rpz->serial;
+	}
+	UNLOCK(&rpz->rpzs->maint_lock);
+
+	if (journal != NULL) {
+		result = update_from_journal(rpz, journal, serial);
+		isc_mem_free(rpz->rpzs->mctx, journal);
+		if (result == ISC_R_SUCCESS || result == ISC_R_SHUTTINGDOWN) {
+			goto shuttingdown;
+		}
+
+		char domain[DNS_NAME_FORMATSIZE];
+		dns_name_format(&rpz->origin, domain, sizeof(domain));
+		isc_log_write(DNS_LOGCATEGORY_GENERAL, DNS_LOGMODULE_MASTER,
+			      ISC_LOG_DEBUG(1),
+			      "rpz: %s: journal does not cover serial %u "
+			      "(%s), walking the whole zone",
+			      domain, serial, isc_result_totext(result));
+	}
+
 	isc_ht_init(&newnodes, rpz->rpzs->mctx, 1, ISC_HT_CASE_SENSITIVE);
 
 	result = update_nodes(rpz, newnodes);
@@ -1949,6 +2269,13 @@ cleanup:
 	isc_ht_destroy(&newnodes);
 
 shuttingdown:
+	/*
+	 * Lookups keep the last complete summary if the update failed
+	 * or was interrupted; the next update publishes its changes.
+	 */
+	if (result == ISC_R_SUCCESS) {
+		cidr_publish(rpz->rpzs);
+	}
 	rpz->updateresult = result;
 }
 
@@ -2020,9 +2347,114 @@ cidr_free(dns_rpz_zones_t *rpzs) {
 		} else {
 			parent->child[parent->child[1] == cur] = NULL;
 		}
+		if (cur->pub != NULL) {
+			isc_mem_put(rpzs->mctx, cur->pub, sizeof(*cur->pub));
+		}
 		isc_mem_put(rpzs->mctx, cur, sizeof(*cur));
 		cur = parent;
 	}
+
+	for (size_t i = 0; i < rpzs->cidr_nretired; i++) {
+		isc_mem_put(rpzs->mctx, rpzs->cidr_retired[i],
+			    sizeof(*rpzs->cidr_retired[i]));
+	}
+	if (rpzs->cidr_retired != NULL) {
+		isc_mem_cput(rpzs->mctx, rpzs->cidr_retired,
+			     rpzs->cidr_retiredsize,
+			     sizeof(rpzs->cidr_retired[0]));
+	}
+}
+
+/*
+ * Free a copy of the radix tree once no reader can be using it, along
+ * with the nodes that only it used.
+ */
+static void
+cidr_snap_destroy(struct rcu_head *rcu_head) {
+	dns_rpz_cidr_snap_t *snap = caa_container_of(rcu_head,
+						     dns_rpz_cidr_snap_t,
+						     rcu_head);
+
+	for (size_t i = 0; i < snap->nretired; i++) {
+		isc_mem_put(snap->mctx, snap->retired[i],
+			    sizeof(*snap->retired[i]));
+	}
+	if (snap->retired != NULL) {
+		isc_mem_cput(snap->mctx, snap->retired, snap->retiredsize,
+			     sizeof(snap->retired[0]));
+	}
+	isc_mem_putanddetach(&snap->mctx, snap, sizeof(*snap));
+}
+
+/*
+ * Return the published copy of 'node', making a new one if the node
+ * has changed since the last copy.  Unchanged subtrees are shared.
+ */
+static dns_rpz_cidr_node_t *
+cidr_publish_node(dns_rpz_zones_t *rpzs, dns_rpz_cidr_node_t *node) {
+	dns_rpz_cidr_node_t *pub = NULL;
+
+	if (node == NULL) {
+		return (NULL);
+	}
+	if (!node->dirty && node->pub != NULL) {
+		return (node->pub);
+	}
+
+	pub = isc_mem_get(rpzs->mctx, sizeof(*pub));
+	*pub = (dns_rpz_cidr_node_t){
+		.ip = node->ip,
+		.prefix = node->prefix,
+		.set = node->set,
+		.sum = node->sum,
+	};
+	pub->child[0] = cidr_publish_node(rpzs, node->child[0]);
+	pub->child[1] = cidr_publish_node(rpzs, node->child[1]);
+
+	cidr_retire(rpzs, node->pub);
+	node->pub = pub;
+	node->dirty = false;
+
+	return (pub);
+}
+
+/*
+ * Replace the copy of the radix tree used by dns_rpz_find_ip() if the
+ * tree has changed since it was made.  Only the changed paths are
+ * copied.  Readers of the old copy are waited for with RCU before it
+ * and the nodes it no longer shares are freed.
+ */
+static void
+cidr_publish(dns_rpz_zones_t *rpzs) {
+	dns_rpz_cidr_snap_t *snap = NULL;
+
+	LOCK(&rpzs->maint_lock);
+	if (!rpzs->cidr_changed) {
+		goto unlock;
+	}
+
+	snap = isc_mem_get(rpzs->mctx, sizeof(*snap));
+	*snap = (dns_rpz_cidr_snap_t){
+		.have = rpzs->have,
+	};
+	isc_mem_attach(rpzs->mctx, &snap->mctx);
+	snap->root = cidr_publish_node(rpzs, rpzs->cidr);
+
+	snap = rcu_xchg_pointer(&rpzs->cidrsnap, snap);
+	if (snap != NULL) {
+		snap->retired = rpzs->cidr_retired;
+		snap->nretired = rpzs->cidr_nretired;
+		snap->retiredsize = rpzs->cidr_retiredsize;
+		rpzs->cidr_retired = NULL;
+		rpzs->cidr_nretired = 0;
+		rpzs->cidr_retiredsize = 0;
+		call_rcu(&snap->rcu_head, cidr_snap_destroy);
+	}
+	INSIST(rpzs->cidr_nretired == 0);
+	rpzs->cidr_changed = false;
+
+unlock:
+	UNLOCK(&rpzs->maint_lock);
 }
 
 static void
@@ -2085,6 +2517,10 @@ dns_rpz_zone_destroy(dns_rpz_zone_t **rpzp) {
 	}
 	INSIST(!rpz->updaterunning);
 
+	if (rpz->journal != NULL) {
+		isc_mem_free(rpzs->mctx, rpz->journal);
+	}
+
 	isc_ht_destroy(&rpz->nodes);
 
 	isc_mem_put(rpzs->mctx, rpz, sizeof(*rpz));
@@ -2104,6 +2540,9 @@ dns__rpz_zones_destroy(dns_rpz_zones_t *rpzs) {
 	}
 
 	cidr_free(rpzs);
+	if (rpzs->cidrsnap != NULL) {
+		cidr_snap_destroy(&rpzs->cidrsnap->rcu_head);
+	}
 	if (rpzs->table != NULL) {
 		dns_qpmulti_destroy(&rpzs->table);
 	}
@@ -2219,8 +2658,10 @@ del_cidr(dns_rpz_zone_t *rpz, dns_rpz_type_t rpz_type,
 	tgt->set.ip &= ~tgt_set.ip;
 	tgt->set.nsip &= ~tgt_set.nsip;
 	set_sum_pair(tgt);
+	cidr_dirty(tgt);
 
 	adj_trigger_cnt(rpz, rpz_type, &tgt_ip, tgt_prefix, false);
+	rpz->rpzs->cidr_changed = true;
 
 	/*
 	 * We might need to delete 2 nodes.
@@ -2261,6 +2702,7 @@ del_cidr(dns_rpz_zone_t *rpz, dns_rpz_type_t rpz_type,
 		if (child != NULL) {
 			child->parent = parent;
 		}
+		cidr_retire(rpz->rpzs, tgt->pub);
 		isc_mem_put(rpz->rpzs->mctx, tgt, sizeof(*tgt));
 
 		tgt = parent;
@@ -2387,15 +2829,23 @@ dns_rpz_find_ip(dns_rpz_zones_t *rpzs, dns_rpz_type_t rpz_type,
 		dns_name_t *ip_name, dns_rpz_prefix_t *prefixp) {
 	dns_rpz_cidr_key_t tgt_ip;
 	dns_rpz_addr_zbits_t tgt_set;
-	dns_rpz_cidr_node_t *found = NULL;
+	const dns_rpz_cidr_snap_t *snap = NULL;
+	const dns_rpz_cidr_node_t *found = NULL;
 	isc_result_t result;
-	dns_rpz_num_t rpz_num = 0;
+	dns_rpz_num_t rpz_num = DNS_RPZ_INVALID_NUM;
 	dns_rpz_have_t have;
 	int i;
 
-	RWLOCK(&rpzs->search_lock, isc_rwlocktype_read);
-	have = rpzs->have;
-	RWUNLOCK(&rpzs->search_lock, isc_rwlocktype_read);
+	/*
+	 * Updates replace the whole snapshot, so it is safe to use
+	 * without a lock until rcu_read_unlock().
+	 */
+	rcu_read_lock();
+	snap = rcu_dereference(rpzs->cidrsnap);
+	if (snap == NULL) {
+		goto unlock;
+	}
+	have = snap->have;
 
 	/*
 	 * Convert IP address to CIDR tree key.
@@ -2446,28 +2896,36 @@ dns_rpz_find_ip(dns_rpz_zones_t *rpzs, dns_rpz_type_t rpz_type,
 			break;
 		}
 	} else {
-		return (DNS_RPZ_INVALID_NUM);
+		goto unlock;
 	}
 
 	if (zbits == 0) {
-		return (DNS_RPZ_INVALID_NUM);
+		goto unlock;
 	}
 	make_addr_set(&tgt_set, zbits, rpz_type);
 
-	RWLOCK(&rpzs->search_lock, isc_rwlocktype_read);
-	result = search(rpzs, &tgt_ip, 128, &tgt_set, false, &found);
-	if (result == ISC_R_NOTFOUND) {
+	found = lookup(snap, &tgt_ip, &tgt_set);
+	if (found == NULL) {
 		/*
 		 * There are no eligible zones for this IP address.
 		 */
-		RWUNLOCK(&rpzs->search_lock, isc_rwlocktype_read);
-		return (DNS_RPZ_INVALID_NUM);
+		goto unlock;
 	}
 
 	/*
 	 * Construct the trigger name for the longest matching trigger
 	 * in the first eligible zone with a match.
 	 */
+	result = ip2name(&found->ip, found->prefix, dns_rootname, ip_name);
+	if (result != ISC_R_SUCCESS) {
+		/*
+		 * bin/tests/system/rpz/tests.sh looks for "rpz.*failed".
+		 */
+		isc_log_write(DNS_LOGCATEGORY_RPZ, DNS_LOGMODULE_RBTDB,
+			      DNS_RPZ_ERROR_LEVEL, "rpz ip2name() failed: %s",
+			      isc_result_totext(result));
+		goto unlock;
+	}
 	*prefixp = found->prefix;
 	switch (rpz_type) {
 	case DNS_RPZ_TYPE_CLIENT_IP:
@@ -2482,17 +2940,9 @@ dns_rpz_find_ip(dns_rpz_zones_t *rpzs, dns_rpz_type_t rpz_type,
 	default:
 		UNREACHABLE();
 	}
-	result = ip2name(&found->ip, found->prefix, dns_rootname, ip_name);
-	RWUNLOCK(&rpzs->search_lock, isc_rwlocktype_read);
-	if (result != ISC_R_SUCCESS) {
-		/*
-		 * bin/tests/system/rpz/tests.sh looks for "rpz.*failed".
-		 */
-		isc_log_write(DNS_LOGCATEGORY_RPZ, DNS_LOGMODULE_RBTDB,
-			      DNS_RPZ_ERROR_LEVEL, "rpz ip2name() failed: %s",
-			      isc_result_totext(result));
-		return (DNS_RPZ_INVALID_NUM);
-	}
+
+unlock:
+	rcu_read_unlock();
 	return (rpz_num);
 }
 
@@ -22,6 +22,7 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include <isc/hash.h>
 #include <isc/log.h>
 #include <isc/mem.h>
 #include <isc/net.h>
@@ -39,8 +40,8 @@
 #include <dns/zone.h>
 
 static void
-log_end(dns_rrl_t *rrl, dns_rrl_entry_t *e, bool early, char *log_buf,
-	unsigned int log_buf_len);
+log_end(dns_rrl_t *rrl, dns_rrl_table_t *t, dns_rrl_entry_t *e, bool early,
+	char *log_buf, unsigned int log_buf_len);
 
 /*
  * Get a modulus for a hash function that is tolerably likely to be
@@ -138,21 +139,22 @@ delta_rrl_time(isc_stdtime_t ts, isc_stdtime_t now) {
 }
 
 static int
-get_age(const dns_rrl_t *rrl, const dns_rrl_entry_t *e, isc_stdtime_t now) {
+get_age(const dns_rrl_table_t *t, const dns_rrl_entry_t *e,
+	isc_stdtime_t now) {
 	if (!e->ts_valid) {
 		return (DNS_RRL_FOREVER);
 	}
-	return (delta_rrl_time(e->ts + rrl->ts_bases[e->ts_gen], now));
+	return (delta_rrl_time(e->ts + t->ts_bases[e->ts_gen], now));
 }
 
 static void
-set_age(dns_rrl_t *rrl, dns_rrl_entry_t *e, isc_stdtime_t now) {
+set_age(dns_rrl_table_t *t, dns_rrl_entry_t *e, isc_stdtime_t now) {
 	dns_rrl_entry_t *e_old;
 	unsigned int ts_gen;
 	int i, ts;
 
-	ts_gen = rrl->ts_gen;
-	ts = now - rrl->ts_bases[ts_gen];
+	ts_gen = t->ts_gen;
+	ts = now - t->ts_bases[ts_gen];
 	if (ts < 0) {
 		if (ts < -DNS_RRL_MAX_TIME_TRAVEL) {
 			ts = DNS_RRL_FOREVER;
@@ -175,7 +177,7 @@ set_age(dns_rrl_t *rrl, dns_rrl_entry_t *e, isc_stdtime_t now) {
 	 */
 	if (ts >= DNS_RRL_MAX_TS) {
 		ts_gen = (ts_gen + 1) % DNS_RRL_TS_BASES;
-		for (e_old = ISC_LIST_TAIL(rrl->lru), i = 0;
+		for (e_old = ISC_LIST_TAIL(t->lru), i = 0;
 		     e_old != NULL && (e_old->ts_gen == ts_gen ||
 				       !ISC_LINK_LINKED(e_old, hlink));
 		     e_old = ISC_LIST_PREV(e_old, lru), ++i)
@@ -188,13 +190,13 @@ set_age(dns_rrl_t *rrl, dns_rrl_entry_t *e, isc_stdtime_t now) {
 				DNS_RRL_LOG_DEBUG1,
 				"rrl new time base scanned %d entries"
 				" at %d for %d %d %d %d",
-				i, now, rrl->ts_bases[ts_gen],
-				rrl->ts_bases[(ts_gen + 1) % DNS_RRL_TS_BASES],
-				rrl->ts_bases[(ts_gen + 2) % DNS_RRL_TS_BASES],
-				rrl->ts_bases[(ts_gen + 3) % DNS_RRL_TS_BASES]);
+				i, now, t->ts_bases[ts_gen],
+				t->ts_bases[(ts_gen + 1) % DNS_RRL_TS_BASES],
+				t->ts_bases[(ts_gen + 2) % DNS_RRL_TS_BASES],
+				t->ts_bases[(ts_gen + 3) % DNS_RRL_TS_BASES]);
 		}
-		rrl->ts_gen = ts_gen;
-		rrl->ts_bases[ts_gen] = now;
+		t->ts_gen = ts_gen;
+		t->ts_bases[ts_gen] = now;
 		ts = 0;
 	}
 
@@ -204,17 +206,18 @@ set_age(dns_rrl_t *rrl, dns_rrl_entry_t *e, isc_stdtime_t now) {
 }
 
 static isc_result_t
-expand_entries(dns_rrl_t *rrl, int newsize) {
+expand_entries(dns_rrl_t *rrl, dns_rrl_table_t *t, int newsize) {
 	unsigned int bsize;
 	dns_rrl_block_t *b;
 	dns_rrl_entry_t *e;
 	double rate;
-	int i;
+	int i, num_entries;
 
-	if (rrl->num_entries + newsize >= rrl->max_entries &&
+	num_entries = atomic_load_relaxed(&rrl->num_entries);
+	if (num_entries + newsize >= rrl->max_entries &&
 	    rrl->max_entries != 0)
 	{
-		newsize = rrl->max_entries - rrl->num_entries;
+		newsize = rrl->max_entries - num_entries;
 		if (newsize <= 0) {
 			return (ISC_R_SUCCESS);
 		}
@@ -224,17 +227,17 @@ expand_entries(dns_rrl_t *rrl, int newsize) {
 	 * Log expansions so that the user can tune max-table-size
 	 * and min-table-size.
 	 */
-	if (isc_log_wouldlog(DNS_RRL_LOG_DROP) && rrl->hash != NULL) {
-		rate = rrl->probes;
-		if (rrl->searches != 0) {
-			rate /= rrl->searches;
+	if (isc_log_wouldlog(DNS_RRL_LOG_DROP) && t->hash != NULL) {
+		rate = t->probes;
+		if (t->searches != 0) {
+			rate /= t->searches;
 		}
 		isc_log_write(DNS_LOGCATEGORY_RRL, DNS_LOGMODULE_REQUEST,
 			      DNS_RRL_LOG_DROP,
 			      "increase from %d to %d RRL entries with"
 			      " %d bins; average search length %.1f",
-			      rrl->num_entries, rrl->num_entries + newsize,
-			      rrl->hash->length, rate);
+			      num_entries, num_entries + newsize,
+			      t->hash->length, rate);
 	}
 
 	bsize = sizeof(dns_rrl_block_t) +
@@ -245,10 +248,11 @@ expand_entries(dns_rrl_t *rrl, int newsize) {
 	e = b->entries;
 	for (i = 0; i < newsize; ++i, ++e) {
 		ISC_LINK_INIT(e, hlink);
-		ISC_LIST_INITANDAPPEND(rrl->lru, e, lru);
+		ISC_LIST_INITANDAPPEND(t->lru, e, lru);
 	}
-	rrl->num_entries += newsize;
-	ISC_LIST_INITANDAPPEND(rrl->blocks, b, link);
+	t->num_entries += newsize;
+	atomic_fetch_add_relaxed(&rrl->num_entries, newsize);
+	ISC_LIST_INITANDAPPEND(t->blocks, b, link);
 
 	return (ISC_R_SUCCESS);
 }
@@ -260,12 +264,12 @@ get_bin(dns_rrl_hash_t *hash, unsigned int hval) {
 }
 
 static void
-free_old_hash(dns_rrl_t *rrl) {
+free_old_hash(dns_rrl_t *rrl, dns_rrl_table_t *t) {
 	dns_rrl_hash_t *old_hash;
 	dns_rrl_bin_t *old_bin;
 	dns_rrl_entry_t *e, *e_next;
 
-	old_hash = rrl->old_hash;
+	old_hash = t->old_hash;
 	for (old_bin = &old_hash->bins[0];
 	     old_bin < &old_hash->bins[old_hash->length]; ++old_bin)
 	{
@@ -279,27 +283,27 @@ free_old_hash(dns_rrl_t *rrl) {
 		    sizeof(*old_hash) +
 			    ISC_CHECKED_MUL((old_hash->length - 1),
 					    sizeof(old_hash->bins[0])));
-	rrl->old_hash = NULL;
+	t->old_hash = NULL;
 }
 
 static isc_result_t
-expand_rrl_hash(dns_rrl_t *rrl, isc_stdtime_t now) {
+expand_rrl_hash(dns_rrl_t *rrl, dns_rrl_table_t *t, isc_stdtime_t now) {
 	dns_rrl_hash_t *hash;
 	int old_bins, new_bins, hsize;
 	double rate;
 
-	if (rrl->old_hash != NULL) {
-		free_old_hash(rrl);
+	if (t->old_hash != NULL) {
+		free_old_hash(rrl, t);
 	}
 
 	/*
 	 * Most searches fail and so go to the end of the chain.
 	 * Use a small hash table load factor.
 	 */
-	old_bins = (rrl->hash == NULL) ? 0 : rrl->hash->length;
+	old_bins = (t->hash == NULL) ? 0 : t->hash->length;
 	new_bins = old_bins / 8 + old_bins;
-	if (new_bins < rrl->num_entries) {
-		new_bins = rrl->num_entries;
+	if (new_bins < t->num_entries) {
+		new_bins = t->num_entries;
 	}
 	new_bins = hash_divisor(new_bins);
 
@@ -307,41 +311,42 @@ expand_rrl_hash(dns_rrl_t *rrl, isc_stdtime_t now) {
 		ISC_CHECKED_MUL((new_bins - 1), sizeof(hash->bins[0]));
 	hash = isc_mem_cget(rrl->mctx, 1, hsize);
 	hash->length = new_bins;
-	rrl->hash_gen ^= 1;
-	hash->gen = rrl->hash_gen;
+	t->hash_gen ^= 1;
+	hash->gen = t->hash_gen;
 
 	if (isc_log_wouldlog(DNS_RRL_LOG_DROP) && old_bins != 0) {
-		rate = rrl->probes;
-		if (rrl->searches != 0) {
-			rate /= rrl->searches;
+		rate = t->probes;
+		if (t->searches != 0) {
+			rate /= t->searches;
 		}
 		isc_log_write(DNS_LOGCATEGORY_RRL, DNS_LOGMODULE_REQUEST,
 			      DNS_RRL_LOG_DROP,
 			      "increase from %d to %d RRL bins for"
 			      " %d entries; average search length %.1f",
-			      old_bins, new_bins, rrl->num_entries, rate);
+			      old_bins, new_bins, t->num_entries, rate);
 	}
 
-	rrl->old_hash = rrl->hash;
-	if (rrl->old_hash != NULL) {
-		rrl->old_hash->check_time = now;
+	t->old_hash = t->hash;
+	if (t->old_hash != NULL) {
+		t->old_hash->check_time = now;
 	}
-	rrl->hash = hash;
+	t->hash = hash;
 
 	return (ISC_R_SUCCESS);
 }
 
 static void
-ref_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, int probes, isc_stdtime_t now) {
+ref_entry(dns_rrl_t *rrl, dns_rrl_table_t *t, dns_rrl_entry_t *e, int probes,
+	  isc_stdtime_t now) {
 	/*
 	 * Make the entry most recently used.
 	 */
-	if (ISC_LIST_HEAD(rrl->lru) != e) {
-		if (e == rrl->last_logged) {
-			rrl->last_logged = ISC_LIST_PREV(e, lru);
+	if (ISC_LIST_HEAD(t->lru) != e) {
+		if (e == t->last_logged) {
+			t->last_logged = ISC_LIST_PREV(e, lru);
 		}
-		ISC_LIST_UNLINK(rrl->lru, e, lru);
-		ISC_LIST_PREPEND(rrl->lru, e, lru);
+		ISC_LIST_UNLINK(t->lru, e, lru);
+		ISC_LIST_PREPEND(t->lru, e, lru);
 	}
 
 	/*
@@ -350,17 +355,16 @@ ref_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, int probes, isc_stdtime_t now) {
 	 * old hash table.  It will migrate to the new hash table the next
 	 * time it is used or be cut loose when the old hash table is destroyed.
 	 */
-	rrl->probes += probes;
-	++rrl->searches;
-	if (rrl->searches > 100 &&
-	    delta_rrl_time(rrl->hash->check_time, now) > 1)
+	t->probes += probes;
+	++t->searches;
+	if (t->searches > 100 && delta_rrl_time(t->hash->check_time, now) > 1)
 	{
-		if (rrl->probes / rrl->searches > 2) {
-			expand_rrl_hash(rrl, now);
+		if (t->probes / t->searches > 2) {
+			expand_rrl_hash(rrl, t, now);
 		}
-		rrl->hash->check_time = now;
-		rrl->probes = 0;
-		rrl->searches = 0;
+		t->hash->check_time = now;
+		t->probes = 0;
+		t->searches = 0;
 	}
 }
 
@@ -462,6 +466,22 @@ make_key(const dns_rrl_t *rrl, dns_rrl_key_t *key,
 	}
 }
 
+/*
+ * Choose the table for a client.  Only the masked client address is
+ * used, so that every bucket for the address block is in the same table.
+ */
+static dns_rrl_table_t *
+get_table(dns_rrl_t *rrl, const isc_sockaddr_t *client_addr) {
+	dns_rrl_key_t key;
+	uint32_t hval;
+
+	make_key(rrl, &key, client_addr, NULL, dns_rdatatype_none, NULL, 0,
+		 DNS_RRL_RTYPE_FREE);
+	hval = isc_hash32(key.s.ip, sizeof(key.s.ip), true);
+
+	return (&rrl->tables[hval % DNS_RRL_TABLES]);
+}
+
 static dns_rrl_rate_t *
 get_rate(dns_rrl_t *rrl, dns_rrl_rtype_t rtype) {
 	switch (rtype) {
@@ -491,7 +511,7 @@ response_balance(dns_rrl_t *rrl, const dns_rrl_entry_t *e, int age) {
 		rate = 1;
 	} else {
 		ratep = get_rate(rrl, e->key.s.rtype);
-		rate = ratep->scaled;
+		rate = atomic_load_relaxed(&ratep->scaled);
 	}
 
 	balance = e->responses + age * rate;
@@ -505,8 +525,8 @@ response_balance(dns_rrl_t *rrl, const dns_rrl_entry_t *e, int age) {
  * Search for an entry for a response and optionally create it.
  */
 static dns_rrl_entry_t *
-get_entry(dns_rrl_t *rrl, const isc_sockaddr_t *client_addr, dns_zone_t *zone,
-	  dns_rdataclass_t qclass, dns_rdatatype_t qtype,
+get_entry(dns_rrl_t *rrl, dns_rrl_table_t *t, const isc_sockaddr_t *client_addr,
+	  dns_zone_t *zone, dns_rdataclass_t qclass, dns_rdatatype_t qtype,
 	  const dns_name_t *qname, dns_rrl_rtype_t rtype, isc_stdtime_t now,
 	  bool create, char *log_buf, unsigned int log_buf_len) {
 	dns_rrl_key_t key;
@@ -522,12 +542,12 @@ get_entry(dns_rrl_t *rrl, const isc_sockaddr_t *client_addr, dns_zone_t *zone,
 	/*
 	 * Look for the entry in the current hash table.
 	 */
-	new_bin = get_bin(rrl->hash, hval);
+	new_bin = get_bin(t->hash, hval);
 	probes = 1;
 	e = ISC_LIST_HEAD(*new_bin);
 	while (e != NULL) {
 		if (key_cmp(&e->key, &key)) {
-			ref_entry(rrl, e, probes, now);
+			ref_entry(rrl, t, e, probes, now);
 			return (e);
 		}
 		++probes;
@@ -537,15 +557,15 @@ get_entry(dns_rrl_t *rrl, const isc_sockaddr_t *client_addr, dns_zone_t *zone,
 	/*
 	 * Look in the old hash table.
 	 */
-	if (rrl->old_hash != NULL) {
-		old_bin = get_bin(rrl->old_hash, hval);
+	if (t->old_hash != NULL) {
+		old_bin = get_bin(t->old_hash, hval);
 		e = ISC_LIST_HEAD(*old_bin);
 		while (e != NULL) {
 			if (key_cmp(&e->key, &key)) {
 				ISC_LIST_UNLINK(*old_bin, e, hlink);
 				ISC_LIST_PREPEND(*new_bin, e, hlink);
-				e->hash_gen = rrl->hash_gen;
-				ref_entry(rrl, e, probes, now);
+				e->hash_gen = t->hash_gen;
+				ref_entry(rrl, t, e, probes, now);
 				return (e);
 			}
 			e = ISC_LIST_NEXT(e, hlink);
@@ -554,9 +574,9 @@ get_entry(dns_rrl_t *rrl, const isc_sockaddr_t *client_addr, dns_zone_t *zone,
 		/*
 		 * Discard previous hash table when all of its entries are old.
 		 */
-		age = delta_rrl_time(rrl->old_hash->check_time, now);
+		age = delta_rrl_time(t->old_hash->check_time, now);
 		if (age > rrl->window) {
-			free_old_hash(rrl);
+			free_old_hash(rrl, t);
 		}
 	}
 
@@ -570,12 +590,11 @@ get_entry(dns_rrl_t *rrl, const isc_sockaddr_t *client_addr, dns_zone_t *zone,
 	 * Try to make more entries if none are idle.
 	 * Steal the oldest entry if we cannot create more.
 	 */
-	for (e = ISC_LIST_TAIL(rrl->lru); e != NULL; e = ISC_LIST_PREV(e, lru))
-	{
+	for (e = ISC_LIST_TAIL(t->lru); e != NULL; e = ISC_LIST_PREV(e, lru)) {
 		if (!ISC_LINK_LINKED(e, hlink)) {
 			break;
 		}
-		age = get_age(rrl, e, now);
+		age = get_age(t, e, now);
 		if (age <= 1) {
 			e = NULL;
 			break;
@@ -585,26 +604,26 @@ get_entry(dns_rrl_t *rrl, const isc_sockaddr_t *client_addr, dns_zone_t *zone,
 		}
 	}
 	if (e == NULL) {
-		expand_entries(rrl, ISC_MIN((rrl->num_entries + 1) / 2, 1000));
-		e = ISC_LIST_TAIL(rrl->lru);
+		expand_entries(rrl, t, ISC_MIN((t->num_entries + 1) / 2, 1000));
+		e = ISC_LIST_TAIL(t->lru);
 	}
 	if (e->logged) {
-		log_end(rrl, e, true, log_buf, log_buf_len);
+		log_end(rrl, t, e, true, log_buf, log_buf_len);
 	}
 	if (ISC_LINK_LINKED(e, hlink)) {
-		if (e->hash_gen == rrl->hash_gen) {
-			hash = rrl->hash;
+		if (e->hash_gen == t->hash_gen) {
+			hash = t->hash;
 		} else {
-			hash = rrl->old_hash;
+			hash = t->old_hash;
 		}
 		old_bin = get_bin(hash, hash_key(&e->key));
 		ISC_LIST_UNLINK(*old_bin, e, hlink);
 	}
 	ISC_LIST_PREPEND(*new_bin, e, hlink);
-	e->hash_gen = rrl->hash_gen;
+	e->hash_gen = t->hash_gen;
 	e->key = key;
 	e->ts_valid = false;
-	ref_entry(rrl, e, probes, now);
+	ref_entry(rrl, t, e, probes, now);
 	return (e);
 }
 
@@ -625,9 +644,9 @@ debit_log(const dns_rrl_entry_t *e, int age, const char *action) {
 }
 
 static dns_rrl_result_t
-debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
-		const isc_sockaddr_t *client_addr, isc_stdtime_t now,
-		char *log_buf, unsigned int log_buf_len) {
+debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_table_t *t, dns_rrl_entry_t *e,
+		double qps, double scale, const isc_sockaddr_t *client_addr,
+		isc_stdtime_t now, char *log_buf, unsigned int log_buf_len) {
 	int rate, new_rate, slip, new_slip, age, log_secs, min;
 	dns_rrl_rate_t *ratep;
 	dns_rrl_entry_t const *credit_e;
@@ -646,11 +665,11 @@ debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
 		/*
 		 * The limit for clients that have used TCP is not scaled.
 		 */
-		credit_e = get_entry(
-			rrl, client_addr, NULL, 0, dns_rdatatype_none, NULL,
-			DNS_RRL_RTYPE_TCP, now, false, log_buf, log_buf_len);
+		credit_e = get_entry(rrl, t, client_addr, NULL, 0,
+				     dns_rdatatype_none, NULL, DNS_RRL_RTYPE_TCP,
+				     now, false, log_buf, log_buf_len);
 		if (credit_e != NULL) {
-			age = get_age(rrl, e, now);
+			age = get_age(t, e, now);
 			if (age < rrl->window) {
 				scale = 1.0;
 			}
@@ -661,7 +680,7 @@ debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
 		if (new_rate < 1) {
 			new_rate = 1;
 		}
-		if (ratep->scaled != new_rate) {
+		if (atomic_load_relaxed(&ratep->scaled) != new_rate) {
 			isc_log_write(DNS_LOGCATEGORY_RRL,
 				      DNS_LOGMODULE_REQUEST, DNS_RRL_LOG_DEBUG1,
 				      "%d qps scaled %s by %.2f"
@@ -669,7 +688,7 @@ debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
 				      (int)qps, ratep->str, scale, rate,
 				      new_rate);
 			rate = new_rate;
-			ratep->scaled = rate;
+			atomic_store_relaxed(&ratep->scaled, rate);
 		}
 	}
 
@@ -680,7 +699,7 @@ debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
 	 * Treat entries older than the window as if they were just created
 	 * Credit other entries.
 	 */
-	age = get_age(rrl, e, now);
+	age = get_age(t, e, now);
 	if (age > 0) {
 		/*
 		 * Credit tokens earned during elapsed time.
@@ -712,7 +731,7 @@ debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
 			e->log_secs = log_secs;
 		}
 	}
-	set_age(rrl, e, now);
+	set_age(t, e, now);
 
 	/*
 	 * Debit the entry for this response.
@@ -737,14 +756,14 @@ debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
 		if (new_slip < 2) {
 			new_slip = 2;
 		}
-		if (rrl->slip.scaled != new_slip) {
+		if (atomic_load_relaxed(&rrl->slip.scaled) != new_slip) {
 			isc_log_write(DNS_LOGCATEGORY_RRL,
 				      DNS_LOGMODULE_REQUEST, DNS_RRL_LOG_DEBUG1,
 				      "%d qps scaled slip"
 				      " by %.2f from %d to %d",
 				      (int)qps, scale, slip, new_slip);
 			slip = new_slip;
-			rrl->slip.scaled = slip;
+			atomic_store_relaxed(&rrl->slip.scaled, slip);
 		}
 	}
 	if (slip != 0 && e->key.s.rtype != DNS_RRL_RTYPE_ALL) {
@@ -768,10 +787,10 @@ debit_rrl_entry(dns_rrl_t *rrl, dns_rrl_entry_t *e, double qps, double scale,
 }
 
 static dns_rrl_qname_buf_t *
-get_qname(dns_rrl_t *rrl, const dns_rrl_entry_t *e) {
+get_qname(dns_rrl_table_t *t, const dns_rrl_entry_t *e) {
 	dns_rrl_qname_buf_t *qbuf;
 
-	qbuf = rrl->qnames[e->log_qname];
+	qbuf = t->qnames[e->log_qname];
 	if (qbuf == NULL || qbuf->e != e) {
 		return (NULL);
 	}
@@ -779,13 +798,13 @@ get_qname(dns_rrl_t *rrl, const dns_rrl_entry_t *e) {
 }
 
 static void
-free_qname(dns_rrl_t *rrl, dns_rrl_entry_t *e) {
+free_qname(dns_rrl_table_t *t, dns_rrl_entry_t *e) {
 	dns_rrl_qname_buf_t *qbuf;
 
-	qbuf = get_qname(rrl, e);
+	qbuf = get_qname(t, e);
 	if (qbuf != NULL) {
 		qbuf->e = NULL;
-		ISC_LIST_APPEND(rrl->qname_free, qbuf, link);
+		ISC_LIST_APPEND(t->qname_free, qbuf, link);
 	}
 }
 
@@ -810,11 +829,11 @@ add_log_str(isc_buffer_t *lb, const char *str, unsigned int str_len) {
  * Build strings for the logs
  */
 static void
-make_log_buf(dns_rrl_t *rrl, dns_rrl_entry_t *e, const char *str1,
-	     const char *str2, bool plural, const dns_name_t *qname,
-	     bool save_qname, dns_rrl_result_t rrl_result,
-	     isc_result_t resp_result, char *log_buf,
-	     unsigned int log_buf_len) {
+make_log_buf(dns_rrl_t *rrl, dns_rrl_table_t *t, dns_rrl_entry_t *e,
+	     const char *str1, const char *str2, bool plural,
+	     const dns_name_t *qname, bool save_qname,
+	     dns_rrl_result_t rrl_result, isc_result_t resp_result,
+	     char *log_buf, unsigned int log_buf_len) {
 	isc_buffer_t lb;
 	dns_rrl_qname_buf_t *qbuf;
 	isc_netaddr_t cidr;
@@ -906,23 +925,23 @@ make_log_buf(dns_rrl_t *rrl, dns_rrl_entry_t *e, const char *str1,
 	    e->key.s.rtype == DNS_RRL_RTYPE_NODATA ||
 	    e->key.s.rtype == DNS_RRL_RTYPE_NXDOMAIN)
 	{
-		qbuf = get_qname(rrl, e);
+		qbuf = get_qname(t, e);
 		if (save_qname && qbuf == NULL && qname != NULL &&
 		    dns_name_isabsolute(qname))
 		{
 			/*
 			 * Capture the qname for the "stop limiting" message.
 			 */
-			qbuf = ISC_LIST_TAIL(rrl->qname_free);
+			qbuf = ISC_LIST_TAIL(t->qname_free);
 			if (qbuf != NULL) {
-				ISC_LIST_UNLINK(rrl->qname_free, qbuf, link);
-			} else if (rrl->num_qnames < DNS_RRL_QNAMES) {
+				ISC_LIST_UNLINK(t->qname_free, qbuf, link);
+			} else if (t->num_qnames < DNS_RRL_QNAMES) {
 				qbuf = isc_mem_get(rrl->mctx, sizeof(*qbuf));
 				*qbuf = (dns_rrl_qname_buf_t){
-					.index = rrl->num_qnames,
+					.index = t->num_qnames,
 				};
 				ISC_LINK_INIT(qbuf, link);
-				rrl->qnames[rrl->num_qnames++] = qbuf;
+				t->qnames[t->num_qnames++] = qbuf;
 			}
 			if (qbuf != NULL) {
 				e->log_qname = qbuf->index;
@@ -962,19 +981,19 @@ make_log_buf(dns_rrl_t *rrl, dns_rrl_entry_t *e, const char *str1,
 }
 
 static void
-log_end(dns_rrl_t *rrl, dns_rrl_entry_t *e, bool early, char *log_buf,
-	unsigned int log_buf_len) {
+log_end(dns_rrl_t *rrl, dns_rrl_table_t *t, dns_rrl_entry_t *e, bool early,
+	char *log_buf, unsigned int log_buf_len) {
 	if (e->logged) {
-		make_log_buf(rrl, e, early ? "*" : NULL,
+		make_log_buf(rrl, t, e, early ? "*" : NULL,
 			     rrl->log_only ? "would stop limiting "
 					   : "stop limiting ",
 			     true, NULL, false, DNS_RRL_RESULT_OK,
 			     ISC_R_SUCCESS, log_buf, log_buf_len);
 		isc_log_write(DNS_LOGCATEGORY_RRL, DNS_LOGMODULE_REQUEST,
 			      DNS_RRL_LOG_DROP, "%s", log_buf);
-		free_qname(rrl, e);
+		free_qname(t, e);
 		e->logged = false;
-		--rrl->num_logged;
+		--t->num_logged;
 	}
 }
 
@@ -982,17 +1001,17 @@ log_end(dns_rrl_t *rrl, dns_rrl_entry_t *e, bool early, char *log_buf,
  * Log messages for streams that have stopped being rate limited.
  */
 static void
-log_stops(dns_rrl_t *rrl, isc_stdtime_t now, int limit, char *log_buf,
-	  unsigned int log_buf_len) {
+log_stops(dns_rrl_t *rrl, dns_rrl_table_t *t, isc_stdtime_t now, int limit,
+	  char *log_buf, unsigned int log_buf_len) {
 	dns_rrl_entry_t *e;
 	int age;
 
-	for (e = rrl->last_logged; e != NULL; e = ISC_LIST_PREV(e, lru)) {
+	for (e = t->last_logged; e != NULL; e = ISC_LIST_PREV(e, lru)) {
 		if (!e->logged) {
 			continue;
 		}
 		if (now != 0) {
-			age = get_age(rrl, e, now);
+			age = get_age(t, e, now);
 			if (age < DNS_RRL_STOP_LOG_SECS ||
 			    response_balance(rrl, e, age) < 0)
 			{
@@ -1000,8 +1019,8 @@ log_stops(dns_rrl_t *rrl, isc_stdtime_t now, int limit, char *log_buf,
 			}
 		}
 
-		log_end(rrl, e, now == 0, log_buf, log_buf_len);
-		if (rrl->num_logged <= 0) {
+		log_end(rrl, t, e, now == 0, log_buf, log_buf_len);
+		if (t->num_logged <= 0) {
 			break;
 		}
 
@@ -1009,15 +1028,15 @@ log_stops(dns_rrl_t *rrl, isc_stdtime_t now, int limit, char *log_buf,
 		 * Too many messages could stall real work.
 		 */
 		if (--limit < 0) {
-			rrl->last_logged = ISC_LIST_PREV(e, lru);
+			t->last_logged = ISC_LIST_PREV(e, lru);
 			return;
 		}
 	}
 	if (e == NULL) {
-		INSIST(rrl->num_logged == 0);
-		rrl->log_stops_time = now;
+		INSIST(t->num_logged == 0);
+		t->log_stops_time = now;
 	}
-	rrl->last_logged = e;
+	t->last_logged = e;
 }
 
 /*
@@ -1029,6 +1048,7 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 	const dns_name_t *qname, isc_result_t resp_result, isc_stdtime_t now,
 	bool wouldlog, char *log_buf, unsigned int log_buf_len) {
 	dns_rrl_t *rrl;
+	dns_rrl_table_t *t;
 	dns_rrl_rtype_t rtype;
 	dns_rrl_entry_t *e;
 	isc_netaddr_t netclient;
@@ -1050,8 +1070,6 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 		}
 	}
 
-	LOCK(&rrl->lock);
-
 	/*
 	 * Estimate total query per second rate when scaling by qps.
 	 */
@@ -1059,6 +1077,7 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 		qps = 0.0;
 		scale = 1.0;
 	} else {
+		LOCK(&rrl->lock);
 		++rrl->qps_responses;
 		secs = delta_rrl_time(rrl->qps_time, now);
 		if (secs <= 0) {
@@ -1082,14 +1101,18 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 				qps = rrl->qps;
 			}
 		}
+		UNLOCK(&rrl->lock);
 		scale = rrl->qps_scale / qps;
 	}
 
+	t = get_table(rrl, client_addr);
+	LOCK(&t->lock);
+
 	/*
 	 * Do maintenance once per second.
 	 */
-	if (rrl->num_logged > 0 && rrl->log_stops_time != now) {
-		log_stops(rrl, now, 8, log_buf, log_buf_len);
+	if (t->num_logged > 0 && t->log_stops_time != now) {
+		log_stops(rrl, t, now, 8, log_buf, log_buf_len);
 	}
 
 	/*
@@ -1098,16 +1121,16 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 	 */
 	if (is_tcp) {
 		if (scale < 1.0) {
-			e = get_entry(rrl, client_addr, NULL, 0,
+			e = get_entry(rrl, t, client_addr, NULL, 0,
 				      dns_rdatatype_none, NULL,
 				      DNS_RRL_RTYPE_TCP, now, true, log_buf,
 				      log_buf_len);
 			if (e != NULL) {
 				e->responses = -(rrl->window + 1);
-				set_age(rrl, e, now);
+				set_age(t, e, now);
 			}
 		}
-		UNLOCK(&rrl->lock);
+		UNLOCK(&t->lock);
 		return (DNS_RRL_RESULT_OK);
 	}
 
@@ -1132,10 +1155,10 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 		rtype = DNS_RRL_RTYPE_ERROR;
 		break;
 	}
-	e = get_entry(rrl, client_addr, zone, qclass, qtype, qname, rtype, now,
-		      true, log_buf, log_buf_len);
+	e = get_entry(rrl, t, client_addr, zone, qclass, qtype, qname, rtype,
+		      now, true, log_buf, log_buf_len);
 	if (e == NULL) {
-		UNLOCK(&rrl->lock);
+		UNLOCK(&t->lock);
 		return (DNS_RRL_RESULT_OK);
 	}
 
@@ -1144,14 +1167,14 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 		 * Do not worry about speed or releasing the lock.
 		 * This message appears before messages from debit_rrl_entry().
 		 */
-		make_log_buf(rrl, e, "consider limiting ", NULL, false, qname,
-			     false, DNS_RRL_RESULT_OK, resp_result, log_buf,
-			     log_buf_len);
+		make_log_buf(rrl, t, e, "consider limiting ", NULL, false,
+			     qname, false, DNS_RRL_RESULT_OK, resp_result,
+			     log_buf, log_buf_len);
 		isc_log_write(DNS_LOGCATEGORY_RRL, DNS_LOGMODULE_REQUEST,
 			      DNS_RRL_LOG_DEBUG1, "%s", log_buf);
 	}
 
-	rrl_result = debit_rrl_entry(rrl, e, qps, scale, client_addr, now,
+	rrl_result = debit_rrl_entry(rrl, t, e, qps, scale, client_addr, now,
 				     log_buf, log_buf_len);
 
 	if (rrl->all_per_second.r != 0) {
@@ -1166,21 +1189,21 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 		dns_rrl_entry_t *e_all;
 		dns_rrl_result_t rrl_all_result;
 
-		e_all = get_entry(rrl, client_addr, zone, 0, dns_rdatatype_none,
-				  NULL, DNS_RRL_RTYPE_ALL, now, true, log_buf,
-				  log_buf_len);
+		e_all = get_entry(rrl, t, client_addr, zone, 0,
+				  dns_rdatatype_none, NULL, DNS_RRL_RTYPE_ALL,
+				  now, true, log_buf, log_buf_len);
 		if (e_all == NULL) {
-			UNLOCK(&rrl->lock);
+			UNLOCK(&t->lock);
 			return (DNS_RRL_RESULT_OK);
 		}
-		rrl_all_result = debit_rrl_entry(rrl, e_all, qps, scale,
+		rrl_all_result = debit_rrl_entry(rrl, t, e_all, qps, scale,
 						 client_addr, now, log_buf,
 						 log_buf_len);
 		if (rrl_all_result != DNS_RRL_RESULT_OK) {
 			e = e_all;
 			rrl_result = rrl_all_result;
 			if (isc_log_wouldlog(DNS_RRL_LOG_DEBUG1)) {
-				make_log_buf(rrl, e,
+				make_log_buf(rrl, t, e,
 					     "prefer all-per-second limiting ",
 					     NULL, true, qname, false,
 					     DNS_RRL_RESULT_OK, resp_result,
@@ -1194,7 +1217,7 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 	}
 
 	if (rrl_result == DNS_RRL_RESULT_OK) {
-		UNLOCK(&rrl->lock);
+		UNLOCK(&t->lock);
 		return (DNS_RRL_RESULT_OK);
 	}
 
@@ -1204,14 +1227,14 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 	if ((!e->logged || e->log_secs >= DNS_RRL_MAX_LOG_SECS) &&
 	    isc_log_wouldlog(DNS_RRL_LOG_DROP))
 	{
-		make_log_buf(rrl, e, rrl->log_only ? "would " : NULL,
+		make_log_buf(rrl, t, e, rrl->log_only ? "would " : NULL,
 			     e->logged ? "continue limiting " : "limit ", true,
 			     qname, true, DNS_RRL_RESULT_OK, resp_result,
 			     log_buf, log_buf_len);
 		if (!e->logged) {
 			e->logged = true;
-			if (++rrl->num_logged <= 1) {
-				rrl->last_logged = e;
+			if (++t->num_logged <= 1) {
+				t->last_logged = e;
 			}
 		}
 		e->log_secs = 0;
@@ -1220,7 +1243,7 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 		 * Avoid holding the lock.
 		 */
 		if (!wouldlog) {
-			UNLOCK(&rrl->lock);
+			UNLOCK(&t->lock);
 			e = NULL;
 		}
 		isc_log_write(DNS_LOGCATEGORY_RRL, DNS_LOGMODULE_REQUEST,
@@ -1231,7 +1254,7 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 	 * Make a log message for the caller.
 	 */
 	if (wouldlog) {
-		make_log_buf(rrl, e,
+		make_log_buf(rrl, t, e,
 			     rrl->log_only ? "would rate limit "
 					   : "rate limit ",
 			     NULL, false, qname, false, rrl_result, resp_result,
@@ -1244,68 +1267,78 @@ dns_rrl(dns_view_t *view, dns_zone_t *zone, const isc_sockaddr_t *client_addr,
 		 * the ending log message.
 		 */
 		if (!e->logged) {
-			free_qname(rrl, e);
+			free_qname(t, e);
 		}
-		UNLOCK(&rrl->lock);
+		UNLOCK(&t->lock);
 	}
 
 	return (rrl_result);
 }
 
-void
-dns_rrl_view_destroy(dns_view_t *view) {
-	dns_rrl_t *rrl;
+static void
+table_destroy(dns_rrl_t *rrl, dns_rrl_table_t *t) {
 	dns_rrl_block_t *b;
 	dns_rrl_hash_t *h;
 	char log_buf[DNS_RRL_LOG_BUF_LEN];
 	int i;
 
-	rrl = view->rrl;
-	if (rrl == NULL) {
-		return;
-	}
-	view->rrl = NULL;
-
-	/*
-	 * Assume the caller takes care of locking the view and anything else.
-	 */
-
-	if (rrl->num_logged > 0) {
-		log_stops(rrl, 0, INT32_MAX, log_buf, sizeof(log_buf));
+	if (t->num_logged > 0) {
+		log_stops(rrl, t, 0, INT32_MAX, log_buf, sizeof(log_buf));
 	}
 
 	for (i = 0; i < DNS_RRL_QNAMES; ++i) {
-		if (rrl->qnames[i] == NULL) {
+		if (t->qnames[i] == NULL) {
 			break;
 		}
-		isc_mem_put(rrl->mctx, rrl->qnames[i], sizeof(*rrl->qnames[i]));
-	}
-
-	if (rrl->exempt != NULL) {
-		dns_acl_detach(&rrl->exempt);
+		isc_mem_put(rrl->mctx, t->qnames[i], sizeof(*t->qnames[i]));
 	}
 
-	isc_mutex_destroy(&rrl->lock);
+	isc_mutex_destroy(&t->lock);
 
-	while (!ISC_LIST_EMPTY(rrl->blocks)) {
-		b = ISC_LIST_HEAD(rrl->blocks);
-		ISC_LIST_UNLINK(rrl->blocks, b, link);
+	while (!ISC_LIST_EMPTY(t->blocks)) {
+		b = ISC_LIST_HEAD(t->blocks);
+		ISC_LIST_UNLINK(t->blocks, b, link);
 		isc_mem_put(rrl->mctx, b, b->size);
 	}
 
-	h = rrl->hash;
+	h = t->hash;
 	if (h != NULL) {
 		isc_mem_put(rrl->mctx, h,
 			    sizeof(*h) + ISC_CHECKED_MUL((h->length - 1),
 							 sizeof(h->bins[0])));
 	}
 
-	h = rrl->old_hash;
+	h = t->old_hash;
 	if (h != NULL) {
 		isc_mem_put(rrl->mctx, h,
 			    sizeof(*h) + ISC_CHECKED_MUL((h->length - 1),
 							 sizeof(h->bins[0])));
 	}
+}
+
+void
+dns_rrl_view_destroy(dns_view_t *view) {
+	dns_rrl_t *rrl;
+
+	rrl = view->rrl;
+	if (rrl == NULL) {
+		return;
+	}
+	view->rrl = NULL;
+
+	/*
+	 * Assume the caller takes care of locking the view and anything else.
+	 */
+
+	for (size_t i = 0; i < DNS_RRL_TABLES; i++) {
+		table_destroy(rrl, &rrl->tables[i]);
+	}
+
+	if (rrl->exempt != NULL) {
+		dns_acl_detach(&rrl->exempt);
+	}
+
+	isc_mutex_destroy(&rrl->lock);
 
 	isc_mem_putanddetach(&rrl->mctx, rrl, sizeof(*rrl));
 }
@@ -1314,27 +1347,42 @@ isc_result_t
 dns_rrl_init(dns_rrl_t **rrlp, dns_view_t *view, int min_entries) {
 	dns_rrl_t *rrl;
 	isc_result_t result;
+	isc_stdtime_t now = isc_stdtime_now();
 
 	*rrlp = NULL;
 
 	rrl = isc_mem_get(view->mctx, sizeof(*rrl));
-	*rrl = (dns_rrl_t){
-		.ts_bases[0] = isc_stdtime_now(),
-	};
+	*rrl = (dns_rrl_t){ 0 };
 	isc_mem_attach(view->mctx, &rrl->mctx);
 	isc_mutex_init(&rrl->lock);
+	atomic_init(&rrl->num_entries, 0);
 
-	view->rrl = rrl;
+	/*
+	 * Spread the initial entries over the tables.
+	 */
+	min_entries = (min_entries + DNS_RRL_TABLES - 1) / DNS_RRL_TABLES;
+	for (size_t i = 0; i < DNS_RRL_TABLES; i++) {
+		dns_rrl_table_t *t = &rrl->tables[i];
 
-	result = expand_entries(rrl, min_entries);
-	if (result != ISC_R_SUCCESS) {
-		dns_rrl_view_destroy(view);
-		return (result);
+		t->ts_bases[0] = now;
+		isc_mutex_init(&t->lock);
 	}
-	result = expand_rrl_hash(rrl, 0);
-	if (result != ISC_R_SUCCESS) {
-		dns_rrl_view_destroy(view);
-		return (result);
+
+	view->rrl = rrl;
+
+	for (size_t i = 0; i < DNS_RRL_TABLES; i++) {
+		dns_rrl_table_t *t = &rrl->tables[i];
+
+		result = expand_entries(rrl, t, min_entries);
+		if (result != ISC_R_SUCCESS) {
+			dns_rrl_view_destroy(view);
+			return (result);
+		}
+		result = expand_rrl_hash(rrl, t, 0);
+		if (result != ISC_R_SUCCESS) {
+			dns_rrl_view_destroy(view);
+			return (result);
+		}
 	}
 
 	*rrlp = rrl;
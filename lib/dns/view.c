@@ -119,6 +119,7 @@ dns_view_create(isc_mem_t *mctx, dns_dispatchmgr_t *dispatchmgr,
 		.staleanswersok = dns_stale_answer_conf,
 		.sendcookie = true,
 		.synthfromdnssec = true,
+		.nxdomaincut = true,
 		.trust_anchor_telemetry = true,
 		.root_key_sentinel = true,
 		.udpsize = DEFAULT_EDNS_BUFSIZE,
@@ -757,6 +758,35 @@ dns_view_addzone(dns_view_t *view, dns_zone_t *zone) {
 	return (result);
 }
 
+void
+dns_view_beginzonebatch(dns_view_t *view) {
+	dns_zt_t *zonetable = NULL;
+
+	REQUIRE(DNS_VIEW_VALID(view));
+	REQUIRE(!view->frozen);
+
+	rcu_read_lock();
+	zonetable = rcu_dereference(view->zonetable);
+	if (zonetable != NULL) {
+		dns_zt_beginbatch(zonetable);
+	}
+	rcu_read_unlock();
+}
+
+void
+dns_view_endzonebatch(dns_view_t *view) {
+	dns_zt_t *zonetable = NULL;
+
+	REQUIRE(DNS_VIEW_VALID(view));
+
+	rcu_read_lock();
+	zonetable = rcu_dereference(view->zonetable);
+	if (zonetable != NULL) {
+		dns_zt_endbatch(zonetable);
+	}
+	rcu_read_unlock();
+}
+
 isc_result_t
 dns_view_delzone(dns_view_t *view, dns_zone_t *zone) {
 	isc_result_t result;
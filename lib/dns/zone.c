@@ -435,6 +435,12 @@ struct dns_zone {
 	 */
 	bool added;
 
+	/*%
+	 * Digest of the configuration the zone was last configured
+	 * from, or zero if unknown.
+	 */
+	uint64_t cfghash;
+
 	/*%
 	 * True if added by automatically by named.
 	 */
@@ -629,6 +635,11 @@ struct dns_zonemgr {
 	unsigned int startupnotifyrate;
 	unsigned int serialqueryrate;
 	unsigned int startupserialqueryrate;
+	unsigned int serialquerybatch;
+
+	/* Locked by soabatchlock. */
+	isc_hashmap_t *soabatches;
+	isc_mutex_t soabatchlock;
 
 	/* Locked by urlock. */
 	/* LRU cache */
@@ -1916,6 +1927,7 @@ dns_zone_rpz_enable_db(dns_zone_t *zone, dns_db_t *db) {
 		return;
 	}
 	REQUIRE(zone->rpzs != NULL);
+	dns_rpz_setjournal(zone->rpzs->zones[zone->rpz_num], zone->journal);
 	dns_rpz_dbupdate_register(db, zone->rpzs->zones[zone->rpz_num]);
 }
 
@@ -14220,8 +14232,148 @@ detach:
 struct soaquery {
 	dns_zone_t *zone;
 	isc_rlevent_t *rlevent;
+	bool canceled;
+	bool batched;
+	ISC_LINK(struct soaquery) link;
+};
+
+/*%
+ * SOA queries for zones on the same loop that are waiting to be sent
+ * to the same primary.  The batch takes a single slot in the refresh
+ * rate limiter, and when it is released its queries are sent together
+ * over one pipelined TCP connection, unless there is only one of them.
+ */
+struct soabatch {
+	dns_zonemgr_t *zmgr;
+	isc_loop_t *loop;
+	isc_sockaddr_t primary;
+	uint32_t hashval;
+	unsigned int count;
+	bool queued; /* Still in zmgr->soabatches */
+	isc_rlevent_t *rlevent;
+	ISC_LIST(struct soaquery) queries;
 };
 
+struct soabatch_key {
+	isc_loop_t *loop;
+	const isc_sockaddr_t *primary;
+};
+
+static bool
+soabatch_match(void *node, const void *key0) {
+	const struct soabatch *batch = node;
+	const struct soabatch_key *key = key0;
+
+	return (batch->loop == key->loop &&
+		isc_sockaddr_equal(&batch->primary, key->primary));
+}
+
+static void
+soa_batch(void *arg) {
+	struct soabatch *batch = (struct soabatch *)arg;
+	dns_zonemgr_t *zmgr = batch->zmgr;
+	ISC_LIST(struct soaquery) queries;
+	struct soaquery *sq = NULL;
+	bool canceled = batch->rlevent->canceled;
+
+	/*
+	 * Queries queued for this primary from now on start a new batch.
+	 */
+	LOCK(&zmgr->soabatchlock);
+	if (batch->queued) {
+		struct soabatch_key key = {
+			.loop = batch->loop,
+			.primary = &batch->primary,
+		};
+		RUNTIME_CHECK(isc_hashmap_delete(zmgr->soabatches,
+						 batch->hashval, soabatch_match,
+						 &key) == ISC_R_SUCCESS);
+		batch->queued = false;
+	}
+	UNLOCK(&zmgr->soabatchlock);
+
+	/*
+	 * Each query holds a reference to its zone, and so to the zone
+	 * manager, so free the batch before sending the queries.
+	 */
+	ISC_LIST_INIT(queries);
+	ISC_LIST_MOVE(queries, batch->queries);
+	isc_rlevent_free(&batch->rlevent);
+	isc_mem_put(zmgr->mctx, batch, sizeof(*batch));
+
+	/*
+	 * There is nothing to pipeline in a batch of one, so send its
+	 * query the same way as an unbatched one.
+	 */
+	sq = ISC_LIST_HEAD(queries);
+	if (sq != NULL && ISC_LIST_NEXT(sq, link) == NULL) {
+		sq->batched = false;
+	}
+
+	while ((sq = ISC_LIST_HEAD(queries)) != NULL) {
+		ISC_LIST_UNLINK(queries, sq, link);
+		sq->canceled = canceled;
+		soa_query(sq);
+	}
+}
+
+/*
+ * Add the SOA query 'sq' for 'zone' to the batch for the zone's loop
+ * and current primary, creating the batch if there is none yet.
+ */
+static isc_result_t
+queue_soa_batch(dns_zone_t *zone, struct soaquery *sq) {
+	dns_zonemgr_t *zmgr = zone->zmgr;
+	struct soabatch *batch = NULL;
+	isc_sockaddr_t primary = dns_remote_curraddr(&zone->primaries);
+	struct soabatch_key key = {
+		.loop = zone->loop,
+		.primary = &primary,
+	};
+	uint32_t hashval = isc_sockaddr_hash(&primary, false) ^
+			   isc_hash32(&zone->loop, sizeof(zone->loop), true);
+	isc_result_t result;
+
+	LOCK(&zmgr->soabatchlock);
+	result = isc_hashmap_find(zmgr->soabatches, hashval, soabatch_match,
+				  &key, (void **)&batch);
+	if (result != ISC_R_SUCCESS) {
+		batch = isc_mem_get(zmgr->mctx, sizeof(*batch));
+		*batch = (struct soabatch){
+			.zmgr = zmgr,
+			.loop = zone->loop,
+			.primary = primary,
+			.hashval = hashval,
+			.queries = ISC_LIST_INITIALIZER,
+		};
+		result = isc_ratelimiter_enqueue(zmgr->refreshrl, zone->loop,
+						 soa_batch, batch,
+						 &batch->rlevent);
+		if (result != ISC_R_SUCCESS) {
+			isc_mem_put(zmgr->mctx, batch, sizeof(*batch));
+			goto unlock;
+		}
+		RUNTIME_CHECK(isc_hashmap_add(zmgr->soabatches, hashval,
+					      soabatch_match, &key, batch,
+					      NULL) == ISC_R_SUCCESS);
+		batch->queued = true;
+	}
+
+	sq->batched = true;
+	ISC_LIST_APPEND(batch->queries, sq, link);
+	if (++batch->count >= zmgr->serialquerybatch) {
+		RUNTIME_CHECK(isc_hashmap_delete(zmgr->soabatches, hashval,
+						 soabatch_match,
+						 &key) == ISC_R_SUCCESS);
+		batch->queued = false;
+	}
+	result = ISC_R_SUCCESS;
+
+unlock:
+	UNLOCK(&zmgr->soabatchlock);
+	return (result);
+}
+
 static void
 queue_soa_query(dns_zone_t *zone) {
 	isc_result_t result;
@@ -14239,7 +14391,7 @@ queue_soa_query(dns_zone_t *zone) {
 	}
 
 	sq = isc_mem_get(zone->mctx, sizeof(*sq));
-	*sq = (struct soaquery){ .zone = NULL };
+	*sq = (struct soaquery){ .link = ISC_LINK_INITIALIZER };
 
 	/* Shows in the statistics channel the duration of the current step. */
 	zone->xfrintime = isc_time_now();
@@ -14248,8 +14400,16 @@ queue_soa_query(dns_zone_t *zone) {
 	 * Attach so that we won't clean up until the event is delivered.
 	 */
 	zone_iattach(zone, &sq->zone);
-	result = isc_ratelimiter_enqueue(zone->zmgr->refreshrl, zone->loop,
-					 soa_query, sq, &sq->rlevent);
+	if (zone->zmgr->serialquerybatch > 1 &&
+	    dns_remote_count(&zone->primaries) > 0 &&
+	    !dns_remote_done(&zone->primaries))
+	{
+		result = queue_soa_batch(zone, sq);
+	} else {
+		result = isc_ratelimiter_enqueue(zone->zmgr->refreshrl,
+						 zone->loop, soa_query, sq,
+						 &sq->rlevent);
+	}
 	if (result != ISC_R_SUCCESS) {
 		zone_idetach(&sq->zone);
 		isc_mem_put(zone->mctx, sq, sizeof(*sq));
@@ -14277,8 +14437,13 @@ soa_query(void *arg) {
 
 	ENTER;
 
+	if (sq->rlevent != NULL) {
+		sq->canceled = sq->rlevent->canceled;
+		isc_rlevent_free(&sq->rlevent);
+	}
+
 	LOCK_ZONE(zone);
-	if (sq->rlevent->canceled || DNS_ZONE_FLAG(zone, DNS_ZONEFLG_EXITING) ||
+	if (sq->canceled || DNS_ZONE_FLAG(zone, DNS_ZONEFLG_EXITING) ||
 	    zone->view->requestmgr == NULL)
 	{
 		if (DNS_ZONE_FLAG(zone, DNS_ZONEFLG_EXITING)) {
@@ -14351,6 +14516,12 @@ again:
 
 	options = DNS_ZONE_FLAG(zone, DNS_ZONEFLG_USEVC) ? DNS_REQUESTOPT_TCP
 							 : 0;
+	if (sq->batched) {
+		/*
+		 * Pipeline the batch over a shared TCP connection.
+		 */
+		options |= DNS_REQUESTOPT_TCP;
+	}
 	reqnsid = zone->view->requestnsid;
 	reqexpire = zone->requestexpire;
 	if (zone->view->peers != NULL) {
@@ -14479,7 +14650,6 @@ cleanup:
 	if (do_queue_xfrin) {
 		queue_xfrin(zone);
 	}
-	isc_rlevent_free(&sq->rlevent);
 	isc_mem_put(zone->mctx, sq, sizeof(*sq));
 	dns_zone_idetach(&zone);
 	return;
@@ -14912,7 +15082,8 @@ zone_timer_set(dns_zone_t *zone, isc_time_t *next, isc_time_t *now) {
 		zone_debuglog(zone, __func__, 10, "zone is not managed");
 	} else if (zone->timer == NULL) {
 		isc_refcount_increment0(&zone->irefs);
-		isc_timer_create(zone->loop, zone_timer, zone, &zone->timer);
+		isc_timer_createwheel(zone->loop, zone_timer, zone,
+				      &zone->timer);
 	}
 	if (zone->timer != NULL) {
 		isc_timer_start(zone->timer, isc_timertype_once, &interval);
@@ -18946,6 +19117,9 @@ dns_zonemgr_create(isc_mem_t *mctx, isc_nm_t *netmgr, dns_zonemgr_t **zmgrp) {
 	}
 	isc_rwlock_init(&zmgr->rwlock);
 
+	isc_hashmap_create(zmgr->mctx, 4, &zmgr->soabatches);
+	isc_mutex_init(&zmgr->soabatchlock);
+
 	/* Unreachable lock. */
 	isc_rwlock_init(&zmgr->urlock);
 
@@ -19163,6 +19337,10 @@ zonemgr_free(dns_zonemgr_t *zmgr) {
 	isc_mem_cput(zmgr->mctx, zmgr->mctxpool, zmgr->workers,
 		     sizeof(zmgr->mctxpool[0]));
 
+	INSIST(isc_hashmap_count(zmgr->soabatches) == 0);
+	isc_hashmap_destroy(&zmgr->soabatches);
+	isc_mutex_destroy(&zmgr->soabatchlock);
+
 	isc_rwlock_destroy(&zmgr->urlock);
 	isc_rwlock_destroy(&zmgr->rwlock);
 	isc_rwlock_destroy(&zmgr->tlsctx_cache_rwlock);
@@ -19442,6 +19620,13 @@ dns_zonemgr_setserialqueryrate(dns_zonemgr_t *zmgr, unsigned int value) {
 	setrl(zmgr->startuprefreshrl, &zmgr->startupserialqueryrate, value);
 }
 
+void
+dns_zonemgr_setserialquerybatch(dns_zonemgr_t *zmgr, unsigned int value) {
+	REQUIRE(DNS_ZONEMGR_VALID(zmgr));
+
+	zmgr->serialquerybatch = value;
+}
+
 unsigned int
 dns_zonemgr_getnotifyrate(dns_zonemgr_t *zmgr) {
 	REQUIRE(DNS_ZONEMGR_VALID(zmgr));
@@ -19463,6 +19648,13 @@ dns_zonemgr_getserialqueryrate(dns_zonemgr_t *zmgr) {
 	return (zmgr->serialqueryrate);
 }
 
+unsigned int
+dns_zonemgr_getserialquerybatch(dns_zonemgr_t *zmgr) {
+	REQUIRE(DNS_ZONEMGR_VALID(zmgr));
+
+	return (zmgr->serialquerybatch);
+}
+
 bool
 dns_zonemgr_unreachable(dns_zonemgr_t *zmgr, isc_sockaddr_t *remote,
 			isc_sockaddr_t *local, isc_time_t *now) {
@@ -23036,6 +23228,21 @@ dns_zone_getadded(dns_zone_t *zone) {
 	return (zone->added);
 }
 
+void
+dns_zone_setcfghash(dns_zone_t *zone, uint64_t cfghash) {
+	REQUIRE(DNS_ZONE_VALID(zone));
+
+	LOCK_ZONE(zone);
+	zone->cfghash = cfghash;
+	UNLOCK_ZONE(zone);
+}
+
+uint64_t
+dns_zone_getcfghash(dns_zone_t *zone) {
+	REQUIRE(DNS_ZONE_VALID(zone));
+	return (zone->cfghash);
+}
+
 isc_result_t
 dns_zone_dlzpostload(dns_zone_t *zone, dns_db_t *db) {
 	isc_time_t loadtime;
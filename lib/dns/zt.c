@@ -44,6 +44,13 @@ struct dns_zt {
 	atomic_bool flush;
 	isc_refcount_t references;
 	isc_refcount_t loads_pending;
+
+	/*
+	 * An open batch of mounts (see dns_zt_beginbatch()). 'batch' is
+	 * only used by the thread whose ID is stored in 'batch_tid'.
+	 */
+	atomic_uint_fast32_t batch_tid;
+	dns_qp_t *batch;
 };
 
 struct zt_load_params {
@@ -86,11 +93,15 @@ ztqptriename(void *uctx, char *buf, size_t size) {
 	snprintf(buf, size, "view %s zone table", view->name);
 }
 
+static dns_qp_t *
+zt_batch(dns_zt_t *zt);
+
 static dns_qpmethods_t ztqpmethods = {
 	ztqpattach,
 	ztqpdetach,
 	ztqpmakekey,
 	ztqptriename,
+	.fingerprint = true,
 };
 
 void
@@ -108,6 +119,7 @@ dns_zt_create(isc_mem_t *mctx, dns_view_t *view, dns_zt_t **ztp) {
 		.magic = ZTMAGIC,
 		.multi = multi,
 		.references = 1,
+		.batch_tid = ISC_TID_UNKNOWN,
 	};
 
 	isc_mem_attach(mctx, &zt->mctx);
@@ -128,11 +140,65 @@ dns_zt_compact(dns_zt_t *zt) {
 
 	REQUIRE(VALID_ZT(zt));
 
+	qp = zt_batch(zt);
+	if (qp != NULL) {
+		dns_qp_compact(qp, DNS_QPGC_ALL);
+		return;
+	}
+
 	dns_qpmulti_write(zt->multi, &qp);
 	dns_qp_compact(qp, DNS_QPGC_ALL);
 	dns_qpmulti_commit(zt->multi, &qp);
 }
 
+/*
+ * Return the open batch if it belongs to the calling thread.
+ */
+static dns_qp_t *
+zt_batch(dns_zt_t *zt) {
+	uint32_t tid = isc_tid();
+
+	if (tid != ISC_TID_UNKNOWN && atomic_load_acquire(&zt->batch_tid) == tid)
+	{
+		return (zt->batch);
+	}
+	return (NULL);
+}
+
+void
+dns_zt_beginbatch(dns_zt_t *zt) {
+	uint32_t tid = isc_tid();
+
+	REQUIRE(VALID_ZT(zt));
+	REQUIRE(zt_batch(zt) == NULL);
+
+	if (tid == ISC_TID_UNKNOWN) {
+		/* no way to tell our own lookups apart; mount one by one */
+		return;
+	}
+
+	dns_qpmulti_write(zt->multi, &zt->batch);
+	atomic_store_release(&zt->batch_tid, tid);
+}
+
+void
+dns_zt_endbatch(dns_zt_t *zt) {
+	dns_qp_t *qp = NULL;
+
+	REQUIRE(VALID_ZT(zt));
+
+	qp = zt_batch(zt);
+	if (qp == NULL) {
+		return;
+	}
+
+	atomic_store_release(&zt->batch_tid, ISC_TID_UNKNOWN);
+	zt->batch = NULL;
+
+	dns_qp_compact(qp, DNS_QPGC_MAYBE);
+	dns_qpmulti_commit(zt->multi, &qp);
+}
+
 isc_result_t
 dns_zt_mount(dns_zt_t *zt, dns_zone_t *zone) {
 	isc_result_t result;
@@ -140,6 +206,11 @@ dns_zt_mount(dns_zt_t *zt, dns_zone_t *zone) {
 
 	REQUIRE(VALID_ZT(zt));
 
+	qp = zt_batch(zt);
+	if (qp != NULL) {
+		return (dns_qp_insert(qp, zone, 0));
+	}
+
 	dns_qpmulti_write(zt->multi, &qp);
 	result = dns_qp_insert(qp, zone, 0);
 	dns_qp_compact(qp, DNS_QPGC_MAYBE);
@@ -155,6 +226,12 @@ dns_zt_unmount(dns_zt_t *zt, dns_zone_t *zone) {
 
 	REQUIRE(VALID_ZT(zt));
 
+	qp = zt_batch(zt);
+	if (qp != NULL) {
+		return (dns_qp_deletename(qp, dns_zone_getorigin(zone), NULL,
+					  NULL));
+	}
+
 	dns_qpmulti_write(zt->multi, &qp);
 	result = dns_qp_deletename(qp, dns_zone_getorigin(zone), NULL, NULL);
 	dns_qp_compact(qp, DNS_QPGC_MAYBE);
@@ -172,17 +249,29 @@ dns_zt_find(dns_zt_t *zt, const dns_name_t *name, dns_ztfind_t options,
 	dns_ztfind_t exactmask = DNS_ZTFIND_NOEXACT | DNS_ZTFIND_EXACT;
 	dns_ztfind_t exactopts = options & exactmask;
 	dns_qpchain_t chain;
+	dns_qp_t *batch = NULL;
+	dns_qpreadable_t qpr_or_batch;
 
 	REQUIRE(VALID_ZT(zt));
 	REQUIRE(exactopts != exactmask);
 
-	dns_qpmulti_query(zt->multi, &qpr);
+	/*
+	 * The thread filling a batch must see its own mounts, e.g.
+	 * for duplicate checks and in-view zones.
+	 */
+	batch = zt_batch(zt);
+	if (batch != NULL) {
+		qpr_or_batch.qpt = batch;
+	} else {
+		dns_qpmulti_query(zt->multi, &qpr);
+		qpr_or_batch.qpr = &qpr;
+	}
 
 	if (exactopts == DNS_ZTFIND_EXACT) {
-		result = dns_qp_getname(&qpr, name, &pval, NULL);
+		result = dns_qp_getname(qpr_or_batch, name, &pval, NULL);
 	} else {
-		result = dns_qp_lookup(&qpr, name, NULL, NULL, &chain, &pval,
-				       NULL);
+		result = dns_qp_lookup(qpr_or_batch, name, NULL, NULL, &chain,
+				       &pval, NULL);
 		if (exactopts == DNS_ZTFIND_NOEXACT && result == ISC_R_SUCCESS)
 		{
 			/* get pval from the previous chain link */
@@ -196,7 +285,9 @@ dns_zt_find(dns_zt_t *zt, const dns_name_t *name, dns_ztfind_t options,
 			}
 		}
 	}
-	dns_qpread_destroy(zt->multi, &qpr);
+	if (batch == NULL) {
+		dns_qpread_destroy(zt->multi, &qpr);
+	}
 
 	if (result == ISC_R_SUCCESS || result == DNS_R_PARTIALMATCH) {
 		dns_zone_t *zone = pval;
@@ -248,6 +339,8 @@ flush(dns_zone_t *zone, void *uap) {
 
 static void
 zt_destroy(dns_zt_t *zt) {
+	INSIST(zt->batch == NULL);
+
 	isc_refcount_destroy(&zt->references);
 	isc_refcount_destroy(&zt->loads_pending);
 
@@ -37,6 +37,11 @@
 #define ISC_NM_LISTEN_ALL 0
 #define ISC_NM_LISTEN_ONE 1
 
+/*%
+ * Upper bound for isc_nm_setmaxpipelined()
+ */
+#define ISC_NM_MAX_PIPELINED 1024U
+
 /*
  * Replacement for isc_sockettype_t provided by socket.h.
  */
@@ -558,6 +563,27 @@ isc_nm_setnetbuffers(isc_nm_t *mgr, int32_t recv_tcp, int32_t send_tcp,
  * \li	'mgr' is a valid netmgr.
  */
 
+void
+isc_nm_setmaxpipelined(isc_nm_t *mgr, uint32_t maxpipelined);
+uint32_t
+isc_nm_getmaxpipelined(isc_nm_t *mgr);
+/*%<
+ * Set and get the maximum number of DNS messages received over a single
+ * DNS-over-TCP or DNS-over-TLS connection that may be processed at the
+ * same time.  Responses are sent as soon as they are ready, in any order.
+ * Reading from a connection is paused while the limit is reached.  The
+ * new value applies to connections accepted after the call.
+ *
+ * Messages that have already been received are processed back to back,
+ * up to 32 of them, so that the responses that are ready at once are
+ * written together; the connection then yields to the other work on
+ * its loop before it processes more.
+ *
+ * Requires:
+ * \li	'mgr' is a valid netmgr.
+ * \li	'maxpipelined' is between 1 and #ISC_NM_MAX_PIPELINED.
+ */
+
 bool
 isc_nm_getloadbalancesockets(isc_nm_t *mgr);
 void
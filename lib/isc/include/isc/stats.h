@@ -80,6 +80,12 @@ enum {
 	isc_sockstatscounter_tcp4clients,
 	isc_sockstatscounter_tcp6clients,
 
+	isc_sockstatscounter_tlshandshake,
+	isc_sockstatscounter_tlsresumed,
+
+	isc_sockstatscounter_tcppipelined,
+	isc_sockstatscounter_tcppipelinefull,
+
 	isc_sockstatscounter_max,
 };
 
@@ -100,6 +100,29 @@ isc_timer_create(isc_loop_t *loop, isc_job_cb cb, void *cbarg,
  *\li	'*timerp' is attached to the newly created timer
  */
 
+void
+isc_timer_createwheel(isc_loop_t *loop, isc_job_cb cb, void *cbarg,
+		      isc_timer_t **timerp);
+/*%<
+ * Like isc_timer_create(), but the timer is kept in the timer wheel of
+ * 'loop' instead of being a libuv timer of its own.  Starting and
+ * stopping such timers costs the same however many of them there are,
+ * which makes them suitable for objects that each need a timer and
+ * come in very large numbers, such as zones.  In exchange, they only
+ * have a resolution of 10 milliseconds: the callback runs at the first
+ * tick of the wheel after the interval has passed.
+ *
+ * Requires:
+ *
+ *\li	'loop' is a valid manager
+ *\li	'cb' is a valid job
+ *\li	'timerp' is a valid pointer, and *timerp == NULL
+ *
+ * Ensures:
+ *
+ *\li	'*timerp' is attached to the newly created timer
+ */
+
 void
 isc_timer_stop(isc_timer_t *timer);
 /*%<
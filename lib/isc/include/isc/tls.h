@@ -52,6 +52,10 @@ isc_tlsctx_createserver(const char *keyfile, const char *certfile,
  * 'keyfile' and 'certfile', or a self-generated ephemeral key and
  * certificdate if both 'keyfile' and 'certfile' are NULL.
  *
+ * Session tickets issued by the context are protected by ticket keys
+ * shared by all server contexts in the process, so clients can resume
+ * their sessions across reconfiguration; see isc_tls_rotateticketkeys().
+ *
  * Requires:
  *\li	'ctxp' != NULL and '*ctxp' == NULL.
  *\li	'keyfile' and 'certfile' are either both NULL or both non-NULL.
@@ -608,6 +612,37 @@ isc_tlsctx_set_random_session_id_context(isc_tlsctx_t *ctx);
  *\li   'ctx' - a valid non-NULL pointer;
  */
 
+void
+isc_tlsctx_set_session_id_context(isc_tlsctx_t *ctx, const void *data,
+				  size_t len);
+/*%<
+ * Set the context within which sessions can be reused to a digest of
+ * the 'len' bytes at 'data', which should identify the configuration
+ * the context was created from. Unlike a random session ID context,
+ * this lets clients resume their sessions with a context rebuilt from
+ * the same configuration, e.g. after the server is reconfigured.
+ *
+ * Requires:
+ *\li   'ctx' - a valid non-NULL pointer;
+ *\li   'data' - a valid non-NULL pointer to 'len' > 0 bytes.
+ */
+
+#define ISC_TLS_TICKETKEY_INTERVAL 3600
+/*%<
+ * The recommended interval between isc_tls_rotateticketkeys() calls, in
+ * seconds.
+ */
+
+void
+isc_tls_rotateticketkeys(void);
+/*%<
+ * Replace the key used to encrypt new session tickets issued by server
+ * contexts. Tickets encrypted with the previous keys are still accepted
+ * (and replaced by new ones) until they have been rotated out, i.e. for
+ * at least one more interval. The first key is created when it is
+ * first needed.
+ */
+
 void
 isc__tls_initialize(void);
 
@@ -36,7 +36,9 @@ typedef struct inputsource {
 	bool need_close;
 	bool at_eof;
 	bool last_was_eol;
+	bool readahead;
 	isc_buffer_t *pushback;
+	unsigned int start; /*%< offset of the current token in pushback */
 	unsigned int ignored;
 	void *input;
 	char *name;
@@ -190,11 +192,13 @@ new_source(isc_lex_t *lex, bool is_file, bool need_close, void *input,
 	source->need_close = need_close;
 	source->at_eof = false;
 	source->last_was_eol = lex->last_was_eol;
+	source->readahead = false;
 	source->input = input;
 	source->name = isc_mem_strdup(lex->mctx, name);
 	source->pushback = NULL;
 	isc_buffer_allocate(lex->mctx, &source->pushback,
 			    (unsigned int)lex->max_token);
+	source->start = 0;
 	source->ignored = 0;
 	source->line = 1;
 	ISC_LIST_INITANDPREPEND(lex->sources, source, link);
@@ -221,6 +225,15 @@ isc_lex_openfile(isc_lex_t *lex, const char *filename) {
 	result = new_source(lex, true, true, stream, filename);
 	if (result != ISC_R_SUCCESS) {
 		(void)fclose(stream);
+		return (result);
+	}
+
+	/*
+	 * Nothing else reads from a stream we opened ourselves, so if it
+	 * is a regular file it is safe to read ahead of the current token.
+	 */
+	if (isc_file_isplainfilefd(fileno(stream)) == ISC_R_SUCCESS) {
+		HEAD(lex->sources)->readahead = true;
 	}
 	return (result);
 }
@@ -315,9 +328,34 @@ pushback(inputsource *source, int c) {
 	}
 }
 
-static isc_result_t
-pushandgrow(isc_lex_t *lex, inputsource *source, int c) {
-	if (isc_buffer_availablelength(source->pushback) == 0) {
+/*
+ * Make room for at least 'needed' more characters in the pushback
+ * buffer.  Characters before the start of the current token are no
+ * longer needed by isc_lex_ungettoken() or isc_lex_getlasttokentext(),
+ * so they are discarded first; the buffer is only grown if that does
+ * not free enough space.
+ */
+static void
+makeroom(isc_lex_t *lex, inputsource *source, unsigned int needed) {
+	isc_buffer_t *pb = source->pushback;
+	unsigned int start = source->start;
+
+	if (isc_buffer_availablelength(pb) >= needed) {
+		return;
+	}
+
+	if (start > 0) {
+		memmove(pb->base, (unsigned char *)pb->base + start,
+			pb->used - start);
+		pb->used -= start;
+		pb->current -= start;
+		source->ignored = (source->ignored > start)
+					  ? source->ignored - start
+					  : 0;
+		source->start = 0;
+	}
+
+	while (isc_buffer_availablelength(source->pushback) < needed) {
 		isc_buffer_t *tbuf = NULL;
 		unsigned int oldlen;
 		isc_region_t used;
@@ -332,10 +370,36 @@ pushandgrow(isc_lex_t *lex, inputsource *source, int c) {
 		isc_buffer_free(&source->pushback);
 		source->pushback = tbuf;
 	}
+}
+
+static isc_result_t
+pushandgrow(isc_lex_t *lex, inputsource *source, int c) {
+	makeroom(lex, source, 1);
 	isc_buffer_putuint8(source->pushback, (uint8_t)c);
 	return (ISC_R_SUCCESS);
 }
 
+/*
+ * Fill the pushback buffer from a regular file with as many characters
+ * as will fit, rather than one at a time.  Returns the number of
+ * characters read, which is zero at end of file or on error.
+ */
+#define LEX_READAHEAD (64 * 1024)
+
+static size_t
+readahead(isc_lex_t *lex, inputsource *source) {
+	isc_region_t avail;
+	size_t n;
+
+	makeroom(lex, source, LEX_READAHEAD / 2);
+
+	isc_buffer_availableregion(source->pushback, &avail);
+	n = fread(avail.base, 1, avail.length, source->input);
+	isc_buffer_add(source->pushback, (unsigned int)n);
+
+	return (n);
+}
+
 isc_result_t
 isc_lex_gettoken(isc_lex_t *lex, unsigned int options, isc_token_t *tokenp) {
 	inputsource *source;
@@ -396,7 +460,7 @@ isc_lex_gettoken(isc_lex_t *lex, unsigned int options, isc_token_t *tokenp) {
 		return (ISC_R_EOF);
 	}
 
-	isc_buffer_compact(source->pushback);
+	source->start = isc_buffer_consumedlength(source->pushback);
 
 	saved_options = options;
 	if ((options & ISC_LEXOPT_DNSMULTILINE) != 0 && lex->paren_count > 0) {
@@ -417,7 +481,21 @@ isc_lex_gettoken(isc_lex_t *lex, unsigned int options, isc_token_t *tokenp) {
 
 	do {
 		if (isc_buffer_remaininglength(source->pushback) == 0) {
-			if (source->is_file) {
+			if (source->readahead) {
+				stream = source->input;
+
+				if (readahead(lex, source) == 0) {
+					if (ferror(stream)) {
+						source->result =
+							isc__errno2result(
+								errno);
+						result = source->result;
+						goto done;
+					}
+					source->at_eof = true;
+				}
+				c = EOF;
+			} else if (source->is_file) {
 				stream = source->input;
 
 #if defined(HAVE_FLOCKFILE) && defined(HAVE_GETC_UNLOCKED)
@@ -1026,12 +1104,12 @@ isc_lex_ungettoken(isc_lex_t *lex, isc_token_t *tokenp) {
 	source = HEAD(lex->sources);
 	REQUIRE(source != NULL);
 	REQUIRE(tokenp != NULL);
-	REQUIRE(isc_buffer_consumedlength(source->pushback) != 0 ||
+	REQUIRE(isc_buffer_consumedlength(source->pushback) != source->start ||
 		tokenp->type == isc_tokentype_eof);
 
 	UNUSED(tokenp);
 
-	isc_buffer_first(source->pushback);
+	source->pushback->current = source->start;
 	lex->paren_count = lex->saved_paren_count;
 	source->line = source->saved_line;
 	source->at_eof = false;
@@ -1045,7 +1123,7 @@ isc_lex_getlasttokentext(isc_lex_t *lex, isc_token_t *tokenp, isc_region_t *r) {
 	source = HEAD(lex->sources);
 	REQUIRE(source != NULL);
 	REQUIRE(tokenp != NULL);
-	REQUIRE(isc_buffer_consumedlength(source->pushback) != 0 ||
+	REQUIRE(isc_buffer_consumedlength(source->pushback) != source->start ||
 		tokenp->type == isc_tokentype_eof);
 
 	UNUSED(tokenp);
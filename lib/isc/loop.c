@@ -155,6 +155,7 @@ destroy_cb(uv_async_t *handle) {
 	uv_close(&loop->destroy_trigger, NULL);
 	uv_close(&loop->pause_trigger, NULL);
 	uv_close(&loop->quiescent, NULL);
+	uv_close(&loop->wheel.timer, NULL);
 
 	uv_walk(&loop->loop, loop_walk_cb, (char *)"destroy_cb");
 }
@@ -225,6 +226,10 @@ loop_init(isc_loop_t *loop, isc_loopmgr_t *loopmgr, uint32_t tid,
 	UV_RUNTIME_CHECK(uv_prepare_init, r);
 	uv_handle_set_data(&loop->quiescent, loop);
 
+	r = uv_timer_init(&loop->loop, &loop->wheel.timer);
+	UV_RUNTIME_CHECK(uv_timer_init, r);
+	uv_handle_set_data(&loop->wheel.timer, loop);
+
 	char name[16];
 	snprintf(name, sizeof(name), "%s-%08" PRIx32, kind, tid);
 	isc_mem_create(&loop->mctx);
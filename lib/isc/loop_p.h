@@ -39,6 +39,27 @@
 #define LOOP_MAGIC    ISC_MAGIC('L', 'O', 'O', 'P')
 #define VALID_LOOP(t) ISC_MAGIC_VALID(t, LOOP_MAGIC)
 
+/*
+ * Hierarchical timer wheel driving the timers created with
+ * isc_timer_createwheel(); see timer.c.  Level 0 has one slot per
+ * tick, and each slot of level N covers a whole turn of level N - 1.
+ */
+#define TIMERWHEEL_TICK	  10 /* milliseconds */
+#define TIMERWHEEL_BITS	  8
+#define TIMERWHEEL_SLOTS  (1 << TIMERWHEEL_BITS)
+#define TIMERWHEEL_MASK	  (TIMERWHEEL_SLOTS - 1)
+#define TIMERWHEEL_LEVELS 4
+
+typedef ISC_LIST(isc_timer_t) isc__timerlist_t;
+
+typedef struct isc__timerwheel {
+	uv_timer_t timer;
+	uint64_t now; /* Last tick processed */
+	size_t count; /* Timers in the wheel */
+	bool advancing; /* In wheel_advance() */
+	isc__timerlist_t slots[TIMERWHEEL_LEVELS][TIMERWHEEL_SLOTS];
+} isc__timerwheel_t;
+
 struct isc_loop {
 	int magic;
 	isc_refcount_t references;
@@ -76,6 +97,9 @@ struct isc_loop {
 
 	/* safe memory reclamation */
 	uv_prepare_t quiescent;
+
+	/* Timer wheel */
+	isc__timerwheel_t wheel;
 };
 
 /*
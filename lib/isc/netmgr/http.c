@@ -555,38 +555,55 @@ on_client_data_chunk_recv_callback(int32_t stream_id, const uint8_t *data,
 	return (0);
 }
 
+static void
+server_free_rbuf(isc_nmsocket_h2_t *h2, isc_mem_t *mctx) {
+	void *base = isc_buffer_base(&h2->rbuf);
+
+	if (base != NULL && base != h2->smallbuf) {
+		isc_mem_free(mctx, base);
+	}
+	isc_buffer_initnull(&h2->rbuf);
+}
+
 static int
-on_server_data_chunk_recv_callback(int32_t stream_id, const uint8_t *data,
-				   size_t len, isc_nm_http_session_t *session) {
-	isc_nmsocket_h2_t *h2 = ISC_LIST_HEAD(session->sstreams);
-	isc_mem_t *mctx = h2->psock->worker->mctx;
-
-	while (h2 != NULL) {
-		if (stream_id == h2->stream_id) {
-			if (isc_buffer_base(&h2->rbuf) == NULL) {
-				isc_buffer_init(
-					&h2->rbuf,
-					isc_mem_allocate(mctx,
-							 h2->content_length),
-					MAX_DNS_MESSAGE_SIZE);
-			}
-			size_t new_bufsize = isc_buffer_usedlength(&h2->rbuf) +
-					     len;
-			if (new_bufsize <= MAX_DNS_MESSAGE_SIZE &&
-			    new_bufsize <= h2->content_length)
-			{
-				isc_buffer_putmem(&h2->rbuf, data, len);
-				break;
-			}
+on_server_data_chunk_recv_callback(nghttp2_session *ngsession,
+				   int32_t stream_id, const uint8_t *data,
+				   size_t len) {
+	isc_nmsocket_t *socket = NULL;
+	isc_nmsocket_h2_t *h2 = NULL;
+	size_t new_bufsize;
 
-			return (NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE);
+	/* Set in server_on_begin_headers_callback() */
+	socket = nghttp2_session_get_stream_user_data(ngsession, stream_id);
+	if (socket == NULL) {
+		return (NGHTTP2_ERR_CALLBACK_FAILURE);
+	}
+
+	h2 = socket->h2;
+	INSIST(h2->stream_id == stream_id);
+
+	if (isc_buffer_base(&h2->rbuf) == NULL) {
+		/*
+		 * Most DNS queries fit in the buffer within the stream
+		 * object, so there is no need for a separate allocation.
+		 */
+		void *base = h2->smallbuf;
+		if (h2->content_length > sizeof(h2->smallbuf)) {
+			base = isc_mem_allocate(socket->worker->mctx,
+						h2->content_length);
 		}
-		h2 = ISC_LIST_NEXT(h2, link);
+		isc_buffer_init(&h2->rbuf, base, MAX_DNS_MESSAGE_SIZE);
 	}
-	if (h2 == NULL) {
-		return (NGHTTP2_ERR_CALLBACK_FAILURE);
+
+	new_bufsize = isc_buffer_usedlength(&h2->rbuf) + len;
+	if (new_bufsize > MAX_DNS_MESSAGE_SIZE ||
+	    new_bufsize > h2->content_length)
+	{
+		return (NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE);
 	}
 
+	isc_buffer_putmem(&h2->rbuf, data, len);
+
 	return (0);
 }
 
@@ -597,15 +614,14 @@ on_data_chunk_recv_callback(nghttp2_session *ngsession, uint8_t flags,
 	isc_nm_http_session_t *session = (isc_nm_http_session_t *)user_data;
 	int rv;
 
-	UNUSED(ngsession);
 	UNUSED(flags);
 
 	if (session->client) {
 		rv = on_client_data_chunk_recv_callback(stream_id, data, len,
 							session);
 	} else {
-		rv = on_server_data_chunk_recv_callback(stream_id, data, len,
-							session);
+		rv = on_server_data_chunk_recv_callback(ngsession, stream_id,
+							data, len);
 	}
 
 	return (rv);
@@ -866,6 +882,15 @@ send_client_connection_header(isc_nm_http_session_t *session) {
 	{ (uint8_t *)(uintptr_t)(NAME), (uint8_t *)(uintptr_t)(VALUE), \
 	  sizeof(NAME) - 1, sizeof(VALUE) - 1, NGHTTP2_NV_FLAG_NONE }
 
+/*
+ * A header with a constant (lowercase) name and value, which nghttp2
+ * does not need to copy.
+ */
+#define MAKE_STATIC_NV(NAME, VALUE)                                    \
+	{ (uint8_t *)(uintptr_t)(NAME), (uint8_t *)(uintptr_t)(VALUE), \
+	  sizeof(NAME) - 1, sizeof(VALUE) - 1,                         \
+	  NGHTTP2_NV_FLAG_NO_COPY_NAME | NGHTTP2_NV_FLAG_NO_COPY_VALUE }
+
 static ssize_t
 client_read_callback(nghttp2_session *ngsession, int32_t stream_id,
 		     uint8_t *buf, size_t length, uint32_t *data_flags,
@@ -2043,15 +2068,9 @@ log_server_error_response(const isc_nmsocket_t *socket,
 static isc_result_t
 server_send_error_response(const isc_http_error_responses_t error,
 			   nghttp2_session *ngsession, isc_nmsocket_t *socket) {
-	void *base;
-
 	REQUIRE(error != ISC_HTTP_ERROR_SUCCESS);
 
-	base = isc_buffer_base(&socket->h2->rbuf);
-	if (base != NULL) {
-		isc_mem_free(socket->h2->session->mctx, base);
-		isc_buffer_initnull(&socket->h2->rbuf);
-	}
+	server_free_rbuf(socket->h2, socket->h2->session->mctx);
 
 	/* We do not want the error response to be cached anywhere. */
 	socket->h2->min_ttl = 0;
@@ -2258,6 +2277,12 @@ server_httpsend(isc_nmhandle_t *handle, isc_nmsocket_t *sock,
 		isc__nm_uvreq_t *req) {
 	size_t content_len_buf_len, cache_control_buf_len;
 	isc_result_t result = ISC_R_SUCCESS;
+	nghttp2_nv hdrs[] = {
+		MAKE_STATIC_NV(":status", "200"),
+		MAKE_STATIC_NV("content-type", DNS_MEDIA_TYPE),
+		MAKE_NV("content-length", sock->h2->clenbuf, 0),
+		MAKE_STATIC_NV("cache-control", DEFAULT_CACHE_CONTROL),
+	};
 	isc_nm_cb_t cb = req->cb.send;
 	void *cbarg = req->cbarg;
 	if (isc__nmsocket_closing(sock) ||
@@ -2277,24 +2302,16 @@ server_httpsend(isc_nmhandle_t *handle, isc_nmsocket_t *sock,
 	content_len_buf_len = snprintf(sock->h2->clenbuf,
 				       sizeof(sock->h2->clenbuf), "%lu",
 				       (unsigned long)req->uvbuf.len);
-	if (sock->h2->min_ttl == 0) {
-		cache_control_buf_len =
-			snprintf(sock->h2->cache_control_buf,
-				 sizeof(sock->h2->cache_control_buf), "%s",
-				 DEFAULT_CACHE_CONTROL);
-	} else {
+	hdrs[2].valuelen = content_len_buf_len;
+	if (sock->h2->min_ttl != 0) {
 		cache_control_buf_len =
 			snprintf(sock->h2->cache_control_buf,
 				 sizeof(sock->h2->cache_control_buf),
 				 "max-age=%" PRIu32, sock->h2->min_ttl);
+		hdrs[3] = (nghttp2_nv)MAKE_NV("cache-control",
+					      sock->h2->cache_control_buf,
+					      cache_control_buf_len);
 	}
-	const nghttp2_nv hdrs[] = { MAKE_NV2(":status", "200"),
-				    MAKE_NV2("Content-Type", DNS_MEDIA_TYPE),
-				    MAKE_NV("Content-Length", sock->h2->clenbuf,
-					    content_len_buf_len),
-				    MAKE_NV("Cache-Control",
-					    sock->h2->cache_control_buf,
-					    cache_control_buf_len) };
 
 	result = server_send_response(handle->httpsession->ngsession,
 				      sock->h2->stream_id, hdrs,
@@ -3234,11 +3251,7 @@ isc__nm_http_cleanup_data(isc_nmsocket_t *sock) {
 
 		INSIST(sock->h2->connect.cstream == NULL);
 
-		if (isc_buffer_base(&sock->h2->rbuf) != NULL) {
-			void *base = isc_buffer_base(&sock->h2->rbuf);
-			isc_mem_free(sock->worker->mctx, base);
-			isc_buffer_initnull(&sock->h2->rbuf);
-		}
+		server_free_rbuf(sock->h2, sock->worker->mctx);
 		FALLTHROUGH;
 	case isc_nm_proxystreamlistener:
 	case isc_nm_proxystreamsocket:
@@ -69,6 +69,12 @@
 #define ISC_NETMGR_TCP_SENDBUF_SIZE (sizeof(uint16_t) + UINT16_MAX)
 #define ISC_NETMGR_TCP_RECVBUF_SIZE (sizeof(uint16_t) + UINT16_MAX)
 
+/*
+ * The maximum number of messages sent over a TCP connection while
+ * processing a single read that are written together with one writev().
+ */
+#define ISC_NETMGR_TCP_SENDQ_MAX 32
+
 /* Pick the larger buffer */
 #define ISC_NETMGR_RECVBUF_SIZE                                     \
 	(ISC_NETMGR_UDP_RECVBUF_SIZE >= ISC_NETMGR_TCP_RECVBUF_SIZE \
@@ -88,10 +94,14 @@ STATIC_ASSERT(ISC_NETMGR_TCP_RECVBUF_SIZE <= ISC_NETMGR_RECVBUF_SIZE,
 	      "receive buffer size");
 
 /*%
- * Maximum outstanding DNS message that we process in a single TCP read.
+ * Default maximum number of outstanding DNS messages that we process
+ * concurrently on a single stream connection (see isc_nm_setmaxpipelined()).
  */
 #define ISC_NETMGR_MAX_STREAM_CLIENTS_PER_CONN 23
 
+STATIC_ASSERT(ISC_NETMGR_MAX_STREAM_CLIENTS_PER_CONN <= ISC_NM_MAX_PIPELINED,
+	      "default pipelining limit must not exceed the upper bound");
+
 /*%
  * Regular TCP buffer size.
  */
@@ -347,6 +357,12 @@ struct isc_nm {
 	 */
 	atomic_bool shuttingdown;
 
+	/*
+	 * The BIO method used to write outgoing TLS records directly
+	 * into send buffers.
+	 */
+	BIO_METHOD *tls_bio_out_method;
+
 	/*
 	 * Timeout values for TCP connections, corresponding to
 	 * tcp-intiial-timeout, tcp-idle-timeout, tcp-keepalive-timeout,
@@ -359,6 +375,12 @@ struct isc_nm {
 	atomic_uint_fast32_t keepalive;
 	atomic_uint_fast32_t advertised;
 
+	/*
+	 * Maximum number of DNS messages received over a single stream
+	 * connection that may be in progress at the same time.
+	 */
+	atomic_uint_fast32_t maxpipelined;
+
 	/*
 	 * Socket SO_RCVBUF and SO_SNDBUF values
 	 */
@@ -445,6 +467,7 @@ typedef struct isc_nmsocket_h2 {
 
 	isc_buffer_t rbuf;
 	isc_buffer_t wbuf;
+	uint8_t smallbuf[512]; /* rbuf storage for small request bodies */
 
 	int32_t stream_id;
 	isc_nm_http_session_t *session;
@@ -543,6 +566,7 @@ struct isc_nmsocket {
 		isc_nmsocket_t *listener;
 		isc_nmsocket_t *sock;
 		size_t nsending;
+		size_t nprocessed;
 		void *send_req;
 		bool dot_alpn_negotiated;
 		const char *tls_verify_error;
@@ -593,6 +617,17 @@ struct isc_nmsocket {
 	 */
 	bool reading_throttled;
 
+	/*%
+	 * TCP sends are queued while the socket is corked - while the
+	 * read callback is running, or while a stream DNS socket on top
+	 * of it is processing the pipelined requests it has buffered -
+	 * so that the responses to them are written together.  Corking
+	 * nests; the queue is written when the last cork is removed.
+	 */
+	unsigned int sendq_corked;
+	size_t sendq_len;
+	ISC_LIST(isc__nm_uvreq_t) sendq;
+
 	/*% outer socket is for 'wrapped' sockets - e.g. tcpdns in tcp */
 	isc_nmsocket_t *outer;
 
@@ -931,6 +966,13 @@ isc__nm_tcp_settimeout(isc_nmhandle_t *handle, uint32_t timeout);
 void
 isc__nmhandle_tcp_set_manual_timer(isc_nmhandle_t *handle, const bool manual);
 
+void
+isc__nmhandle_tcp_cork(isc_nmhandle_t *handle, const bool cork);
+/*%<
+ * Add ('cork' is true) or remove a cork on the TCP socket associated
+ * with 'handle'; see isc__nmhandle_cork().
+ */
+
 void
 isc__nm_tcp_senddns(isc_nmhandle_t *handle, const isc_region_t *region,
 		    isc_nm_cb_t cb, void *cbarg);
@@ -1025,6 +1067,19 @@ void
 isc__nm_tls_failed_read_cb(isc_nmsocket_t *sock, isc_result_t result,
 			   bool async);
 
+void
+isc__nm_tls_initialize(isc_nm_t *mgr);
+/*%<
+ * Create the network manager's TLS BIO method.
+ */
+
+void
+isc__nm_tls_shutdown(isc_nm_t *mgr);
+/*%<
+ * Free the network manager's TLS BIO method.  Must not be called
+ * before all of the TLS sockets of the network manager are destroyed.
+ */
+
 void
 isc__nmhandle_tls_get_selected_alpn(isc_nmhandle_t *handle,
 				    const unsigned char **alpn,
@@ -1492,6 +1547,17 @@ isc__nmhandle_set_manual_timer(isc_nmhandle_t *handle, const bool manual);
  * automatically on read nor get started when read is initiated.
  */
 
+void
+isc__nmhandle_cork(isc_nmhandle_t *handle, const bool cork);
+/*
+ * Add ('cork' is true) or remove a cork on the transport socket
+ * associated with 'handle'. While a TCP socket is corked, the messages
+ * sent over it are queued, and they are written together, with a
+ * single system call, when the last cork is removed. Every cork added
+ * must be removed through the same handle. The call has no effect on
+ * other transports.
+ */
+
 void
 isc__nmhandle_get_selected_alpn(isc_nmhandle_t *handle,
 				const unsigned char **alpn,
@@ -200,6 +200,8 @@ isc_netmgr_create(isc_mem_t *mctx, isc_loopmgr_t *loopmgr, isc_nm_t **netmgrp) {
 	atomic_init(&netmgr->idle, 30000);
 	atomic_init(&netmgr->keepalive, 30000);
 	atomic_init(&netmgr->advertised, 30000);
+	atomic_init(&netmgr->maxpipelined,
+		    ISC_NETMGR_MAX_STREAM_CLIENTS_PER_CONN);
 
 	netmgr->workers = isc_mem_cget(mctx, netmgr->nloops,
 				       sizeof(netmgr->workers[0]));
@@ -208,6 +210,8 @@ isc_netmgr_create(isc_mem_t *mctx, isc_loopmgr_t *loopmgr, isc_nm_t **netmgrp) {
 
 	netmgr->magic = NM_MAGIC;
 
+	isc__nm_tls_initialize(netmgr);
+
 	for (size_t i = 0; i < netmgr->nloops; i++) {
 		isc_loop_t *loop = isc_loop_get(netmgr->loopmgr, i);
 		isc__networker_t *worker = &netmgr->workers[i];
@@ -251,6 +255,8 @@ nm_destroy(isc_nm_t **mgr0) {
 
 	isc_refcount_destroy(&mgr->references);
 
+	isc__nm_tls_shutdown(mgr);
+
 	mgr->magic = 0;
 
 	if (mgr->stats != NULL) {
@@ -359,6 +365,21 @@ isc_nm_setnetbuffers(isc_nm_t *mgr, int32_t recv_tcp, int32_t send_tcp,
 	atomic_store_relaxed(&mgr->send_udp_buffer_size, send_udp);
 }
 
+void
+isc_nm_setmaxpipelined(isc_nm_t *mgr, uint32_t maxpipelined) {
+	REQUIRE(VALID_NM(mgr));
+	REQUIRE(maxpipelined > 0 && maxpipelined <= ISC_NM_MAX_PIPELINED);
+
+	atomic_store_relaxed(&mgr->maxpipelined, maxpipelined);
+}
+
+uint32_t
+isc_nm_getmaxpipelined(isc_nm_t *mgr) {
+	REQUIRE(VALID_NM(mgr));
+
+	return (atomic_load_relaxed(&mgr->maxpipelined));
+}
+
 bool
 isc_nm_getloadbalancesockets(isc_nm_t *mgr) {
 	REQUIRE(VALID_NM(mgr));
@@ -2747,6 +2768,22 @@ isc__nmhandle_set_manual_timer(isc_nmhandle_t *handle, const bool manual) {
 	UNREACHABLE();
 }
 
+void
+isc__nmhandle_cork(isc_nmhandle_t *handle, const bool cork) {
+	REQUIRE(VALID_NMHANDLE(handle));
+	REQUIRE(VALID_NMSOCK(handle->sock));
+
+	isc_nmsocket_t *sock = handle->sock;
+
+	switch (sock->type) {
+	case isc_nm_tcpsocket:
+		isc__nmhandle_tcp_cork(handle, cork);
+		return;
+	default:
+		return;
+	};
+}
+
 void
 isc__nmhandle_get_selected_alpn(isc_nmhandle_t *handle,
 				const unsigned char **alpn,
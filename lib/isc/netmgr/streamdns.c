@@ -17,6 +17,7 @@
 #include <isc/async.h>
 #include <isc/atomic.h>
 #include <isc/result.h>
+#include <isc/stats.h>
 #include <isc/thread.h>
 
 #include "netmgr-int.h"
@@ -122,6 +123,32 @@ streamdns_pauseread(isc_nmsocket_t *sock, isc_nmhandle_t *transphandle) {
 	}
 }
 
+static void
+streamdns_incstats(isc_nmsocket_t *sock, isc_statscounter_t counter) {
+	isc_stats_t *stats = sock->worker->netmgr->stats;
+
+	if (stats != NULL) {
+		isc_stats_increment(stats, counter);
+	}
+}
+
+/*
+ * Count a message that arrived while the earlier ones received over the
+ * same connection were still being processed.
+ */
+static void
+streamdns_pipeline_stats(isc_nmsocket_t *sock) {
+	size_t inflight = sock->active_handles_cur;
+
+	if (sock->recv_handle != NULL) {
+		inflight--;
+	}
+
+	if (inflight > 0) {
+		streamdns_incstats(sock, isc_sockstatscounter_tcppipelined);
+	}
+}
+
 static bool
 streamdns_on_complete_dnsmessage(isc_dnsstream_assembler_t *dnsasm,
 				 isc_region_t *restrict region,
@@ -134,6 +161,8 @@ streamdns_on_complete_dnsmessage(isc_dnsstream_assembler_t *dnsasm,
 	 */
 	bool stop = sock->client;
 
+	sock->streamdns.nprocessed++;
+
 	sock->reading = false;
 	if (sock->recv_cb != NULL) {
 		if (!sock->client) {
@@ -145,8 +174,11 @@ streamdns_on_complete_dnsmessage(isc_dnsstream_assembler_t *dnsasm,
 			 * (streamdns_resume_processing()) is invoked.
 			 * That is required for pipelining support.
 			 */
-			isc_nmhandle_t *handle = isc__nmhandle_get(
-				sock, &sock->peer, &sock->iface);
+			isc_nmhandle_t *handle = NULL;
+
+			streamdns_pipeline_stats(sock);
+			handle = isc__nmhandle_get(sock, &sock->peer,
+						   &sock->iface);
 			sock->recv_cb(handle, ISC_R_SUCCESS, region,
 				      sock->recv_cbarg);
 			isc_nmhandle_detach(&handle);
@@ -176,6 +208,10 @@ streamdns_on_complete_dnsmessage(isc_dnsstream_assembler_t *dnsasm,
 	    (sock->active_handles_cur >= sock->active_handles_max))
 	{
 		stop = true;
+		if (!sock->client) {
+			streamdns_incstats(sock,
+					   isc_sockstatscounter_tcppipelinefull);
+		}
 	}
 	INSIST(sock->active_handles_cur <= sock->active_handles_max);
 
@@ -188,6 +224,13 @@ streamdns_on_complete_dnsmessage(isc_dnsstream_assembler_t *dnsasm,
 		 * The call also restarts the timer.
 		 */
 		streamdns_readmore(sock, transphandle);
+	} else if (sock->streamdns.nprocessed < ISC_NETMGR_TCP_SENDQ_MAX) {
+		/*
+		 * Process the next DNS message right away, so that the
+		 * responses to the pipelined messages that are answered
+		 * synchronously get written together.
+		 */
+		return (true);
 	} else {
 		/*
 		 * Process more DNS messages in the next loop tick.
@@ -256,10 +299,31 @@ streamdns_handle_incoming_data(isc_nmsocket_t *sock,
 	 * 'len == 0', try to resume processing of the data within the
 	 * internal buffers or resume reading, if there is no any.
 	 */
+	sock->streamdns.nprocessed = 0;
 	isc_dnsstream_assembler_incoming(dnsasm, transphandle, data, len);
 	streamdns_try_close_unused(sock);
 }
 
+/*
+ * Resume processing of the data within the internal buffers outside
+ * of the transport's read callback. The transport is corked meanwhile,
+ * so that the responses sent synchronously are written together, as
+ * they are when processing data as it is read.
+ */
+static void
+streamdns_handle_buffered_data(isc_nmsocket_t *sock) {
+	isc_nmhandle_t *transphandle = NULL;
+
+	INSIST(VALID_NMHANDLE(sock->outerhandle));
+	isc_nmhandle_attach(sock->outerhandle, &transphandle);
+
+	isc__nmhandle_cork(transphandle, true);
+	streamdns_handle_incoming_data(sock, transphandle, NULL, 0);
+	isc__nmhandle_cork(transphandle, false);
+
+	isc_nmhandle_detach(&transphandle);
+}
+
 static isc_nmsocket_t *
 streamdns_sock_new(isc__networker_t *worker, const isc_nmsocket_type_t type,
 		   isc_sockaddr_t *addr, const bool is_server) {
@@ -693,7 +757,7 @@ streamdns_resume_processing(void *arg) {
 		return;
 	}
 
-	streamdns_handle_incoming_data(sock, sock->outerhandle, NULL, 0);
+	streamdns_handle_buffered_data(sock);
 }
 
 static isc_result_t
@@ -721,6 +785,8 @@ streamdns_accept_cb(isc_nmhandle_t *handle, isc_result_t result, void *cbarg) {
 				   &iface, true);
 	nsock->recv_cb = listensock->recv_cb;
 	nsock->recv_cbarg = listensock->recv_cbarg;
+	nsock->active_handles_max =
+		isc_nm_getmaxpipelined(handle->sock->worker->netmgr);
 
 	nsock->peer = isc_nmhandle_peeraddr(handle);
 	nsock->tid = tid;
@@ -900,8 +966,7 @@ streamdns_read_cb(void *arg) {
 		goto detach;
 	}
 
-	INSIST(VALID_NMHANDLE(sock->outerhandle));
-	streamdns_handle_incoming_data(sock, sock->outerhandle, NULL, 0);
+	streamdns_handle_buffered_data(sock);
 detach:
 	isc__nmsocket_detach(&sock);
 }
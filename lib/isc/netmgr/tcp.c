@@ -55,8 +55,8 @@ can_log_tcp_quota(void) {
 static isc_result_t
 tcp_connect_direct(isc_nmsocket_t *sock, isc__nm_uvreq_t *req);
 
-static isc_result_t
-tcp_send_direct(isc_nmsocket_t *sock, isc__nm_uvreq_t *req);
+static void
+tcp_send_queued(isc_nmsocket_t *sock);
 static void
 tcp_connect_cb(uv_connect_t *uvreq, int status);
 static void
@@ -774,7 +774,16 @@ isc__nm_tcp_read_cb(uv_stream_t *stream, ssize_t nread, const uv_buf_t *buf) {
 				: atomic_load_relaxed(&netmgr->idle);
 	}
 
+	/*
+	 * Hold back the responses sent while processing the messages
+	 * read and write them together afterwards.
+	 */
+	sock->sendq_corked++;
 	isc__nm_readcb(sock, req, ISC_R_SUCCESS, false);
+	INSIST(sock->sendq_corked > 0);
+	if (--sock->sendq_corked == 0) {
+		tcp_send_queued(sock);
+	}
 
 	if (!sock->client && sock->reading) {
 		/*
@@ -998,7 +1007,6 @@ tcp_send(isc_nmhandle_t *handle, const isc_region_t *region, isc_nm_cb_t cb,
 	REQUIRE(VALID_NMSOCK(handle->sock));
 
 	isc_nmsocket_t *sock = handle->sock;
-	isc_result_t result;
 	isc__nm_uvreq_t *uvreq = NULL;
 	isc_nm_t *netmgr = sock->worker->netmgr;
 
@@ -1024,13 +1032,35 @@ tcp_send(isc_nmhandle_t *handle, const isc_region_t *region, isc_nm_cb_t cb,
 				: atomic_load_relaxed(&netmgr->idle);
 	}
 
-	result = tcp_send_direct(sock, uvreq);
-	if (result != ISC_R_SUCCESS) {
-		isc__nm_incstats(sock, STATID_SENDFAIL);
-		isc__nm_failed_send_cb(sock, uvreq, result, true);
+	ISC_LIST_APPEND(sock->sendq, uvreq, link);
+	sock->sendq_len++;
+
+	if (sock->sendq_corked == 0 ||
+	    sock->sendq_len >= ISC_NETMGR_TCP_SENDQ_MAX)
+	{
+		tcp_send_queued(sock);
 	}
+}
 
-	return;
+void
+isc__nmhandle_tcp_cork(isc_nmhandle_t *handle, const bool cork) {
+	REQUIRE(VALID_NMHANDLE(handle));
+	REQUIRE(VALID_NMSOCK(handle->sock));
+
+	isc_nmsocket_t *sock = handle->sock;
+
+	REQUIRE(sock->type == isc_nm_tcpsocket);
+	REQUIRE(sock->tid == isc_tid());
+
+	if (cork) {
+		sock->sendq_corked++;
+		return;
+	}
+
+	INSIST(sock->sendq_corked > 0);
+	if (--sock->sendq_corked == 0) {
+		tcp_send_queued(sock);
+	}
 }
 
 void
@@ -1105,88 +1135,138 @@ tcp_send_cb(uv_write_t *req, int status) {
 	tcp_maybe_restart_reading(sock);
 }
 
+static size_t
+tcp_send_bufs(isc__nm_uvreq_t *req, uv_buf_t *bufs) {
+	size_t nbufs = 0;
+
+	/* Check if we are trying to send a DNS message */
+	if (*(uint16_t *)req->tcplen != 0) {
+		bufs[nbufs].base = req->tcplen;
+		bufs[nbufs].len = 2;
+		nbufs++;
+	}
+
+	bufs[nbufs].base = req->uvbuf.base;
+	bufs[nbufs].len = req->uvbuf.len;
+	nbufs++;
+
+	return (nbufs);
+}
+
 static isc_result_t
-tcp_send_direct(isc_nmsocket_t *sock, isc__nm_uvreq_t *req) {
+tcp_send_uvwrite(isc_nmsocket_t *sock, isc__nm_uvreq_t *req, uv_buf_t *bufs,
+		 size_t nbufs) {
+	int r;
+
+	r = uv_write(&req->uv_req.write, &sock->uv_handle.stream, bufs, nbufs,
+		     tcp_send_cb);
+	if (r < 0) {
+		return (isc_uverr2result(r));
+	}
+
+	isc_nm_timer_create(req->handle, isc__nmsocket_writetimeout_cb, req,
+			    &req->timer);
+	if (sock->write_timeout > 0) {
+		isc_nm_timer_start(req->timer, sock->write_timeout);
+	}
+
+	return (ISC_R_SUCCESS);
+}
+
+/*
+ * Write all of the queued messages, with their length prefixes, using
+ * a single uv_try_write().  Whatever could not be written immediately
+ * is passed to uv_write(), one request at a time, which keeps the
+ * messages in order.
+ */
+static void
+tcp_send_queued(isc_nmsocket_t *sock) {
+	uv_buf_t bufs[ISC_NETMGR_TCP_SENDQ_MAX * 2];
+	size_t nbufs = 0;
+	size_t written = 0;
+	bool throttled = false;
+	isc_result_t result = ISC_R_SUCCESS;
+	isc__nm_uvreq_t *req = NULL;
+	int r;
+
 	REQUIRE(VALID_NMSOCK(sock));
-	REQUIRE(VALID_UVREQ(req));
 	REQUIRE(sock->tid == isc_tid());
 	REQUIRE(sock->type == isc_nm_tcpsocket);
 
-	int r;
-	uv_buf_t bufs[2] = { { 0 }, { 0 } }; /* ugly, but required for old GCC
-						versions */
-	size_t nbufs = 1;
+	if (ISC_LIST_EMPTY(sock->sendq)) {
+		return;
+	}
 
 	if (isc__nmsocket_closing(sock)) {
-		return (ISC_R_CANCELED);
+		result = ISC_R_CANCELED;
+	} else {
+		for (req = ISC_LIST_HEAD(sock->sendq); req != NULL;
+		     req = ISC_LIST_NEXT(req, link))
+		{
+			nbufs += tcp_send_bufs(req, &bufs[nbufs]);
+		}
+
+		r = uv_try_write(&sock->uv_handle.stream, bufs, nbufs);
+		if (r >= 0) {
+			written = (size_t)r;
+		} else if (!(r == UV_ENOSYS || r == UV_EAGAIN)) {
+			result = isc_uverr2result(r);
+		}
 	}
 
-	/* Check if we are not trying to send a DNS message */
-	if (*(uint16_t *)req->tcplen == 0) {
-		bufs[0].base = req->uvbuf.base;
-		bufs[0].len = req->uvbuf.len;
+	while ((req = ISC_LIST_HEAD(sock->sendq)) != NULL) {
+		uv_buf_t reqbufs[2] = { { 0 }, { 0 } };
+		size_t nreqbufs, i = 0;
 
-		r = uv_try_write(&sock->uv_handle.stream, bufs, nbufs);
+		ISC_LIST_UNLINK(sock->sendq, req, link);
+		sock->sendq_len--;
 
-		if (r == (int)(bufs[0].len)) {
-			/* Wrote everything */
-			isc__nm_sendcb(sock, req, ISC_R_SUCCESS, true);
-			tcp_maybe_restart_reading(sock);
-			return (ISC_R_SUCCESS);
-		} else if (r > 0) {
-			bufs[0].base += (size_t)r;
-			bufs[0].len -= (size_t)r;
-		} else if (!(r == UV_ENOSYS || r == UV_EAGAIN)) {
-			return (isc_uverr2result(r));
+		if (result != ISC_R_SUCCESS) {
+			isc__nm_incstats(sock, STATID_SENDFAIL);
+			isc__nm_failed_send_cb(sock, req, result, true);
+			continue;
 		}
-	} else {
-		nbufs = 2;
-		bufs[0].base = req->tcplen;
-		bufs[0].len = 2;
-		bufs[1].base = req->uvbuf.base;
-		bufs[1].len = req->uvbuf.len;
 
-		r = uv_try_write(&sock->uv_handle.stream, bufs, nbufs);
+		/* Skip over the part that has been written already */
+		nreqbufs = tcp_send_bufs(req, reqbufs);
+		while (i < nreqbufs && written >= reqbufs[i].len) {
+			written -= reqbufs[i].len;
+			i++;
+		}
 
-		if (r == (int)(bufs[0].len + bufs[1].len)) {
+		if (i == nreqbufs) {
 			/* Wrote everything */
 			isc__nm_sendcb(sock, req, ISC_R_SUCCESS, true);
-			tcp_maybe_restart_reading(sock);
-			return (ISC_R_SUCCESS);
-		} else if (r == 1) {
-			/* Partial write of DNSMSG length */
-			bufs[0].base = req->tcplen + 1;
-			bufs[0].len = 1;
-		} else if (r > 0) {
-			/* Partial write of DNSMSG */
-			nbufs = 1;
-			bufs[0].base = req->uvbuf.base + (r - 2);
-			bufs[0].len = req->uvbuf.len - (r - 2);
-		} else if (!(r == UV_ENOSYS || r == UV_EAGAIN)) {
-			return (isc_uverr2result(r));
+			continue;
 		}
-	}
 
-	isc_log_write(ISC_LOGCATEGORY_GENERAL, ISC_LOGMODULE_NETMGR,
-		      ISC_LOG_DEBUG(3),
-		      "throttling TCP connection, the other side is not "
-		      "reading the data, switching to uv_write()");
-	sock->reading_throttled = true;
-	isc__nm_stop_reading(sock);
+		reqbufs[i].base += written;
+		reqbufs[i].len -= written;
+		written = 0;
 
-	r = uv_write(&req->uv_req.write, &sock->uv_handle.stream, bufs, nbufs,
-		     tcp_send_cb);
-	if (r < 0) {
-		return (isc_uverr2result(r));
-	}
+		if (!throttled) {
+			isc_log_write(ISC_LOGCATEGORY_GENERAL,
+				      ISC_LOGMODULE_NETMGR, ISC_LOG_DEBUG(3),
+				      "throttling TCP connection, the other "
+				      "side is not reading the data, "
+				      "switching to uv_write()");
+			sock->reading_throttled = true;
+			isc__nm_stop_reading(sock);
+			throttled = true;
+		}
 
-	isc_nm_timer_create(req->handle, isc__nmsocket_writetimeout_cb, req,
-			    &req->timer);
-	if (sock->write_timeout > 0) {
-		isc_nm_timer_start(req->timer, sock->write_timeout);
+		result = tcp_send_uvwrite(sock, req, &reqbufs[i],
+					  nreqbufs - i);
+		if (result != ISC_R_SUCCESS) {
+			isc__nm_incstats(sock, STATID_SENDFAIL);
+			isc__nm_failed_send_cb(sock, req, result, true);
+		}
 	}
+	INSIST(sock->sendq_len == 0);
 
-	return (ISC_R_SUCCESS);
+	if (result == ISC_R_SUCCESS && !throttled) {
+		tcp_maybe_restart_reading(sock);
+	}
 }
 
 static void
@@ -33,6 +33,7 @@
 #include <isc/region.h>
 #include <isc/result.h>
 #include <isc/sockaddr.h>
+#include <isc/stats.h>
 #include <isc/stdtime.h>
 #include <isc/thread.h>
 #include <isc/util.h>
@@ -138,6 +139,9 @@ tls_try_shutdown(isc_tls_t *tls, const bool quite);
 static void
 tls_try_to_enable_tcp_nodelay(isc_nmsocket_t *tlssock);
 
+static isc_once_t tls_bio_once = ISC_ONCE_INIT;
+static int tls_bio_out_type = 0;
+
 /*
  * The socket is closing, outerhandle has been detached, listener is
  * inactive, or the netmgr is closing: any operation on it should abort
@@ -348,14 +352,110 @@ async_tls_do_bio(isc_nmsocket_t *sock) {
 	isc_async_run(sock->worker->loop, tls_do_bio_cb, sock);
 }
 
+/*
+ * Outgoing TLS records are not kept in a memory BIO: the BIO below
+ * appends them directly to the buffer of the next send request, which
+ * is then passed to isc_nm_send() as is, saving a copy of every record
+ * sent.
+ */
+static isc_nmsocket_tls_send_req_t *
+tls_get_send_req(isc_nmsocket_t *sock) {
+	isc_nmsocket_tls_send_req_t *send_req = sock->tlsstream.send_req;
+
+	if (send_req == NULL) {
+		send_req = isc_mem_get(sock->worker->mctx, sizeof(*send_req));
+		*send_req = (isc_nmsocket_tls_send_req_t){ 0 };
+		isc_buffer_init(&send_req->data, &send_req->smallbuf,
+				sizeof(send_req->smallbuf));
+		isc_buffer_setmctx(&send_req->data, sock->worker->mctx);
+		sock->tlsstream.send_req = send_req;
+	}
+
+	return (send_req);
+}
+
+static int
+tls_bio_out_write(BIO *bio, const char *data, int len) {
+	isc_nmsocket_t *sock = BIO_get_data(bio);
+	isc_nmsocket_tls_send_req_t *send_req = NULL;
+
+	REQUIRE(VALID_NMSOCK(sock));
+
+	BIO_clear_retry_flags(bio);
+	if (len <= 0) {
+		return (0);
+	}
+
+	send_req = tls_get_send_req(sock);
+	isc_buffer_putmem(&send_req->data, (const unsigned char *)data,
+			  (unsigned int)len);
+
+	return (len);
+}
+
+static long
+tls_bio_out_ctrl(BIO *bio, int cmd, long num, void *ptr) {
+	isc_nmsocket_t *sock = BIO_get_data(bio);
+
+	UNUSED(num);
+	UNUSED(ptr);
+
+	switch (cmd) {
+	case BIO_CTRL_PENDING:
+		if (sock == NULL || sock->tlsstream.send_req == NULL) {
+			return (0);
+		}
+		return (isc_buffer_usedlength(&sock->tlsstream.send_req->data));
+	case BIO_CTRL_FLUSH:
+		return (1);
+	default:
+		return (0);
+	}
+}
+
+/*
+ * The BIO type index is allocated only once per process, as OpenSSL
+ * has a small, fixed number of them; the method itself belongs to the
+ * network manager and is freed with it.
+ */
+static void
+tls_bio_initialize(void) {
+	tls_bio_out_type = BIO_get_new_index();
+	RUNTIME_CHECK(tls_bio_out_type != -1);
+	tls_bio_out_type |= BIO_TYPE_SOURCE_SINK;
+}
+
+void
+isc__nm_tls_initialize(isc_nm_t *mgr) {
+	REQUIRE(VALID_NM(mgr));
+	REQUIRE(mgr->tls_bio_out_method == NULL);
+
+	isc_once_do(&tls_bio_once, tls_bio_initialize);
+
+	mgr->tls_bio_out_method = BIO_meth_new(tls_bio_out_type,
+					       "isc netmgr out");
+	RUNTIME_CHECK(mgr->tls_bio_out_method != NULL);
+	RUNTIME_CHECK(BIO_meth_set_write(mgr->tls_bio_out_method,
+					 tls_bio_out_write) == 1);
+	RUNTIME_CHECK(BIO_meth_set_ctrl(mgr->tls_bio_out_method,
+					tls_bio_out_ctrl) == 1);
+}
+
+void
+isc__nm_tls_shutdown(isc_nm_t *mgr) {
+	REQUIRE(VALID_NM(mgr));
+
+	if (mgr->tls_bio_out_method != NULL) {
+		BIO_meth_free(mgr->tls_bio_out_method);
+		mgr->tls_bio_out_method = NULL;
+	}
+}
+
 static int
 tls_send_outgoing(isc_nmsocket_t *sock, bool finish, isc_nmhandle_t *tlshandle,
 		  isc_nm_cb_t cb, void *cbarg) {
 	isc_nmsocket_tls_send_req_t *send_req = NULL;
 	int pending;
-	int rv;
-	size_t len = 0;
-	bool new_send_req = false;
 	isc_region_t used_region = { 0 };
 	bool shutting_down = isc__nm_closing(sock->worker);
 
@@ -379,23 +479,12 @@ tls_send_outgoing(isc_nmsocket_t *sock, bool finish, isc_nmhandle_t *tlshandle,
 		return (pending);
 	}
 
-	/* Try to reuse previously allocated object */
-	if (sock->tlsstream.send_req != NULL) {
-		send_req = sock->tlsstream.send_req;
-		send_req->finish = finish;
-		sock->tlsstream.send_req = NULL;
-	} else {
-		send_req = isc_mem_get(sock->worker->mctx, sizeof(*send_req));
-		*send_req = (isc_nmsocket_tls_send_req_t){ .finish = finish };
-		new_send_req = true;
-	}
-
-	if (new_send_req) {
-		isc_buffer_init(&send_req->data, &send_req->smallbuf,
-				sizeof(send_req->smallbuf));
-		isc_buffer_setmctx(&send_req->data, sock->worker->mctx);
-	}
-	INSIST(isc_buffer_remaininglength(&send_req->data) == 0);
+	/* The records to send have been written to the send request */
+	send_req = sock->tlsstream.send_req;
+	INSIST(send_req != NULL);
+	INSIST(isc_buffer_remaininglength(&send_req->data) == (size_t)pending);
+	sock->tlsstream.send_req = NULL;
+	send_req->finish = finish;
 
 	isc__nmsocket_attach(sock, &send_req->tlssock);
 	if (cb != NULL) {
@@ -404,14 +493,6 @@ tls_send_outgoing(isc_nmsocket_t *sock, bool finish, isc_nmhandle_t *tlshandle,
 		isc_nmhandle_attach(tlshandle, &send_req->handle);
 	}
 
-	RUNTIME_CHECK(isc_buffer_reserve(&send_req->data, pending) ==
-		      ISC_R_SUCCESS);
-	isc_buffer_add(&send_req->data, pending);
-	rv = BIO_read_ex(sock->tlsstream.bio_out,
-			 isc_buffer_base(&send_req->data), pending, &len);
-	/* There's something pending, read must succeed */
-	RUNTIME_CHECK(rv == 1 && len == (size_t)pending);
-
 	INSIST(VALID_NMHANDLE(sock->outerhandle));
 
 	sock->tlsstream.nsending++;
@@ -447,6 +528,20 @@ tls_process_outgoing(isc_nmsocket_t *sock, bool finish,
 	return (pending);
 }
 
+static void
+tls_handshake_stats(isc_nmsocket_t *sock) {
+	isc_stats_t *stats = sock->worker->netmgr->stats;
+
+	if (stats == NULL) {
+		return;
+	}
+
+	isc_stats_increment(stats, isc_sockstatscounter_tlshandshake);
+	if (SSL_session_reused(sock->tlsstream.tls) == 1) {
+		isc_stats_increment(stats, isc_sockstatscounter_tlsresumed);
+	}
+}
+
 static int
 tls_try_handshake(isc_nmsocket_t *sock, isc_result_t *presult) {
 	REQUIRE(sock->tlsstream.state == TLS_HANDSHAKE);
@@ -464,6 +559,9 @@ tls_try_handshake(isc_nmsocket_t *sock, isc_result_t *presult) {
 		INSIST(SSL_is_init_finished(sock->tlsstream.tls) == 1);
 
 		isc__nmsocket_log_tls_session_reuse(sock, sock->tlsstream.tls);
+		if (sock->tlsstream.server) {
+			tls_handshake_stats(sock);
+		}
 		tlshandle = isc__nmhandle_get(sock, &sock->peer, &sock->iface);
 		tls_read_stop(sock);
 
@@ -849,17 +947,18 @@ initialize_tls(isc_nmsocket_t *sock, bool server) {
 		isc_tls_free(&sock->tlsstream.tls);
 		return (ISC_R_TLSERROR);
 	}
-	sock->tlsstream.bio_out = BIO_new(BIO_s_mem());
+	sock->tlsstream.bio_out =
+		BIO_new(sock->worker->netmgr->tls_bio_out_method);
 	if (sock->tlsstream.bio_out == NULL) {
 		BIO_free_all(sock->tlsstream.bio_in);
 		sock->tlsstream.bio_in = NULL;
 		isc_tls_free(&sock->tlsstream.tls);
 		return (ISC_R_TLSERROR);
 	}
+	BIO_set_data(sock->tlsstream.bio_out, sock);
+	BIO_set_init(sock->tlsstream.bio_out, 1);
 
-	if (BIO_set_mem_eof_return(sock->tlsstream.bio_in, EOF) != 1 ||
-	    BIO_set_mem_eof_return(sock->tlsstream.bio_out, EOF) != 1)
-	{
+	if (BIO_set_mem_eof_return(sock->tlsstream.bio_in, EOF) != 1) {
 		goto error;
 	}
 
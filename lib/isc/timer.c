@@ -44,11 +44,209 @@ struct isc_timer {
 	uint64_t timeout;
 	uint64_t repeat;
 	atomic_bool running;
+
+	/* Timer wheel */
+	bool wheel;
+	uint64_t expires; /* In ticks */
+	isc__timerlist_t *slot;
+	ISC_LINK(isc_timer_t) link;
 };
 
-void
-isc_timer_create(isc_loop_t *loop, isc_job_cb cb, void *cbarg,
-		 isc_timer_t **timerp) {
+/*
+ * Timer wheel
+ *
+ * Timers created with isc_timer_createwheel() are not libuv timers of
+ * their own.  They are kept in the hashed hierarchical timer wheel of
+ * their loop, which is driven by a single uv_timer_t ticking every
+ * TIMERWHEEL_TICK milliseconds while the wheel is not empty.  Starting
+ * and stopping such a timer is O(1), however many there are.
+ *
+ * A timer due in less than one turn of level 0 is put in the level 0
+ * slot of its expiry tick.  Timers due later go in the slot of the
+ * first level whose turn covers them.  When level 0 wraps around, the
+ * current slot of level 1 is cascaded, i.e. its timers are put back
+ * in the wheel and so land in level 0; when that one wraps around too,
+ * level 2 is cascaded, and so on.
+ */
+
+static uint64_t
+wheel_tick(isc_loop_t *loop) {
+	return (uv_now(&loop->loop) / TIMERWHEEL_TICK);
+}
+
+static void
+wheel_insert(isc__timerwheel_t *wheel, isc_timer_t *timer) {
+	uint64_t delta;
+	unsigned int level;
+
+	if (timer->expires < wheel->now) {
+		timer->expires = wheel->now;
+	}
+
+	delta = timer->expires - wheel->now;
+	for (level = 0; level < TIMERWHEEL_LEVELS - 1; level++) {
+		if (delta < (UINT64_C(1) << (TIMERWHEEL_BITS * (level + 1)))) {
+			break;
+		}
+	}
+	if (delta >= (UINT64_C(1) << (TIMERWHEEL_BITS * TIMERWHEEL_LEVELS))) {
+		/* Beyond the wheel's horizon, clamp it */
+		timer->expires = wheel->now +
+				 (UINT64_C(1)
+				  << (TIMERWHEEL_BITS * TIMERWHEEL_LEVELS)) -
+				 1;
+	}
+
+	timer->slot = &wheel->slots[level][(timer->expires >>
+					    (TIMERWHEEL_BITS * level)) &
+					   TIMERWHEEL_MASK];
+	ISC_LIST_APPEND(*timer->slot, timer, link);
+}
+
+static void
+wheel_cb(uv_timer_t *handle);
+
+static void
+wheel_link(isc_timer_t *timer, uint64_t ticks) {
+	isc__timerwheel_t *wheel = &timer->loop->wheel;
+
+	if (wheel->count++ == 0) {
+		/*
+		 * The wheel is empty, so its time can be moved forward
+		 * to the present without processing the ticks in between,
+		 * unless a callback run by wheel_advance() got us here.
+		 */
+		int r = uv_timer_start(&wheel->timer, wheel_cb,
+				       TIMERWHEEL_TICK, TIMERWHEEL_TICK);
+		UV_RUNTIME_CHECK(uv_timer_start, r);
+		if (!wheel->advancing) {
+			wheel->now = wheel_tick(timer->loop);
+		}
+	}
+
+	/*
+	 * The current tick is already partly over, so count from the
+	 * next one to never fire early.
+	 */
+	timer->expires = ISC_MAX(wheel_tick(timer->loop) + ticks + 1,
+				 wheel->now + 1);
+	wheel_insert(wheel, timer);
+}
+
+static void
+wheel_unlink(isc_timer_t *timer) {
+	isc__timerwheel_t *wheel = &timer->loop->wheel;
+
+	if (timer->slot == NULL) {
+		return;
+	}
+
+	ISC_LIST_UNLINK(*timer->slot, timer, link);
+	timer->slot = NULL;
+
+	INSIST(wheel->count > 0);
+	if (--wheel->count == 0) {
+		uv_timer_stop(&wheel->timer);
+	}
+}
+
+/*
+ * Move the timers in the current slot of 'level' down the wheel.
+ * Return true if the higher levels need to be cascaded too.
+ */
+static bool
+wheel_cascade(isc__timerwheel_t *wheel, unsigned int level) {
+	unsigned int index = (wheel->now >> (TIMERWHEEL_BITS * level)) &
+			     TIMERWHEEL_MASK;
+	isc__timerlist_t list = ISC_LIST_INITIALIZER;
+	isc_timer_t *timer = NULL;
+
+	ISC_LIST_MOVE(list, wheel->slots[level][index]);
+	while ((timer = ISC_LIST_HEAD(list)) != NULL) {
+		ISC_LIST_UNLINK(list, timer, link);
+		wheel_insert(wheel, timer);
+	}
+
+	return (index == 0);
+}
+
+/*
+ * Advance the wheel of 'loop' up to tick 'target', running the
+ * callbacks of the timers that expire on the way.
+ *
+ * The expired timers are detached from their slot before any callback
+ * runs, and stay linked on the local 'expired' list until their turn,
+ * so that the callbacks can stop or restart any of them.  A timer
+ * restarted while the wheel is otherwise empty must not move the
+ * wheel's time under the loop, see wheel_link().
+ */
+static void
+wheel_advance(isc_loop_t *loop, uint64_t target) {
+	isc__timerwheel_t *wheel = &loop->wheel;
+	isc__timerlist_t expired = ISC_LIST_INITIALIZER;
+
+	INSIST(!wheel->advancing);
+	wheel->advancing = true;
+
+	while (wheel->count > 0 && wheel->now < target) {
+		isc__timerlist_t *slot = NULL;
+		isc_timer_t *timer = NULL;
+
+		wheel->now++;
+		if ((wheel->now & TIMERWHEEL_MASK) == 0) {
+			for (unsigned int level = 1;
+			     level < TIMERWHEEL_LEVELS &&
+			     wheel_cascade(wheel, level);
+			     level++)
+			{
+				/* Cascade the next level up */
+			}
+		}
+
+		slot = &wheel->slots[0][wheel->now & TIMERWHEEL_MASK];
+		ISC_LIST_MOVE(expired, *slot);
+		for (timer = ISC_LIST_HEAD(expired); timer != NULL;
+		     timer = ISC_LIST_NEXT(timer, link))
+		{
+			timer->slot = &expired;
+		}
+
+		while ((timer = ISC_LIST_HEAD(expired)) != NULL) {
+			if (!atomic_load_acquire(&timer->running)) {
+				wheel_unlink(timer);
+				continue;
+			}
+
+			if (timer->repeat > 0) {
+				ISC_LIST_UNLINK(expired, timer, link);
+				timer->expires = wheel->now + timer->repeat;
+				wheel_insert(wheel, timer);
+			} else {
+				wheel_unlink(timer);
+			}
+
+			timer->cb(timer->cbarg);
+		}
+	}
+
+	wheel->advancing = false;
+}
+
+static void
+wheel_cb(uv_timer_t *handle) {
+	isc_loop_t *loop = uv_handle_get_data(handle);
+
+	wheel_advance(loop, wheel_tick(loop));
+}
+
+static uint64_t
+wheel_ticks(uint64_t ms) {
+	return ((ms + TIMERWHEEL_TICK - 1) / TIMERWHEEL_TICK);
+}
+
+static void
+timer_new(isc_loop_t *loop, isc_job_cb cb, void *cbarg, bool wheel,
+	  isc_timer_t **timerp) {
 	int r;
 	isc_timer_t *timer;
 	isc_loopmgr_t *loopmgr = NULL;
@@ -67,18 +265,34 @@ isc_timer_create(isc_loop_t *loop, isc_job_cb cb, void *cbarg,
 	*timer = (isc_timer_t){
 		.cb = cb,
 		.cbarg = cbarg,
+		.wheel = wheel,
+		.link = ISC_LINK_INITIALIZER,
 		.magic = TIMER_MAGIC,
 	};
 
 	isc_loop_attach(loop, &timer->loop);
 
-	r = uv_timer_init(&loop->loop, &timer->timer);
-	UV_RUNTIME_CHECK(uv_timer_init, r);
-	uv_handle_set_data(&timer->timer, timer);
+	if (!wheel) {
+		r = uv_timer_init(&loop->loop, &timer->timer);
+		UV_RUNTIME_CHECK(uv_timer_init, r);
+		uv_handle_set_data(&timer->timer, timer);
+	}
 
 	*timerp = timer;
 }
 
+void
+isc_timer_create(isc_loop_t *loop, isc_job_cb cb, void *cbarg,
+		 isc_timer_t **timerp) {
+	timer_new(loop, cb, cbarg, false, timerp);
+}
+
+void
+isc_timer_createwheel(isc_loop_t *loop, isc_job_cb cb, void *cbarg,
+		      isc_timer_t **timerp) {
+	timer_new(loop, cb, cbarg, true, timerp);
+}
+
 void
 isc_timer_stop(isc_timer_t *timer) {
 	REQUIRE(VALID_TIMER(timer));
@@ -92,7 +306,11 @@ isc_timer_stop(isc_timer_t *timer) {
 
 	/* Stop the timer, if the loops are matching */
 	if (timer->loop == isc_loop()) {
-		uv_timer_stop(&timer->timer);
+		if (timer->wheel) {
+			wheel_unlink(timer);
+		} else {
+			uv_timer_stop(&timer->timer);
+		}
 	}
 }
 
@@ -142,6 +360,16 @@ isc_timer_start(isc_timer_t *timer, isc_timertype_t type,
 	}
 
 	atomic_store_release(&timer->running, true);
+
+	if (timer->wheel) {
+		wheel_unlink(timer);
+		if (timer->repeat > 0) {
+			timer->repeat = ISC_MAX(wheel_ticks(timer->repeat), 1);
+		}
+		wheel_link(timer, wheel_ticks(timer->timeout));
+		return;
+	}
+
 	r = uv_timer_start(&timer->timer, timer_cb, timer->timeout,
 			   timer->repeat);
 	UV_RUNTIME_CHECK(uv_timer_start, r);
@@ -166,6 +394,16 @@ timer_destroy(void *arg) {
 	isc_timer_t *timer = arg;
 
 	atomic_store_release(&timer->running, false);
+
+	if (timer->wheel) {
+		isc_loop_t *loop = timer->loop;
+
+		wheel_unlink(timer);
+		isc_mem_put(loop->mctx, timer, sizeof(*timer));
+		isc_loop_detach(&loop);
+		return;
+	}
+
 	uv_timer_stop(&timer->timer);
 	uv_close(&timer->timer, timer_close);
 }
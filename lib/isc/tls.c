@@ -32,12 +32,18 @@
 #include <openssl/rsa.h>
 #include <openssl/x509_vfy.h>
 #include <openssl/x509v3.h>
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+#include <openssl/core_names.h>
+#else /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
+#include <openssl/hmac.h>
+#endif /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
 
 #include <isc/atomic.h>
 #include <isc/fips.h>
 #include <isc/ht.h>
 #include <isc/log.h>
 #include <isc/magic.h>
+#include <isc/md.h>
 #include <isc/mem.h>
 #include <isc/mutex.h>
 #include <isc/mutexblock.h>
@@ -45,7 +51,9 @@
 #include <isc/random.h>
 #include <isc/refcount.h>
 #include <isc/rwlock.h>
+#include <isc/safe.h>
 #include <isc/sockaddr.h>
+#include <isc/stdtime.h>
 #include <isc/thread.h>
 #include <isc/tls.h>
 #include <isc/util.h>
@@ -57,6 +65,25 @@
 
 static isc_mem_t *isc__tls_mctx = NULL;
 
+/*
+ * Session ticket keys, shared by all of the server contexts in the
+ * process so that tickets survive reconfiguration.  A new key is made
+ * current by isc_tls_rotateticketkeys(); tickets encrypted with one of
+ * the older keys still in the ring are accepted and renewed.
+ */
+#define TICKET_KEYS 3
+
+typedef struct ticket_key {
+	unsigned char name[16];
+	unsigned char aes_key[32];
+	unsigned char hmac_key[32];
+	isc_stdtime_t created;
+} ticket_key_t;
+
+static isc_rwlock_t ticket_keys_lock;
+static ticket_key_t ticket_keys[TICKET_KEYS];
+static unsigned int ticket_keys_current = 0;
+
 #if !defined(LIBRESSL_VERSION_NUMBER) && OPENSSL_VERSION_NUMBER >= 0x30000000L
 /*
  * This was crippled with LibreSSL, so just skip it:
@@ -181,10 +208,15 @@ isc__tls_initialize(void) {
 	}
 
 	enable_fips_mode();
+
+	isc_rwlock_init(&ticket_keys_lock);
 }
 
 void
 isc__tls_shutdown(void) {
+	isc_rwlock_destroy(&ticket_keys_lock);
+	isc_safe_memwipe(ticket_keys, sizeof(ticket_keys));
+
 	OPENSSL_cleanup();
 
 	isc_mem_destroy(&isc__tls_mctx);
@@ -216,6 +248,163 @@ isc_tlsctx_attach(isc_tlsctx_t *src, isc_tlsctx_t **ptarget) {
 	*ptarget = src;
 }
 
+static void
+ticket_key_generate(ticket_key_t *key, isc_stdtime_t now) {
+	RUNTIME_CHECK(RAND_bytes(key->name, sizeof(key->name)) == 1);
+	RUNTIME_CHECK(RAND_bytes(key->aes_key, sizeof(key->aes_key)) == 1);
+	RUNTIME_CHECK(RAND_bytes(key->hmac_key, sizeof(key->hmac_key)) == 1);
+	key->created = now;
+}
+
+/*
+ * Return a copy of the current ticket key, creating it first if there
+ * is none yet.
+ */
+static void
+ticket_key_current(ticket_key_t *key) {
+	ticket_key_t *current = NULL;
+
+	RWLOCK(&ticket_keys_lock, isc_rwlocktype_read);
+	current = &ticket_keys[ticket_keys_current];
+	if (current->created != 0) {
+		*key = *current;
+		RWUNLOCK(&ticket_keys_lock, isc_rwlocktype_read);
+		return;
+	}
+	RWUNLOCK(&ticket_keys_lock, isc_rwlocktype_read);
+
+	RWLOCK(&ticket_keys_lock, isc_rwlocktype_write);
+	current = &ticket_keys[ticket_keys_current];
+	if (current->created == 0) {
+		ticket_key_generate(current, isc_stdtime_now());
+	}
+	*key = *current;
+	RWUNLOCK(&ticket_keys_lock, isc_rwlocktype_write);
+}
+
+void
+isc_tls_rotateticketkeys(void) {
+	RWLOCK(&ticket_keys_lock, isc_rwlocktype_write);
+	if (ticket_keys[ticket_keys_current].created != 0) {
+		/*
+		 * Keep the current key, and the one before it, for
+		 * decrypting the tickets issued with them.
+		 */
+		ticket_keys_current = (ticket_keys_current + 1) % TICKET_KEYS;
+		ticket_key_generate(&ticket_keys[ticket_keys_current],
+				    isc_stdtime_now());
+	}
+	RWUNLOCK(&ticket_keys_lock, isc_rwlocktype_write);
+}
+
+/*
+ * Find the ticket key named 'name'.  Returns 1 if it is the current key,
+ * 2 if it is an older key (and the ticket should be renewed), or 0 if
+ * there is no such key.
+ */
+static int
+ticket_key_find(const unsigned char *name, ticket_key_t *key) {
+	int ret = 0;
+
+	RWLOCK(&ticket_keys_lock, isc_rwlocktype_read);
+	for (unsigned int i = 0; i < TICKET_KEYS; i++) {
+		if (ticket_keys[i].created != 0 &&
+		    memcmp(ticket_keys[i].name, name, sizeof(key->name)) == 0)
+		{
+			*key = ticket_keys[i];
+			ret = (i == ticket_keys_current) ? 1 : 2;
+			break;
+		}
+	}
+	RWUNLOCK(&ticket_keys_lock, isc_rwlocktype_read);
+
+	return (ret);
+}
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+typedef EVP_MAC_CTX ticket_hmac_ctx_t;
+
+static bool
+ticket_hmac_init(ticket_hmac_ctx_t *hctx, ticket_key_t *key) {
+	OSSL_PARAM params[3];
+
+	params[0] = OSSL_PARAM_construct_octet_string(
+		OSSL_MAC_PARAM_KEY, key->hmac_key, sizeof(key->hmac_key));
+	params[1] = OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST,
+						     (char *)"sha256", 0);
+	params[2] = OSSL_PARAM_construct_end();
+
+	return (EVP_MAC_CTX_set_params(hctx, params) == 1);
+}
+#else  /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
+typedef HMAC_CTX ticket_hmac_ctx_t;
+
+static bool
+ticket_hmac_init(ticket_hmac_ctx_t *hctx, ticket_key_t *key) {
+	return (HMAC_Init_ex(hctx, key->hmac_key, sizeof(key->hmac_key),
+			     EVP_sha256(), NULL) == 1);
+}
+#endif /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
+
+static int
+ticket_key_cb(SSL *ssl, unsigned char *name, unsigned char *iv,
+	      EVP_CIPHER_CTX *cctx, ticket_hmac_ctx_t *hctx, int enc) {
+	ticket_key_t key;
+	int ret = 1;
+
+	UNUSED(ssl);
+
+	if (enc == 1) {
+		ticket_key_current(&key);
+		if (RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc())) !=
+		    1)
+		{
+			ret = -1;
+			goto cleanup;
+		}
+		memmove(name, key.name, sizeof(key.name));
+		if (EVP_EncryptInit_ex(cctx, EVP_aes_256_cbc(), NULL,
+				       key.aes_key, iv) != 1)
+		{
+			ret = -1;
+			goto cleanup;
+		}
+	} else {
+		ret = ticket_key_find(name, &key);
+		if (ret == 0) {
+			/* Unknown or expired key: do a full handshake */
+			return (0);
+		}
+		if (EVP_DecryptInit_ex(cctx, EVP_aes_256_cbc(), NULL,
+				       key.aes_key, iv) != 1)
+		{
+			ret = -1;
+			goto cleanup;
+		}
+	}
+
+	if (!ticket_hmac_init(hctx, &key)) {
+		ret = -1;
+	}
+
+cleanup:
+	isc_safe_memwipe(&key, sizeof(key));
+	return (ret);
+}
+
+/*
+ * Use the process-wide ticket keys for the session tickets issued by
+ * a server context.
+ */
+static void
+ticket_keys_init(isc_tlsctx_t *ctx) {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+	(void)SSL_CTX_set_tlsext_ticket_key_evp_cb(ctx, ticket_key_cb);
+#else  /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
+	(void)SSL_CTX_set_tlsext_ticket_key_cb(ctx, ticket_key_cb);
+#endif /* OPENSSL_VERSION_NUMBER >= 0x30000000L */
+}
+
 /*
  * Callback invoked by the SSL library whenever a new TLS pre-master secret
  * needs to be logged.
@@ -462,6 +651,7 @@ isc_tlsctx_createserver(const char *keyfile, const char *certfile,
 	}
 
 	sslkeylogfile_init(ctx);
+	ticket_keys_init(ctx);
 
 	*ctxp = ctx;
 	return (ISC_R_SUCCESS);
@@ -1654,6 +1844,23 @@ isc_tlsctx_set_random_session_id_context(isc_tlsctx_t *ctx) {
 		SSL_CTX_set_session_id_context(ctx, session_id_ctx, len) == 1);
 }
 
+void
+isc_tlsctx_set_session_id_context(isc_tlsctx_t *ctx, const void *data,
+				  size_t len) {
+	unsigned char digest[ISC_MAX_MD_SIZE];
+	unsigned int digestlen = 0;
+
+	REQUIRE(ctx != NULL);
+	REQUIRE(data != NULL && len > 0);
+
+	RUNTIME_CHECK(isc_md(ISC_MD_SHA256, data, len, digest, &digestlen) ==
+		      ISC_R_SUCCESS);
+	INSIST(digestlen <= SSL_MAX_SID_CTX_LENGTH);
+
+	RUNTIME_CHECK(SSL_CTX_set_session_id_context(ctx, digest, digestlen) ==
+		      1);
+}
+
 static isc_result_t
 isc__tls_toresult(isc_result_t fallback) {
 	isc_result_t result = fallback;
@@ -1264,6 +1264,13 @@ check_options(const cfg_obj_t *options, const cfg_obj_t *config,
 		{ "max-cache-ttl", 1, UINT32_MAX },	     /* no limit */
 		{ "min-ncache-ttl", 1, MAX_MIN_NCACHE_TTL }, /* 90 secs */
 		{ "max-ncache-ttl", 1, MAX_MAX_NCACHE_TTL }, /*  7 days */
+
+		/* background refresh work per second */
+		{ "prefetch-refresh-count", 1, MAX_PREFETCH_REFRESH },
+		{ "prefetch-refresh-rate", 1, MAX_PREFETCH_REFRESH },
+
+		/* UDP requests per second from one source */
+		{ "early-drop-rate", 1, MAX_EARLY_DROP_RATE },
 	};
 
 	static const char *server_contact[] = { "empty-server", "empty-contact",
@@ -1340,8 +1347,8 @@ check_options(const cfg_obj_t *options, const cfg_obj_t *config,
 	}
 
 	/*
-	 * Check that fields specified in units of time other than seconds
-	 * have reasonable values.
+	 * Check that fields specified in units of time other than seconds,
+	 * and counts that size per-second work, have reasonable values.
 	 */
 	for (i = 0; i < sizeof(intervals) / sizeof(intervals[0]); i++) {
 		uint32_t val;
@@ -1684,6 +1691,46 @@ check_options(const cfg_obj_t *options, const cfg_obj_t *config,
 		}
 	}
 
+	/*
+	 * Check the query names and types to be dropped early.
+	 */
+	obj = NULL;
+	(void)cfg_map_get(options, "early-drop-names", &obj);
+	for (element = cfg_list_first(obj); element != NULL;
+	     element = cfg_list_next(element))
+	{
+		obj = cfg_listelt_value(element);
+		str = cfg_obj_asstring(obj);
+		if (check_name(str) != ISC_R_SUCCESS) {
+			cfg_obj_log(obj, ISC_LOG_ERROR,
+				    "early-drop-names: invalid name '%s'", str);
+			if (result == ISC_R_SUCCESS) {
+				result = ISC_R_FAILURE;
+			}
+		}
+	}
+
+	obj = NULL;
+	(void)cfg_map_get(options, "early-drop-types", &obj);
+	for (element = cfg_list_first(obj); element != NULL;
+	     element = cfg_list_next(element))
+	{
+		isc_textregion_t r;
+		dns_rdatatype_t type;
+
+		obj = cfg_listelt_value(element);
+		r.base = UNCONST(cfg_obj_asstring(obj));
+		r.length = strlen(r.base);
+		if (dns_rdatatype_fromtext(&type, &r) != ISC_R_SUCCESS) {
+			cfg_obj_log(obj, ISC_LOG_ERROR,
+				    "early-drop-types: invalid type '%s'",
+				    r.base);
+			if (result == ISC_R_SUCCESS) {
+				result = ISC_R_FAILURE;
+			}
+		}
+	}
+
 	/*
 	 * Check that server-id is not too long.
 	 * 1024 bytes should be big enough.
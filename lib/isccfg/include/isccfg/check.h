@@ -32,6 +32,14 @@
 #define MAX_MAX_NCACHE_TTL 7 * 24 * 3600
 #endif /* MAX_MAX_NCACHE_TTL */
 
+#ifndef MAX_PREFETCH_REFRESH
+#define MAX_PREFETCH_REFRESH 10000
+#endif /* MAX_PREFETCH_REFRESH */
+
+#ifndef MAX_EARLY_DROP_RATE
+#define MAX_EARLY_DROP_RATE 65535
+#endif /* MAX_EARLY_DROP_RATE */
+
 #define BIND_CHECK_PLUGINS 0x00000001
 /*%<
  * Check the plugin configuration.
@@ -19,6 +19,7 @@
 #include <isc/atomic.h>
 #include <isc/formatcheck.h>
 #include <isc/fuzz.h>
+#include <isc/hash.h>
 #include <isc/hmac.h>
 #include <isc/log.h>
 #include <isc/mutex.h>
@@ -29,6 +30,7 @@
 #include <isc/siphash.h>
 #include <isc/stats.h>
 #include <isc/stdio.h>
+#include <isc/stdtime.h>
 #include <isc/string.h>
 #include <isc/thread.h>
 #include <isc/tid.h>
@@ -38,11 +40,14 @@
 #include <dns/adb.h>
 #include <dns/badcache.h>
 #include <dns/cache.h>
+#include <dns/compress.h>
 #include <dns/db.h>
 #include <dns/dispatch.h>
 #include <dns/dnstap.h>
 #include <dns/edns.h>
+#include <dns/fixedname.h>
 #include <dns/message.h>
+#include <dns/nametree.h>
 #include <dns/peer.h>
 #include <dns/rcode.h>
 #include <dns/rdata.h>
@@ -1805,6 +1810,183 @@ ns_client_setup_view(ns_client_t *client, isc_netaddr_t *netaddr) {
 	return (result);
 }
 
+static void
+early_drop_log(const isc_sockaddr_t *peeraddr, const char *reason) {
+	char peerbuf[ISC_SOCKADDR_FORMATSIZE];
+
+	if (!isc_log_wouldlog(ISC_LOG_DEBUG(10))) {
+		return;
+	}
+
+	isc_sockaddr_format(peeraddr, peerbuf, sizeof(peerbuf));
+	isc_log_write(DNS_LOGCATEGORY_SECURITY, NS_LOGMODULE_CLIENT,
+		      ISC_LOG_DEBUG(10), "client %s: dropped request: %s",
+		      peerbuf, reason);
+}
+
+/*
+ * Count a UDP request against its source's allowance for the current
+ * second, and return true if the allowance has been used up.  Sources
+ * are counted in a fixed-size table of slots indexed by a hash of the
+ * address; each slot packs the rest of the hash, the second and the
+ * count into one word so that it can be updated without locking.  A
+ * source that hashes to a slot in use by another one takes it over and
+ * starts counting afresh, so collisions can let a busy source through,
+ * but never cause an innocent one to be dropped.
+ */
+static bool
+early_drop_rate(ns_server_t *sctx, const isc_sockaddr_t *peeraddr) {
+	isc_netaddr_t netaddr;
+	uint32_t hash, now;
+	uint64_t old, new;
+	atomic_uint_fast64_t *slot = NULL;
+
+	isc_netaddr_fromsockaddr(&netaddr, peeraddr);
+	if (netaddr.family == AF_INET6) {
+		hash = isc_hash32(&netaddr.type.in6, 8, true);
+	} else {
+		hash = isc_hash32(&netaddr.type.in, sizeof(netaddr.type.in),
+				  true);
+	}
+	now = isc_stdtime_now() & 0xffff;
+	slot = &sctx->dropsources[hash % NS_SERVER_DROPSOURCES];
+
+	old = atomic_load_relaxed(slot);
+	do {
+		if ((old >> 32) == hash && ((old >> 16) & 0xffff) == now) {
+			if ((old & 0xffff) >= sctx->droprate) {
+				return (true);
+			}
+			new = old + 1;
+		} else {
+			new = ((uint64_t)hash << 32) | (now << 16) | 1;
+		}
+	} while (!atomic_compare_exchange_weak_relaxed(slot, &old, new));
+
+	return (false);
+}
+
+/*
+ * Look at the question of a standard query, without parsing the rest
+ * of the message, and return true if its name or type is one that is
+ * configured to be dropped.
+ */
+static bool
+early_drop_question(ns_server_t *sctx, isc_region_t *region) {
+	isc_buffer_t buffer;
+	isc_result_t result;
+	dns_fixedname_t fixed;
+	dns_name_t *name = dns_fixedname_initname(&fixed);
+	dns_rdatatype_t type;
+
+	/* One question, opcode QUERY */
+	if (region->base[4] != 0 || region->base[5] != 1 ||
+	    ((region->base[2] >> 3) & 0xf) != dns_opcode_query)
+	{
+		return (false);
+	}
+
+	isc_buffer_init(&buffer, region->base, region->length);
+	isc_buffer_add(&buffer, region->length);
+	isc_buffer_forward(&buffer, DNS_MESSAGE_HEADERLEN);
+
+	result = dns_name_fromwire(name, &buffer, DNS_DECOMPRESS_NEVER, NULL);
+	if (result != ISC_R_SUCCESS || isc_buffer_remaininglength(&buffer) < 4)
+	{
+		return (false);
+	}
+	type = isc_buffer_getuint16(&buffer);
+
+	if (sctx->droptypes != NULL &&
+	    (sctx->droptypes[type / 8] & (1 << (type % 8))) != 0)
+	{
+		return (true);
+	}
+
+	return (sctx->dropnames != NULL &&
+		dns_nametree_covered(sctx->dropnames, name, NULL, 0));
+}
+
+/*
+ * Decide whether to drop a request using only the peer address, the
+ * fixed-size message header and, if any query names or types are to
+ * be dropped, the question.  This is done before a client is set up
+ * for the request, so that blackholed peers, runt packets, stray
+ * responses and floods that have been singled out in the configuration
+ * are discarded without allocating and initializing a client and its
+ * message.
+ */
+static bool
+early_drop(ns_clientmgr_t *manager, const isc_sockaddr_t *peeraddr,
+	   bool stream, isc_region_t *region, dns_messageid_t *idp,
+	   unsigned int *flagsp) {
+	ns_server_t *sctx = manager->sctx;
+	isc_buffer_t buffer;
+	isc_netaddr_t netaddr;
+	isc_result_t result;
+	int match;
+
+#if NS_CLIENT_DROPPORT
+	if (ns_client_dropport(isc_sockaddr_getport(peeraddr)) ==
+	    DROPPORT_REQUEST)
+	{
+		early_drop_log(peeraddr, "suspicious port");
+		return (true);
+	}
+#endif /* if NS_CLIENT_DROPPORT */
+
+	if (sctx->blackholeacl != NULL) {
+		isc_netaddr_fromsockaddr(&netaddr, peeraddr);
+		if (dns_acl_match(&netaddr, NULL, sctx->blackholeacl,
+				  manager->aclenv, &match,
+				  NULL) == ISC_R_SUCCESS &&
+		    match > 0)
+		{
+			early_drop_log(peeraddr, "blackholed peer");
+			return (true);
+		}
+	}
+
+	isc_buffer_init(&buffer, region->base, region->length);
+	isc_buffer_add(&buffer, region->length);
+	result = dns_message_peekheader(&buffer, idp, flagsp);
+	if (result != ISC_R_SUCCESS) {
+		/*
+		 * There isn't enough header to determine whether
+		 * this was a request or a response.  Drop it.
+		 */
+		early_drop_log(peeraddr, "invalid message header");
+		return (true);
+	}
+
+	/*
+	 * The client object handles requests, not responses.
+	 */
+	if ((*flagsp & DNS_MESSAGEFLAG_QR) != 0) {
+		early_drop_log(peeraddr, "unexpected response");
+		return (true);
+	}
+
+	/*
+	 * TCP clients have completed a handshake, so their source
+	 * addresses are real, and they are limited by the TCP quotas.
+	 */
+	if (!stream && sctx->droprate != 0 && early_drop_rate(sctx, peeraddr))
+	{
+		early_drop_log(peeraddr, "source rate exceeded");
+		return (true);
+	}
+
+	if ((sctx->droptypes != NULL || sctx->dropnames != NULL) &&
+	    early_drop_question(sctx, region))
+	{
+		early_drop_log(peeraddr, "query name or type");
+		return (true);
+	}
+
+	return (false);
+}
+
 /*
  * Handle an incoming request event from the socket (UDP case)
  * or tcpmsg (TCP case).
@@ -1813,26 +1995,37 @@ void
 ns_client_request(isc_nmhandle_t *handle, isc_result_t eresult,
 		  isc_region_t *region, void *arg) {
 	ns_client_t *client = NULL;
+	ns_clientmgr_t *clientmgr = NULL;
 	isc_result_t result;
 	dns_rdataset_t *opt = NULL;
 	isc_netaddr_t netaddr;
-	int match;
+	isc_sockaddr_t peeraddr;
 	dns_messageid_t id;
 	unsigned int flags;
 	bool notimp;
 	size_t reqsize;
-	dns_aclenv_t *env = NULL;
 
 	if (eresult != ISC_R_SUCCESS) {
 		return;
 	}
 
 	client = isc_nmhandle_getdata(handle);
-	if (client == NULL) {
+	if (client != NULL) {
+		clientmgr = client->manager;
+	} else {
 		ns_interface_t *ifp = (ns_interface_t *)arg;
-		ns_clientmgr_t *clientmgr =
-			ns_interfacemgr_getclientmgr(ifp->mgr);
+		clientmgr = ns_interfacemgr_getclientmgr(ifp->mgr);
+	}
 
+	peeraddr = isc_nmhandle_peeraddr(handle);
+	if (early_drop(clientmgr, &peeraddr, isc_nmhandle_is_stream(handle),
+		       region, &id, &flags))
+	{
+		isc_nm_bad_request(handle);
+		return;
+	}
+
+	if (client == NULL) {
 		INSIST(VALID_MANAGER(clientmgr));
 		INSIST(clientmgr->tid == isc_tid());
 
@@ -1867,7 +2060,7 @@ ns_client_request(isc_nmhandle_t *handle, isc_result_t eresult,
 	isc_buffer_add(&client->tbuffer, region->length);
 	client->buffer = &client->tbuffer;
 
-	client->peeraddr = isc_nmhandle_peeraddr(handle);
+	client->peeraddr = peeraddr;
 	client->peeraddr_valid = true;
 
 	reqsize = isc_buffer_usedlength(client->buffer);
@@ -1880,67 +2073,16 @@ ns_client_request(isc_nmhandle_t *handle, isc_result_t eresult,
 
 	isc_netaddr_fromsockaddr(&netaddr, &client->peeraddr);
 
-#if NS_CLIENT_DROPPORT
-	if (ns_client_dropport(isc_sockaddr_getport(&client->peeraddr)) ==
-	    DROPPORT_REQUEST)
-	{
-		ns_client_log(client, DNS_LOGCATEGORY_SECURITY,
-			      NS_LOGMODULE_CLIENT, ISC_LOG_DEBUG(10),
-			      "dropped request: suspicious port");
-		isc_nm_bad_request(handle);
-		return;
-	}
-#endif /* if NS_CLIENT_DROPPORT */
-
-	env = client->manager->aclenv;
-	if (client->manager->sctx->blackholeacl != NULL &&
-	    (dns_acl_match(&netaddr, NULL, client->manager->sctx->blackholeacl,
-			   env, &match, NULL) == ISC_R_SUCCESS) &&
-	    match > 0)
-	{
-		ns_client_log(client, DNS_LOGCATEGORY_SECURITY,
-			      NS_LOGMODULE_CLIENT, ISC_LOG_DEBUG(10),
-			      "dropped request: blackholed peer");
-		isc_nm_bad_request(handle);
-		return;
-	}
-
 	ns_client_log(client, NS_LOGCATEGORY_CLIENT, NS_LOGMODULE_CLIENT,
 		      ISC_LOG_DEBUG(3), "%s request",
 		      TCP_CLIENT(client) ? "TCP" : "UDP");
 
-	result = dns_message_peekheader(client->buffer, &id, &flags);
-	if (result != ISC_R_SUCCESS) {
-		/*
-		 * There isn't enough header to determine whether
-		 * this was a request or a response.  Drop it.
-		 */
-		ns_client_log(client, DNS_LOGCATEGORY_SECURITY,
-			      NS_LOGMODULE_CLIENT, ISC_LOG_DEBUG(10),
-			      "dropped request: invalid message header");
-		isc_nm_bad_request(handle);
-		return;
-	}
-
 #ifdef WANT_SINGLETRACE
 	if (id == 0) {
 		isc_log_setforcelog(true);
 	}
 #endif /* WANT_SINGLETRACE */
 
-	/*
-	 * The client object handles requests, not responses.
-	 * If this is a UDP response, forward it to the dispatcher.
-	 * If it's a TCP response, discard it here.
-	 */
-	if ((flags & DNS_MESSAGEFLAG_QR) != 0) {
-		ns_client_log(client, DNS_LOGCATEGORY_SECURITY,
-			      NS_LOGMODULE_CLIENT, ISC_LOG_DEBUG(10),
-			      "dropped request: unexpected response");
-		isc_nm_bad_request(handle);
-		return;
-	}
-
 	/*
 	 * Update some statistics counters.  Don't count responses.
 	 */
@@ -18,7 +18,9 @@
 #include <inttypes.h>
 #include <stdbool.h>
 
+#include <isc/atomic.h>
 #include <isc/fuzz.h>
+#include <isc/hashmap.h>
 #include <isc/histo.h>
 #include <isc/log.h>
 #include <isc/magic.h>
@@ -28,6 +30,7 @@
 #include <isc/types.h>
 
 #include <dns/acl.h>
+#include <dns/nametree.h>
 #include <dns/types.h>
 
 #include <ns/types.h>
@@ -51,6 +54,17 @@
 #define NS_SERVER_TRANSFERSTUCK	 0x00020000U /*%< -T transferstuck */
 #define NS_SERVER_LOGRESPONSES	 0x00040000U /*%< log responses */
 
+/*%
+ * The largest per-source request rate that can be enforced before
+ * requests are parsed.
+ */
+#define NS_SERVER_DROPRATE_MAX 65535
+
+/*%
+ * The number of slots used to count requests per source address.
+ */
+#define NS_SERVER_DROPSOURCES 65536
+
 /*%
  * Type for callback function to get hostname.
  */
@@ -96,10 +110,22 @@ struct ns_server {
 	ISC_LIST(isc_quota_t) http_quotas;
 	isc_mutex_t http_quotas_lock;
 
+	/*% Dynamic updates waiting to be applied, by zone */
+	isc_hashmap_t *updbatches;
+	isc_mutex_t    updbatch_lock;
+	uint32_t       updbatchsize; /*%< 0 or 1: no batching */
+
 	/*% Test options and other configurables */
 	uint32_t options;
 
 	dns_acl_t     *blackholeacl;
+
+	/*% Requests dropped before they are parsed */
+	dns_nametree_t	     *dropnames;
+	uint8_t		     *droptypes;
+	uint32_t	      droprate;
+	atomic_uint_fast64_t *dropsources;
+
 	uint16_t       udpsize;
 	uint16_t       transfer_tcp_message_size;
 	bool	       interface_auto;
@@ -195,6 +221,42 @@ ns_server_getoption(ns_server_t *sctx, unsigned int option);
  *\li	'sctx' is valid.
  */
 
+void
+ns_server_setdroptypes(ns_server_t *sctx, const dns_rdatatype_t *types,
+		       size_t ntypes);
+/*%<
+ *	Drop queries for any of the 'ntypes' types in 'types' as soon as
+ *	they are received, before they are parsed.  An empty list disables
+ *	dropping by type.
+ *
+ * Requires:
+ *\li	'sctx' is valid.
+ */
+
+void
+ns_server_setdropnames(ns_server_t *sctx, dns_nametree_t *names);
+/*%<
+ *	Drop queries for names at or below any name in 'names' as soon as
+ *	they are received, before they are parsed.  If 'names' is NULL,
+ *	dropping by name is disabled.
+ *
+ * Requires:
+ *\li	'sctx' is valid.
+ */
+
+void
+ns_server_setdroprate(ns_server_t *sctx, uint32_t rate);
+/*%<
+ *	Drop UDP requests from a source address that has already sent
+ *	'rate' requests in the current second, before they are parsed.
+ *	IPv6 sources are counted per /64.  A 'rate' of 0 disables the
+ *	limit.
+ *
+ * Requires:
+ *\li	'sctx' is valid;
+ *\li	'rate' is no greater than #NS_SERVER_DROPRATE_MAX.
+ */
+
 void
 ns_server_append_http_quota(ns_server_t *sctx, isc_quota_t *http_quota);
 /*%<
@@ -15,6 +15,7 @@
 
 #include <stdbool.h>
 
+#include <isc/buffer.h>
 #include <isc/log.h>
 #include <isc/mem.h>
 #include <isc/netmgr.h>
@@ -27,6 +28,36 @@
 static void
 destroy(ns_listenlist_t *list);
 
+/*
+ * Derive the TLS session ID context of a listener from the parts of its
+ * configuration that determine which sessions it may resume, so that
+ * it stays the same when the TLS context is rebuilt.
+ */
+static void
+listenelt_set_session_id_context(isc_mem_t *mctx, isc_tlsctx_t *sslctx,
+				 const ns_listen_tls_params_t *tls_params,
+				 const bool is_http) {
+	const char *parts[] = { is_http ? "https" : "tls",
+				tls_params->name,
+				tls_params->key,
+				tls_params->cert,
+				tls_params->ca_file };
+	isc_buffer_t *b = NULL;
+
+	isc_buffer_allocate(mctx, &b, 256);
+	for (size_t i = 0; i < ARRAY_SIZE(parts); i++) {
+		if (parts[i] != NULL) {
+			isc_buffer_putstr(b, parts[i]);
+		}
+		isc_buffer_putuint8(b, 0);
+	}
+
+	isc_tlsctx_set_session_id_context(sslctx, isc_buffer_base(b),
+					  isc_buffer_usedlength(b));
+
+	isc_buffer_free(&b);
+}
+
 static isc_result_t
 listenelt_create(isc_mem_t *mctx, in_port_t port, dns_acl_t *acl,
 		 const uint16_t family, const bool is_http, bool tls,
@@ -75,7 +106,8 @@ listenelt_create(isc_mem_t *mctx, in_port_t port, dns_acl_t *acl,
 			 * 'SSL_CTX_set_session_id_context()', the "Warnings"
 			 * section.
 			 */
-			isc_tlsctx_set_random_session_id_context(sslctx);
+			listenelt_set_session_id_context(mctx, sslctx,
+							 tls_params, is_http);
 
 			/*
 			 * If CA-bundle file is specified - enable client
@@ -5695,6 +5695,9 @@ query_lookup(query_ctx_t *qctx) {
 	{
 		dboptions |= DNS_DBFIND_COVERINGNSEC;
 	}
+	if (!qctx->is_zone && qctx->view->nxdomaincut) {
+		dboptions |= DNS_DBFIND_NXDOMAINCUT;
+	}
 
 	(void)dns_db_getservestalerefresh(qctx->client->view->cachedb,
 					  &stale_refresh);
@@ -15,8 +15,10 @@
 
 #include <stdbool.h>
 
+#include <isc/hashmap.h>
 #include <isc/mem.h>
 #include <isc/stats.h>
+#include <isc/string.h>
 #include <isc/util.h>
 
 #include <dns/stats.h>
@@ -69,6 +71,8 @@ ns_server_create(isc_mem_t *mctx, ns_matchview_t matchingview,
 	isc_quota_init(&sctx->sig0checksquota, 1);
 	ISC_LIST_INIT(sctx->http_quotas);
 	isc_mutex_init(&sctx->http_quotas_lock);
+	isc_hashmap_create(mctx, 4, &sctx->updbatches);
+	isc_mutex_init(&sctx->updbatch_lock);
 
 	ns_stats_create(mctx, ns_statscounter_max, &sctx->nsstats);
 
@@ -158,6 +162,10 @@ ns_server_detach(ns_server_t **sctxp) {
 		}
 		isc_mutex_destroy(&sctx->http_quotas_lock);
 
+		INSIST(isc_hashmap_count(sctx->updbatches) == 0);
+		isc_hashmap_destroy(&sctx->updbatches);
+		isc_mutex_destroy(&sctx->updbatch_lock);
+
 		if (sctx->server_id != NULL) {
 			isc_mem_free(sctx->mctx, sctx->server_id);
 		}
@@ -165,6 +173,9 @@ ns_server_detach(ns_server_t **sctxp) {
 		if (sctx->blackholeacl != NULL) {
 			dns_acl_detach(&sctx->blackholeacl);
 		}
+		ns_server_setdroptypes(sctx, NULL, 0);
+		ns_server_setdropnames(sctx, NULL);
+		ns_server_setdroprate(sctx, 0);
 		if (sctx->tkeyctx != NULL) {
 			dns_tkeyctx_destroy(&sctx->tkeyctx);
 		}
@@ -248,6 +259,62 @@ ns_server_getoption(ns_server_t *sctx, unsigned int option) {
 	return ((sctx->options & option) != 0);
 }
 
+void
+ns_server_setdroptypes(ns_server_t *sctx, const dns_rdatatype_t *types,
+		       size_t ntypes) {
+	REQUIRE(SCTX_VALID(sctx));
+	REQUIRE(types != NULL || ntypes == 0);
+
+	if (ntypes == 0) {
+		if (sctx->droptypes != NULL) {
+			isc_mem_put(sctx->mctx, sctx->droptypes, 65536 / 8);
+		}
+		return;
+	}
+
+	if (sctx->droptypes == NULL) {
+		sctx->droptypes = isc_mem_get(sctx->mctx, 65536 / 8);
+	}
+	memset(sctx->droptypes, 0, 65536 / 8);
+	for (size_t i = 0; i < ntypes; i++) {
+		sctx->droptypes[types[i] / 8] |= 1 << (types[i] % 8);
+	}
+}
+
+void
+ns_server_setdropnames(ns_server_t *sctx, dns_nametree_t *names) {
+	REQUIRE(SCTX_VALID(sctx));
+
+	if (sctx->dropnames != NULL) {
+		dns_nametree_detach(&sctx->dropnames);
+	}
+	if (names != NULL) {
+		dns_nametree_attach(names, &sctx->dropnames);
+	}
+}
+
+void
+ns_server_setdroprate(ns_server_t *sctx, uint32_t rate) {
+	REQUIRE(SCTX_VALID(sctx));
+	REQUIRE(rate <= NS_SERVER_DROPRATE_MAX);
+
+	sctx->droprate = rate;
+	if (rate == 0) {
+		if (sctx->dropsources != NULL) {
+			isc_mem_cput(sctx->mctx, sctx->dropsources,
+				     NS_SERVER_DROPSOURCES,
+				     sizeof(sctx->dropsources[0]));
+		}
+		return;
+	}
+
+	if (sctx->dropsources == NULL) {
+		sctx->dropsources = isc_mem_cget(sctx->mctx,
+						 NS_SERVER_DROPSOURCES,
+						 sizeof(sctx->dropsources[0]));
+	}
+}
+
 void
 ns_server_append_http_quota(ns_server_t *sctx, isc_quota_t *http_quota) {
 	REQUIRE(SCTX_VALID(sctx));
@@ -15,6 +15,8 @@
 #include <stdbool.h>
 
 #include <isc/async.h>
+#include <isc/hash.h>
+#include <isc/hashmap.h>
 #include <isc/log.h>
 #include <isc/netaddr.h>
 #include <isc/serial.h>
@@ -231,8 +233,43 @@ struct update {
 	dns_message_t *answer;
 	const dns_ssurule_t **rules;
 	size_t ruleslen;
+	ISC_LINK(update_t) link;
 };
 
+/*%
+ * Updates queued for one zone, waiting to be applied together on the
+ * zone's loop.  'queued' is cleared once the batch is full or is being
+ * applied, and further updates start a new batch (protected by
+ * sctx->updbatch_lock).
+ */
+typedef struct update_batch {
+	isc_mem_t *mctx;
+	ns_server_t *sctx;
+	dns_zone_t *zone;
+	ISC_LIST(update_t) updates;
+	uint32_t count;
+	bool queued;
+} update_batch_t;
+
+/*%
+ * A new version of a zone's database and the changes made to it by
+ * the updates applied so far.
+ */
+typedef struct update_txn {
+	dns_zone_t *zone;
+	dns_db_t *db;
+	dns_dbversion_t *oldver;
+	dns_dbversion_t *ver;
+	dns_name_t *zonename;
+	dns_rdataclass_t zoneclass;
+	dns_ssutable_t *ssutable;
+	dns_zoneopt_t options;
+	dns_rdatatype_t privatetype;
+	bool is_signing;
+	bool soa_serial_changed;
+	dns_diff_t diff; /* Pending updates. */
+} update_txn_t;
+
 /*%
  * Prepare an RR for the addition of the new RR 'ctx->update_rr',
  * with TTL 'ctx->update_rr_ttl', to its rdataset, by deleting
@@ -261,7 +298,7 @@ typedef struct {
  */
 
 static void
-update_action(void *arg);
+update_queue(ns_client_t *client, update_t *uev);
 static void
 updatedone_action(void *arg);
 static isc_result_t
@@ -1886,10 +1923,11 @@ send_update(ns_client_t *client, dns_zone_t *zone) {
 		.rules = rules,
 		.ruleslen = ruleslen,
 		.result = ISC_R_SUCCESS,
+		.link = ISC_LINK_INITIALIZER,
 	};
 
 	isc_nmhandle_attach(client->handle, &client->updatehandle);
-	isc_async_run(dns_zone_getloop(zone), update_action, uev);
+	update_queue(client, uev);
 	rules = NULL;
 
 failure:
@@ -2725,54 +2763,62 @@ isdnssec(dns_db_t *db, dns_dbversion_t *ver, dns_rdatatype_t privatetype) {
 	return (build_nsec || build_nsec3);
 }
 
-static void
-update_action(void *arg) {
-	update_t *uev = (update_t *)arg;
-	dns_zone_t *zone = uev->zone;
-	ns_client_t *client = uev->client;
-	const dns_ssurule_t **rules = uev->rules;
-	size_t rule = 0, ruleslen = uev->ruleslen;
+/*%
+ * Begin a transaction on 'zone': open a new version of its database
+ * that one or more updates are then applied to.
+ */
+static isc_result_t
+update_begin(dns_zone_t *zone, isc_mem_t *mctx, update_txn_t *txn) {
 	isc_result_t result;
-	dns_db_t *db = NULL;
-	dns_dbversion_t *oldver = NULL;
-	dns_dbversion_t *ver = NULL;
-	dns_diff_t diff; /* Pending updates. */
-	dns_diff_t temp; /* Pending RR existence assertions. */
-	bool soa_serial_changed = false;
-	isc_mem_t *mctx = client->manager->mctx;
-	dns_rdatatype_t covers;
-	dns_message_t *request = client->message;
-	dns_rdataclass_t zoneclass;
-	dns_name_t *zonename = NULL;
-	dns_ssutable_t *ssutable = NULL;
-	dns_fixedname_t tmpnamefixed;
-	dns_name_t *tmpname = NULL;
-	dns_zoneopt_t options;
-	bool had_dnskey;
-	dns_rdatatype_t privatetype = dns_zone_getprivatetype(zone);
-	dns_ttl_t maxttl = 0;
-	uint32_t maxrecords;
-	uint64_t records;
-	bool is_inline, is_maintain, is_signing;
+	bool is_inline, is_maintain;
 
-	dns_diff_init(mctx, &diff);
-	dns_diff_init(mctx, &temp);
+	*txn = (update_txn_t){
+		.zone = zone,
+		.privatetype = dns_zone_getprivatetype(zone),
+	};
+	dns_diff_init(mctx, &txn->diff);
 
-	CHECK(dns_zone_getdb(zone, &db));
-	zonename = dns_db_origin(db);
-	zoneclass = dns_db_class(db);
-	dns_zone_getssutable(zone, &ssutable);
-	options = dns_zone_getoptions(zone);
+	result = dns_zone_getdb(zone, &txn->db);
+	if (result != ISC_R_SUCCESS) {
+		return (result);
+	}
+	txn->zonename = dns_db_origin(txn->db);
+	txn->zoneclass = dns_db_class(txn->db);
+	dns_zone_getssutable(zone, &txn->ssutable);
+	txn->options = dns_zone_getoptions(zone);
 
 	is_inline = (!dns_zone_israw(zone) && dns_zone_issecure(zone));
 	is_maintain = ((dns_zone_getkeyopts(zone) & DNS_ZONEKEY_MAINTAIN) != 0);
-	is_signing = is_inline || (!is_inline && is_maintain);
+	txn->is_signing = is_inline || (!is_inline && is_maintain);
 
 	/*
 	 * Get old and new versions now that queryacl has been checked.
 	 */
-	dns_db_currentversion(db, &oldver);
-	CHECK(dns_db_newversion(db, &ver));
+	dns_db_currentversion(txn->db, &txn->oldver);
+	return (dns_db_newversion(txn->db, &txn->ver));
+}
+
+/*%
+ * Check the prerequisites of the update in 'uev' against the
+ * transaction's current version.
+ */
+static isc_result_t
+update_prereqs(update_t *uev, update_txn_t *txn) {
+	dns_zone_t *zone = txn->zone;
+	ns_client_t *client = uev->client;
+	isc_result_t result;
+	dns_db_t *db = txn->db;
+	dns_dbversion_t *ver = txn->ver;
+	dns_diff_t temp; /* Pending RR existence assertions. */
+	isc_mem_t *mctx = client->manager->mctx;
+	dns_rdatatype_t covers;
+	dns_message_t *request = client->message;
+	dns_rdataclass_t zoneclass = txn->zoneclass;
+	dns_name_t *zonename = txn->zonename;
+	dns_fixedname_t tmpnamefixed;
+	dns_name_t *tmpname = NULL;
+
+	dns_diff_init(mctx, &temp);
 
 	/*
 	 * Check prerequisites.
@@ -2894,6 +2940,35 @@ update_action(void *arg) {
 	}
 
 	update_log(client, zone, LOGLEVEL_DEBUG, "prerequisites are OK");
+	result = ISC_R_SUCCESS;
+
+failure:
+	dns_diff_clear(&temp);
+	return (result);
+}
+
+/*%
+ * Apply the update section of the update in 'uev' to the transaction's
+ * version, logging the changes in 'diff'.
+ */
+static isc_result_t
+update_apply(update_t *uev, update_txn_t *txn, dns_diff_t *diff) {
+	dns_zone_t *zone = txn->zone;
+	ns_client_t *client = uev->client;
+	const dns_ssurule_t **rules = uev->rules;
+	size_t rule = 0, ruleslen = uev->ruleslen;
+	isc_result_t result;
+	dns_db_t *db = txn->db;
+	dns_dbversion_t *ver = txn->ver;
+	dns_rdatatype_t covers;
+	dns_message_t *request = client->message;
+	dns_rdataclass_t zoneclass = txn->zoneclass;
+	dns_name_t *zonename = txn->zonename;
+	dns_ssutable_t *ssutable = txn->ssutable;
+	dns_zoneopt_t options = txn->options;
+	isc_mem_t *mctx = client->manager->mctx;
+	dns_rdatatype_t privatetype = txn->privatetype;
+	dns_ttl_t maxttl = 0;
 
 	/*
 	 * Process the Update Section.
@@ -2993,7 +3068,7 @@ update_action(void *arg) {
 						   "ignoring it");
 					continue;
 				}
-				soa_serial_changed = true;
+				txn->soa_serial_changed = true;
 			}
 
 			if (dns_rdatatype_atparent(rdata.type) &&
@@ -3113,7 +3188,7 @@ update_action(void *arg) {
 				add_rr_prepare_ctx_t ctx;
 				ctx.db = db;
 				ctx.ver = ver;
-				ctx.diff = &diff;
+				ctx.diff = diff;
 				ctx.name = name;
 				ctx.oldname = name;
 				ctx.update_rr = &rdata;
@@ -3130,11 +3205,11 @@ update_action(void *arg) {
 					dns_diff_clear(&ctx.add_diff);
 				} else {
 					result = do_diff(&ctx.del_diff, db, ver,
-							 &diff);
+							 diff);
 					if (result == ISC_R_SUCCESS) {
 						result = do_diff(&ctx.add_diff,
 								 db, ver,
-								 &diff);
+								 diff);
 					}
 					if (result != ISC_R_SUCCESS) {
 						dns_diff_clear(&ctx.del_diff);
@@ -3142,7 +3217,7 @@ update_action(void *arg) {
 						goto failure;
 					}
 					result = update_one_rr(
-						db, ver, &diff, DNS_DIFFOP_ADD,
+						db, ver, diff, DNS_DIFFOP_ADD,
 						name, ttl, &rdata);
 					if (result != ISC_R_SUCCESS) {
 						update_log(client, zone,
@@ -3171,12 +3246,12 @@ update_action(void *arg) {
 					CHECK(delete_if(type_not_soa_nor_ns_p,
 							db, ver, name,
 							dns_rdatatype_any, 0,
-							&rdata, &diff));
+							&rdata, diff));
 				} else {
 					CHECK(delete_if(type_not_dnssec, db,
 							ver, name,
 							dns_rdatatype_any, 0,
-							&rdata, &diff));
+							&rdata, diff));
 				}
 			} else if (dns_name_equal(name, zonename) &&
 				   (rdata.type == dns_rdatatype_soa ||
@@ -3202,7 +3277,7 @@ update_action(void *arg) {
 				}
 				CHECK(delete_if(true_p, db, ver, name,
 						rdata.type, covers, &rdata,
-						&diff));
+						diff));
 			}
 		} else if (update_class == dns_rdataclass_none) {
 			char namestr[DNS_NAME_FORMATSIZE];
@@ -3269,23 +3344,48 @@ update_action(void *arg) {
 			update_log(client, zone, LOGLEVEL_PROTOCOL,
 				   "deleting an RR at %s %s", namestr, typestr);
 			CHECK(delete_if(rr_equal_p, db, ver, name, rdata.type,
-					covers, &rdata, &diff));
+					covers, &rdata, diff));
 		}
 	}
 	if (result != ISC_R_NOMORE) {
 		FAIL(result);
 	}
+	result = ISC_R_SUCCESS;
+
+failure:
+	return (result);
+}
+
+/*%
+ * Check the changes collected in the transaction, sign them if needed,
+ * write them to the journal and commit the new version.  'client' is
+ * used for logging.
+ */
+static isc_result_t
+update_commit(ns_client_t *client, update_txn_t *txn) {
+	dns_zone_t *zone = txn->zone;
+	isc_result_t result;
+	dns_db_t *db = txn->db;
+	dns_dbversion_t *oldver = txn->oldver;
+	dns_dbversion_t *ver = txn->ver;
+	dns_diff_t *diff = &txn->diff;
+	isc_mem_t *mctx = client->manager->mctx;
+	dns_name_t *zonename = txn->zonename;
+	bool had_dnskey;
+	dns_rdatatype_t privatetype = txn->privatetype;
+	uint32_t maxrecords;
+	uint64_t records;
 
 	/*
 	 * Check that any changes to DNSKEY/NSEC3PARAM records make sense.
 	 * If they don't then back out all changes to DNSKEY/NSEC3PARAM
 	 * records.
 	 */
-	if (!ISC_LIST_EMPTY(diff.tuples)) {
-		CHECK(check_dnssec(client, zone, db, ver, &diff));
+	if (!ISC_LIST_EMPTY(diff->tuples)) {
+		CHECK(check_dnssec(client, zone, db, ver, diff));
 	}
 
-	if (!ISC_LIST_EMPTY(diff.tuples)) {
+	if (!ISC_LIST_EMPTY(diff->tuples)) {
 		unsigned int errors = 0;
 		CHECK(dns_zone_nscheck(zone, db, ver, &errors));
 		if (errors != 0) {
@@ -3296,7 +3396,7 @@ update_action(void *arg) {
 			goto failure;
 		}
 	}
-	if (!ISC_LIST_EMPTY(diff.tuples) && is_signing) {
+	if (!ISC_LIST_EMPTY(diff->tuples) && txn->is_signing) {
 		result = dns_zone_cdscheck(zone, db, ver);
 		if (result == DNS_R_BADCDS || result == DNS_R_BADCDNSKEY) {
 			update_log(client, zone, LOGLEVEL_PROTOCOL,
@@ -3315,7 +3415,7 @@ update_action(void *arg) {
 	 * update RRSIGs and NSECs (if zone is secure), and write the update
 	 * to the journal.
 	 */
-	if (!ISC_LIST_EMPTY(diff.tuples)) {
+	if (!ISC_LIST_EMPTY(diff->tuples)) {
 		char *journalfile;
 		dns_journal_t *journal;
 		bool has_dnskey;
@@ -3324,15 +3424,15 @@ update_action(void *arg) {
 		 * Increment the SOA serial, but only if it was not
 		 * changed as a result of an update operation.
 		 */
-		if (!soa_serial_changed) {
+		if (!txn->soa_serial_changed) {
 			CHECK(update_soa_serial(
-				db, ver, &diff, mctx,
+				db, ver, diff, mctx,
 				dns_zone_getserialupdatemethod(zone)));
 		}
 
-		CHECK(check_mx(client, zone, db, ver, &diff));
+		CHECK(check_mx(client, zone, db, ver, diff));
 
-		CHECK(remove_orphaned_ds(db, ver, &diff));
+		CHECK(remove_orphaned_ds(db, ver, diff));
 
 		CHECK(rrset_exists(db, ver, zonename, dns_rdatatype_dnskey, 0,
 				   &has_dnskey));
@@ -3340,11 +3440,11 @@ update_action(void *arg) {
 		CHECK(rrset_exists(db, oldver, zonename, dns_rdatatype_dnskey,
 				   0, &had_dnskey));
 
-		CHECK(rollback_private(db, privatetype, ver, &diff));
+		CHECK(rollback_private(db, privatetype, ver, diff));
 
-		CHECK(add_nsec3param_records(client, zone, db, ver, &diff));
+		CHECK(add_nsec3param_records(client, zone, db, ver, diff));
 
-		if (is_signing && had_dnskey && !has_dnskey) {
+		if (txn->is_signing && had_dnskey && !has_dnskey) {
 			/*
 			 * We are transitioning from secure to insecure.
 			 * Cause all NSEC3 chains to be deleted.  When the
@@ -3352,7 +3452,7 @@ update_action(void *arg) {
 			 * remove any NSEC chain present will also be removed.
 			 */
 			CHECK(dns_nsec3param_deletechains(db, ver, zone, true,
-							  &diff));
+							  diff));
 		} else if (has_dnskey && isdnssec(db, ver, privatetype)) {
 			dns_update_log_t log;
 			uint32_t interval =
@@ -3361,7 +3461,7 @@ update_action(void *arg) {
 			log.func = update_log_cb;
 			log.arg = client;
 			result = dns_update_signatures(&log, zone, db, oldver,
-						       ver, &diff, interval);
+						       ver, diff, interval);
 
 			if (result != ISC_R_SUCCESS) {
 				update_log(client, zone, ISC_LOG_ERROR,
@@ -3396,7 +3496,7 @@ update_action(void *arg) {
 				FAILS(result, "journal open failed");
 			}
 
-			result = dns_journal_write_transaction(journal, &diff);
+			result = dns_journal_write_transaction(journal, diff);
 			if (result != ISC_R_SUCCESS) {
 				dns_journal_destroy(&journal);
 				FAILS(result, "journal write failed");
@@ -3413,7 +3513,7 @@ update_action(void *arg) {
 		update_log(client, zone, LOGLEVEL_DEBUG,
 			   "committing update transaction");
 
-		dns_db_closeversion(db, &ver, true);
+		dns_db_closeversion(db, &txn->ver, true);
 
 		/*
 		 * Mark the zone as dirty so that it will be written to disk.
@@ -3426,47 +3526,237 @@ update_action(void *arg) {
 		dns_zone_notify(zone);
 	} else {
 		update_log(client, zone, LOGLEVEL_DEBUG, "redundant request");
-		dns_db_closeversion(db, &ver, true);
+		dns_db_closeversion(db, &txn->ver, true);
 	}
 	result = ISC_R_SUCCESS;
-	goto common;
 
 failure:
-	/*
-	 * The reason for failure should have been logged at this point.
-	 */
-	if (ver != NULL) {
-		update_log(client, zone, LOGLEVEL_DEBUG, "rolling back");
-		dns_db_closeversion(db, &ver, false);
+	return (result);
+}
+
+/*%
+ * Release the transaction, rolling back the new version if it has not
+ * been committed.
+ */
+static void
+update_end(ns_client_t *client, update_txn_t *txn) {
+	if (txn->ver != NULL) {
+		/*
+		 * The reason for failure should have been logged at
+		 * this point.
+		 */
+		update_log(client, txn->zone, LOGLEVEL_DEBUG, "rolling back");
+		dns_db_closeversion(txn->db, &txn->ver, false);
 	}
 
-common:
-	dns_diff_clear(&temp);
-	dns_diff_clear(&diff);
+	dns_diff_clear(&txn->diff);
 
-	if (oldver != NULL) {
-		dns_db_closeversion(db, &oldver, false);
+	if (txn->oldver != NULL) {
+		dns_db_closeversion(txn->db, &txn->oldver, false);
 	}
 
-	if (db != NULL) {
-		dns_db_detach(&db);
+	if (txn->db != NULL) {
+		dns_db_detach(&txn->db);
 	}
 
-	if (rules != NULL) {
-		isc_mem_cput(mctx, rules, ruleslen, sizeof(*rules));
+	if (txn->ssutable != NULL) {
+		dns_ssutable_detach(&txn->ssutable);
 	}
+}
 
-	if (ssutable != NULL) {
-		dns_ssutable_detach(&ssutable);
+/*%
+ * Hand the result of the update in 'uev' back to the client's loop.
+ */
+static void
+update_finish(update_t *uev, isc_result_t result) {
+	ns_client_t *client = uev->client;
+
+	if (uev->rules != NULL) {
+		isc_mem_cput(client->manager->mctx, uev->rules, uev->ruleslen,
+			     sizeof(*uev->rules));
+		uev->rules = NULL;
 	}
 
 	uev->result = result;
-	if (zone != NULL) {
-		INSIST(uev->zone == zone); /* we use this later */
+	isc_async_run(client->manager->loop, updatedone_action, uev);
+}
+
+static void
+update_action(void *arg) {
+	update_t *uev = (update_t *)arg;
+	ns_client_t *client = uev->client;
+	update_txn_t txn;
+	isc_result_t result;
+
+	result = update_begin(uev->zone, client->manager->mctx, &txn);
+	if (result == ISC_R_SUCCESS) {
+		result = update_prereqs(uev, &txn);
 	}
+	if (result == ISC_R_SUCCESS) {
+		result = update_apply(uev, &txn, &txn.diff);
+	}
+	if (result == ISC_R_SUCCESS) {
+		result = update_commit(client, &txn);
+	}
+	update_end(client, &txn);
+	INSIST(txn.ver == NULL);
 
-	isc_async_run(client->manager->loop, updatedone_action, uev);
-	INSIST(ver == NULL);
+	update_finish(uev, result);
+}
+
+/*%
+ * Apply the updates queued in 'batch' to a single new version of the
+ * zone, so that they share one journal transaction and one commit.
+ *
+ * Updates are applied in the order they were queued, and the
+ * prerequisites of each are checked against the changes made by the
+ * ones before it, as if they had been applied one at a time.  An update
+ * whose prerequisites are not satisfied makes no changes and gets its
+ * own error response.  If anything else fails, the whole transaction is
+ * rolled back and the updates are applied one at a time instead, so
+ * that each update succeeds or fails exactly as it would on its own.
+ */
+static void
+update_batch_apply(update_batch_t *batch) {
+	update_t *uev = ISC_LIST_HEAD(batch->updates);
+	ns_client_t *client = uev->client;
+	isc_mem_t *mctx = client->manager->mctx;
+	update_txn_t txn;
+	isc_result_t result;
+	unsigned int count = 0;
+
+	result = update_begin(batch->zone, mctx, &txn);
+	for (; result == ISC_R_SUCCESS && uev != NULL;
+	     uev = ISC_LIST_NEXT(uev, link))
+	{
+		dns_diff_t diff;
+		dns_difftuple_t *tuple = NULL;
+
+		uev->result = update_prereqs(uev, &txn);
+		if (uev->result != ISC_R_SUCCESS) {
+			continue;
+		}
+
+		dns_diff_init(mctx, &diff);
+		result = update_apply(uev, &txn, &diff);
+		while ((tuple = ISC_LIST_HEAD(diff.tuples)) != NULL) {
+			ISC_LIST_UNLINK(diff.tuples, tuple, link);
+			dns_diff_appendminimal(&txn.diff, &tuple);
+		}
+		dns_diff_clear(&diff);
+		count++;
+	}
+
+	if (result == ISC_R_SUCCESS && count != 0) {
+		update_log(client, batch->zone, LOGLEVEL_DEBUG,
+			   "committing %u batched updates", count);
+		result = update_commit(client, &txn);
+	} else if (result == ISC_R_SUCCESS) {
+		dns_db_closeversion(txn.db, &txn.ver, false);
+	}
+	update_end(client, &txn);
+
+	while ((uev = ISC_LIST_HEAD(batch->updates)) != NULL) {
+		ISC_LIST_UNLINK(batch->updates, uev, link);
+		if (result == ISC_R_SUCCESS) {
+			update_finish(uev, uev->result);
+		} else {
+			update_action(uev);
+		}
+	}
+}
+
+static bool
+update_batch_match(void *node, const void *key) {
+	const update_batch_t *batch = node;
+
+	return (batch->zone == key);
+}
+
+static uint32_t
+update_batch_hash(const dns_zone_t *zone) {
+	return (isc_hash32(&zone, sizeof(zone), true));
+}
+
+static void
+update_batch_action(void *arg) {
+	update_batch_t *batch = (update_batch_t *)arg;
+	ns_server_t *sctx = batch->sctx;
+	isc_result_t result;
+
+	/*
+	 * Updates queued from now on start a new batch.
+	 */
+	LOCK(&sctx->updbatch_lock);
+	if (batch->queued) {
+		result = isc_hashmap_delete(sctx->updbatches,
+					    update_batch_hash(batch->zone),
+					    update_batch_match, batch->zone);
+		RUNTIME_CHECK(result == ISC_R_SUCCESS);
+		batch->queued = false;
+	}
+	UNLOCK(&sctx->updbatch_lock);
+
+	if (ISC_LIST_HEAD(batch->updates) == ISC_LIST_TAIL(batch->updates)) {
+		update_t *uev = ISC_LIST_HEAD(batch->updates);
+
+		ISC_LIST_UNLINK(batch->updates, uev, link);
+		update_action(uev);
+	} else {
+		update_batch_apply(batch);
+	}
+
+	dns_zone_detach(&batch->zone);
+	isc_mem_putanddetach(&batch->mctx, batch, sizeof(*batch));
+	ns_server_detach(&sctx);
+}
+
+/*%
+ * Queue the update in 'uev' to be applied on the zone's loop.  When
+ * "update-batch-size" is greater than one, up to that many updates
+ * that arrive for the same zone before the loop gets to them are
+ * applied together by update_batch_action().
+ */
+static void
+update_queue(ns_client_t *client, update_t *uev) {
+	ns_server_t *sctx = client->manager->sctx;
+	dns_zone_t *zone = uev->zone;
+	update_batch_t *batch = NULL;
+	uint32_t hashval;
+
+	if (sctx->updbatchsize < 2) {
+		isc_async_run(dns_zone_getloop(zone), update_action, uev);
+		return;
+	}
+
+	hashval = update_batch_hash(zone);
+
+	LOCK(&sctx->updbatch_lock);
+	if (isc_hashmap_find(sctx->updbatches, hashval, update_batch_match,
+			     zone, (void **)&batch) != ISC_R_SUCCESS)
+	{
+		batch = isc_mem_get(sctx->mctx, sizeof(*batch));
+		*batch = (update_batch_t){
+			.updates = ISC_LIST_INITIALIZER,
+			.queued = true,
+		};
+		isc_mem_attach(sctx->mctx, &batch->mctx);
+		ns_server_attach(sctx, &batch->sctx);
+		dns_zone_attach(zone, &batch->zone);
+		RUNTIME_CHECK(isc_hashmap_add(sctx->updbatches, hashval,
+					      update_batch_match, zone, batch,
+					      NULL) == ISC_R_SUCCESS);
+		isc_async_run(dns_zone_getloop(zone), update_batch_action,
+			      batch);
+	}
+	ISC_LIST_APPEND(batch->updates, uev, link);
+	if (++batch->count >= sctx->updbatchsize) {
+		RUNTIME_CHECK(isc_hashmap_delete(sctx->updbatches, hashval,
+						 update_batch_match,
+						 zone) == ISC_R_SUCCESS);
+		batch->queued = false;
+	}
+	UNLOCK(&sctx->updbatch_lock);
 }
 
 static void
@@ -456,6 +456,67 @@ thread_qp_brr(void *arg0) {
 	return (_thread_qp(arg0, true, true));
 }
 
+/*
+ * qp, loaded in bulk: each thread sorts its share of the names and
+ * builds a trie of its own from them with dns_qpbuild_add()
+ */
+
+static void *
+new_qpbuild(isc_mem_t *mem) {
+	return (mem);
+}
+
+static int
+item_compare(const void *a, const void *b) {
+	const size_t *ia = a, *ib = b;
+	return (dns_name_compare(&item[*ia].fixed.name,
+				 &item[*ib].fixed.name));
+}
+
+static void *
+thread_qpbuild(void *arg0) {
+	struct thread_s *arg = arg0;
+	size_t count = arg->end - arg->start;
+	size_t *order = isc_mem_cget(mctx, count, sizeof(order[0]));
+	dns_qpbuild_t *qpb = NULL;
+	dns_qp_t *qp = NULL;
+
+	for (size_t i = 0; i < count; i++) {
+		order[i] = arg->start + i;
+	}
+	qsort(order, count, sizeof(order[0]), item_compare);
+
+	isc_barrier_wait(&barrier);
+
+	isc_time_t t0 = isc_time_now_hires();
+	dns_qp_create(arg->map, &qpmethods, NULL, &qp);
+	dns_qpbuild_create(qp, &qpb);
+	for (size_t i = 0; i < count; i++) {
+		isc_result_t result = dns_qpbuild_add(qpb, &item[order[i]],
+						      order[i]);
+		CHECK(order[i], result);
+	}
+	dns_qpbuild_destroy(&qpb);
+
+	isc_time_t t1 = isc_time_now_hires();
+
+	for (size_t n = arg->start; n < arg->end; n++) {
+		void *pval = NULL;
+		isc_result_t result = get_qp(qp, n, &pval);
+		CHECK(n, result);
+		assert(pval == &item[n]);
+	}
+
+	isc_time_t t2 = isc_time_now_hires();
+
+	arg->d0 = isc_time_microdiff(&t1, &t0);
+	arg->d1 = isc_time_microdiff(&t2, &t1);
+
+	isc_mem_cput(mctx, order, count, sizeof(order[0]));
+
+	return (NULL);
+}
+
 /*
  * fun table
  */
@@ -467,6 +528,7 @@ static struct fun fun_list[] = {
 	{ "qp", new_qp, thread_qp },
 	{ "qp+nosqz", new_qp, thread_qp_nosqz },
 	{ "qp+barrier", new_qp, thread_qp_brr },
+	{ "qp+build", new_qpbuild, thread_qpbuild },
 	{ NULL, NULL, NULL },
 };
 
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) Internet Systems Consortium, Inc. ("ISC")
+ *
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * See the COPYRIGHT file distributed with this work for additional
+ * information regarding copyright ownership.
+ */
+
+/*
+ * Parse a corpus of queries built from a list of query names read from
+ * stdin, one per line, in the shape most resolvers send them: one
+ * question and an OPT record with the DO bit and a client cookie.
+ * Compare the small-query path of dns_message_parse() with the general
+ * one, which is what DNS_MESSAGEPARSE_PRESERVEORDER selects.
+ */
+
+#include <err.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <isc/buffer.h>
+#include <isc/mem.h>
+#include <isc/random.h>
+#include <isc/result.h>
+#include <isc/time.h>
+#include <isc/util.h>
+
+#include <dns/fixedname.h>
+#include <dns/message.h>
+#include <dns/name.h>
+#include <dns/rdatatype.h>
+
+#define QUERYSIZE 512
+
+static uint8_t wire[65536][QUERYSIZE];
+static unsigned int wirelen[65536];
+
+static unsigned int
+makequery(uint8_t *q, const dns_name_t *name, dns_rdatatype_t type) {
+	isc_buffer_t buf;
+	isc_region_t r;
+	uint8_t cookie[8];
+
+	isc_buffer_init(&buf, q, QUERYSIZE);
+
+	/* header: id, RD, one question, one additional */
+	isc_buffer_putuint16(&buf, isc_random16());
+	isc_buffer_putuint16(&buf, 0x0100);
+	isc_buffer_putuint16(&buf, 1);
+	isc_buffer_putuint16(&buf, 0);
+	isc_buffer_putuint16(&buf, 0);
+	isc_buffer_putuint16(&buf, 1);
+
+	dns_name_toregion(name, &r);
+	isc_buffer_putmem(&buf, r.base, r.length);
+	isc_buffer_putuint16(&buf, type);
+	isc_buffer_putuint16(&buf, dns_rdataclass_in);
+
+	/* OPT: 1232 byte UDP payload, DO, client cookie */
+	isc_buffer_putuint8(&buf, 0);
+	isc_buffer_putuint16(&buf, dns_rdatatype_opt);
+	isc_buffer_putuint16(&buf, 1232);
+	isc_buffer_putuint32(&buf, DNS_MESSAGEEXTFLAG_DO);
+	isc_buffer_putuint16(&buf, 4 + sizeof(cookie));
+	isc_buffer_putuint16(&buf, DNS_OPT_COOKIE);
+	isc_buffer_putuint16(&buf, sizeof(cookie));
+	isc_random_buf(cookie, sizeof(cookie));
+	isc_buffer_putmem(&buf, cookie, sizeof(cookie));
+
+	return (isc_buffer_usedlength(&buf));
+}
+
+static uint64_t
+parse_bench(isc_mem_t *mctx, isc_mempool_t *namepool, isc_mempool_t *rdspool,
+	    unsigned int count, unsigned int repeat, unsigned int options) {
+	isc_time_t start = isc_time_now_hires();
+
+	for (unsigned int n = 0; n < repeat; n++) {
+		for (unsigned int i = 0; i < count; i++) {
+			dns_message_t *msg = NULL;
+			isc_buffer_t buf;
+			isc_result_t result;
+
+			isc_buffer_init(&buf, wire[i], wirelen[i]);
+			isc_buffer_add(&buf, wirelen[i]);
+
+			dns_message_create(mctx, namepool, rdspool,
+					   DNS_MESSAGE_INTENTPARSE, &msg);
+			result = dns_message_parse(msg, &buf, options);
+			if (result != ISC_R_SUCCESS ||
+			    dns_message_getopt(msg) == NULL)
+			{
+				errx(1, "parse: %s", isc_result_totext(result));
+			}
+			dns_message_detach(&msg);
+		}
+	}
+
+	isc_time_t finish = isc_time_now_hires();
+	return (isc_time_microdiff(&finish, &start));
+}
+
+int
+main(void) {
+	static const dns_rdatatype_t types[] = {
+		dns_rdatatype_a,
+		dns_rdatatype_aaaa,
+		dns_rdatatype_a,
+		dns_rdatatype_https,
+	};
+	isc_result_t result;
+	isc_buffer_t buf;
+	isc_mem_t *mctx = NULL;
+	isc_mempool_t *namepool = NULL;
+	isc_mempool_t *rdspool = NULL;
+	unsigned int count = 0;
+	unsigned int repeat = 100;
+	char *line = NULL;
+	size_t linecap = 0;
+	ssize_t linelen;
+
+	isc_mem_create(&mctx);
+	dns_message_createpools(mctx, &namepool, &rdspool);
+
+	while ((linelen = getline(&line, &linecap, stdin)) > 0) {
+		dns_fixedname_t fixed;
+		dns_name_t *name = dns_fixedname_initname(&fixed);
+
+		if (line[linelen - 1] == '\n') {
+			line[--linelen] = '\0';
+		}
+		isc_buffer_init(&buf, line, linelen);
+		isc_buffer_add(&buf, linelen);
+
+		if (count == ARRAY_SIZE(wire)) {
+			errx(1, "too many names");
+		}
+		result = dns_name_fromtext(name, &buf, dns_rootname, 0, NULL);
+		if (result != ISC_R_SUCCESS) {
+			errx(1, "%s: %s", line, isc_result_totext(result));
+		}
+		wirelen[count] = makequery(wire[count], name,
+					   types[count % ARRAY_SIZE(types)]);
+		count++;
+	}
+	free(line);
+
+	if (count == 0) {
+		errx(1, "usage: msgparse < names.txt");
+	}
+
+	uint64_t general = parse_bench(mctx, namepool, rdspool, count, repeat,
+				       DNS_MESSAGEPARSE_PRESERVEORDER);
+	uint64_t small = parse_bench(mctx, namepool, rdspool, count, repeat,
+				     0);
+	double queries = (double)count * repeat;
+
+	printf("%u queries x %u\n", count, repeat);
+	printf("  general %f ms; %f ns / query\n", general / 1000.0,
+	       general * 1000.0 / queries);
+	printf("  small   %f ms; %f ns / query\n", small / 1000.0,
+	       small * 1000.0 / queries);
+	printf("  general/small %f\n", (double)general / (double)small);
+
+	dns_message_destroypools(&namepool, &rdspool);
+	isc_mem_detach(&mctx);
+
+	return (0);
+}
@@ -18,6 +18,7 @@
 #include <isc/file.h>
 #include <isc/ht.h>
 #include <isc/rwlock.h>
+#include <isc/time.h>
 #include <isc/util.h>
 
 #include <dns/fixedname.h>
@@ -123,8 +124,9 @@ const dns_qpmethods_t methods = {
 static void
 usage(void) {
 	fprintf(stderr,
-		"usage: qp_dump [-dt] <filename>\n"
+		"usage: qp_dump [-dst] <filename>\n"
 		"	-d	output in graphviz dot format\n"
+		"	-s	names are sorted; load them in bulk\n"
 		"	-t	output in ad-hoc indented text format\n");
 }
 
@@ -132,6 +134,7 @@ int
 main(int argc, char *argv[]) {
 	isc_result_t result;
 	dns_qp_t *qp = NULL;
+	dns_qpbuild_t *qpb = NULL;
 	const char *filename = NULL;
 	char *filetext = NULL;
 	size_t filesize;
@@ -139,14 +142,17 @@ main(int argc, char *argv[]) {
 	FILE *fp = NULL;
 	size_t wirebytes = 0, labels = 0, names = 0;
 	char *pos = NULL, *file_end = NULL;
-	bool dumpdot = false, dumptxt = false;
+	bool dumpdot = false, dumptxt = false, sorted = false;
 	int opt;
 
-	while ((opt = isc_commandline_parse(argc, argv, "dt")) != -1) {
+	while ((opt = isc_commandline_parse(argc, argv, "dst")) != -1) {
 		switch (opt) {
 		case 'd':
 			dumpdot = true;
 			continue;
+		case 's':
+			sorted = true;
+			continue;
 		case 't':
 			dumptxt = true;
 			continue;
@@ -185,7 +191,12 @@ main(int argc, char *argv[]) {
 	fclose(fp);
 	filetext[filesize] = '\0';
 
+	isc_time_t t0 = isc_time_now_hires();
+
 	dns_qp_create(mctx, &methods, NULL, &qp);
+	if (sorted) {
+		dns_qpbuild_create(qp, &qpb);
+	}
 
 	pos = filetext;
 	file_end = pos + filesize;
@@ -211,7 +222,11 @@ main(int argc, char *argv[]) {
 					   NULL);
 		if (result == ISC_R_SUCCESS) {
 			smallname_from_name(name, &pval, &ival);
-			result = dns_qp_insert(qp, pval, ival);
+			if (qpb != NULL) {
+				result = dns_qpbuild_add(qpb, pval, ival);
+			} else {
+				result = dns_qp_insert(qp, pval, ival);
+			}
 		}
 		if (result == ISC_R_EXISTS && pval != NULL) {
 			smallname_free(pval, ival);
@@ -227,7 +242,13 @@ main(int argc, char *argv[]) {
 		labels += name->labels;
 		names += 1;
 	}
-	dns_qp_compact(qp, DNS_QPGC_ALL);
+	if (qpb != NULL) {
+		dns_qpbuild_destroy(&qpb);
+	} else {
+		dns_qp_compact(qp, DNS_QPGC_ALL);
+	}
+
+	isc_time_t t1 = isc_time_now_hires();
 
 #define print_megabytes(label, value) \
 	printf("%6.2f MiB - " label "\n", (double)(value) / 1048576.0)
@@ -250,6 +271,8 @@ main(int argc, char *argv[]) {
 		       memusage.free, memusage.hold, memusage.chunk_count,
 		       memusage.bytes);
 
+		printf("%f load\n",
+		       (double)isc_time_microdiff(&t1, &t0) / 1000000);
 		printf("%f compaction\n", (double)compaction_us / 1000000);
 		printf("%f recovery\n", (double)recovery_us / 1000000);
 		printf("%f rollback\n", (double)rollback_us / 1000000);
@@ -17,6 +17,7 @@
 #include <isc/commandline.h>
 #include <isc/file.h>
 #include <isc/ht.h>
+#include <isc/random.h>
 #include <isc/rwlock.h>
 #include <isc/time.h>
 #include <isc/util.h>
@@ -29,58 +30,61 @@
 #include <tests/dns.h>
 #include <tests/qp.h>
 
-static inline size_t
-smallname_length(void *pval, uint32_t ival) {
-	UNUSED(pval);
-	return (ival & 0xff);
-}
+/*
+ * A smallname keeps its length and label count in its header rather
+ * than in the leaf's integer value, so that the trie can use the
+ * integer value for key fingerprints.
+ */
+typedef struct smallname {
+	isc_refcount_t refcount;
+	uint32_t info;
+} smallname_t;
 
 static inline size_t
-smallname_labels(void *pval, uint32_t ival) {
-	UNUSED(pval);
-	return (ival >> 8);
+smallname_length(smallname_t *sn) {
+	return (sn->info & 0xff);
 }
 
-static inline isc_refcount_t *
-smallname_refcount(void *pval, uint32_t ival) {
-	UNUSED(ival);
-	return (pval);
+static inline size_t
+smallname_labels(smallname_t *sn) {
+	return (sn->info >> 8);
 }
 
 static inline uint8_t *
-smallname_ndata(void *pval, uint32_t ival) {
-	return ((uint8_t *)(smallname_refcount(pval, ival) + 1));
+smallname_ndata(smallname_t *sn) {
+	return ((uint8_t *)(sn + 1));
 }
 
 static inline uint8_t *
-smallname_offsets(void *pval, uint32_t ival) {
-	return (smallname_ndata(pval, ival) + smallname_length(pval, ival));
+smallname_offsets(smallname_t *sn) {
+	return (smallname_ndata(sn) + smallname_length(sn));
 }
 
-static void
-smallname_from_name(const dns_name_t *name, void **valp, uint32_t *ctxp) {
-	size_t size = sizeof(isc_refcount_t) + name->length + name->labels;
-	*valp = isc_mem_get(mctx, size);
-	*ctxp = name->labels << 8 | name->length;
-	isc_refcount_init(smallname_refcount(*valp, *ctxp), 0);
-	memmove(smallname_ndata(*valp, *ctxp), name->ndata, name->length);
-	memmove(smallname_offsets(*valp, *ctxp), name->offsets, name->labels);
+static smallname_t *
+smallname_from_name(const dns_name_t *name) {
+	size_t size = sizeof(smallname_t) + name->length + name->labels;
+	smallname_t *sn = isc_mem_get(mctx, size);
+	sn->info = name->labels << 8 | name->length;
+	isc_refcount_init(&sn->refcount, 0);
+	memmove(smallname_ndata(sn), name->ndata, name->length);
+	memmove(smallname_offsets(sn), name->offsets, name->labels);
+	return (sn);
 }
 
 static void
-smallname_free(void *pval, uint32_t ival) {
-	size_t size = sizeof(isc_refcount_t);
-	size += smallname_length(pval, ival) + smallname_labels(pval, ival);
-	isc_mem_put(mctx, pval, size);
+smallname_free(smallname_t *sn) {
+	size_t size = sizeof(smallname_t);
+	size += smallname_length(sn) + smallname_labels(sn);
+	isc_mem_put(mctx, sn, size);
 }
 
 static void
-name_from_smallname(dns_name_t *name, void *pval, uint32_t ival) {
+name_from_smallname(dns_name_t *name, smallname_t *sn) {
 	dns_name_reset(name);
-	name->ndata = smallname_ndata(pval, ival);
-	name->length = smallname_length(pval, ival);
-	name->labels = smallname_labels(pval, ival);
-	name->offsets = smallname_offsets(pval, ival);
+	name->ndata = smallname_ndata(sn);
+	name->length = smallname_length(sn);
+	name->labels = smallname_labels(sn);
+	name->offsets = smallname_offsets(sn);
 	name->attributes.readonly = true;
 	if (name->ndata[name->offsets[name->labels - 1]] == '\0') {
 		name->attributes.absolute = true;
@@ -90,21 +94,26 @@ name_from_smallname(dns_name_t *name, void *pval, uint32_t ival) {
 static size_t
 qpkey_from_smallname(dns_qpkey_t key, void *ctx, void *pval, uint32_t ival) {
 	UNUSED(ctx);
+	UNUSED(ival);
 	dns_name_t name = DNS_NAME_INITEMPTY;
-	name_from_smallname(&name, pval, ival);
+	name_from_smallname(&name, pval);
 	return (dns_qpkey_fromname(key, &name));
 }
 
 static void
 smallname_attach(void *ctx, void *pval, uint32_t ival) {
+	smallname_t *sn = pval;
 	UNUSED(ctx);
-	isc_refcount_increment0(smallname_refcount(pval, ival));
+	UNUSED(ival);
+	isc_refcount_increment0(&sn->refcount);
 }
 
 static void
 smallname_detach(void *ctx, void *pval, uint32_t ival) {
-	if (isc_refcount_decrement(smallname_refcount(pval, ival)) == 1) {
-		isc_mem_free(ctx, pval);
+	smallname_t *sn = pval;
+	UNUSED(ival);
+	if (isc_refcount_decrement(&sn->refcount) == 1) {
+		isc_mem_free(ctx, sn);
 	}
 }
 
@@ -121,9 +130,20 @@ const dns_qpmethods_t methods = {
 	testname,
 };
 
+const dns_qpmethods_t fingerprint_methods = {
+	smallname_attach,
+	smallname_detach,
+	qpkey_from_smallname,
+	testname,
+	.fingerprint = true,
+};
+
+#define BATCH 64
+
 static void
 usage(void) {
-	fprintf(stderr, "usage: lookups <filename>\n");
+	fprintf(stderr, "usage: lookups [-f] <filename>\n"
+			"	-f	keep key fingerprints in the leaves\n");
 	exit(EXIT_FAILURE);
 }
 
@@ -156,8 +176,7 @@ load_qp(dns_qp_t *qp, const char *filename) {
 	pos = filetext;
 	file_end = pos + filesize;
 	while (pos < file_end) {
-		void *pval = NULL;
-		uint32_t ival = 0;
+		smallname_t *sn = NULL;
 		dns_fixedname_t fixed;
 		dns_name_t *name = dns_fixedname_initname(&fixed);
 		isc_buffer_t buffer;
@@ -176,11 +195,11 @@ load_qp(dns_qp_t *qp, const char *filename) {
 		result = dns_name_fromtext(name, &buffer, dns_rootname, 0,
 					   NULL);
 		if (result == ISC_R_SUCCESS) {
-			smallname_from_name(name, &pval, &ival);
-			result = dns_qp_insert(qp, pval, ival);
+			sn = smallname_from_name(name);
+			result = dns_qp_insert(qp, sn, 0);
 		}
-		if (result == ISC_R_EXISTS && pval != NULL) {
-			smallname_free(pval, ival);
+		if (result == ISC_R_EXISTS && sn != NULL) {
+			smallname_free(sn);
 			continue;
 		}
 		if (result != ISC_R_SUCCESS) {
@@ -200,21 +219,38 @@ main(int argc, char **argv) {
 	dns_qp_t *qp = NULL;
 	isc_nanosecs_t start, stop;
 	dns_fixedname_t *items = NULL;
+	const dns_name_t **names = NULL;
+	isc_result_t results[BATCH];
 	dns_qpiter_t it = { 0 };
 	dns_name_t *name = NULL;
 	size_t i = 0, n = 0;
 	char buf[BUFSIZ];
+	const dns_qpmethods_t *qpmethods = &methods;
+	int opt;
+
+	while ((opt = isc_commandline_parse(argc, argv, "f")) != -1) {
+		switch (opt) {
+		case 'f':
+			qpmethods = &fingerprint_methods;
+			continue;
+		default:
+			usage();
+			continue;
+		}
+	}
+	argc -= isc_commandline_index;
+	argv += isc_commandline_index;
 
-	if (argc != 2) {
+	if (argc != 1) {
 		usage();
 	}
 
 	isc_mem_create(&mctx);
 
-	dns_qp_create(mctx, &methods, NULL, &qp);
+	dns_qp_create(mctx, qpmethods, NULL, &qp);
 
 	start = isc_time_monotonic();
-	n = load_qp(qp, argv[1]);
+	n = load_qp(qp, argv[0]);
 	dns_qp_compact(qp, DNS_QPGC_ALL);
 	stop = isc_time_monotonic();
 
@@ -257,6 +293,40 @@ main(int argc, char **argv) {
 	snprintf(buf, sizeof(buf), "look up %zd names (dns_qp_lookup):", n);
 	printf("%-57s%7.3fsec\n", buf, (stop - start) / (double)NS_PER_SEC);
 
+	/*
+	 * looking up the names in order is kind to the CPU caches, so
+	 * shuffle them to compare single and batched lookups
+	 */
+	names = isc_mem_cget(mctx, n, sizeof(names[0]));
+	for (i = 0; i < n; i++) {
+		size_t j = isc_random_uniform(i + 1);
+		names[i] = names[j];
+		names[j] = dns_fixedname_name(&items[i]);
+	}
+
+	start = isc_time_monotonic();
+	for (i = 0; i < n; i++) {
+		dns_qp_getname(qp, names[i], NULL, NULL);
+	}
+	stop = isc_time_monotonic();
+
+	snprintf(buf, sizeof(buf),
+		 "look up %zd shuffled names (dns_qp_getname):", n);
+	printf("%-57s%7.3fsec\n", buf, (stop - start) / (double)NS_PER_SEC);
+
+	start = isc_time_monotonic();
+	for (i = 0; i < n; i += BATCH) {
+		dns_qp_getnames(qp, ISC_MIN(n - i, BATCH), names + i, NULL,
+				NULL, results);
+	}
+	stop = isc_time_monotonic();
+
+	snprintf(buf, sizeof(buf),
+		 "look up %zd shuffled names (dns_qp_getnames):", n);
+	printf("%-57s%7.3fsec\n", buf, (stop - start) / (double)NS_PER_SEC);
+
+	isc_mem_cput(mctx, names, n, sizeof(names[0]));
+
 	start = isc_time_monotonic();
 	for (i = 0; i < n; i++) {
 		/*
@@ -283,6 +353,26 @@ main(int argc, char **argv) {
 		 "look up %zd wrong names (dns_qp_lookup):", n);
 	printf("%-57s%7.3fsec\n", buf, (stop - start) / (double)NS_PER_SEC);
 
+	start = isc_time_monotonic();
+	for (i = 0; i < n; i++) {
+		/* as above, but exact matches can use key fingerprints */
+		dns_fixedname_t sf;
+		dns_name_t *search = dns_fixedname_initname(&sf);
+
+		name = dns_fixedname_name(&items[i]);
+		dns_name_copy(name, search);
+		if (search->ndata[1] != 0) {
+			++search->ndata[1];
+		}
+
+		dns_qp_getname(qp, search, NULL, NULL);
+	}
+	stop = isc_time_monotonic();
+
+	snprintf(buf, sizeof(buf),
+		 "look up %zd wrong names (dns_qp_getname):", n);
+	printf("%-57s%7.3fsec\n", buf, (stop - start) / (double)NS_PER_SEC);
+
 	isc_mem_cput(mctx, items, n, sizeof(dns_fixedname_t));
 	return (0);
 }
@@ -58,6 +58,8 @@ static isc_sockaddr_t udp_server_addr;
 static isc_sockaddr_t udp_connect_addr;
 static isc_sockaddr_t tcp_server_addr;
 static isc_sockaddr_t tcp_connect_addr;
+static isc_sockaddr_t tcp_any_addr;
+static isc_sockaddr_t *idle_connect_addr = NULL;
 static isc_sockaddr_t tls_server_addr;
 static isc_sockaddr_t tls_connect_addr;
 
@@ -167,6 +169,9 @@ setup_test(void **state) {
 	tcp_connect_addr = (isc_sockaddr_t){ .length = 0 };
 	isc_sockaddr_fromin6(&tcp_connect_addr, &in6addr_loopback, 0);
 
+	tcp_any_addr = (isc_sockaddr_t){ .length = 0 };
+	isc_sockaddr_any6(&tcp_any_addr);
+
 	tls_connect_addr = (isc_sockaddr_t){ .length = 0 };
 	isc_sockaddr_fromin6(&tls_connect_addr, &in6addr_loopback, 0);
 
@@ -508,7 +513,7 @@ connected_gettcp(isc_result_t eresult ISC_ATTR_UNUSED,
 	};
 
 	result = dns_dispatch_gettcp(test2->dispatchmgr, &tcp_server_addr,
-				     &tcp_connect_addr, &test2->dispatch);
+				     &tcp_connect_addr, NULL, &test2->dispatch);
 	assert_int_equal(result, ISC_R_SUCCESS);
 
 	assert_ptr_equal(test1->dispatch, test2->dispatch);
@@ -525,6 +530,55 @@ connected_gettcp(isc_result_t eresult ISC_ATTR_UNUSED,
 	test_dispatch_done(test1);
 }
 
+static void
+response_idle(isc_result_t eresult, isc_region_t *region ISC_ATTR_UNUSED,
+	      void *arg) {
+	test_dispatch_t *test5 = arg;
+	dns_dispatch_t *disp = test5->dispatch;
+
+	if (eresult != ISC_R_SUCCESS) {
+		return;
+	}
+
+	/* Client 2 */
+	isc_result_t result;
+	test_dispatch_t *test6 = isc_mem_get(mctx, sizeof(*test6));
+	*test6 = (test_dispatch_t){
+		.dispatchmgr = dns_dispatchmgr_ref(test5->dispatchmgr),
+	};
+
+	/* The connection stays open after the only response is done */
+	test_dispatch_done(test5);
+
+	/*
+	 * The source address has port 0, but the connected socket has a
+	 * real port; the dispatch is found by the address it was created
+	 * with
+	 */
+	result = dns_dispatch_gettcp(test6->dispatchmgr, &tcp_server_addr,
+				     idle_connect_addr, NULL,
+				     &test6->dispatch);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	assert_ptr_equal(disp, test6->dispatch);
+
+	/* A different transport must not share the connection */
+	dns_dispatch_t *tls_dispatch = NULL;
+	result = dns_dispatch_gettcp(test6->dispatchmgr, &tcp_server_addr,
+				     idle_connect_addr, tls_transport,
+				     &tls_dispatch);
+	assert_int_equal(result, ISC_R_NOTFOUND);
+
+	result = dns_dispatch_add(test6->dispatch, isc_loop_main(loopmgr), 0,
+				  T_CLIENT_CONNECT, &tcp_server_addr, NULL,
+				  NULL, connected_shutdown, client_senddone,
+				  response_noop, test6, &test6->id,
+				  &test6->dispentry);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	dns_dispatch_connect(test6->dispentry);
+}
+
 static void
 connected_newtcp(isc_result_t eresult ISC_ATTR_UNUSED,
 		 isc_region_t *region ISC_ATTR_UNUSED, void *arg) {
@@ -537,7 +591,7 @@ connected_newtcp(isc_result_t eresult ISC_ATTR_UNUSED,
 		.dispatchmgr = dns_dispatchmgr_ref(test3->dispatchmgr),
 	};
 	result = dns_dispatch_gettcp(test4->dispatchmgr, &tcp_server_addr,
-				     &tcp_connect_addr, &test4->dispatch);
+				     &tcp_connect_addr, NULL, &test4->dispatch);
 	assert_int_equal(result, ISC_R_NOTFOUND);
 
 	result = dns_dispatch_createtcp(
@@ -828,6 +882,55 @@ ISC_LOOP_TEST_IMPL(dispatch_gettcp) {
 	dns_dispatch_connect(test->dispentry);
 }
 
+static void
+gettcp_idle(isc_sockaddr_t *connect_addr) {
+	isc_result_t result;
+	test_dispatch_t *test = isc_mem_get(mctx, sizeof(*test));
+	*test = (test_dispatch_t){ 0 };
+
+	/* Server */
+	result = isc_nm_listenstreamdns(
+		netmgr, ISC_NM_LISTEN_ONE, &tcp_server_addr, nameserver, NULL,
+		accept_cb, NULL, 0, NULL, NULL, ISC_NM_PROXY_NONE, &sock);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* ensure we stop listening after the test is done */
+	isc_loop_teardown(isc_loop_main(loopmgr), stop_listening, sock);
+
+	result = dns_dispatchmgr_create(mctx, loopmgr, connect_nm,
+					&test->dispatchmgr);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* Client */
+	testdata.region.base = testdata.message;
+	testdata.region.length = sizeof(testdata.message);
+
+	idle_connect_addr = connect_addr;
+	result = dns_dispatch_createtcp(test->dispatchmgr, idle_connect_addr,
+					&tcp_server_addr, 0, &test->dispatch);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	result = dns_dispatch_add(
+		test->dispatch, isc_loop_main(loopmgr), 0, T_CLIENT_CONNECT,
+		&tcp_server_addr, NULL, NULL, connected, client_senddone,
+		response_idle, test, &test->id, &test->dispentry);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	testdata.message[0] = (test->id >> 8) & 0xff;
+	testdata.message[1] = test->id & 0xff;
+
+	dns_dispatch_connect(test->dispentry);
+}
+
+ISC_LOOP_TEST_IMPL(dispatch_gettcp_idle) {
+	gettcp_idle(&tcp_connect_addr);
+}
+
+/* a wildcard source address, as used when no query source is set */
+ISC_LOOP_TEST_IMPL(dispatch_gettcp_idle_any) {
+	gettcp_idle(&tcp_any_addr);
+}
+
 ISC_LOOP_TEST_IMPL(dispatch_newtcp) {
 	isc_result_t result;
 	test_dispatch_t *test = isc_mem_get(mctx, sizeof(*test));
@@ -863,6 +966,8 @@ ISC_LOOP_TEST_IMPL(dispatch_newtcp) {
 
 ISC_TEST_LIST_START
 ISC_TEST_ENTRY_CUSTOM(dispatch_gettcp, setup_test, teardown_test)
+ISC_TEST_ENTRY_CUSTOM(dispatch_gettcp_idle, setup_test, teardown_test)
+ISC_TEST_ENTRY_CUSTOM(dispatch_gettcp_idle_any, setup_test, teardown_test)
 ISC_TEST_ENTRY_CUSTOM(dispatch_newtcp, setup_test, teardown_test)
 ISC_TEST_ENTRY_CUSTOM(dispatch_timeout_udp_response, setup_test, teardown_test)
 ISC_TEST_ENTRY_CUSTOM(dispatchset_create, setup_test, teardown_test)
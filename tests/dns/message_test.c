@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) Internet Systems Consortium, Inc. ("ISC")
+ *
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * See the COPYRIGHT file distributed with this work for additional
+ * information regarding copyright ownership.
+ */
+
+#include <inttypes.h>
+#include <sched.h> /* IWYU pragma: keep */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UNIT_TESTING
+#include <cmocka.h>
+
+#include <isc/buffer.h>
+#include <isc/result.h>
+#include <isc/util.h>
+
+#include <dns/message.h>
+#include <dns/rdata.h>
+#include <dns/rdataset.h>
+
+#include <tests/dns.h>
+
+/* Header of a query for example.com/A with one additional record */
+#define QUERY_HEADER(arcount)                                         \
+	0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, \
+		0x00, (arcount), 0x07, 'e', 'x', 'a', 'm', 'p', 'l', 'e', \
+		0x03, 'c', 'o', 'm', 0x00, 0x00, 0x01, 0x00, 0x01
+
+/* OPT record with a 4096 byte UDP size, the DO bit and a client cookie */
+#define OPT_COOKIE                                                    \
+	0x00, 0x00, 0x29, 0x10, 0x00, 0x00, 0x00, 0x80, 0x00, 0x00, \
+		0x0c, 0x00, 0x0a, 0x00, 0x08, 0x01, 0x02, 0x03, 0x04, \
+		0x05, 0x06, 0x07, 0x08
+
+static isc_result_t
+parse(const unsigned char *wire, size_t len, unsigned int options,
+      dns_message_t **msgp) {
+	isc_buffer_t source;
+	isc_result_t result;
+
+	dns_message_create(mctx, NULL, NULL, DNS_MESSAGE_INTENTPARSE, msgp);
+
+	isc_buffer_constinit(&source, wire, len);
+	isc_buffer_add(&source, len);
+
+	result = dns_message_parse(*msgp, &source, options);
+	return (result);
+}
+
+/*
+ * Parse 'wire' through the small query path and, by asking for the
+ * record order to be preserved, through the general section code, and
+ * check that both give the same result and the same OPT record.
+ */
+static isc_result_t
+parse_both(const unsigned char *wire, size_t len) {
+	dns_message_t *fast = NULL, *slow = NULL;
+	isc_result_t fresult, sresult;
+
+	fresult = parse(wire, len, 0, &fast);
+	sresult = parse(wire, len, DNS_MESSAGEPARSE_PRESERVEORDER, &slow);
+	assert_int_equal(fresult, sresult);
+
+	if (fresult == ISC_R_SUCCESS) {
+		dns_rdataset_t *fopt = dns_message_getopt(fast);
+		dns_rdataset_t *sopt = dns_message_getopt(slow);
+		dns_rdata_t frdata = DNS_RDATA_INIT;
+		dns_rdata_t srdata = DNS_RDATA_INIT;
+
+		assert_non_null(fopt);
+		assert_non_null(sopt);
+		assert_int_equal(fopt->type, sopt->type);
+		assert_int_equal(fopt->rdclass, sopt->rdclass);
+		assert_int_equal(fopt->ttl, sopt->ttl);
+		assert_int_equal(fast->rcode, slow->rcode);
+		assert_int_equal(dns_rdataset_count(fopt),
+				 dns_rdataset_count(sopt));
+
+		assert_int_equal(dns_rdataset_first(fopt), ISC_R_SUCCESS);
+		assert_int_equal(dns_rdataset_first(sopt), ISC_R_SUCCESS);
+		dns_rdataset_current(fopt, &frdata);
+		dns_rdataset_current(sopt, &srdata);
+		assert_int_equal(dns_rdata_compare(&frdata, &srdata), 0);
+
+		assert_int_equal(
+			ISC_LIST_EMPTY(fast->sections[DNS_SECTION_ADDITIONAL]),
+			ISC_LIST_EMPTY(slow->sections[DNS_SECTION_ADDITIONAL]));
+	}
+
+	dns_message_detach(&fast);
+	dns_message_detach(&slow);
+
+	return (fresult);
+}
+
+/* a valid query with a single OPT record takes either path to the same end */
+ISC_RUN_TEST_IMPL(smallopt_valid) {
+	static const unsigned char cookie[] = { QUERY_HEADER(1), OPT_COOKIE };
+	static const unsigned char empty[] = { QUERY_HEADER(1), 0x00, 0x00,
+					       0x29, 0x04, 0xd0, 0x00, 0x00,
+					       0x00, 0x00, 0x00, 0x00 };
+	/* extended rcode bits set in the TTL */
+	static const unsigned char rcode[] = { QUERY_HEADER(1), 0x00, 0x00,
+					       0x29, 0x02, 0x00, 0x01, 0x00,
+					       0x00, 0x00, 0x00, 0x00 };
+
+	UNUSED(state);
+
+	assert_int_equal(parse_both(cookie, sizeof(cookie)), ISC_R_SUCCESS);
+	assert_int_equal(parse_both(empty, sizeof(empty)), ISC_R_SUCCESS);
+	assert_int_equal(parse_both(rcode, sizeof(rcode)), ISC_R_SUCCESS);
+}
+
+/* an OPT record that is not owned by the root name is rejected */
+ISC_RUN_TEST_IMPL(smallopt_badowner) {
+	static const unsigned char wire[] = { QUERY_HEADER(1), 0x01, 'a', 0x00,
+					      0x00, 0x29, 0x10, 0x00, 0x00,
+					      0x00, 0x00, 0x00, 0x00, 0x00 };
+
+	UNUSED(state);
+
+	assert_int_equal(parse_both(wire, sizeof(wire)), DNS_R_FORMERR);
+}
+
+/* a second OPT record is rejected */
+ISC_RUN_TEST_IMPL(smallopt_duplicate) {
+	static const unsigned char wire[] = { QUERY_HEADER(2), OPT_COOKIE,
+					      OPT_COOKIE };
+
+	UNUSED(state);
+
+	assert_int_equal(parse_both(wire, sizeof(wire)), DNS_R_FORMERR);
+}
+
+/* OPT rdata that runs past the end of the message */
+ISC_RUN_TEST_IMPL(smallopt_truncated) {
+	static const unsigned char wire[] = { QUERY_HEADER(1), OPT_COOKIE };
+
+	UNUSED(state);
+
+	assert_int_equal(parse_both(wire, sizeof(wire) - 1),
+			 ISC_R_UNEXPECTEDEND);
+}
+
+/* trailing data after the OPT record is tolerated the same way */
+ISC_RUN_TEST_IMPL(smallopt_trailing) {
+	static const unsigned char wire[] = { QUERY_HEADER(1), OPT_COOKIE,
+					      0xde, 0xad, 0xbe, 0xef };
+
+	UNUSED(state);
+
+	assert_int_equal(parse_both(wire, sizeof(wire)), ISC_R_SUCCESS);
+}
+
+ISC_TEST_LIST_START
+ISC_TEST_ENTRY(smallopt_valid)
+ISC_TEST_ENTRY(smallopt_badowner)
+ISC_TEST_ENTRY(smallopt_duplicate)
+ISC_TEST_ENTRY(smallopt_truncated)
+ISC_TEST_ENTRY(smallopt_trailing)
+ISC_TEST_LIST_END
+
+ISC_TEST_MAIN
@@ -339,6 +339,94 @@ ISC_RUN_TEST_IMPL(qpiter) {
 	dns_qp_destroy(&qp);
 }
 
+ISC_RUN_TEST_IMPL(qpbuild) {
+	dns_qp_t *qp = NULL, *ref = NULL;
+	dns_qpbuild_t *qpb = NULL;
+	uint32_t item[ITER_ITEMS] = { 0 };
+	dns_qp_memusage_t memusage, refusage;
+	dns_qpiter_t qpi;
+	uint32_t ival, prev;
+	isc_result_t result;
+
+	for (size_t tests = 0; tests < 100; tests++) {
+		dns_qp_create(mctx, &qpiter_methods, item, &qp);
+		dns_qp_create(mctx, &qpiter_methods, item, &ref);
+
+		/* add a random subset of the items in order */
+		dns_qpbuild_create(qp, &qpb);
+		for (ival = 1; ival < ITER_ITEMS; ival++) {
+			item[ival] = isc_random_uniform(2) == 0 ? 0 : ival;
+			if (item[ival] == 0) {
+				continue;
+			}
+			result = dns_qpbuild_add(qpb, &item[ival], ival);
+			assert_int_equal(result, ISC_R_SUCCESS);
+			result = dns_qpbuild_add(qpb, &item[ival], ival);
+			assert_int_equal(result, ISC_R_EXISTS);
+			result = dns_qp_insert(ref, &item[ival], ival);
+			assert_int_equal(result, ISC_R_SUCCESS);
+		}
+		dns_qpbuild_destroy(&qpb);
+		assert_null(qpb);
+
+		/* the result is the same size as a compacted trie */
+		dns_qp_compact(ref, DNS_QPGC_ALL);
+		memusage = dns_qp_memusage(qp);
+		refusage = dns_qp_memusage(ref);
+		assert_int_equal(memusage.leaves, refusage.leaves);
+		assert_int_equal(memusage.live, refusage.live);
+		assert_int_equal(memusage.used, memusage.live);
+		assert_int_equal(memusage.free, 0);
+		assert_false(memusage.fragmented);
+
+		/* check that we see every item in the correct order */
+		prev = 0;
+		dns_qpiter_init(qp, &qpi);
+		while (dns_qpiter_next(&qpi, NULL, NULL, &ival) ==
+		       ISC_R_SUCCESS)
+		{
+			assert_in_range(ival, prev + 1, ITER_ITEMS - 1);
+			assert_int_equal(ival, item[ival]);
+			item[ival] = ~ival;
+			prev = ival;
+		}
+		for (ival = 0; ival < ITER_ITEMS; ival++) {
+			if (item[ival] != 0) {
+				assert_int_equal(item[ival], ~ival);
+			}
+		}
+
+		dns_qp_destroy(&ref);
+		dns_qp_destroy(&qp);
+	}
+
+	/* out of order items are still added */
+	dns_qp_create(mctx, &qpiter_methods, item, &qp);
+	dns_qpbuild_create(qp, &qpb);
+	for (ival = 1; ival < ITER_ITEMS; ival++) {
+		item[ival] = ival;
+	}
+	for (ival = ITER_ITEMS / 2; ival < ITER_ITEMS; ival++) {
+		result = dns_qpbuild_add(qpb, &item[ival], ival);
+		assert_int_equal(result, ISC_R_SUCCESS);
+	}
+	for (ival = 1; ival < ITER_ITEMS / 2; ival++) {
+		result = dns_qpbuild_add(qpb, &item[ival], ival);
+		assert_int_equal(result, ISC_R_SUCCESS);
+	}
+	dns_qpbuild_destroy(&qpb);
+
+	prev = 0;
+	dns_qpiter_init(qp, &qpi);
+	while (dns_qpiter_next(&qpi, NULL, NULL, &ival) == ISC_R_SUCCESS) {
+		assert_int_equal(ival, prev + 1);
+		prev = ival;
+	}
+	assert_int_equal(prev, ITER_ITEMS - 1);
+
+	dns_qp_destroy(&qp);
+}
+
 static void
 no_op(void *uctx, void *pval, uint32_t ival) {
 	UNUSED(uctx);
@@ -366,6 +454,14 @@ const dns_qpmethods_t string_methods = {
 	getname,
 };
 
+const dns_qpmethods_t fingerprint_methods = {
+	no_op,
+	no_op,
+	qpkey_fromstring,
+	getname,
+	.fingerprint = true,
+};
+
 struct check_partialmatch {
 	const char *query;
 	isc_result_t result;
@@ -512,6 +608,102 @@ ISC_RUN_TEST_IMPL(partialmatch) {
 	dns_qp_destroy(&qp);
 }
 
+/*
+ * exact lookups must give the same answers with and without fingerprints,
+ * one name at a time or in batches with dns_qp_getnames()
+ */
+static void
+check_getname(const dns_qpmethods_t *methods) {
+	dns_qp_t *qp = NULL;
+
+	dns_qp_create(mctx, methods, NULL, &qp);
+
+	const char insert[][16] = {
+		"a.b.",		"b.",		"fo.bar.",	"foo.bar.",
+		"fooo.bar.",	"web.foo.bar.",	"x.",		"y.x.",
+		"z.y.x.",	"example.",	"www.example.",	"mx.example.",
+		"ns1.example.",	"ns2.example.",
+	};
+
+	/*
+	 * more queries than fit in one batch of interleaved searches
+	 */
+	static const char *query[] = {
+		"a.b.",		"b.c.",		"bar.",		"foo.bar.",
+		"foooo.bar.",	"web.foo.bar.",	"my.foo.bar.",	"x.",
+		"y.x.",		"z.y.x.",	"zz.y.x.",	"example.",
+		"ns1.example.",	"ns3.example.",	"mx.example.",	".",
+		"b.",		"www.example.",	"fo.bar.",	"w.x.",
+	};
+	dns_fixedname_t fixed[ARRAY_SIZE(query)];
+	const dns_name_t *names[ARRAY_SIZE(query)];
+	bool present[ARRAY_SIZE(query)] = { false };
+	void *pvals[ARRAY_SIZE(query)];
+	isc_result_t results[ARRAY_SIZE(query)];
+
+	for (size_t q = 0; q < ARRAY_SIZE(query); q++) {
+		names[q] = dns_fixedname_initname(&fixed[q]);
+		dns_test_namefromstring(query[q], &fixed[q]);
+		for (size_t i = 0; i < ARRAY_SIZE(insert); i++) {
+			if (strcmp(query[q], insert[i]) == 0) {
+				present[q] = true;
+			}
+		}
+	}
+
+	/* an empty trie has none of the names */
+	dns_qp_getnames(qp, ARRAY_SIZE(query), names, NULL, NULL, results);
+	for (size_t q = 0; q < ARRAY_SIZE(query); q++) {
+		assert_int_equal(results[q], ISC_R_NOTFOUND);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(insert); i++) {
+		insert_str(qp, insert[i]);
+	}
+
+	dns_qp_getnames(qp, ARRAY_SIZE(query), names, pvals, NULL, results);
+	for (size_t q = 0; q < ARRAY_SIZE(query); q++) {
+		void *pval = NULL;
+		isc_result_t result = dns_qp_getname(qp, names[q], &pval,
+						     NULL);
+		if (verbose) {
+			fprintf(stderr, "%s %s\n", query[q],
+				isc_result_totext(result));
+		}
+		assert_int_equal(results[q], result);
+		if (present[q]) {
+			assert_int_equal(result, ISC_R_SUCCESS);
+			assert_string_equal(pval, query[q]);
+			assert_ptr_equal(pvals[q], pval);
+		} else {
+			assert_int_equal(result, ISC_R_NOTFOUND);
+		}
+	}
+
+	/* half of the names are gone */
+	for (size_t q = 0; q < ARRAY_SIZE(query); q += 2) {
+		isc_result_t result = dns_qp_deletename(qp, names[q], NULL,
+							NULL);
+		assert_int_equal(result,
+				 present[q] ? ISC_R_SUCCESS : ISC_R_NOTFOUND);
+	}
+	dns_qp_getnames(qp, ARRAY_SIZE(query), names, NULL, NULL, results);
+	for (size_t q = 0; q < ARRAY_SIZE(query); q++) {
+		isc_result_t result = dns_qp_getname(qp, names[q], NULL, NULL);
+		assert_int_equal(results[q], result);
+		assert_int_equal(result, q % 2 == 1 && present[q]
+						 ? ISC_R_SUCCESS
+						 : ISC_R_NOTFOUND);
+	}
+
+	dns_qp_destroy(&qp);
+}
+
+ISC_RUN_TEST_IMPL(getname) {
+	check_getname(&string_methods);
+	check_getname(&fingerprint_methods);
+}
+
 struct check_qpchain {
 	const char *query;
 	isc_result_t result;
@@ -931,7 +1123,9 @@ ISC_TEST_LIST_START
 ISC_TEST_ENTRY(qpkey_name)
 ISC_TEST_ENTRY(qpkey_sort)
 ISC_TEST_ENTRY(qpiter)
+ISC_TEST_ENTRY(qpbuild)
 ISC_TEST_ENTRY(partialmatch)
+ISC_TEST_ENTRY(getname)
 ISC_TEST_ENTRY(qpchain)
 ISC_TEST_ENTRY(predecessors)
 ISC_TEST_ENTRY(fixiterator)
@@ -211,9 +211,301 @@ ISC_LOOP_TEST_IMPL(overmempurge_longname) {
 	isc_loopmgr_shutdown(loopmgr);
 }
 
+/*
+ * Add a prefetch-eligible rdataset of private type 'rtype' with TTL 'ttl'
+ * at <idx>.example.com, and look it up 'hits' times.
+ */
+static void
+gethot_addrdataset(dns_db_t *db, isc_stdtime_t now, int idx,
+		   dns_rdatatype_t rtype, dns_ttl_t ttl, unsigned int hits) {
+	isc_result_t result;
+	dns_rdata_t rdata = DNS_RDATA_INIT;
+	dns_dbnode_t *node = NULL;
+	dns_rdatalist_t rdatalist;
+	dns_rdataset_t rdataset;
+	dns_fixedname_t fname;
+	char namebuf[DNS_NAME_FORMATSIZE];
+	unsigned char rdatabuf[4] = { 0 };
+
+	snprintf(namebuf, sizeof(namebuf), "%d.example.com.", idx);
+	dns_test_namefromstring(namebuf, &fname);
+
+	result = dns_db_findnode(db, dns_fixedname_name(&fname), true, &node);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	rdata.length = sizeof(rdatabuf);
+	rdata.data = rdatabuf;
+	rdata.rdclass = dns_rdataclass_in;
+	rdata.type = rtype;
+
+	dns_rdatalist_init(&rdatalist);
+	rdatalist.rdclass = dns_rdataclass_in;
+	rdatalist.type = rtype;
+	rdatalist.ttl = ttl;
+	ISC_LIST_APPEND(rdatalist.rdata, &rdata, link);
+
+	dns_rdataset_init(&rdataset);
+	dns_rdatalist_tordataset(&rdatalist, &rdataset);
+	rdataset.attributes |= DNS_RDATASETATTR_PREFETCH;
+
+	result = dns_db_addrdataset(db, node, NULL, now, &rdataset, 0, NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	for (unsigned int i = 0; i < hits; i++) {
+		dns_rdataset_t found;
+
+		dns_rdataset_init(&found);
+		result = dns_db_findrdataset(db, node, NULL, rtype, 0, now,
+					     &found, NULL);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		dns_rdataset_disassociate(&found);
+	}
+
+	dns_db_detachnode(db, &node);
+}
+
+ISC_RUN_TEST_IMPL(gethot) {
+	isc_result_t result;
+	dns_db_t *db = NULL;
+	dns_dbhotentry_t entries[2];
+	isc_stdtime_t now = isc_stdtime_now();
+	char namebuf[DNS_NAME_FORMATSIZE];
+	unsigned int n;
+
+	result = dns_db_create(mctx, "qpcache", dns_rootname, dns_dbtype_cache,
+			       dns_rdataclass_in, 0, NULL, &db);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* About to expire, with increasing popularity */
+	gethot_addrdataset(db, now, 1, 50053, 5, 1);
+	gethot_addrdataset(db, now, 2, 50053, 5, 3);
+	gethot_addrdataset(db, now, 3, 50053, 5, 10);
+	gethot_addrdataset(db, now, 4, 50053, 5, 5);
+
+	/* Popular, but not expiring soon */
+	gethot_addrdataset(db, now, 5, 50053, 3600, 20);
+
+	n = dns_db_gethot(db, now, 10, 2, entries, ARRAY_SIZE(entries));
+	assert_int_equal(n, 2);
+
+	dns_name_format(entries[0].name, namebuf, sizeof(namebuf));
+	assert_string_equal(namebuf, "3.example.com");
+	assert_int_equal(entries[0].type, 50053);
+	assert_true(entries[0].hits > entries[1].hits);
+
+	dns_name_format(entries[1].name, namebuf, sizeof(namebuf));
+	assert_string_equal(namebuf, "4.example.com");
+
+	/* The RRsets returned have been claimed */
+	n = dns_db_gethot(db, now, 10, 2, entries, ARRAY_SIZE(entries));
+	assert_int_equal(n, 1);
+	dns_name_format(entries[0].name, namebuf, sizeof(namebuf));
+	assert_string_equal(namebuf, "2.example.com");
+
+	/* 1.example.com has not been looked up often enough */
+	n = dns_db_gethot(db, now, 10, 2, entries, ARRAY_SIZE(entries));
+	assert_int_equal(n, 0);
+
+	dns_db_detach(&db);
+}
+
+/*
+ * Many more candidates than entries: only the most popular ones are
+ * returned, most popular first.
+ */
+ISC_RUN_TEST_IMPL(gethot_top) {
+	isc_result_t result;
+	dns_db_t *db = NULL;
+	dns_dbhotentry_t entries[8];
+	isc_stdtime_t now = isc_stdtime_now();
+	unsigned int n;
+
+	result = dns_db_create(mctx, "qpcache", dns_rootname, dns_dbtype_cache,
+			       dns_rdataclass_in, 0, NULL, &db);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* Hit counts 2..41, added in no particular order */
+	for (int i = 0; i < 40; i++) {
+		gethot_addrdataset(db, now, i, 50053, 5, (i * 7) % 40 + 2);
+	}
+
+	n = dns_db_gethot(db, now, 10, 2, entries, ARRAY_SIZE(entries));
+	assert_int_equal(n, ARRAY_SIZE(entries));
+	for (unsigned int i = 0; i < n; i++) {
+		assert_int_equal(entries[i].hits, 41 - i);
+	}
+
+	/* The next most popular ones are returned on the next call */
+	n = dns_db_gethot(db, now, 10, 2, entries, ARRAY_SIZE(entries));
+	assert_int_equal(n, ARRAY_SIZE(entries));
+	for (unsigned int i = 0; i < n; i++) {
+		assert_int_equal(entries[i].hits, 33 - i);
+	}
+
+	dns_db_detach(&db);
+}
+
+/*
+ * Cache an NXDOMAIN for 'namestr' with the given trust level and
+ * dns_db_addrdataset() options.
+ */
+static void
+nxdomaincut_add(dns_db_t *db, const char *namestr, dns_trust_t trust,
+		unsigned int options, isc_stdtime_t now) {
+	isc_result_t result;
+	dns_dbnode_t *node = NULL;
+	dns_rdata_t rdata = DNS_RDATA_INIT;
+	dns_rdatalist_t rdatalist;
+	dns_rdataset_t rdataset;
+	dns_fixedname_t fname;
+	unsigned char rdatabuf[4] = { 0 };
+
+	dns_test_namefromstring(namestr, &fname);
+	result = dns_db_findnode(db, dns_fixedname_name(&fname), true, &node);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	rdata.length = sizeof(rdatabuf);
+	rdata.data = rdatabuf;
+	rdata.rdclass = dns_rdataclass_in;
+	rdata.type = dns_rdatatype_none;
+
+	dns_rdatalist_init(&rdatalist);
+	rdatalist.rdclass = dns_rdataclass_in;
+	rdatalist.type = dns_rdatatype_none;
+	rdatalist.covers = dns_rdatatype_any;
+	rdatalist.ttl = 300;
+	ISC_LIST_APPEND(rdatalist.rdata, &rdata, link);
+
+	dns_rdataset_init(&rdataset);
+	dns_rdatalist_tordataset(&rdatalist, &rdataset);
+	rdataset.trust = trust;
+	rdataset.attributes |= DNS_RDATASETATTR_NEGATIVE |
+			       DNS_RDATASETATTR_NXDOMAIN;
+
+	result = dns_db_addrdataset(db, node, NULL, now, &rdataset, options,
+				    NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	dns_db_detachnode(db, &node);
+}
+
+static isc_result_t
+nxdomaincut_find(dns_db_t *db, const char *namestr, unsigned int options,
+		 isc_stdtime_t now, dns_name_t *found) {
+	isc_result_t result;
+	dns_rdataset_t rdataset;
+	dns_fixedname_t fname;
+
+	dns_test_namefromstring(namestr, &fname);
+	dns_rdataset_init(&rdataset);
+	result = dns_db_find(db, dns_fixedname_name(&fname), NULL,
+			     dns_rdatatype_a, options, now, NULL, found,
+			     &rdataset, NULL);
+	if (dns_rdataset_isassociated(&rdataset)) {
+		dns_rdataset_disassociate(&rdataset);
+	}
+
+	return (result);
+}
+
+/*
+ * With DNS_DBFIND_NXDOMAINCUT, an NXDOMAIN for a name also covers
+ * everything underneath it, whether it was validated or not.
+ */
+ISC_RUN_TEST_IMPL(nxdomaincut) {
+	isc_result_t result;
+	dns_db_t *db = NULL;
+	dns_fixedname_t fname, ffound;
+	dns_name_t *found = dns_fixedname_initname(&ffound);
+	isc_stdtime_t now = isc_stdtime_now();
+
+	result = dns_db_create(mctx, "qpcache", dns_rootname, dns_dbtype_cache,
+			       dns_rdataclass_in, 0, NULL, &db);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	nxdomaincut_add(db, "nx.example.com.", dns_trust_secure, 0, now);
+	nxdomaincut_add(db, "unsigned.example.", dns_trust_answer, 0, now);
+
+	/* The name itself */
+	result = nxdomaincut_find(db, "nx.example.com.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, DNS_R_NCACHENXDOMAIN);
+
+	/* A name below it is answered from the cut */
+	result = nxdomaincut_find(db, "a.b.nx.example.com.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, DNS_R_NCACHENXDOMAIN);
+	dns_test_namefromstring("nx.example.com.", &fname);
+	assert_true(dns_name_equal(found, dns_fixedname_name(&fname)));
+
+	/* ...but only when asked for */
+	result = nxdomaincut_find(db, "a.b.nx.example.com.", 0, now, found);
+	assert_int_equal(result, ISC_R_NOTFOUND);
+
+	/* A sibling is not affected */
+	result = nxdomaincut_find(db, "a.example.com.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, ISC_R_NOTFOUND);
+
+	/* An unsigned NXDOMAIN cuts as well */
+	result = nxdomaincut_find(db, "random.unsigned.example.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, DNS_R_NCACHENXDOMAIN);
+	dns_test_namefromstring("unsigned.example.", &fname);
+	assert_true(dns_name_equal(found, dns_fixedname_name(&fname)));
+
+	dns_db_detach(&db);
+}
+
+/*
+ * An unvalidated NXDOMAIN learned by relaxed QNAME minimization, which
+ * may be a broken server's answer for an empty non-terminal, does not
+ * hide the names below it.  A validated one still does.
+ */
+ISC_RUN_TEST_IMPL(nxdomaincut_ent) {
+	isc_result_t result;
+	dns_db_t *db = NULL;
+	dns_fixedname_t ffound;
+	dns_name_t *found = dns_fixedname_initname(&ffound);
+	isc_stdtime_t now = isc_stdtime_now();
+
+	result = dns_db_create(mctx, "qpcache", dns_rootname, dns_dbtype_cache,
+			       dns_rdataclass_in, 0, NULL, &db);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	nxdomaincut_add(db, "ent.example.com.", dns_trust_answer,
+			DNS_DBADD_QMIN, now);
+	nxdomaincut_add(db, "nx.example.net.", dns_trust_secure,
+			DNS_DBADD_QMIN, now);
+	nxdomaincut_add(db, "pending.example.org.", dns_trust_pending_answer,
+			0, now);
+
+	result = nxdomaincut_find(db, "ent.example.com.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, DNS_R_NCACHENXDOMAIN);
+
+	result = nxdomaincut_find(db, "www.ent.example.com.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, ISC_R_NOTFOUND);
+
+	result = nxdomaincut_find(db, "www.nx.example.net.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, DNS_R_NCACHENXDOMAIN);
+
+	/* Data still pending validation is not used either */
+	result = nxdomaincut_find(db, "www.pending.example.org.",
+				  DNS_DBFIND_NXDOMAINCUT, now, found);
+	assert_int_equal(result, ISC_R_NOTFOUND);
+
+	dns_db_detach(&db);
+}
+
 ISC_TEST_LIST_START
 ISC_TEST_ENTRY_CUSTOM(overmempurge_bigrdata, setup_managers, teardown_managers)
 ISC_TEST_ENTRY_CUSTOM(overmempurge_longname, setup_managers, teardown_managers)
+ISC_TEST_ENTRY(gethot)
+ISC_TEST_ENTRY(gethot_top)
+ISC_TEST_ENTRY(nxdomaincut)
+ISC_TEST_ENTRY(nxdomaincut_ent)
 ISC_TEST_LIST_END
 
 ISC_TEST_MAIN
@@ -216,9 +216,87 @@ ISC_RUN_TEST_IMPL(setownercase) {
 	assert_true(dns_name_caseequal(name1, name2));
 }
 
+/*
+ * only the NS targets that have address records below a zone cut are
+ * glue; the targets that are not in the tree are skipped by the batched
+ * lookup in newglue()
+ */
+ISC_RUN_TEST_IMPL(glue) {
+	isc_result_t result;
+	dns_db_t *db = NULL;
+	dns_dbversion_t *version = NULL;
+	dns_dbnode_t *node = NULL;
+	dns_rdataset_t rdataset;
+	dns_fixedname_t fixed;
+	dns_name_t *name = dns_fixedname_initname(&fixed);
+	struct {
+		const char *name;
+		bool a, aaaa, required;
+		bool seen;
+	} expect[] = {
+		{ "ns1.sub.test.", true, true, true, false },
+		{ "ns2.sub.test.", true, false, true, false },
+		{ "ns.sibling.test.", false, true, false, false },
+	};
+	size_t count = 0;
+
+	UNUSED(state);
+
+	result = dns_test_loaddb(&db, dns_dbtype_zone, "test.",
+				 TESTS_DIR "/testdata/qpzone/glue.db");
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	dns_db_currentversion(db, &version);
+	dns_test_namefromstring("sub.test.", &fixed);
+	result = dns_db_findnode(db, name, false, &node);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	dns_rdataset_init(&rdataset);
+	result = dns_db_findrdataset(db, node, version, dns_rdatatype_ns, 0, 0,
+				     &rdataset, NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	assert_int_equal(dns_rdataset_count(&rdataset), 6);
+
+	dns_glue_t *glue_list = newglue(db, (qpz_version_t *)version,
+					(qpznode_t *)node, &rdataset);
+	for (dns_glue_t *glue = glue_list; glue != NULL; glue = glue->next) {
+		dns_name_t *gluename = dns_fixedname_name(&glue->fixedname);
+		bool found = false;
+
+		count++;
+		for (size_t i = 0; i < ARRAY_SIZE(expect); i++) {
+			dns_test_namefromstring(expect[i].name, &fixed);
+			if (!dns_name_equal(gluename, name)) {
+				continue;
+			}
+			assert_false(expect[i].seen);
+			expect[i].seen = found = true;
+			assert_int_equal(
+				dns_rdataset_isassociated(&glue->rdataset_a),
+				expect[i].a);
+			assert_int_equal(
+				dns_rdataset_isassociated(&glue->rdataset_aaaa),
+				expect[i].aaaa);
+			dns_rdataset_t *rds = expect[i].a ? &glue->rdataset_a
+							  : &glue->rdataset_aaaa;
+			assert_int_equal((rds->attributes &
+					  DNS_RDATASETATTR_REQUIRED) != 0,
+					 expect[i].required);
+		}
+		assert_true(found);
+	}
+	assert_int_equal(count, ARRAY_SIZE(expect));
+
+	freeglue(db->mctx, glue_list);
+	dns_rdataset_disassociate(&rdataset);
+	dns_db_detachnode(db, &node);
+	dns_db_closeversion(db, &version, false);
+	dns_db_detach(&db);
+}
+
 ISC_TEST_LIST_START
 ISC_TEST_ENTRY(ownercase)
 ISC_TEST_ENTRY(setownercase)
+ISC_TEST_ENTRY_CUSTOM(glue, setup_managers, teardown_managers)
 ISC_TEST_LIST_END
 
 ISC_TEST_MAIN
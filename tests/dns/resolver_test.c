@@ -28,8 +28,11 @@
 #include <isc/tls.h>
 #include <isc/util.h>
 
+#include <dns/db.h>
 #include <dns/dispatch.h>
 #include <dns/name.h>
+#include <dns/rdatalist.h>
+#include <dns/rdataset.h>
 #include <dns/resolver.h>
 #include <dns/view.h>
 
@@ -65,7 +68,12 @@ setup_test(void **state) {
 static int
 teardown_test(void **state) {
 	dns_dispatch_detach(&dispatch);
-	dns_view_detach(&view);
+	if (view != NULL) {
+		dns_view_detach(&view);
+	}
+	if (tlsctx_cache != NULL) {
+		isc_tlsctx_cache_detach(&tlsctx_cache);
+	}
 	teardown_managers(state);
 
 	return (0);
@@ -184,6 +192,109 @@ ISC_LOOP_TEST_IMPL(settimeout_overmax) {
 	isc_loopmgr_shutdown(loopmgr);
 }
 
+static dns_fetch_t *fetches[3];
+static dns_rdataset_t fetchrdatasets[3];
+static unsigned int fetches_outstanding;
+
+static void
+fetch_done(void *arg) {
+	dns_fetchresponse_t *resp = (dns_fetchresponse_t *)arg;
+	dns_fetch_t **fetchp = resp->arg;
+
+	if (resp->node != NULL) {
+		dns_db_detachnode(resp->db, &resp->node);
+	}
+	if (resp->db != NULL) {
+		dns_db_detach(&resp->db);
+	}
+	if (dns_rdataset_isassociated(resp->rdataset)) {
+		dns_rdataset_disassociate(resp->rdataset);
+	}
+	isc_mem_putanddetach(&resp->mctx, resp, sizeof(*resp));
+	dns_resolver_destroyfetch(fetchp);
+
+	if (--fetches_outstanding == 0) {
+		/* Shut the resolver down while the loop is still running */
+		dns_view_detach(&view);
+		isc_loopmgr_shutdown(loopmgr);
+	}
+}
+
+static isc_result_t
+sharedquota_fetch(dns_resolver_t *resolver, const char *namestr,
+		  dns_rdataset_t *nameservers, unsigned int options,
+		  dns_fetch_t **fetchp, dns_rdataset_t *rdataset) {
+	dns_fixedname_t fname, fdomain;
+
+	dns_test_namefromstring(namestr, &fname);
+	dns_test_namefromstring("example.", &fdomain);
+
+	dns_rdataset_init(rdataset);
+	return (dns_resolver_createfetch(
+		resolver, dns_fixedname_name(&fname), dns_rdatatype_a,
+		dns_fixedname_name(&fdomain), nameservers, NULL, NULL, 0,
+		options, 0, NULL, mainloop, fetch_done, fetchp, rdataset, NULL,
+		fetchp));
+}
+
+/*
+ * A client fetch for data that is being prefetched must still be
+ * counted against fetches-per-zone, so it does not join the prefetch.
+ */
+ISC_LOOP_TEST_IMPL(sharedquota) {
+	isc_result_t result;
+	dns_resolver_t *resolver = NULL;
+	dns_rdata_t rdata = DNS_RDATA_INIT;
+	dns_rdatalist_t rdatalist;
+	dns_rdataset_t nameservers;
+	unsigned char rdatabuf[DNS_NAME_MAXWIRE];
+
+	isc_tlsctx_cache_create(mctx, &tlsctx_cache);
+	result = dns_view_createresolver(view, netmgr, 0, tlsctx_cache,
+					 dispatch, NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	dns_resolver_attach(view->resolver, &resolver);
+	dns_resolver_setfetchesperzone(resolver, 1);
+	dns_view_freeze(view);
+
+	result = dns_test_rdatafromstring(&rdata, dns_rdataclass_in,
+					  dns_rdatatype_ns, rdatabuf,
+					  sizeof(rdatabuf), "ns.example.",
+					  false);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	dns_rdatalist_init(&rdatalist);
+	rdatalist.rdclass = dns_rdataclass_in;
+	rdatalist.type = dns_rdatatype_ns;
+	rdatalist.ttl = 3600;
+	ISC_LIST_APPEND(rdatalist.rdata, &rdata, link);
+	dns_rdataset_init(&nameservers);
+	dns_rdatalist_tordataset(&rdatalist, &nameservers);
+
+	/* The prefetch is exempt from fetches-per-zone */
+	result = sharedquota_fetch(resolver, "a.example.", &nameservers,
+				   DNS_FETCHOPT_PREFETCH, &fetches[0],
+				   &fetchrdatasets[0]);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* A client fetch for the same data uses up the quota... */
+	result = sharedquota_fetch(resolver, "a.example.", &nameservers, 0,
+				   &fetches[1], &fetchrdatasets[1]);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* ...so there is no room for another one in the same zone */
+	result = sharedquota_fetch(resolver, "b.example.", &nameservers, 0,
+				   &fetches[2], &fetchrdatasets[2]);
+	assert_int_equal(result, DNS_R_DROP);
+	assert_null(fetches[2]);
+
+	fetches_outstanding = 2;
+	dns_resolver_cancelfetch(fetches[0]);
+	dns_resolver_cancelfetch(fetches[1]);
+
+	dns_rdataset_disassociate(&nameservers);
+	dns_resolver_detach(&resolver);
+}
+
 ISC_TEST_LIST_START
 ISC_TEST_ENTRY_CUSTOM(create, setup_test, teardown_test)
 ISC_TEST_ENTRY_CUSTOM(gettimeout, setup_test, teardown_test)
@@ -191,6 +302,7 @@ ISC_TEST_ENTRY_CUSTOM(settimeout, setup_test, teardown_test)
 ISC_TEST_ENTRY_CUSTOM(settimeout_default, setup_test, teardown_test)
 ISC_TEST_ENTRY_CUSTOM(settimeout_belowmin, setup_test, teardown_test)
 ISC_TEST_ENTRY_CUSTOM(settimeout_overmax, setup_test, teardown_test)
+ISC_TEST_ENTRY_CUSTOM(sharedquota, setup_test, teardown_test)
 ISC_TEST_LIST_END
 
 ISC_TEST_MAIN
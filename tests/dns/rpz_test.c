@@ -0,0 +1,519 @@
+/*
+ * Copyright (C) Internet Systems Consortium, Inc. ("ISC")
+ *
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * See the COPYRIGHT file distributed with this work for additional
+ * information regarding copyright ownership.
+ */
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <sched.h> /* IWYU pragma: keep */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UNIT_TESTING
+#include <cmocka.h>
+
+#include <isc/atomic.h>
+#include <isc/file.h>
+#include <isc/ht.h>
+#include <isc/loop.h>
+#include <isc/netaddr.h>
+#include <isc/thread.h>
+#include <isc/timer.h>
+#include <isc/util.h>
+
+#include <dns/db.h>
+#include <dns/diff.h>
+#include <dns/fixedname.h>
+#include <dns/journal.h>
+#include <dns/rpz.h>
+#include <dns/view.h>
+
+#include <tests/dns.h>
+
+#define JOURNAL "rpz_test.jnl"
+
+/*
+ * Both policy zones summarize the same database.  The first one is told
+ * about the journal and follows it, the second one always walks the
+ * whole database; after each update their summaries must be the same.
+ */
+static dns_view_t *view = NULL;
+static dns_db_t *db = NULL;
+static dns_rpz_zones_t *rpzs[2] = { NULL, NULL };
+static dns_rpz_zone_t *rpzones[2] = { NULL, NULL };
+static isc_timer_t *timer = NULL;
+static int step = 0;
+
+/* serial 1, loaded without a journal */
+static const zonechange_t load[] = {
+	{ DNS_DIFFOP_ADD, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 1 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "rpz", 300, "NS", "ns.example." },
+	{ DNS_DIFFOP_ADD, "bad.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "*.bad.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "gone.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "32.1.2.0.192.rpz-ip.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "24.0.3.0.198.rpz-ip.rpz", 300, "CNAME", "." },
+	{ 0, NULL, 0, NULL, NULL }
+};
+
+/* serial 1 to 2: add, delete and rewrite names and addresses */
+static const zonechange_t update2[] = {
+	{ DNS_DIFFOP_DEL, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 1 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 2 3600 600 86400 300" },
+	{ DNS_DIFFOP_DEL, "gone.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "new.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_DEL, "bad.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "bad.example.rpz", 300, "CNAME", "*." },
+	{ DNS_DIFFOP_ADD, "16.0.0.0.10.rpz-ip.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_DEL, "32.1.2.0.192.rpz-ip.rpz", 300, "CNAME", "." },
+	{ 0, NULL, 0, NULL, NULL }
+};
+
+/* serial 2 to 3: re-add a deleted name, add an IPv6 address */
+static const zonechange_t update3[] = {
+	{ DNS_DIFFOP_DEL, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 2 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 3 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "gone.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_DEL, "24.0.3.0.198.rpz-ip.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "128.1.zz.db8.2001.rpz-ip.rpz", 300, "CNAME", "." },
+	{ 0, NULL, 0, NULL, NULL }
+};
+
+/* serial 3 to 4, never journaled */
+static const zonechange_t update4[] = {
+	{ DNS_DIFFOP_DEL, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 3 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 4 3600 600 86400 300" },
+	{ DNS_DIFFOP_DEL, "new.example.rpz", 300, "CNAME", "." },
+	{ DNS_DIFFOP_ADD, "32.1.2.0.192.rpz-ip.rpz", 300, "CNAME", "." },
+	{ 0, NULL, 0, NULL, NULL }
+};
+
+/* serial 4 to 5 */
+static const zonechange_t update5[] = {
+	{ DNS_DIFFOP_DEL, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 4 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 5 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "other.example.rpz", 300, "CNAME", "." },
+	{ 0, NULL, 0, NULL, NULL }
+};
+
+static const char *qnames[] = { "bad.example",	 "www.bad.example",
+				"gone.example",	 "new.example",
+				"other.example", "good.example",
+				NULL };
+
+static const char *addresses[] = { "192.0.2.1",	  "198.0.3.5", "10.0.5.5",
+				   "10.1.0.1",	  "2001:db8::1",
+				   "2001:db8::2", NULL };
+
+static void
+apply(const zonechange_t *changes, bool journal) {
+	dns_dbversion_t *version = NULL;
+	dns_diff_t diff;
+	isc_result_t result;
+
+	result = dns_test_difffromchanges(&diff, changes, false);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	result = dns_db_newversion(db, &version);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	result = dns_diff_apply(&diff, db, version);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	if (journal) {
+		dns_journal_t *j = NULL;
+
+		result = dns_journal_open(mctx, JOURNAL, DNS_JOURNAL_CREATE,
+					  &j);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		result = dns_journal_write_transaction(j, &diff);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		dns_journal_destroy(&j);
+	}
+
+	/* Committing the version notifies both policy zones */
+	dns_db_closeversion(db, &version, true);
+	dns_diff_clear(&diff);
+}
+
+static bool
+idle(dns_rpz_zone_t *rpz) {
+	bool result;
+
+	LOCK(&rpz->rpzs->maint_lock);
+	result = !rpz->updatepending && !rpz->updaterunning;
+	UNLOCK(&rpz->rpzs->maint_lock);
+
+	return (result);
+}
+
+static dns_rpz_zbits_t
+find_name(dns_rpz_zones_t *z, const char *namestr) {
+	dns_fixedname_t fname;
+
+	dns_test_namefromstring(namestr, &fname);
+	return (dns_rpz_find_name(z, DNS_RPZ_TYPE_QNAME, DNS_RPZ_ALL_ZBITS,
+				  dns_fixedname_name(&fname)));
+}
+
+static dns_rpz_num_t
+find_ip(dns_rpz_zones_t *z, const char *addrstr, dns_name_t *ip_name,
+	dns_rpz_prefix_t *prefix) {
+	isc_netaddr_t netaddr;
+	struct in_addr in4;
+	struct in6_addr in6;
+
+	if (inet_pton(AF_INET, addrstr, &in4) == 1) {
+		isc_netaddr_fromin(&netaddr, &in4);
+	} else {
+		assert_int_equal(inet_pton(AF_INET6, addrstr, &in6), 1);
+		isc_netaddr_fromin6(&netaddr, &in6);
+	}
+
+	return (dns_rpz_find_ip(z, DNS_RPZ_TYPE_IP, DNS_RPZ_ALL_ZBITS,
+				&netaddr, ip_name, prefix));
+}
+
+/*
+ * The summary followed from the journal must be the one the whole
+ * database walk built.
+ */
+static void
+compare(void) {
+	assert_memory_equal(&rpzs[0]->triggers[0], &rpzs[1]->triggers[0],
+			    sizeof(rpzs[0]->triggers[0]));
+	assert_memory_equal(&rpzs[0]->have, &rpzs[1]->have,
+			    sizeof(rpzs[0]->have));
+	assert_int_equal(isc_ht_count(rpzones[0]->nodes),
+			 isc_ht_count(rpzones[1]->nodes));
+
+	for (size_t i = 0; qnames[i] != NULL; i++) {
+		assert_int_equal(find_name(rpzs[0], qnames[i]),
+				 find_name(rpzs[1], qnames[i]));
+	}
+
+	for (size_t i = 0; addresses[i] != NULL; i++) {
+		dns_fixedname_t fname0, fname1;
+		dns_name_t *name0 = dns_fixedname_initname(&fname0);
+		dns_name_t *name1 = dns_fixedname_initname(&fname1);
+		dns_rpz_prefix_t prefix0 = 0, prefix1 = 0;
+		dns_rpz_num_t num0, num1;
+
+		num0 = find_ip(rpzs[0], addresses[i], name0, &prefix0);
+		num1 = find_ip(rpzs[1], addresses[i], name1, &prefix1);
+		assert_int_equal(num0, num1);
+		if (num0 != DNS_RPZ_INVALID_NUM) {
+			assert_int_equal(prefix0, prefix1);
+			assert_true(dns_name_equal(name0, name1));
+		}
+	}
+}
+
+static void
+shutdown_test(void) {
+	isc_timer_stop(timer);
+	isc_timer_destroy(&timer);
+
+	for (size_t i = 0; i < ARRAY_SIZE(rpzs); i++) {
+		if (rpzs[i] != NULL) {
+			dns_rpz_zones_shutdown(rpzs[i]);
+			dns_rpz_zones_detach(&rpzs[i]);
+		}
+	}
+	dns_db_detach(&db);
+	dns_view_detach(&view);
+	(void)isc_file_remove(JOURNAL);
+
+	isc_loopmgr_shutdown(loopmgr);
+}
+
+static void
+poll_cb(void *arg ISC_ATTR_UNUSED) {
+	dns_rpz_zbits_t zbit = DNS_RPZ_ZBIT(0);
+	dns_fixedname_t fname;
+	dns_name_t *name = dns_fixedname_initname(&fname);
+	dns_rpz_prefix_t prefix;
+
+	if (!idle(rpzones[0]) || !idle(rpzones[1])) {
+		return;
+	}
+
+	compare();
+
+	switch (step++) {
+	case 0:
+		/* The initial load was walked */
+		assert_int_equal(find_name(rpzs[0], "gone.example"), zbit);
+		assert_true(rpzones[0]->insync);
+		assert_int_equal(rpzones[0]->serial, 1);
+		apply(update2, true);
+		break;
+	case 1:
+		assert_int_equal(find_name(rpzs[0], "gone.example"), 0);
+		assert_int_equal(find_name(rpzs[0], "new.example"), zbit);
+		assert_int_equal(find_name(rpzs[0], "bad.example"), zbit);
+		assert_int_equal(find_ip(rpzs[0], "10.0.5.5", name, &prefix),
+				 0);
+		assert_int_equal(prefix, 16);
+		assert_int_equal(find_ip(rpzs[0], "192.0.2.1", name, &prefix),
+				 DNS_RPZ_INVALID_NUM);
+		assert_int_equal(rpzones[0]->serial, 2);
+		apply(update3, true);
+		break;
+	case 2:
+		assert_int_equal(find_name(rpzs[0], "gone.example"), zbit);
+		assert_int_equal(find_ip(rpzs[0], "198.0.3.5", name, &prefix),
+				 DNS_RPZ_INVALID_NUM);
+		assert_int_equal(find_ip(rpzs[0], "2001:db8::1", name, &prefix),
+				 0);
+		assert_int_equal(rpzones[0]->serial, 3);
+
+		/*
+		 * Start a new journal at serial 4, as if the old one had
+		 * been compacted away: it does not cover the change from
+		 * serial 3, so the next update has to fall back to the walk.
+		 */
+		apply(update4, false);
+		assert_int_equal(isc_file_remove(JOURNAL), ISC_R_SUCCESS);
+		apply(update5, true);
+		break;
+	case 3:
+		assert_int_equal(find_name(rpzs[0], "new.example"), 0);
+		assert_int_equal(find_name(rpzs[0], "other.example"), zbit);
+		assert_int_equal(find_ip(rpzs[0], "192.0.2.1", name, &prefix),
+				 0);
+		assert_int_equal(rpzones[0]->serial, 5);
+		assert_true(rpzones[0]->insync);
+		shutdown_test();
+		break;
+	default:
+		UNREACHABLE();
+	}
+}
+
+static void
+setnames(dns_rpz_zone_t *rpz) {
+	isc_result_t result;
+	struct {
+		dns_name_t *name;
+		const char *str;
+		const dns_name_t *origin;
+	} names[] = {
+		{ &rpz->origin, "rpz", dns_rootname },
+		{ &rpz->client_ip, DNS_RPZ_CLIENT_IP_ZONE, &rpz->origin },
+		{ &rpz->ip, DNS_RPZ_IP_ZONE, &rpz->origin },
+		{ &rpz->nsdname, DNS_RPZ_NSDNAME_ZONE, &rpz->origin },
+		{ &rpz->nsip, DNS_RPZ_NSIP_ZONE, &rpz->origin },
+		{ &rpz->passthru, DNS_RPZ_PASSTHRU_NAME, dns_rootname },
+		{ &rpz->drop, DNS_RPZ_DROP_NAME, dns_rootname },
+		{ &rpz->tcp_only, DNS_RPZ_TCP_ONLY_NAME, dns_rootname },
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(names); i++) {
+		result = dns_name_fromstring(names[i].name, names[i].str,
+					     names[i].origin,
+					     DNS_NAME_DOWNCASE, mctx);
+		assert_int_equal(result, ISC_R_SUCCESS);
+	}
+}
+
+/*
+ * Create the zone database and 'nzones' policy zones that summarize it,
+ * and call 'cb' every 10ms until the test shuts down.
+ */
+static void
+setup_test(size_t nzones, isc_job_cb cb) {
+	isc_result_t result;
+	isc_interval_t interval;
+	dns_fixedname_t forigin;
+	dns_name_t *origin = dns_fixedname_initname(&forigin);
+
+	step = 0;
+
+	result = dns_test_makeview("view", false, false, &view);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	result = dns_name_fromstring(origin, "rpz", dns_rootname, 0, NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	result = dns_db_create(mctx, ZONEDB_DEFAULT, origin, dns_dbtype_zone,
+			       dns_rdataclass_in, 0, NULL, &db);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	for (size_t i = 0; i < nzones; i++) {
+		result = dns_rpz_new_zones(view, loopmgr, &rpzs[i]);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		result = dns_rpz_new_zone(rpzs[i], &rpzones[i]);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		setnames(rpzones[i]);
+		dns_rpz_dbupdate_register(db, rpzones[i]);
+	}
+
+	isc_timer_create(mainloop, cb, NULL, &timer);
+	isc_interval_set(&interval, 0, 10 * NS_PER_MS);
+	isc_timer_start(timer, isc_timertype_ticker, &interval);
+}
+
+/* updates read from the journal give the same summary as a full walk */
+ISC_LOOP_TEST_IMPL(journal) {
+	(void)isc_file_remove(JOURNAL);
+
+	setup_test(2, poll_cb);
+	dns_rpz_setjournal(rpzones[0], JOURNAL);
+
+	apply(load, false);
+}
+
+#define NREADERS 4
+#define NUPDATES 50
+
+static isc_thread_t readers[NREADERS];
+static atomic_bool readers_done;
+static atomic_uint_fast32_t lookups;
+static atomic_uint_fast32_t errors;
+
+/* serial 1, with the address that is never removed */
+static const zonechange_t concurrent_load[] = {
+	{ DNS_DIFFOP_ADD, "rpz", 300, "SOA",
+	  "ns.example. hostmaster.example. 1 3600 600 86400 300" },
+	{ DNS_DIFFOP_ADD, "rpz", 300, "NS", "ns.example." },
+	{ DNS_DIFFOP_ADD, "32.1.2.0.192.rpz-ip.rpz", 300, "CNAME", "." },
+	ZONECHANGE_SENTINEL
+};
+
+/* added by the odd updates and removed by the even ones */
+static const char *toggled[] = {
+	"24.0.100.51.198.rpz-ip.rpz",
+	"24.0.0.0.10.rpz-ip.rpz",
+	"16.0.0.0.10.rpz-ip.rpz",
+	"128.1.zz.db8.2001.rpz-ip.rpz",
+};
+
+/*
+ * The addresses the readers look up, and the prefix of the trigger
+ * that matches each of them when the toggled triggers are present.
+ */
+static const struct {
+	const char *address;
+	dns_rpz_prefix_t prefix;
+	bool always;
+} probes[] = {
+	{ "192.0.2.1", 32, true },     { "198.51.100.7", 24, false },
+	{ "10.0.0.1", 24, false },     { "10.0.1.1", 16, false },
+	{ "2001:db8::1", 128, false }, { "192.0.2.2", 0, false },
+};
+
+static void *
+reader(void *arg ISC_ATTR_UNUSED) {
+	dns_fixedname_t fname;
+	dns_name_t *name = dns_fixedname_initname(&fname);
+
+	while (!atomic_load_acquire(&readers_done)) {
+		for (size_t i = 0; i < ARRAY_SIZE(probes); i++) {
+			dns_rpz_prefix_t prefix = 0;
+			dns_rpz_num_t num;
+
+			num = find_ip(rpzs[0], probes[i].address, name,
+				      &prefix);
+			if (num == DNS_RPZ_INVALID_NUM) {
+				if (probes[i].always) {
+					atomic_fetch_add_relaxed(&errors, 1);
+				}
+			} else if (num != 0 || prefix != probes[i].prefix) {
+				atomic_fetch_add_relaxed(&errors, 1);
+			}
+		}
+		atomic_fetch_add_relaxed(&lookups, 1);
+	}
+
+	return (NULL);
+}
+
+static void
+toggle(int serial) {
+	char oldsoa[128], newsoa[128];
+	zonechange_t changes[2 + ARRAY_SIZE(toggled) + 1] = {
+		{ DNS_DIFFOP_DEL, "rpz", 300, "SOA", oldsoa },
+		{ DNS_DIFFOP_ADD, "rpz", 300, "SOA", newsoa },
+	};
+	dns_diffop_t op = (serial % 2 == 1) ? DNS_DIFFOP_ADD
+					    : DNS_DIFFOP_DEL;
+
+	snprintf(oldsoa, sizeof(oldsoa),
+		 "ns.example. hostmaster.example. %d 3600 600 86400 300",
+		 serial);
+	snprintf(newsoa, sizeof(newsoa),
+		 "ns.example. hostmaster.example. %d 3600 600 86400 300",
+		 serial + 1);
+	for (size_t i = 0; i < ARRAY_SIZE(toggled); i++) {
+		changes[2 + i] = (zonechange_t){ op, toggled[i], 300, "CNAME",
+						 "." };
+	}
+
+	apply(changes, false);
+}
+
+static void
+concurrent_poll_cb(void *arg ISC_ATTR_UNUSED) {
+	if (!idle(rpzones[0])) {
+		return;
+	}
+
+	if (step == 0) {
+		/* Start looking up once the first summary is published */
+		atomic_init(&readers_done, false);
+		atomic_init(&lookups, 0);
+		atomic_init(&errors, 0);
+		for (size_t i = 0; i < ARRAY_SIZE(readers); i++) {
+			isc_thread_create(reader, NULL, &readers[i]);
+		}
+	}
+
+	if (step < NUPDATES) {
+		toggle(++step);
+		return;
+	}
+
+	atomic_store_release(&readers_done, true);
+	for (size_t i = 0; i < ARRAY_SIZE(readers); i++) {
+		isc_thread_join(readers[i], NULL);
+	}
+	assert_int_equal(atomic_load(&errors), 0);
+	assert_true(atomic_load(&lookups) > 0);
+
+	shutdown_test();
+}
+
+/* IP address lookups run while the radix tree is being updated */
+ISC_LOOP_TEST_IMPL(concurrent) {
+	setup_test(1, concurrent_poll_cb);
+
+	apply(concurrent_load, false);
+}
+
+ISC_TEST_LIST_START
+ISC_TEST_ENTRY_CUSTOM(journal, setup_managers, teardown_managers)
+ISC_TEST_ENTRY_CUSTOM(concurrent, setup_managers, teardown_managers)
+ISC_TEST_LIST_END
+
+ISC_TEST_MAIN
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) Internet Systems Consortium, Inc. ("ISC")
+ *
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * See the COPYRIGHT file distributed with this work for additional
+ * information regarding copyright ownership.
+ */
+
+#include <arpa/inet.h>
+#include <inttypes.h>
+#include <sched.h> /* IWYU pragma: keep */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UNIT_TESTING
+#include <cmocka.h>
+
+#include <isc/sockaddr.h>
+#include <isc/util.h>
+
+#include <dns/view.h>
+
+/* Include the main file */
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wshadow"
+#undef CHECK
+#include "rrl.c"
+#pragma GCC diagnostic pop
+
+#undef CHECK
+#include <tests/dns.h>
+
+static dns_view_t *view = NULL;
+
+/*
+ * Create a view with response rate limiting of 'rate' responses per
+ * second per /24 client block, dropping every limited response, with
+ * a one second window.
+ */
+static dns_rrl_t *
+rrl_create(int rate, int min_entries, int max_entries) {
+	isc_result_t result;
+	dns_rrl_t *rrl = NULL;
+
+	result = dns_test_makeview("view", false, false, &view);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	result = dns_rrl_init(&rrl, view, min_entries);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	rrl->responses_per_second.r = rate;
+	atomic_init(&rrl->responses_per_second.scaled, rate);
+	rrl->window = 1;
+	rrl->max_entries = max_entries;
+	rrl->ipv4_prefixlen = 24;
+	rrl->ipv4_mask = htonl(0xffffff00);
+
+	return (rrl);
+}
+
+static void
+rrl_sockaddr(const char *addr, isc_sockaddr_t *sa) {
+	struct in_addr in;
+
+	assert_int_equal(inet_pton(AF_INET, addr, &in), 1);
+	isc_sockaddr_fromin(sa, &in, 53);
+}
+
+static dns_rrl_table_t *
+rrl_table(dns_rrl_t *rrl, const char *addr) {
+	isc_sockaddr_t sa;
+
+	rrl_sockaddr(addr, &sa);
+	return (get_table(rrl, &sa));
+}
+
+static dns_rrl_result_t
+rrl_query(const char *addr, const char *qname, isc_stdtime_t now) {
+	isc_sockaddr_t sa;
+	dns_fixedname_t fname;
+	char log_buf[DNS_RRL_LOG_BUF_LEN];
+
+	rrl_sockaddr(addr, &sa);
+	dns_test_namefromstring(qname, &fname);
+
+	return (dns_rrl(view, NULL, &sa, false, dns_rdataclass_in,
+			dns_rdatatype_a, dns_fixedname_name(&fname),
+			ISC_R_SUCCESS, now, false, log_buf, sizeof(log_buf)));
+}
+
+/*
+ * Find an address in a /24 block other than 'addr's that maps to a
+ * table (if 'same' is true) or not (if 'same' is false) that of 'addr'.
+ * 'skip' matching blocks are passed over first.
+ */
+static void
+rrl_findaddr(dns_rrl_t *rrl, const char *addr, bool same, int skip,
+	     char *buf, size_t size) {
+	dns_rrl_table_t *t = rrl_table(rrl, addr);
+
+	for (int i = 1; i < 256; i++) {
+		for (int j = 0; j < 256; j++) {
+			snprintf(buf, size, "10.%d.%d.1", i, j);
+			if (strcmp(buf, addr) != 0 &&
+			    (rrl_table(rrl, buf) == t) == same && skip-- == 0)
+			{
+				return;
+			}
+		}
+	}
+
+	fail_msg("no address found");
+}
+
+/*
+ * The same client block and response are limited the same way on
+ * every query, and get their full rate again once the window is over.
+ */
+ISC_RUN_TEST_IMPL(rrl_limit) {
+	isc_stdtime_t now = isc_stdtime_now();
+
+	rrl_create(2, 32, 0);
+
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_DROP);
+
+	/* Another address in the same /24 block shares the bucket */
+	assert_int_equal(rrl_query("10.53.0.2", "www.example.", now),
+			 DNS_RRL_RESULT_DROP);
+
+	/* A different response has a bucket of its own */
+	assert_int_equal(rrl_query("10.53.0.1", "other.example.", now),
+			 DNS_RRL_RESULT_OK);
+
+	/* After the window, the limit starts over */
+	now += 2;
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query("10.53.0.2", "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_DROP);
+
+	dns_view_detach(&view);
+}
+
+/*
+ * Clients in different tables do not affect each other's limits or
+ * table size.
+ */
+ISC_RUN_TEST_IMPL(rrl_tables) {
+	isc_stdtime_t now = isc_stdtime_now();
+	dns_rrl_t *rrl = rrl_create(2, 32, 0);
+	dns_rrl_table_t *ta = NULL, *tb = NULL;
+	char b[sizeof("10.255.255.1")];
+	char qname[DNS_NAME_FORMATSIZE];
+	int ta_entries, tb_entries;
+
+	rrl_findaddr(rrl, "10.53.0.1", false, 0, b, sizeof(b));
+	ta = rrl_table(rrl, "10.53.0.1");
+	tb = rrl_table(rrl, b);
+	assert_ptr_not_equal(ta, tb);
+	ta_entries = ta->num_entries;
+	tb_entries = tb->num_entries;
+
+	/* Make the first client's table grow, and limit it */
+	for (int i = 0; i < 100; i++) {
+		snprintf(qname, sizeof(qname), "n%d.example.", i);
+		assert_int_equal(rrl_query("10.53.0.1", qname, now),
+				 DNS_RRL_RESULT_OK);
+	}
+	assert_int_equal(rrl_query("10.53.0.1", "n0.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query("10.53.0.1", "n0.example.", now),
+			 DNS_RRL_RESULT_DROP);
+	assert_true(ta->num_entries > ta_entries);
+	assert_int_equal(tb->num_entries, tb_entries);
+
+	/* The second client still gets its full rate */
+	assert_int_equal(rrl_query(b, "n0.example.", now), DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query(b, "n0.example.", now), DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query(b, "n0.example.", now),
+			 DNS_RRL_RESULT_DROP);
+
+	assert_int_equal(atomic_load(&rrl->num_entries),
+			 32 + ta->num_entries - ta_entries);
+
+	dns_view_detach(&view);
+}
+
+/*
+ * Idle entries are reused for new clients instead of growing the
+ * table, and max-table-size caps the number of entries.
+ */
+ISC_RUN_TEST_IMPL(rrl_cleanup) {
+	isc_stdtime_t now = isc_stdtime_now();
+	dns_rrl_t *rrl = rrl_create(2, 64, 64);
+	dns_rrl_table_t *t = rrl_table(rrl, "10.53.0.1");
+	char addr[sizeof("10.255.255.1")];
+	int skip = 0;
+
+	assert_int_equal(t->num_entries, 4);
+
+	/* Fill the table */
+	for (int i = 0; i < 3; i++) {
+		rrl_findaddr(rrl, "10.53.0.1", true, skip++, addr,
+			     sizeof(addr));
+		assert_int_equal(rrl_query(addr, "www.example.", now),
+				 DNS_RRL_RESULT_OK);
+	}
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_DROP);
+
+	/* At the size limit the oldest entry is taken */
+	rrl_findaddr(rrl, "10.53.0.1", true, skip++, addr, sizeof(addr));
+	assert_int_equal(rrl_query(addr, "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+	assert_int_equal(t->num_entries, 4);
+	assert_int_equal(atomic_load(&rrl->num_entries), 64);
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_DROP);
+
+	/* Once they are idle, entries are reused for new clients */
+	now += 5;
+	for (int i = 0; i < 4; i++) {
+		rrl_findaddr(rrl, "10.53.0.1", true, skip++, addr,
+			     sizeof(addr));
+		assert_int_equal(rrl_query(addr, "www.example.", now),
+				 DNS_RRL_RESULT_OK);
+	}
+	assert_int_equal(t->num_entries, 4);
+	assert_int_equal(atomic_load(&rrl->num_entries), 64);
+
+	/* The client that was limited is not any more */
+	assert_int_equal(rrl_query("10.53.0.1", "www.example.", now),
+			 DNS_RRL_RESULT_OK);
+
+	dns_view_detach(&view);
+}
+
+ISC_TEST_LIST_START
+ISC_TEST_ENTRY(rrl_limit)
+ISC_TEST_ENTRY(rrl_tables)
+ISC_TEST_ENTRY(rrl_cleanup)
+ISC_TEST_LIST_END
+
+ISC_TEST_MAIN
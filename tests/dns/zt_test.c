@@ -32,6 +32,7 @@
 #include <isc/util.h>
 
 #include <dns/db.h>
+#include <dns/fixedname.h>
 #include <dns/name.h>
 #include <dns/view.h>
 #include <dns/zone.h>
@@ -88,6 +89,61 @@ ISC_LOOP_TEST_IMPL(apply) {
 	isc_loopmgr_shutdown(loopmgr);
 }
 
+/* mount zones in a batch */
+ISC_LOOP_TEST_IMPL(batch) {
+	isc_result_t result;
+	dns_zone_t *zone1 = NULL, *zone2 = NULL, *found = NULL;
+	dns_fixedname_t fixed;
+	dns_name_t *name = dns_fixedname_initname(&fixed);
+	int nzones = 0;
+
+	result = dns_test_makezone("foo", &zone1, NULL, true);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	view = dns_zone_getview(zone1);
+
+	dns_view_beginzonebatch(view);
+
+	result = dns_test_makezone("bar", &zone2, view, false);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* the batching thread sees its own mounts ... */
+	result = dns_name_fromstring(name, "bar", dns_rootname, 0, NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	result = dns_view_findzone(view, name, DNS_ZTFIND_EXACT, &found);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	assert_ptr_equal(found, zone2);
+	dns_zone_detach(&found);
+
+	result = dns_view_addzone(view, zone2);
+	assert_int_equal(result, ISC_R_EXISTS);
+
+	/* ... but the committed table does not have them yet */
+	result = dns_view_apply(view, false, NULL, count_zone, &nzones);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	assert_int_equal(nzones, 1);
+
+	dns_view_endzonebatch(view);
+
+	nzones = 0;
+	result = dns_view_apply(view, false, NULL, count_zone, &nzones);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	assert_int_equal(nzones, 2);
+
+	dns_test_setupzonemgr();
+	result = dns_test_managezone(zone1);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	result = dns_test_managezone(zone2);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	dns_test_releasezone(zone1);
+	dns_test_releasezone(zone2);
+	dns_test_closezonemgr();
+
+	dns_view_detach(&view);
+	dns_zone_detach(&zone1);
+	dns_zone_detach(&zone2);
+	isc_loopmgr_shutdown(loopmgr);
+}
+
 static isc_result_t
 load_done_last(void *uap) {
 	dns_zone_t *zone = uap;
@@ -273,6 +329,7 @@ ISC_LOOP_TEST_IMPL(asyncload_zt) {
 
 ISC_TEST_LIST_START
 ISC_TEST_ENTRY_CUSTOM(apply, setup_managers, teardown_managers)
+ISC_TEST_ENTRY_CUSTOM(batch, setup_managers, teardown_managers)
 ISC_TEST_ENTRY_CUSTOM(asyncload_zone, setup_managers, teardown_managers)
 ISC_TEST_ENTRY_CUSTOM(asyncload_zt, setup_managers, teardown_managers)
 ISC_TEST_LIST_END
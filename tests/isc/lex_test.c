@@ -26,6 +26,7 @@
 #include <isc/buffer.h>
 #include <isc/lex.h>
 #include <isc/mem.h>
+#include <isc/stdio.h>
 #include <isc/util.h>
 
 #include <tests/isc.h>
@@ -338,8 +339,105 @@ ISC_RUN_TEST_IMPL(lex_keypair) {
 	}
 }
 
+static void
+lex_all(isc_lex_t *lex, isc_buffer_t *out) {
+	isc_result_t result;
+	isc_token_t token;
+	isc_region_t r;
+	unsigned int options = ISC_LEXOPT_EOL | ISC_LEXOPT_EOF |
+			       ISC_LEXOPT_DNSMULTILINE | ISC_LEXOPT_QSTRING;
+	unsigned int n = 0;
+
+	for (;;) {
+		result = isc_lex_gettoken(lex, options, &token);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		if (token.type == isc_tokentype_eof) {
+			break;
+		}
+
+		/* Exercise ungettoken across read-ahead boundaries. */
+		if (++n % 7 == 0) {
+			isc_lex_ungettoken(lex, &token);
+			result = isc_lex_gettoken(lex, options, &token);
+			assert_int_equal(result, ISC_R_SUCCESS);
+		}
+
+		isc_lex_getlasttokentext(lex, &token, &r);
+		isc_buffer_putuint32(out, isc_lex_getsourceline(lex));
+		isc_buffer_putuint8(out, token.type);
+		isc_buffer_putmem(out, r.base, r.length);
+	}
+}
+
+/* check that a file source is tokenized the same as a buffer source */
+ISC_RUN_TEST_IMPL(lex_file) {
+	isc_result_t result;
+	isc_lex_t *lex = NULL;
+	isc_buffer_t *text = NULL, *fromfile = NULL, *frombuffer = NULL;
+	isc_lexspecials_t specials;
+	isc_region_t r;
+	FILE *f = NULL;
+	char line[256];
+	size_t i;
+
+	UNUSED(state);
+
+	isc_buffer_allocate(mctx, &text, 1024);
+	isc_buffer_allocate(mctx, &fromfile, 1024);
+	isc_buffer_allocate(mctx, &frombuffer, 1024);
+
+	/* Several times the size of the read-ahead block. */
+	for (i = 0; i < 20000; i++) {
+		snprintf(line, sizeof(line),
+			 "name%zu 3600 IN TXT ( \"text %zu\" ; comment\n"
+			 "\tx%zu )\n",
+			 i * 7919, i, i);
+		isc_buffer_putstr(text, line);
+	}
+
+	result = isc_stdio_open("lex.test", "w", &f);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	isc_buffer_usedregion(text, &r);
+	result = isc_stdio_write(r.base, r.length, 1, f, NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	isc_stdio_close(f);
+
+	memset(specials, 0, sizeof(specials));
+	specials['('] = 1;
+	specials[')'] = 1;
+	specials['"'] = 1;
+
+	isc_lex_create(mctx, 1024, &lex);
+	isc_lex_setspecials(lex, specials);
+	isc_lex_setcomments(lex, ISC_LEXCOMMENT_DNSMASTERFILE);
+	result = isc_lex_openfile(lex, "lex.test");
+	assert_int_equal(result, ISC_R_SUCCESS);
+	lex_all(lex, fromfile);
+	isc_lex_destroy(&lex);
+
+	isc_lex_create(mctx, 1024, &lex);
+	isc_lex_setspecials(lex, specials);
+	isc_lex_setcomments(lex, ISC_LEXCOMMENT_DNSMASTERFILE);
+	result = isc_lex_openbuffer(lex, text);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	lex_all(lex, frombuffer);
+	isc_lex_destroy(&lex);
+
+	assert_int_equal(isc_buffer_usedlength(fromfile),
+			 isc_buffer_usedlength(frombuffer));
+	assert_memory_equal(isc_buffer_base(fromfile),
+			    isc_buffer_base(frombuffer),
+			    isc_buffer_usedlength(fromfile));
+
+	(void)remove("lex.test");
+	isc_buffer_free(&text);
+	isc_buffer_free(&fromfile);
+	isc_buffer_free(&frombuffer);
+}
+
 ISC_TEST_LIST_START
 ISC_TEST_ENTRY(lex_0xff)
+ISC_TEST_ENTRY(lex_file)
 ISC_TEST_ENTRY(lex_keypair)
 ISC_TEST_ENTRY(lex_setline)
 ISC_TEST_ENTRY(lex_string)
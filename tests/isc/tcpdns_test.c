@@ -127,6 +127,97 @@ ISC_LOOP_TEST_IMPL(tcpdns_recv_send) {
 	}
 }
 
+/*
+ * Send several queries in one write and check that the responses sent
+ * synchronously from the read callback are held back on the TCP socket
+ * and written together, rather than one by one.
+ */
+
+#define PIPELINED 8
+
+static size_t pipelined_sreads = 0;
+static size_t pipelined_queued[PIPELINED];
+static size_t pipelined_creceived = 0;
+static unsigned char
+	pipelined_queries[PIPELINED * (sizeof(uint16_t) + sizeof(send_magic))];
+
+static void
+pipelined_send_cb(isc_nmhandle_t *handle ISC_ATTR_UNUSED, isc_result_t eresult,
+		  void *cbarg ISC_ATTR_UNUSED) {
+	assert_int_equal(eresult, ISC_R_SUCCESS);
+}
+
+static void
+pipelined_recv_cb(isc_nmhandle_t *handle, isc_result_t eresult,
+		  isc_region_t *region ISC_ATTR_UNUSED,
+		  void *cbarg ISC_ATTR_UNUSED) {
+	isc_nmsocket_t *tcpsock = NULL;
+
+	if (eresult != ISC_R_SUCCESS) {
+		return;
+	}
+
+	assert_true(pipelined_sreads < PIPELINED);
+
+	isc_nm_send(handle, &send_msg, pipelined_send_cb, NULL);
+
+	/* The response must still be queued on the TCP socket */
+	tcpsock = handle->sock->outerhandle->sock;
+	pipelined_queued[pipelined_sreads++] = tcpsock->sendq_len;
+}
+
+static void
+pipelined_read_cb(isc_nmhandle_t *handle ISC_ATTR_UNUSED, isc_result_t eresult,
+		  isc_region_t *region, void *cbarg ISC_ATTR_UNUSED) {
+	if (eresult != ISC_R_SUCCESS) {
+		return;
+	}
+
+	pipelined_creceived += region->length;
+	if (pipelined_creceived >= sizeof(pipelined_queries)) {
+		isc_loopmgr_shutdown(loopmgr);
+	}
+}
+
+static void
+pipelined_connect_cb(isc_nmhandle_t *handle, isc_result_t eresult,
+		     void *cbarg ISC_ATTR_UNUSED) {
+	unsigned char *p = pipelined_queries;
+
+	assert_int_equal(eresult, ISC_R_SUCCESS);
+
+	for (size_t i = 0; i < PIPELINED; i++) {
+		*p++ = 0;
+		*p++ = sizeof(send_magic);
+		memmove(p, &send_magic, sizeof(send_magic));
+		p += sizeof(send_magic);
+	}
+
+	isc_nm_read(handle, pipelined_read_cb, NULL);
+	isc_nm_send(handle,
+		    &(isc_region_t){ pipelined_queries,
+				     sizeof(pipelined_queries) },
+		    pipelined_send_cb, NULL);
+}
+
+ISC_LOOP_TEST_IMPL(tcpdns_pipelined) {
+	start_listening(ISC_NM_LISTEN_ONE, noop_accept_cb, pipelined_recv_cb);
+
+	isc_nm_tcpconnect(connect_nm, &tcp_connect_addr, &tcp_listen_addr,
+			  pipelined_connect_cb, NULL, T_CONNECT);
+}
+
+static int
+tcpdns_pipelined_teardown(void **state) {
+	assert_int_equal(pipelined_sreads, PIPELINED);
+	for (size_t i = 0; i < PIPELINED; i++) {
+		assert_int_equal(pipelined_queued[i], i + 1);
+	}
+	assert_int_equal(pipelined_creceived, sizeof(pipelined_queries));
+
+	return (teardown_netmgr_test(state));
+}
+
 /* PROXY tests */
 
 ISC_LOOP_TEST_IMPL(proxy_tcpdns_noop) { loop_test_tcpdns_noop(arg); }
@@ -158,6 +249,8 @@ ISC_TEST_ENTRY_CUSTOM(tcpdns_recv_two, stream_recv_two_setup,
 		      stream_recv_two_teardown)
 ISC_TEST_ENTRY_CUSTOM(tcpdns_recv_send, stream_recv_send_setup,
 		      stream_recv_send_teardown)
+ISC_TEST_ENTRY_CUSTOM(tcpdns_pipelined, setup_netmgr_test,
+		      tcpdns_pipelined_teardown)
 /* PROXY */
 
 ISC_TEST_ENTRY_CUSTOM(proxy_tcpdns_noop, proxystream_noop_setup,
@@ -520,6 +520,136 @@ ISC_LOOP_TEST_CUSTOM_IMPL(reschedule_ticker, setup_loop_reschedule_ticker,
 	isc_interval_set(&timer_interval, 0, NS_PER_SEC / 4);
 }
 
+/*
+ * The same with timers kept in the loop's timer wheel.
+ */
+
+ISC_LOOP_TEST_CUSTOM_IMPL(wheel_reschedule_up, setup_loop_reschedule_up,
+			  teardown_loop_timer_expect) {
+	isc_timer_createwheel(mainloop, timer_event, NULL, &timer);
+
+	/* Schedule the timer to fire immediately */
+	isc_interval_set(&timer_interval, 0, 0);
+	isc_timer_start(timer, timer_type, &timer_interval);
+
+	/* And then reschedule it to 1 second */
+	isc_interval_set(&timer_interval, 1, 0);
+	isc_timer_start(timer, timer_type, &timer_interval);
+}
+
+ISC_LOOP_TEST_CUSTOM_IMPL(wheel_reschedule_ticker,
+			  setup_loop_reschedule_ticker,
+			  teardown_loop_timer_expect) {
+	isc_timer_createwheel(mainloop, timer_event, NULL, &timer);
+
+	/* Schedule the timer to fire immediately (in the next tick) */
+	isc_interval_set(&timer_interval, 0, 0);
+	isc_timer_start(timer, timer_type, &timer_interval);
+
+	/* Then fire every 1/4 second */
+	isc_interval_set(&timer_interval, 0, NS_PER_SEC / 4);
+}
+
+/*
+ * Drive the timer wheel by hand through all of its levels and check
+ * that every timer fires on its tick, and a stopped one never does.
+ */
+
+static const uint64_t wheel_seconds[] = { 1, 2, 60, 3600, 86400 };
+static uint64_t wheel_fired[ARRAY_SIZE(wheel_seconds) + 1];
+
+static void
+wheel_event(void *arg) {
+	wheel_fired[(uintptr_t)arg] = isc_loop()->wheel.now;
+}
+
+ISC_LOOP_TEST_IMPL(wheel_levels) {
+	isc_loop_t *loop = isc_loop();
+	isc_timer_t *timers[ARRAY_SIZE(wheel_fired)] = { NULL };
+	const size_t stopped = ARRAY_SIZE(wheel_seconds);
+	uint64_t base = wheel_tick(loop) + 1;
+	isc_interval_t interval;
+
+	for (size_t i = 0; i < ARRAY_SIZE(timers); i++) {
+		isc_timer_createwheel(loop, wheel_event, (void *)(uintptr_t)i,
+				      &timers[i]);
+		if (i == stopped) {
+			isc_interval_set(&interval, 30, 0);
+		} else {
+			isc_interval_set(&interval, wheel_seconds[i], 0);
+		}
+		isc_timer_start(timers[i], isc_timertype_once, &interval);
+		wheel_fired[i] = 0;
+	}
+	isc_timer_stop(timers[stopped]);
+
+	wheel_advance(loop, UINT64_MAX);
+	assert_int_equal(loop->wheel.count, 0);
+
+	for (size_t i = 0; i < ARRAY_SIZE(wheel_seconds); i++) {
+		assert_int_equal(wheel_fired[i],
+				 base + wheel_seconds[i] * MS_PER_SEC /
+						TIMERWHEEL_TICK);
+	}
+	assert_int_equal(wheel_fired[stopped], 0);
+
+	for (size_t i = 0; i < ARRAY_SIZE(timers); i++) {
+		isc_timer_destroy(&timers[i]);
+	}
+	isc_loopmgr_shutdown(loopmgr);
+}
+
+/*
+ * A timer that restarts itself from its callback on an otherwise empty
+ * wheel must neither fire again on the same tick nor move the wheel's
+ * time backwards.
+ */
+
+#define WHEEL_REARMS 3
+
+static uint64_t wheel_rearmed[WHEEL_REARMS];
+static size_t wheel_nrearmed;
+
+static void
+wheel_rearm_event(void *arg) {
+	isc_interval_t interval;
+
+	UNUSED(arg);
+
+	assert_in_range(wheel_nrearmed, 0, WHEEL_REARMS - 1);
+	wheel_rearmed[wheel_nrearmed++] = isc_loop()->wheel.now;
+	if (wheel_nrearmed < WHEEL_REARMS) {
+		isc_interval_set(&interval, 1, 0);
+		isc_timer_start(timer, isc_timertype_once, &interval);
+	}
+}
+
+ISC_LOOP_TEST_IMPL(wheel_rearm) {
+	isc_loop_t *loop = isc_loop();
+	uint64_t base = wheel_tick(loop) + 1;
+	isc_interval_t interval;
+
+	isc_timer_createwheel(loop, wheel_rearm_event, NULL, &timer);
+
+	wheel_nrearmed = 0;
+	isc_interval_set(&interval, 1, 0);
+	isc_timer_start(timer, isc_timertype_once, &interval);
+
+	wheel_advance(loop, UINT64_MAX);
+	assert_int_equal(loop->wheel.count, 0);
+	assert_false(loop->wheel.advancing);
+
+	assert_int_equal(wheel_nrearmed, WHEEL_REARMS);
+	assert_int_equal(wheel_rearmed[0],
+			 base + MS_PER_SEC / TIMERWHEEL_TICK);
+	for (size_t i = 1; i < WHEEL_REARMS; i++) {
+		assert_true(wheel_rearmed[i] > wheel_rearmed[i - 1]);
+	}
+
+	isc_timer_destroy(&timer);
+	isc_loopmgr_shutdown(loopmgr);
+}
+
 ISC_TEST_LIST_START
 
 ISC_TEST_ENTRY_CUSTOM(ticker, setup_loopmgr, teardown_loopmgr)
@@ -531,6 +661,11 @@ ISC_TEST_ENTRY_CUSTOM(reschedule_down, setup_loopmgr, teardown_loopmgr)
 ISC_TEST_ENTRY_CUSTOM(reschedule_from_callback, setup_loopmgr, teardown_loopmgr)
 ISC_TEST_ENTRY_CUSTOM(zero, setup_loopmgr, teardown_loopmgr)
 ISC_TEST_ENTRY_CUSTOM(reschedule_ticker, setup_loopmgr, teardown_loopmgr)
+ISC_TEST_ENTRY_CUSTOM(wheel_reschedule_up, setup_loopmgr, teardown_loopmgr)
+ISC_TEST_ENTRY_CUSTOM(wheel_reschedule_ticker, setup_loopmgr,
+		      teardown_loopmgr)
+ISC_TEST_ENTRY_CUSTOM(wheel_levels, setup_loopmgr, teardown_loopmgr)
+ISC_TEST_ENTRY_CUSTOM(wheel_rearm, setup_loopmgr, teardown_loopmgr)
 
 ISC_TEST_LIST_END
 
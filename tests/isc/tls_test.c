@@ -25,6 +25,7 @@
  * redefined malloc in cmocka.h.
  */
 #include <openssl/err.h>
+#include <openssl/ssl.h>
 
 #define UNIT_TESTING
 #include <cmocka.h>
@@ -36,6 +37,7 @@
 #include <isc/refcount.h>
 #include <isc/sockaddr.h>
 #include <isc/thread.h>
+#include <isc/tls.h>
 #include <isc/util.h>
 #include <isc/uv.h>
 
@@ -152,8 +154,128 @@ ISC_LOOP_TEST_IMPL(proxy_tls_recv_send_quota_sendback) {
 	loop_test_tls_recv_send(arg);
 }
 
+/*
+ * Do a TLS handshake in memory, offering '*sessionp' for resumption if
+ * it is not NULL, and replace it with the resulting session. Returns
+ * whether the session was resumed.
+ */
+static bool
+tls_handshake(isc_tlsctx_t *server_ctx, isc_tlsctx_t *client_ctx,
+	      SSL_SESSION **sessionp) {
+	SSL *server = SSL_new(server_ctx);
+	SSL *client = SSL_new(client_ctx);
+	BIO *server_bio = NULL, *client_bio = NULL;
+	unsigned char buf[1];
+	bool resumed;
+	int i;
+
+	assert_non_null(server);
+	assert_non_null(client);
+
+	assert_int_equal(BIO_new_bio_pair(&server_bio, 0, &client_bio, 0), 1);
+	SSL_set_bio(server, server_bio, server_bio);
+	SSL_set_bio(client, client_bio, client_bio);
+	SSL_set_accept_state(server);
+	SSL_set_connect_state(client);
+
+	if (*sessionp != NULL) {
+		assert_int_equal(SSL_set_session(client, *sessionp), 1);
+		SSL_SESSION_free(*sessionp);
+		*sessionp = NULL;
+	}
+
+	for (i = 0; i < 10; i++) {
+		int cr = SSL_do_handshake(client);
+		int sr = SSL_do_handshake(server);
+		if (cr == 1 && sr == 1) {
+			break;
+		}
+	}
+	assert_true(i < 10);
+
+	/* Let the client process the session tickets, if any */
+	assert_true(SSL_read(client, buf, sizeof(buf)) <= 0);
+
+	resumed = (SSL_session_reused(client) == 1);
+	*sessionp = SSL_get1_session(client);
+	assert_non_null(*sessionp);
+
+	/* Otherwise the session is marked as not resumable */
+	SSL_set_shutdown(client, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+	SSL_set_shutdown(server, SSL_SENT_SHUTDOWN | SSL_RECEIVED_SHUTDOWN);
+
+	SSL_free(client);
+	SSL_free(server);
+
+	return (resumed);
+}
+
+static isc_tlsctx_t *
+tls_server_ctx(const char *config) {
+	isc_tlsctx_t *ctx = NULL;
+
+	assert_int_equal(isc_tlsctx_createserver(NULL, NULL, &ctx),
+			 ISC_R_SUCCESS);
+	isc_tlsctx_set_session_id_context(ctx, config, strlen(config));
+
+	return (ctx);
+}
+
+/*
+ * A session must be resumable with a server context that has been
+ * rebuilt from the same configuration, using a ticket encrypted with
+ * a key that has since been rotated, but not once the key is gone.
+ */
+ISC_RUN_TEST_IMPL(tls_resume_rebuilt) {
+	isc_tlsctx_t *client_ctx = NULL, *server_ctx = NULL;
+	SSL_SESSION *session = NULL, *saved = NULL;
+
+	assert_int_equal(isc_tlsctx_createclient(&client_ctx), ISC_R_SUCCESS);
+
+	server_ctx = tls_server_ctx("listener");
+	assert_false(tls_handshake(server_ctx, client_ctx, &session));
+	isc_tlsctx_free(&server_ctx);
+
+	/* Rebuilt from the same configuration */
+	server_ctx = tls_server_ctx("listener");
+	SSL_SESSION_up_ref(session);
+	saved = session;
+	assert_true(tls_handshake(server_ctx, client_ctx, &session));
+
+	/* Previous ticket key */
+	isc_tls_rotateticketkeys();
+	SSL_SESSION_free(session);
+	session = saved;
+	SSL_SESSION_up_ref(session);
+	assert_true(tls_handshake(server_ctx, client_ctx, &session));
+	isc_tlsctx_free(&server_ctx);
+
+	/* A different configuration */
+	server_ctx = tls_server_ctx("another listener");
+	SSL_SESSION_free(session);
+	session = saved;
+	SSL_SESSION_up_ref(session);
+	assert_false(tls_handshake(server_ctx, client_ctx, &session));
+	isc_tlsctx_free(&server_ctx);
+
+	/* The ticket key has been rotated out */
+	for (size_t i = 0; i < 3; i++) {
+		isc_tls_rotateticketkeys();
+	}
+	server_ctx = tls_server_ctx("listener");
+	SSL_SESSION_free(session);
+	session = saved;
+	assert_false(tls_handshake(server_ctx, client_ctx, &session));
+	isc_tlsctx_free(&server_ctx);
+
+	SSL_SESSION_free(session);
+	isc_tlsctx_free(&client_ctx);
+}
+
 ISC_TEST_LIST_START
 
+ISC_TEST_ENTRY(tls_resume_rebuilt)
+
 /* TLS */
 ISC_TEST_ENTRY_CUSTOM(tls_noop, stream_noop_setup, stream_noop_teardown)
 ISC_TEST_ENTRY_CUSTOM(tls_noresponse, stream_noresponse_setup,
@@ -0,0 +1,349 @@
+/*
+ * Copyright (C) Internet Systems Consortium, Inc. ("ISC")
+ *
+ * SPDX-License-Identifier: MPL-2.0
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, you can obtain one at https://mozilla.org/MPL/2.0/.
+ *
+ * See the COPYRIGHT file distributed with this work for additional
+ * information regarding copyright ownership.
+ */
+
+#include <inttypes.h>
+#include <sched.h> /* IWYU pragma: keep */
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UNIT_TESTING
+#include <cmocka.h>
+
+#include <isc/async.h>
+#include <isc/file.h>
+#include <isc/loop.h>
+#include <isc/util.h>
+
+#include <dns/acl.h>
+#include <dns/db.h>
+#include <dns/fixedname.h>
+#include <dns/journal.h>
+#include <dns/rcode.h>
+#include <dns/rdataset.h>
+#include <dns/view.h>
+#include <dns/zone.h>
+
+#include <ns/client.h>
+#include <ns/server.h>
+#include <ns/update.h>
+
+#include <tests/ns.h>
+
+#define JOURNAL "update_test.jnl"
+
+#define MAXUPDATES 3
+
+/*
+ * A set of updates sent to example.com before the zone's loop gets to
+ * any of them, and what is expected once they have all been answered.
+ */
+typedef struct {
+	const char *msgs[MAXUPDATES];
+	dns_rcode_t rcodes[MAXUPDATES];
+	uint32_t maxrecords;
+	const char *present[MAXUPDATES];
+	const char *absent[MAXUPDATES];
+	uint32_t serial;
+	unsigned int transactions;
+} scenario_t;
+
+/* the second update's prerequisite fails because of the first one */
+static const scenario_t prereq_batched = {
+	.msgs = { "prereq1", "prereq2", "prereq3" },
+	.rcodes = { dns_rcode_noerror, dns_rcode_yxdomain, dns_rcode_noerror },
+	.present = { "a.example.com", "c.example.com" },
+	.absent = { "b.example.com" },
+	/* one new version for the whole batch */
+	.serial = 2,
+	.transactions = 1,
+};
+
+/* the first two updates are one batch, the third one is on its own */
+static const scenario_t prereq_bounded = {
+	.msgs = { "prereq1", "prereq2", "prereq3" },
+	.rcodes = { dns_rcode_noerror, dns_rcode_yxdomain, dns_rcode_noerror },
+	.present = { "a.example.com", "c.example.com" },
+	.absent = { "b.example.com" },
+	.serial = 3,
+	.transactions = 2,
+};
+
+static const scenario_t prereq_unbatched = {
+	.msgs = { "prereq1", "prereq2", "prereq3" },
+	.rcodes = { dns_rcode_noerror, dns_rcode_yxdomain, dns_rcode_noerror },
+	.present = { "a.example.com", "c.example.com" },
+	.absent = { "b.example.com" },
+	.serial = 3,
+	.transactions = 2,
+};
+
+/*
+ * The second update takes the zone over its record limit.  The batch
+ * cannot be committed, and replaying it update by update gives the
+ * same results as without batching.
+ */
+static const scenario_t rollback = {
+	.msgs = { "rollback1", "rollback2", "rollback3" },
+	.rcodes = { dns_rcode_noerror, dns_rcode_servfail, dns_rcode_noerror },
+	.maxrecords = 6,
+	.present = { "d.example.com", "f.example.com" },
+	.absent = { "e.example.com" },
+	.serial = 3,
+	.transactions = 2,
+};
+
+static const scenario_t *scenario = NULL;
+static dns_view_t *view = NULL;
+static ns_client_t *clients[MAXUPDATES];
+static dns_rcode_t rcodes[MAXUPDATES];
+static unsigned int responses = 0;
+
+static void
+check_updates(void *arg ISC_ATTR_UNUSED);
+
+static void
+check_response(isc_buffer_t *buf) {
+	isc_result_t result;
+	dns_message_t *message = NULL;
+	size_t i;
+
+	dns_message_create(mctx, NULL, NULL, DNS_MESSAGE_INTENTPARSE, &message);
+
+	result = dns_message_parse(message, buf, 0);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	/* The message IDs of the updates are their positions, from 1 */
+	i = message->id - 1;
+	assert_true(i < MAXUPDATES);
+	if (i < MAXUPDATES) {
+		rcodes[i] = message->rcode;
+	}
+
+	dns_message_detach(&message);
+
+	if (++responses == MAXUPDATES) {
+		isc_async_current(check_updates, NULL);
+	}
+}
+
+static bool
+exists(dns_db_t *db, const char *namestr) {
+	isc_result_t result;
+	dns_fixedname_t fname, ffound;
+	dns_name_t *found = dns_fixedname_initname(&ffound);
+	dns_rdataset_t rdataset;
+
+	dns_test_namefromstring(namestr, &fname);
+	dns_rdataset_init(&rdataset);
+	result = dns_db_find(db, dns_fixedname_name(&fname), NULL,
+			     dns_rdatatype_any, 0, 0, NULL, found, &rdataset,
+			     NULL);
+	if (dns_rdataset_isassociated(&rdataset)) {
+		dns_rdataset_disassociate(&rdataset);
+	}
+
+	return (result == ISC_R_SUCCESS);
+}
+
+/*
+ * Count the transactions in the journal and check that it ends at the
+ * serial of the zone.
+ */
+static unsigned int
+journal_transactions(uint32_t serial) {
+	isc_result_t result;
+	dns_journal_t *j = NULL;
+	unsigned int soas = 0;
+
+	result = dns_journal_open(mctx, JOURNAL, DNS_JOURNAL_READ, &j);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	assert_int_equal(dns_journal_first_serial(j), 1);
+	assert_int_equal(dns_journal_last_serial(j), serial);
+
+	result = dns_journal_iter_init(j, 1, serial, NULL);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	for (result = dns_journal_first_rr(j); result == ISC_R_SUCCESS;
+	     result = dns_journal_next_rr(j))
+	{
+		dns_name_t *name = NULL;
+		dns_rdata_t *rdata = NULL;
+		uint32_t ttl;
+
+		dns_journal_current_rr(j, &name, &ttl, &rdata);
+		if (rdata->type == dns_rdatatype_soa) {
+			soas++;
+		}
+	}
+	assert_int_equal(result, ISC_R_NOMORE);
+	dns_journal_destroy(&j);
+
+	/* Each transaction deletes the old SOA and adds the new one */
+	return (soas / 2);
+}
+
+static void
+check_updates(void *arg ISC_ATTR_UNUSED) {
+	isc_result_t result;
+	dns_zone_t *zone = NULL;
+	dns_db_t *db = NULL;
+	dns_fixedname_t fname;
+	uint32_t serial = 0;
+
+	for (size_t i = 0; i < MAXUPDATES; i++) {
+		assert_int_equal(rcodes[i], scenario->rcodes[i]);
+	}
+
+	dns_test_namefromstring("example.com", &fname);
+	result = dns_view_findzone(view, dns_fixedname_name(&fname),
+				   DNS_ZTFIND_EXACT, &zone);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	result = dns_zone_getdb(zone, &db);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	for (size_t i = 0; i < MAXUPDATES; i++) {
+		if (scenario->present[i] != NULL) {
+			assert_true(exists(db, scenario->present[i]));
+		}
+		if (scenario->absent[i] != NULL) {
+			assert_false(exists(db, scenario->absent[i]));
+		}
+	}
+	dns_db_detach(&db);
+
+	result = dns_zone_getserial(zone, &serial);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	assert_int_equal(serial, scenario->serial);
+	assert_int_equal(journal_transactions(serial), scenario->transactions);
+	dns_zone_detach(&zone);
+
+	for (size_t i = 0; i < MAXUPDATES; i++) {
+		isc_nmhandle_t *handle = clients[i]->handle;
+
+		isc_nmhandle_detach(&clients[i]->handle);
+		isc_nmhandle_detach(&handle);
+		clients[i] = NULL;
+	}
+
+	ns_test_cleanup_zone();
+	dns_view_detach(&view);
+	(void)isc_file_remove(JOURNAL);
+
+	isc_loop_teardown(mainloop, shutdown_interfacemgr, NULL);
+	isc_loopmgr_shutdown(loopmgr);
+}
+
+/*
+ * Load example.com, and send it the updates of scenario 's' with the
+ * given "update-batch-size".
+ */
+static void
+run_updates(const scenario_t *s, uint32_t batchsize) {
+	isc_result_t result;
+	dns_zone_t *zone = NULL;
+	dns_acl_t *acl = NULL;
+	dns_fixedname_t fname;
+
+	scenario = s;
+	responses = 0;
+	(void)isc_file_remove(JOURNAL);
+
+	result = dns_test_makeview("view", false, false, &view);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	result = ns_test_serve_zone(
+		"example.com", TESTS_DIR "/testdata/update/zone1.db", view);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	dns_test_namefromstring("example.com", &fname);
+	result = dns_view_findzone(view, dns_fixedname_name(&fname),
+				   DNS_ZTFIND_EXACT, &zone);
+	assert_int_equal(result, ISC_R_SUCCESS);
+
+	result = dns_acl_any(mctx, &acl);
+	assert_int_equal(result, ISC_R_SUCCESS);
+	dns_zone_setupdateacl(zone, acl);
+	dns_acl_detach(&acl);
+	dns_zone_setjournal(zone, JOURNAL);
+	dns_zone_setmaxrecords(zone, s->maxrecords);
+	dns_zone_detach(&zone);
+
+	sctx->updbatchsize = batchsize;
+
+	for (size_t i = 0; i < MAXUPDATES; i++) {
+		char file[PATH_MAX];
+		unsigned char data[4096];
+		isc_buffer_t buf;
+		size_t size;
+		ns_client_t *client = NULL;
+
+		snprintf(file, sizeof(file), "%s/testdata/update/%s.msg",
+			 TESTS_DIR, s->msgs[i]);
+		result = ns_test_getdata(file, data, sizeof(data), &size);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		isc_buffer_init(&buf, data, size);
+		isc_buffer_add(&buf, size);
+
+		ns_test_getclient(NULL, false, &client);
+		dns_view_attach(view, &client->view);
+		if (client->message != NULL) {
+			dns_message_detach(&client->message);
+		}
+		dns_message_create(mctx, NULL, NULL, DNS_MESSAGE_INTENTPARSE,
+				   &client->message);
+		result = dns_message_parse(client->message, &buf, 0);
+		assert_int_equal(result, ISC_R_SUCCESS);
+		client->sendcb = check_response;
+
+		clients[i] = client;
+	}
+
+	/*
+	 * Queue all the updates before the zone's loop can get to the
+	 * first one, so that they end up in the same batch.
+	 */
+	isc_loopmgr_pause(loopmgr);
+	for (size_t i = 0; i < MAXUPDATES; i++) {
+		ns_update_start(clients[i], clients[i]->handle, ISC_R_SUCCESS);
+	}
+	isc_loopmgr_resume(loopmgr);
+}
+
+/* an update whose prerequisites fail does not stop the rest of a batch */
+ISC_LOOP_TEST_IMPL(prereq_batched) { run_updates(&prereq_batched, 10); }
+
+/* the same updates applied one at a time */
+ISC_LOOP_TEST_IMPL(prereq_unbatched) { run_updates(&prereq_unbatched, 0); }
+
+/* a batch that fails to commit is replayed one update at a time */
+ISC_LOOP_TEST_IMPL(rollback_batched) { run_updates(&rollback, 10); }
+
+/* the same updates applied one at a time */
+ISC_LOOP_TEST_IMPL(rollback_unbatched) { run_updates(&rollback, 0); }
+
+/* a batch is limited to "update-batch-size" updates */
+ISC_LOOP_TEST_IMPL(batch_size) { run_updates(&prereq_bounded, 2); }
+
+ISC_TEST_LIST_START
+ISC_TEST_ENTRY_CUSTOM(prereq_batched, setup_server, teardown_server)
+ISC_TEST_ENTRY_CUSTOM(prereq_unbatched, setup_server, teardown_server)
+ISC_TEST_ENTRY_CUSTOM(rollback_batched, setup_server, teardown_server)
+ISC_TEST_ENTRY_CUSTOM(rollback_unbatched, setup_server, teardown_server)
+ISC_TEST_ENTRY_CUSTOM(batch_size, setup_server, teardown_server)
+ISC_TEST_LIST_END
+
+ISC_TEST_MAIN